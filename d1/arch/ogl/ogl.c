@@ -54,6 +54,7 @@
 #include "gauges.h"
 #include "playsave.h"
 #include "args.h"
+#include "profile.h"
 #include "xmodel.h"
 #include "oglprog.h"
 
@@ -78,7 +79,6 @@
 unsigned char *ogl_pal=gr_palette;
 
 int last_width=-1,last_height=-1;
-int GL_TEXTURE_2D_enabled=-1;
 int GL_texclamp_enabled=-1;
 GLfloat ogl_maxanisotropy = 0;
 
@@ -96,7 +96,7 @@ int r_polyc,r_tpolyc,r_bitmapc,r_ubitbltc,r_upixelc;
 extern int linedotscale;
 #define f2glf(x) (f2fl(x))
 
-#define OGL_BINDTEXTURE(a) glBindTexture(GL_TEXTURE_2D, a);
+#define OGL_BINDTEXTURE(a) ogl_state_bind_texture(GL_TEXTURE_2D, a);
 
 
 ogl_texture ogl_texture_list[OGL_TEXTURE_LIST_SIZE];
@@ -218,6 +218,7 @@ void ogl_init_texture_list_internal(void){
 	ogl_texture_list_cur=0;
 	for (i=0;i<OGL_TEXTURE_LIST_SIZE;i++)
 		ogl_reset_texture(&ogl_texture_list[i]);
+	ogl_state_invalidate();
 }
 
 void ogl_smash_texture_list_internal(void){
@@ -251,6 +252,7 @@ void ogl_smash_texture_list_internal(void){
 		}
 		ogl_texture_list[i].wrapstate = -1;
 	}
+	ogl_state_invalidate();
 
 	xmodel_free_gl_all();
 
@@ -268,6 +270,7 @@ void ogl_smash_png_textures(void){
 	for (i=0;i<OGL_TEXTURE_LIST_SIZE;i++){
 		if (ogl_texture_list[i].handle>0 && ogl_texture_list[i].is_png){
 			glDeleteTextures( 1, &ogl_texture_list[i].handle );
+			ogl_state_forget_texture(ogl_texture_list[i].handle);
 			ogl_texture_list[i].handle=0;
 		}
 	}
@@ -341,6 +344,7 @@ void ogl_texture_stats(void)
 	gr_printf(FSPACX(2), FSPACY(1)+LINE_SPACING, "%i(%i,%i,%i,%i) %iK(%iK wasted) (%i postcachedtex)", used, usedrgba, usedrgb, usedidx, usedother, truebytes / 1024, (truebytes - databytes) / 1024, r_texcount - r_cachedtexcount);
 	gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*2), "%ibpp(r%i,g%i,b%i,a%i)x%i=%iK depth%i=%iK", idx, r, g, b, a, dbl, colorsize / 1024, depth, depthsize / 1024);
 	gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*3), "total=%iK", (colorsize + depthsize + truebytes) / 1024);
+	gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*4), "%i state calls %i elided %i queries", ogl_state_issued, ogl_state_elided, ogl_state_queries);
 }
 
 void ogl_bindbmtex(grs_bitmap *bm){
@@ -353,12 +357,15 @@ void ogl_bindbmtex(grs_bitmap *bm){
 //gltexture MUST be bound first
 void ogl_texwrap(ogl_texture *gltexture,int state)
 {
-	if (gltexture->wrapstate != state || gltexture->numrend < 1)
+	if (gltexture->wrapstate != state)
 	{
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, state);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, state);
 		gltexture->wrapstate = state;
+		ogl_state_issued += 2;
 	}
+	else
+		ogl_state_elided += 2;
 }
 
 void ogl_cache_level_textures(void)
@@ -388,8 +395,8 @@ bool g3_draw_line(g3s_point *p0,g3s_point *p1)
 	GLfloat vertex_array[] = { f2glf(p0->p3_vec.x),f2glf(p0->p3_vec.y),-f2glf(p0->p3_vec.z), f2glf(p1->p3_vec.x),f2glf(p1->p3_vec.y),-f2glf(p1->p3_vec.z) };
   
 	c=grd_curcanv->cv_color;
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	OGL_DISABLE(TEXTURE_2D);
 	color_r = PAL2Tr(c);
 	color_g = PAL2Tg(c);
@@ -401,18 +408,18 @@ bool g3_draw_line(g3s_point *p0,g3s_point *p1)
 	glVertexPointer(3, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glDrawArrays(GL_LINES, 0, 2);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 
 	return 1;
 }
 
 void ogl_drawcircle(int nsides, int type, GLfloat *vertex_array)
 {
-	glEnableClientState(GL_VERTEX_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
 	glDrawArrays(type, 0, nsides);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
 }
 
 GLfloat *circle_array_init(int nsides)
@@ -538,9 +545,9 @@ void ogl_draw_vertex_reticle(int cross,int primary,int secondary,int color,int a
 
 	glLineWidth(linedotscale*2);
 	OGL_DISABLE(TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_disable(GL_CULL_FACE);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	
 	//cross
 	if(cross)
@@ -606,8 +613,8 @@ void ogl_draw_vertex_reticle(int cross,int primary,int secondary,int color,int a
 		ogl_drawcircle(16, GL_LINE_LOOP, secondary_lva[2]);
 	}
 	
-	//glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	//ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 	glPopMatrix();
 	glLineWidth(linedotscale);
 }
@@ -628,7 +635,7 @@ int g3_draw_sphere(g3s_point *pnt,fix rad){
 		color_array[i+3] = 1.0;
 	}
 	OGL_DISABLE(TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
+	ogl_state_disable(GL_CULL_FACE);
 	glPushMatrix();
 	glTranslatef(f2glf(pnt->p3_vec.x),f2glf(pnt->p3_vec.y),-f2glf(pnt->p3_vec.z));
 	if (scale >= 1)
@@ -643,10 +650,10 @@ int g3_draw_sphere(g3s_point *pnt,fix rad){
 	}
 	if(!sphere_va)
 		sphere_va = circle_array_init(20);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	ogl_drawcircle(20, GL_TRIANGLE_FAN, sphere_va);
-	glDisableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 	glPopMatrix();
 	return 0;
 }
@@ -706,8 +713,8 @@ bool g3_draw_poly(int nv,g3s_point **pointlist)
 		Error("Too many vertices %d", nv);
 
 	r_polyc++;
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	c = grd_curcanv->cv_color;
 	OGL_DISABLE(TEXTURE_2D);
 	color_r = PAL2Tr(c);
@@ -734,8 +741,8 @@ bool g3_draw_poly(int nv,g3s_point **pointlist)
 	glVertexPointer(3, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 
 	return 0;
 }
@@ -763,11 +770,11 @@ bool g3_draw_tmap(int nv,g3s_point **pointlist,g3s_uvl *uvl_list,g3s_lrgb *light
 	if (nv > MAX_VERTS)
 		Error("Too many vertices: %d", nv);
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	
 	if (tmap_drawer_ptr == draw_tmap) {
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 		OGL_ENABLE(TEXTURE_2D);
 		ogl_bindbmtex(bm);
 		ogl_texwrap(bm->gltexture, GL_REPEAT);
@@ -814,9 +821,9 @@ bool g3_draw_tmap(int nv,g3s_point **pointlist,g3s_uvl *uvl_list,g3s_lrgb *light
 	
 	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
 	
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 
 	return 0;
 }
@@ -839,9 +846,9 @@ bool g3_draw_tmap_2(int nv, g3s_point **pointlist, g3s_uvl *uvl_list, g3s_lrgb *
 #ifndef OGL_MERGE
 	g3_draw_tmap(nv,pointlist,uvl_list,light_rgb,bmbot);//draw the bottom texture first.. could be optimized with multitexturing..
 	
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 	
 	OGL_ENABLE(TEXTURE_2D);
 	ogl_bindbmtex(bmovl);
@@ -850,17 +857,17 @@ bool g3_draw_tmap_2(int nv, g3s_point **pointlist, g3s_uvl *uvl_list, g3s_lrgb *
 	ogl_bindbmtex(bmbot);
 	ogl_texwrap(bmbot->gltexture,GL_REPEAT);
 
-	glActiveTexture(GL_TEXTURE1);
+	ogl_state_active_texture(GL_TEXTURE1);
 	ogl_bindbmtex(bmovl);
 	ogl_texwrap(bmovl->gltexture,GL_REPEAT);
 
 	if (super) {
-		glActiveTexture(GL_TEXTURE2);
+		ogl_state_active_texture(GL_TEXTURE2);
 		OGL_BINDTEXTURE(bmovl->gltexture_mask->handle);
 		ogl_texwrap(bmovl->gltexture_mask,GL_REPEAT);
 	}
 
-	glActiveTexture(GL_TEXTURE0);
+	ogl_state_active_texture(GL_TEXTURE0);
 #endif
 	
 	for (c=0; c<nv; c++) {
@@ -907,9 +914,9 @@ bool g3_draw_tmap_2(int nv, g3s_point **pointlist, g3s_uvl *uvl_list, g3s_lrgb *
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoordovl_array);
 	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 #else
 	glUseProgram(super ? ogl_prog_tex2m : ogl_prog_tex2);
 
@@ -948,9 +955,9 @@ bool g3_draw_bitmap_full(vms_vector *pos,fix width,fix height,grs_bitmap *bm,
 	r_bitmapc++;
 	v1.z=0;
 	
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 
 	OGL_ENABLE(TEXTURE_2D);
 	ogl_bindbmtex(bm);
@@ -1001,9 +1008,9 @@ bool g3_draw_bitmap_full(vms_vector *pos,fix width,fix height,grs_bitmap *bm,
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array);  
 	glDrawArrays(GL_TRIANGLE_FAN, 0, 4); // Replaced GL_QUADS
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 
 	return 0;
 }
@@ -1032,9 +1039,9 @@ bool ogl_ubitblt_i(int dw,int dh,int dx,int dy, int sw, int sh, int sx, int sy,
 	ogl_texture tex;
 	r_ubitbltc++;
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 
 	ogl_init_texture(&tex, sw, sh, OGL_FLAG_ALPHA);
 	tex.prio = 0.0;
@@ -1081,9 +1088,9 @@ bool ogl_ubitblt_i(int dw,int dh,int dx,int dy, int sw, int sh, int sx, int sy,
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array);  
 	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
 
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 	ogl_freetexture(&tex);
 	return 0;
 }
@@ -1098,9 +1105,9 @@ bool ogl_ubitblt(int w,int h,int dx,int dy, int sx, int sy, grs_bitmap * src, gr
 void ogl_toggle_depth_test(int enable)
 {
 	if (enable)
-		glEnable(GL_DEPTH_TEST);
+		ogl_state_enable(GL_DEPTH_TEST);
 	else
-		glDisable(GL_DEPTH_TEST);
+		ogl_state_disable(GL_DEPTH_TEST);
 }
 
 /* 
@@ -1111,14 +1118,14 @@ void ogl_set_blending()
 	switch ( grd_curcanv->cv_blend_func )
 	{
 		case GR_BLEND_ADDITIVE_A:
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE );
+			ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE);
 			break;
 		case GR_BLEND_ADDITIVE_C:
-			glBlendFunc( GL_ONE, GL_ONE );
+			ogl_state_blend_func(GL_ONE, GL_ONE);
 			break;
 		case GR_BLEND_NORMAL:
 		default:
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+			ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 			break;
 	}
 }
@@ -1131,24 +1138,25 @@ void ogl_start_frame(void){
 	#endif
 
 	r_polyc=0;r_tpolyc=0;r_bitmapc=0;r_ubitbltc=0;r_upixelc=0;
+	ogl_state_reset_counters();
 
 	OGL_VIEWPORT(grd_curcanv->cv_bitmap.bm_x,grd_curcanv->cv_bitmap.bm_y,Canvas_width,Canvas_height);
 	glClearColor(0.0, 0.0, 0.0, 0.0);
 
 	glLineWidth(linedotscale);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	ogl_state_enable(GL_BLEND);
+	ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glEnable(GL_ALPHA_TEST);
+	ogl_state_enable(GL_ALPHA_TEST);
 	glAlphaFunc(GL_GEQUAL,0.02);
 
 	if (!GameCfg.ClassicDepth || (Game_mode & GM_MULTI))
-		glEnable(GL_DEPTH_TEST);
+		ogl_state_enable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LEQUAL);
 
 	glClear(GL_DEPTH_BUFFER_BIT);
 
-	glEnable(GL_CULL_FACE);
+	ogl_state_enable(GL_CULL_FACE);
 	glFrontFace(GL_CW);
 
 	glShadeModel(GL_SMOOTH);
@@ -1179,8 +1187,8 @@ void ogl_end_frame(void){
 #endif
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();//clear matrix
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
+	ogl_state_disable(GL_CULL_FACE);
+	ogl_state_disable(GL_DEPTH_TEST);
 
 #ifdef OGL_MERGE
 	ogl_prog_set_matrix(ogl_mat_ortho);
@@ -1516,6 +1524,8 @@ void tex_set_size(ogl_texture *tex){
 int ogl_loadtexture (unsigned char *data, int dxo, int dyo, ogl_texture *tex, int bm_flags, int data_format, int texfilt)
 {
 	GLubyte	*bufP = texbuf;
+
+	PROF_BEGIN(PROF_TEXTURE);
 	tex->tw = pow2ize (tex->w);
 	tex->th = pow2ize (tex->h);//calculate smallest texture size that can accomodate us (must be multiples of 2)
 
@@ -1552,6 +1562,7 @@ int ogl_loadtexture (unsigned char *data, int dxo, int dyo, ogl_texture *tex, in
 	}
 	// Generate OpenGL texture IDs.
 	glGenTextures (1, &tex->handle);
+	tex->wrapstate = -1; // the handle may have been recycled
 #ifndef OGLES
 	//set priority
 	glPrioritizeTextures (1, &tex->handle, &tex->prio);
@@ -1599,6 +1610,7 @@ int ogl_loadtexture (unsigned char *data, int dxo, int dyo, ogl_texture *tex, in
 
 	tex_set_size (tex);
 	r_texcount++;
+	PROF_END(PROF_TEXTURE);
 	return 0;
 }
 
@@ -1821,6 +1833,7 @@ void ogl_freetexture(ogl_texture *gltexture)
 		r_texcount--;
 		glmprintf((0,"ogl_freetexture(%p):%i (%i left)\n",gltexture,gltexture->handle,r_texcount));
 		glDeleteTextures( 1, &gltexture->handle );
+		ogl_state_forget_texture(gltexture->handle);
 //		gltexture->handle=0;
 		ogl_reset_texture(gltexture);
 	}
@@ -1853,9 +1866,9 @@ bool ogl_ubitmapm_cs(int x, int y,int dw, int dh, grs_bitmap *bm,int c, int scal
 	yo=1.0-y/(float)last_height;
 	yf=1.0-(bm->bm_h+y)/(float)last_height;
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 
 	if (dw < 0)
 		dw = grd_curcanv->cv_bitmap.bm_w;
@@ -1935,9 +1948,9 @@ bool ogl_ubitmapm_cs(int x, int y,int dw, int dh, grs_bitmap *bm,int c, int scal
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array);  
 	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 	
 	return 0;
 }
@@ -1949,12 +1962,12 @@ void ogl_update_window_clip()
 
 	if (!Window_clip_left && !Window_clip_top &&
 		Window_clip_right == cw - 1 && Window_clip_bot == ch - 1) {
-		glDisable(GL_SCISSOR_TEST);
+		ogl_state_disable(GL_SCISSOR_TEST);
 	} else {
-		glScissor(Window_clip_left + grd_curcanv->cv_bitmap.bm_x,
+		ogl_state_scissor(Window_clip_left + grd_curcanv->cv_bitmap.bm_x,
 			grd_curscreen->sc_h - grd_curcanv->cv_bitmap.bm_y - Window_clip_bot - 1,
 			Window_clip_right - Window_clip_left + 1,
 			Window_clip_bot - Window_clip_top + 1);
-		glEnable(GL_SCISSOR_TEST);
+		ogl_state_enable(GL_SCISSOR_TEST);
 	}
 }
@@ -0,0 +1,397 @@
+/*
+ *
+ * OpenGL state cache.
+ *
+ * Keeps a shadow copy of the GL state the renderer switches around most
+ * (enables, blend function, client arrays, texture and framebuffer bindings,
+ * viewport, scissor box, read buffer, pixel alignment). Calls that would not
+ * change anything are dropped, and code that has to save and restore state
+ * (the VR submit paths) can read it here instead of stalling on glGet*.
+ * Whatever is not known yet - after a context change or
+ * ogl_state_invalidate() - is set or queried once and remembered from then on.
+ * State changed behind the back of this file must be followed by
+ * ogl_state_invalidate().
+ *
+ */
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#include <stddef.h>
+#endif
+#include <string.h>
+
+#include "internal.h"
+
+#define OGL_STATE_UNKNOWN -1
+#define OGL_STATE_UNITS 4
+
+enum {
+	OGL_CAP_TEXTURE_2D,
+	OGL_CAP_BLEND,
+	OGL_CAP_ALPHA_TEST,
+	OGL_CAP_DEPTH_TEST,
+	OGL_CAP_CULL_FACE,
+	OGL_CAP_SCISSOR_TEST,
+	OGL_CAP_COUNT
+};
+
+enum {
+	OGL_ARRAY_VERTEX,
+	OGL_ARRAY_COLOR,
+	OGL_ARRAY_TEXCOORD,
+	OGL_ARRAY_COUNT
+};
+
+typedef struct ogl_state {
+	int cap[OGL_STATE_UNITS][OGL_CAP_COUNT]; // GL_TEXTURE_2D is per texture unit, the others only use [0]
+	int array[OGL_ARRAY_COUNT];
+	GLint blend_src, blend_dst;
+	int unit; // active texture unit, 0 based
+	GLint tex2d[OGL_STATE_UNITS], texarray[OGL_STATE_UNITS];
+	GLint read_fbo, draw_fbo;
+	GLint viewport[4], scissor[4];
+	GLint read_buffer, draw_buffer;
+	GLint pack_align, unpack_align;
+	GLint doublebuffer;
+} ogl_state;
+
+static ogl_state ogl_cur_state;
+
+int ogl_state_issued, ogl_state_elided, ogl_state_queries;
+
+// forget everything. Needed after a new context got created or somebody changed state directly.
+void ogl_state_invalidate(void)
+{
+	GLint *p = (GLint *)&ogl_cur_state;
+	int i;
+
+	// the struct is nothing but ints
+	for (i = 0; i < sizeof(ogl_cur_state) / sizeof(GLint); i++)
+		p[i] = OGL_STATE_UNKNOWN;
+}
+
+// a call went through (1) or got dropped (0)
+static int ogl_state_issue(int changed)
+{
+	if (changed)
+		ogl_state_issued++;
+	else
+		ogl_state_elided++;
+	return changed;
+}
+
+static int ogl_state_cap_index(GLenum cap)
+{
+	switch (cap)
+	{
+		case GL_TEXTURE_2D: return OGL_CAP_TEXTURE_2D;
+		case GL_BLEND: return OGL_CAP_BLEND;
+		case GL_ALPHA_TEST: return OGL_CAP_ALPHA_TEST;
+		case GL_DEPTH_TEST: return OGL_CAP_DEPTH_TEST;
+		case GL_CULL_FACE: return OGL_CAP_CULL_FACE;
+		case GL_SCISSOR_TEST: return OGL_CAP_SCISSOR_TEST;
+	}
+	return -1;
+}
+
+static int *ogl_state_cap(GLenum cap)
+{
+	int i = ogl_state_cap_index(cap);
+
+	if (i < 0)
+		return NULL;
+	if (i == OGL_CAP_TEXTURE_2D && ogl_cur_state.unit > 0 && ogl_cur_state.unit < OGL_STATE_UNITS)
+		return &ogl_cur_state.cap[ogl_cur_state.unit][i];
+	if (i == OGL_CAP_TEXTURE_2D && ogl_cur_state.unit != 0)
+		return NULL; // active unit unknown or not tracked
+	return &ogl_cur_state.cap[0][i];
+}
+
+void ogl_state_set(GLenum cap, int on)
+{
+	int *s = ogl_state_cap(cap);
+
+	on = !!on;
+	if (s && *s == on)
+	{
+		ogl_state_issue(0);
+		return;
+	}
+	if (on)
+		glEnable(cap);
+	else
+		glDisable(cap);
+	if (s)
+		*s = on;
+	ogl_state_issue(1);
+}
+
+void ogl_state_enable(GLenum cap)
+{
+	ogl_state_set(cap, 1);
+}
+
+void ogl_state_disable(GLenum cap)
+{
+	ogl_state_set(cap, 0);
+}
+
+int ogl_state_enabled(GLenum cap)
+{
+	int *s = ogl_state_cap(cap);
+
+	if (!s)
+	{
+		ogl_state_queries++;
+		return glIsEnabled(cap);
+	}
+	if (*s == OGL_STATE_UNKNOWN)
+	{
+		ogl_state_queries++;
+		*s = glIsEnabled(cap) ? 1 : 0;
+	}
+	return *s;
+}
+
+void ogl_state_blend_func(GLenum src, GLenum dst)
+{
+	if (!ogl_state_issue(ogl_cur_state.blend_src != src || ogl_cur_state.blend_dst != dst))
+		return;
+	glBlendFunc(src, dst);
+	ogl_cur_state.blend_src = src;
+	ogl_cur_state.blend_dst = dst;
+}
+
+// GL_VERTEX_ARRAY, GL_COLOR_ARRAY or GL_TEXTURE_COORD_ARRAY
+void ogl_state_client_array(GLenum array, int on)
+{
+	int i;
+
+	switch (array)
+	{
+		case GL_VERTEX_ARRAY: i = OGL_ARRAY_VERTEX; break;
+		case GL_COLOR_ARRAY: i = OGL_ARRAY_COLOR; break;
+		case GL_TEXTURE_COORD_ARRAY: i = OGL_ARRAY_TEXCOORD; break;
+		default: i = -1; break;
+	}
+	on = !!on;
+	if (i >= 0 && !ogl_state_issue(ogl_cur_state.array[i] != on))
+		return;
+	if (on)
+		glEnableClientState(array);
+	else
+		glDisableClientState(array);
+	if (i >= 0)
+		ogl_cur_state.array[i] = on;
+	else
+		ogl_state_issue(1);
+}
+
+void ogl_state_active_texture(GLenum unit)
+{
+	if (!ogl_state_issue(ogl_cur_state.unit != (int)(unit - GL_TEXTURE0)))
+		return;
+	glActiveTexture(unit);
+	ogl_cur_state.unit = unit - GL_TEXTURE0;
+}
+
+// returns 1 if the texture actually had to be bound
+int ogl_state_bind_texture(GLenum target, GLuint handle)
+{
+	GLint *s = NULL;
+
+	if (ogl_cur_state.unit >= 0 && ogl_cur_state.unit < OGL_STATE_UNITS)
+	{
+		if (target == GL_TEXTURE_2D)
+			s = &ogl_cur_state.tex2d[ogl_cur_state.unit];
+#ifdef GL_TEXTURE_2D_ARRAY
+		else if (target == GL_TEXTURE_2D_ARRAY)
+			s = &ogl_cur_state.texarray[ogl_cur_state.unit];
+#endif
+	}
+	if (!ogl_state_issue(!s || *s != (GLint)handle))
+		return 0;
+	glBindTexture(target, handle);
+	if (s)
+		*s = handle;
+	return 1;
+}
+
+// deleting a bound texture silently rebinds 0, and the name may come back from glGenTextures
+void ogl_state_forget_texture(GLuint handle)
+{
+	int i;
+
+	for (i = 0; i < OGL_STATE_UNITS; i++)
+	{
+		if (ogl_cur_state.tex2d[i] == (GLint)handle)
+			ogl_cur_state.tex2d[i] = 0;
+		if (ogl_cur_state.texarray[i] == (GLint)handle)
+			ogl_cur_state.texarray[i] = 0;
+	}
+}
+
+#ifdef GL_FRAMEBUFFER
+void ogl_state_bind_framebuffer(GLenum target, GLuint fbo)
+{
+	int read = target != GL_DRAW_FRAMEBUFFER, draw = target != GL_READ_FRAMEBUFFER;
+
+	if (!ogl_state_issue((read && ogl_cur_state.read_fbo != (GLint)fbo) || (draw && ogl_cur_state.draw_fbo != (GLint)fbo)))
+		return;
+	glBindFramebuffer(target, fbo);
+	// glReadBuffer and glDrawBuffer state belongs to the framebuffer, so it is unknown after a switch
+	if (read && ogl_cur_state.read_fbo != (GLint)fbo)
+	{
+		ogl_cur_state.read_fbo = fbo;
+		ogl_cur_state.read_buffer = OGL_STATE_UNKNOWN;
+	}
+	if (draw && ogl_cur_state.draw_fbo != (GLint)fbo)
+	{
+		ogl_cur_state.draw_fbo = fbo;
+		ogl_cur_state.draw_buffer = OGL_STATE_UNKNOWN;
+	}
+}
+
+// GL_READ_FRAMEBUFFER, anything else gives the draw framebuffer
+GLuint ogl_state_framebuffer(GLenum target)
+{
+	if (target == GL_READ_FRAMEBUFFER)
+	{
+		if (ogl_cur_state.read_fbo == OGL_STATE_UNKNOWN)
+		{
+			glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ogl_cur_state.read_fbo);
+			ogl_state_queries++;
+		}
+		return ogl_cur_state.read_fbo;
+	}
+	if (ogl_cur_state.draw_fbo == OGL_STATE_UNKNOWN)
+	{
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &ogl_cur_state.draw_fbo);
+		ogl_state_queries++;
+	}
+	return ogl_cur_state.draw_fbo;
+}
+
+// as with textures, deleting the bound framebuffer falls back to the default one
+void ogl_state_forget_framebuffer(GLuint fbo)
+{
+	if (ogl_cur_state.read_fbo == (GLint)fbo)
+	{
+		ogl_cur_state.read_fbo = 0;
+		ogl_cur_state.read_buffer = OGL_STATE_UNKNOWN;
+	}
+	if (ogl_cur_state.draw_fbo == (GLint)fbo)
+	{
+		ogl_cur_state.draw_fbo = 0;
+		ogl_cur_state.draw_buffer = OGL_STATE_UNKNOWN;
+	}
+}
+#endif
+
+static int ogl_state_rect(GLint *r, GLint x, GLint y, GLsizei w, GLsizei h)
+{
+	if (!ogl_state_issue(r[0] != x || r[1] != y || r[2] != w || r[3] != h))
+		return 0;
+	r[0] = x;
+	r[1] = y;
+	r[2] = w;
+	r[3] = h;
+	return 1;
+}
+
+void ogl_state_viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+	if (ogl_state_rect(ogl_cur_state.viewport, x, y, w, h))
+		glViewport(x, y, w, h);
+}
+
+void ogl_state_scissor(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+	if (ogl_state_rect(ogl_cur_state.scissor, x, y, w, h))
+		glScissor(x, y, w, h);
+}
+
+static void ogl_state_query(GLenum pname, GLint *v)
+{
+	if (*v == OGL_STATE_UNKNOWN)
+	{
+		glGetIntegerv(pname, v);
+		ogl_state_queries++;
+	}
+}
+
+void ogl_state_get_viewport(GLint *v)
+{
+	ogl_state_query(GL_VIEWPORT, ogl_cur_state.viewport);
+	memcpy(v, ogl_cur_state.viewport, sizeof(ogl_cur_state.viewport));
+}
+
+void ogl_state_get_scissor(GLint *v)
+{
+	ogl_state_query(GL_SCISSOR_BOX, ogl_cur_state.scissor);
+	memcpy(v, ogl_cur_state.scissor, sizeof(ogl_cur_state.scissor));
+}
+
+void ogl_state_read_buffer(GLenum mode)
+{
+	if (!ogl_state_issue(ogl_cur_state.read_buffer != (GLint)mode))
+		return;
+	glReadBuffer(mode);
+	ogl_cur_state.read_buffer = mode;
+}
+
+void ogl_state_draw_buffer(GLenum mode)
+{
+	if (!ogl_state_issue(ogl_cur_state.draw_buffer != (GLint)mode))
+		return;
+	glDrawBuffer(mode);
+	ogl_cur_state.draw_buffer = mode;
+}
+
+GLenum ogl_state_get_read_buffer(void)
+{
+	ogl_state_query(GL_READ_BUFFER, &ogl_cur_state.read_buffer);
+	return ogl_cur_state.read_buffer;
+}
+
+GLenum ogl_state_get_draw_buffer(void)
+{
+	ogl_state_query(GL_DRAW_BUFFER, &ogl_cur_state.draw_buffer);
+	return ogl_cur_state.draw_buffer;
+}
+
+// GL_PACK_ALIGNMENT or GL_UNPACK_ALIGNMENT
+void ogl_state_pixel_store(GLenum pname, GLint v)
+{
+	GLint *s = pname == GL_PACK_ALIGNMENT ? &ogl_cur_state.pack_align : pname == GL_UNPACK_ALIGNMENT ? &ogl_cur_state.unpack_align : NULL;
+
+	if (!ogl_state_issue(!s || *s != v))
+		return;
+	glPixelStorei(pname, v);
+	if (s)
+		*s = v;
+}
+
+GLint ogl_state_get_pixel_store(GLenum pname)
+{
+	GLint *s = pname == GL_PACK_ALIGNMENT ? &ogl_cur_state.pack_align : &ogl_cur_state.unpack_align;
+
+	ogl_state_query(pname, s);
+	return *s;
+}
+
+int ogl_state_doublebuffer(void)
+{
+#ifdef OGLES
+	return 1;
+#else
+	ogl_state_query(GL_DOUBLEBUFFER, &ogl_cur_state.doublebuffer);
+	return ogl_cur_state.doublebuffer;
+#endif
+}
+
+void ogl_state_reset_counters(void)
+{
+	ogl_state_issued = ogl_state_elided = ogl_state_queries = 0;
+}
@@ -213,11 +213,15 @@ void event_process(void)
 			wind = window_get_next(wind);
 	}
 
-	gr_flip();
+	if (!GameArg.SysHeadless)
+		gr_flip();
 }
 
 void event_toggle_focus(int activate_focus)
 {
+	if (GameArg.SysHeadless) // there is no window to grab
+		return;
+
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 	SDL_Window *window = SDL_GetMouseFocus();
 	if (!window)
@@ -16,7 +16,8 @@ void arch_close(void)
 {
 	songs_uninit();
 
-	gr_close();
+	if (!GameArg.SysHeadless)
+		gr_close();
 
 	if (!GameArg.CtlNoJoystick)
 		joy_close();
@@ -29,7 +30,8 @@ void arch_close(void)
 		digi_close();
 	}
 
-	key_close();
+	if (!GameArg.SysHeadless)
+		key_close();
 
 	SDL_Quit();
 }
@@ -38,6 +40,14 @@ void arch_init(void)
 {
 	int t;
 
+	if (GameArg.SysHeadless) // headless, only the timer is needed
+	{
+		if (SDL_Init(SDL_INIT_TIMER) < 0)
+			Error("SDL library initialisation failed: %s.",SDL_GetError());
+		atexit(arch_close);
+		return;
+	}
+
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 		Error("SDL library initialisation failed: %s.",SDL_GetError());
 
@@ -52,6 +52,10 @@ typedef struct Arg
 	int SysNoBorders;
 	int SysAutoDemo;
 	int SysNoTitles;
+	char *SysTimeDemo;
+	const char *SysTimeDemoJSON;
+	int SysTimeDemoNoRender;
+	int SysHeadless; // -dedicated, -headless or -timedemo_norender: no window, sound or input
 	int CtlNoCursor;
 	int CtlNoMouse;
 	int CtlNoJoystick;
@@ -68,6 +72,14 @@ typedef struct Arg
 	const char *MplUdpHostAddr;
 	int MplUdpHostPort;
 	int MplUdpMyPort;
+	int MplUdpJoin;
+	int MplUdpThread;
+	int MplUdpMtu;
+	int MplUdpSnapshot;
+	int MplObsRelay;
+	int MplDedicated;
+	const char *MplDedicatedCmd;
+	int MplDedicatedTick;
 #ifdef USE_TRACKER
 	const char *MplTrackerAddr;
 	int MplTrackerPort;
@@ -76,6 +88,11 @@ typedef struct Arg
 	int DbgSafelog;
 	int DbgNoRun;
 	int DbgRenderStats;
+#ifdef BENCHMARKS
+	int DbgPlpBench;
+	int DbgSigBench;
+#endif
+	int DbgProfile;
 	char *DbgAltTex;
 	char *DbgTexMap;
 	int DbgShowMemInfo;
@@ -94,6 +111,7 @@ typedef struct Arg
 	int DbgSdlASyncBlit;
 #endif
 	int LogNetTraffic; 
+	int LogNetCrash;
 	int GameLogTimeStamp;
 	int GameLogSplit;
 } __pack__ Arg;
@@ -18,14 +18,8 @@ extern int ogl_brightness_ok;
 extern int ogl_brightness_r, ogl_brightness_g, ogl_brightness_b;
 extern int ogl_fullscreen;
 
-extern int GL_TEXTURE_2D_enabled;
-#define OGL_ENABLE2(a,f) {if (a ## _enabled!=1) {f;a ## _enabled=1;}}
-#define OGL_DISABLE2(a,f) {if (a ## _enabled!=0) {f;a ## _enabled=0;}}
-
-//#define OGL_ENABLE(a) OGL_ENABLE2(a,glEnable(a))
-//#define OGL_DISABLE(a) OGL_DISABLE2(a,glDisable(a))
-#define OGL_ENABLE(a) OGL_ENABLE2(GL_ ## a,glEnable(GL_ ## a))
-#define OGL_DISABLE(a) OGL_DISABLE2(GL_ ## a,glDisable(GL_ ## a))
+#define OGL_ENABLE(a) ogl_state_enable(GL_ ## a)
+#define OGL_DISABLE(a) ogl_state_disable(GL_ ## a)
 
 //#define OGL_TEXCLAMP() OGL_ENABLE2(GL_texclamp,glTexParameteri(GL_TEXTURE_2D,  GL_TEXTURE_WRAP_S, GL_CLAMP);glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,    GL_CLAMP);)
 //#define OGL_TEXREPEAT() OGL_DISABLE2(GL_texclamp,glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);)
@@ -34,7 +28,7 @@ extern int GL_TEXTURE_2D_enabled;
 //#define OGL_TEXPARAM(p,m) OGL_SETSTATE(p,m,glTexParameteri(GL_TEXTURE_2D,p,m))
 
 extern int last_width,last_height;
-#define OGL_VIEWPORT(x,y,w,h){if (w!=last_width || h!=last_height){glViewport(x,grd_curscreen->sc_canvas.cv_bitmap.bm_h-y-h,w,h);last_width=w;last_height=h;}}
+#define OGL_VIEWPORT(x,y,w,h){ogl_state_viewport(x,grd_curscreen->sc_canvas.cv_bitmap.bm_h-y-h,w,h);last_width=w;last_height=h;}
 
 //platform specific funcs
 extern void ogl_swap_buffers_internal(void);
@@ -111,4 +111,35 @@ void ogl_toggle_depth_test(int enable);
 void ogl_set_blending();
 int pow2ize(int x);//from ogl.c
 
+/* GL state cache (oglstate.c). Anything that changes this state directly has to call ogl_state_invalidate() afterwards. */
+extern int ogl_state_issued, ogl_state_elided, ogl_state_queries;
+void ogl_state_invalidate(void);
+void ogl_state_reset_counters(void);
+void ogl_state_set(GLenum cap, int on);
+void ogl_state_enable(GLenum cap);
+void ogl_state_disable(GLenum cap);
+int ogl_state_enabled(GLenum cap);
+void ogl_state_blend_func(GLenum src, GLenum dst);
+void ogl_state_client_array(GLenum array, int on);
+void ogl_state_active_texture(GLenum unit);
+int ogl_state_bind_texture(GLenum target, GLuint handle);
+void ogl_state_forget_texture(GLuint handle);
+#ifdef GL_FRAMEBUFFER
+void ogl_state_bind_framebuffer(GLenum target, GLuint fbo);
+GLuint ogl_state_framebuffer(GLenum target);
+void ogl_state_forget_framebuffer(GLuint fbo);
+#endif
+void ogl_state_viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+void ogl_state_get_viewport(GLint *v);
+void ogl_state_scissor(GLint x, GLint y, GLsizei w, GLsizei h);
+void ogl_state_get_scissor(GLint *v);
+void ogl_state_read_buffer(GLenum mode);
+void ogl_state_draw_buffer(GLenum mode);
+GLenum ogl_state_get_read_buffer(void);
+GLenum ogl_state_get_draw_buffer(void);
+void ogl_state_pixel_store(GLenum pname, GLint v);
+GLint ogl_state_get_pixel_store(GLenum pname);
+int ogl_state_doublebuffer(void);
+
+
 #endif /* _OGL_INIT_H_ */
@@ -26,6 +26,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 void timer_update();
 fix64 timer_query();
+fix64 timer_query_perf(u_int64_t perf);
 void timer_delay(fix seconds);
 void timer_delay2(int fps);
 
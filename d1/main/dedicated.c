@@ -0,0 +1,263 @@
+/*
+ *
+ * Headless dedicated host.
+ *
+ * With -dedicated the game hosts UDP netgames without a window, sound or input, and without a ship of its own: the
+ * host sits in slot 0 as an observer (Netgame.host_is_obs) and the players join the game in progress. The game runs
+ * in its usual window on the headless screen in memory, game_handler() skips drawing it and calc_frame_time() paces
+ * it to -dedicated_tick frames per second. Commands come from the -dedicated_cmd file and from the console:
+ *
+ *   mission <name>      host mission <name>, the mission file name without extension
+ *   level <n>           start at level <n>
+ *   preset <name>       load the netgame settings from <name>.ngs, as saved with "Save Preset" when setting up a game
+ *   set <key>=<value>   change one netgame setting, named as in a preset file (e.g. set KillGoal=10)
+ *   start               host a game with these settings, done after the -dedicated_cmd file anyway
+ *   stop                end the game and do not start another one
+ *   say <text>          send a message to everyone
+ *   kick <n>            drop player <n> as listed by status
+ *   status              show the game and its players
+ *   exec <file>         run the commands in <file>
+ *   quit                end the game and exit
+ *
+ * Settings changed during a game apply to the next one. A game that ends is started again.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/select.h>
+#endif
+
+#include "pstypes.h"
+#include "args.h"
+#include "console.h"
+#include "dxxerror.h"
+#include "physfsx.h"
+#include "strutil.h"
+#include "timer.h"
+#include "window.h"
+#include "game.h"
+#include "inferno.h"
+#include "player.h"
+#include "playsave.h"
+#include "mission.h"
+#include "multi.h"
+#include "net_udp.h"
+#include "config.h"
+#include "dedicated.h"
+
+#define DEDICATED_MISSION D1_MISSION_FILENAME
+
+static netgame_info dedicated_netgame; // settings for the next game
+static char dedicated_mission[PATH_MAX] = DEDICATED_MISSION;
+static int dedicated_run = 1, dedicated_quit = 0;
+
+static void dedicated_command(char *line);
+
+static void dedicated_exec(const char *filename)
+{
+	PHYSFS_file *fp;
+	char line[256];
+
+	if (!(fp = PHYSFSX_openReadBuffered(filename)))
+	{
+		con_printf(CON_URGENT, "Cannot open %s\n", filename);
+		return;
+	}
+	while (!PHYSFS_eof(fp) && !dedicated_quit)
+	{
+		PHYSFSX_fgets(line, sizeof(line), fp);
+		dedicated_command(line);
+	}
+	PHYSFS_close(fp);
+}
+
+#ifndef _WIN32
+// commands typed on the console, without waiting for them
+static void dedicated_read_console(void)
+{
+	static char line[256];
+	static int len = 0, eof = 0;
+	struct timeval tv;
+	fd_set fds;
+	char c;
+
+	while (!eof)
+	{
+		FD_ZERO(&fds);
+		FD_SET(0, &fds);
+		tv.tv_sec = tv.tv_usec = 0;
+		if (select(1, &fds, NULL, NULL, &tv) <= 0)
+			return;
+		if (read(0, &c, 1) != 1)
+			eof = 1;
+		else if (c == '\n')
+		{
+			line[len] = 0;
+			len = 0;
+			dedicated_command(line);
+		}
+		else if (len < (int)sizeof(line) - 1)
+			line[len++] = c;
+	}
+}
+#else
+static void dedicated_read_console(void)
+{
+	// no console input on Windows, use -dedicated_cmd
+}
+#endif
+
+static void dedicated_status(void)
+{
+	int i;
+
+	if (!Game_wind)
+	{
+		con_printf(CON_NORMAL, "No game running%s\n", dedicated_run ? "" : ", type start to host one");
+		return;
+	}
+	con_printf(CON_NORMAL, "%s: %s, level %i, %i players, %i observers\n", Netgame.game_name, Current_mission_longname, Current_level_num, N_players - 1, Netgame.numobservers);
+	for (i = 1; i < N_players; i++)
+		if (Players[i].connected)
+			con_printf(CON_NORMAL, "%i. %-8s  %i kills, %i deaths%s\n", i, Players[i].callsign, Players[i].net_kills_total, Players[i].net_killed_total, Players[i].connected == CONNECT_PLAYING ? "" : "  (between levels)");
+}
+
+static int dedicated_start(void)
+{
+	char *name = dedicated_mission;
+
+	if ((!Current_mission || d_stricmp(Current_mission_filename, name)) && !load_mission_by_name(name))
+	{
+		con_printf(CON_URGENT, "Mission '%s' not found\n", name);
+		return 0;
+	}
+
+	Netgame = dedicated_netgame;
+	if (!net_udp_host_dedicated())
+	{
+		con_printf(CON_URGENT, "Cannot host the game\n");
+		return 0;
+	}
+	con_printf(CON_NORMAL, "Hosting %s: %s, level %i\n", Netgame.game_name, Netgame.mission_title, Netgame.levelnum);
+	return 1;
+}
+
+static void dedicated_command(char *line)
+{
+	char *cmd = line, *arg, *p;
+	int i;
+
+	while (isspace((unsigned char)*cmd))
+		cmd++;
+	for (p = cmd + strlen(cmd); p > cmd && isspace((unsigned char)p[-1]); p--)
+		*(p - 1) = 0;
+	if (!*cmd || *cmd == '#' || *cmd == ';')
+		return;
+	for (arg = cmd; *arg && !isspace((unsigned char)*arg); arg++)
+		;
+	if (*arg)
+		*arg++ = 0;
+	while (isspace((unsigned char)*arg))
+		arg++;
+
+	if (!d_stricmp(cmd, "mission"))
+		snprintf(dedicated_mission, sizeof(dedicated_mission), "%s", arg);
+	else if (!d_stricmp(cmd, "level"))
+		dedicated_netgame.levelnum = atoi(arg);
+	else if (!d_stricmp(cmd, "preset"))
+	{
+		char filename[PATH_MAX];
+
+		snprintf(filename, sizeof(filename), "%s.ngs", arg);
+		if (read_netgame_settings_file(filename, &dedicated_netgame, 1))
+			con_printf(CON_URGENT, "Cannot read preset %s\n", filename);
+	}
+	else if (!d_stricmp(cmd, "set"))
+	{
+		if (!(p = strchr(arg, '=')))
+			p = arg + strlen(arg);
+		else
+			*p++ = 0;
+		if (!netgame_setting_set(&dedicated_netgame, arg, p, 0))
+			con_printf(CON_URGENT, "Unknown setting '%s'\n", arg);
+	}
+	else if (!d_stricmp(cmd, "start"))
+		dedicated_run = 1;
+	else if (!d_stricmp(cmd, "stop"))
+		dedicated_run = 0;
+	else if (!d_stricmp(cmd, "say"))
+	{
+		if (!Game_wind)
+			return;
+		snprintf(Network_message, MAX_MESSAGE_LEN, "%s", arg);
+		Network_message_reciever = 100;
+		multi_send_message();
+	}
+	else if (!d_stricmp(cmd, "kick"))
+	{
+		i = atoi(arg);
+		if (!Game_wind || i < 1 || i >= N_players || !Players[i].connected)
+			con_printf(CON_URGENT, "No player %s\n", arg);
+		else
+		{
+			con_printf(CON_NORMAL, "Dumping %s...\n", Players[i].callsign);
+			net_udp_dump_player(Netgame.players[i].protocol.udp.addr, 0, DUMP_KICKED);
+		}
+	}
+	else if (!d_stricmp(cmd, "status"))
+		dedicated_status();
+	else if (!d_stricmp(cmd, "exec"))
+		dedicated_exec(arg);
+	else if (!d_stricmp(cmd, "quit"))
+		dedicated_quit = 1;
+	else
+		con_printf(CON_URGENT, "Unknown command '%s'\n", cmd);
+}
+
+void dedicated_main(void)
+{
+	d_event event;
+
+	if (!Players[Player_num].callsign[0])
+	{
+		strcpy(Players[Player_num].callsign, "server");
+		new_player_config();
+	}
+	PlayerCfg.maxFps = max(min(GameArg.MplDedicatedTick, MAXIMUM_FPS), 25); // the lowest the menu allows
+	PlayerCfg.CurrentCockpitMode = PlayerCfg.PreferredCockpitMode = CM_FULL_SCREEN;
+	PlayerCfg.AutoDemoMp = 0;
+	GameArg.SysUseNiceFPS = 1;
+	GameCfg.VSync = 0;
+
+	netgame_set_defaults();
+	dedicated_netgame = Netgame;
+	dedicated_netgame.levelnum = 1;
+
+	if (GameArg.MplDedicatedCmd)
+		dedicated_exec(GameArg.MplDedicatedCmd);
+
+	// closing the game window comes back here
+	setjmp(LeaveEvents);
+	while (!dedicated_quit)
+	{
+		timer_update();
+		dedicated_read_console();
+
+		if (Game_wind && (dedicated_quit || !dedicated_run))
+			window_close(Game_wind);
+		else if (Game_wind)
+		{
+			event.type = EVENT_WINDOW_DRAW;
+			window_send_event(Game_wind, &event);
+		}
+		else if (!dedicated_run)
+			timer_delay(F1_0 / 10);
+		else if (!dedicated_start())
+			dedicated_run = 0;
+	}
+}
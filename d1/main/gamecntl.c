@@ -61,6 +61,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "weapon.h"
 #include "sounds.h"
 #include "args.h"
+#include "profile.h"
 #include "gameseq.h"
 #include "automap.h"
 #include "text.h"
@@ -420,6 +421,16 @@ int HandleDemoKey(int key)
 		case KEY_CTRLED + KEY_LEFT:
 			newdemo_goto_beginning();
 			break;
+		case KEY_PAGEUP:
+			newdemo_skip(-F1_0*10);
+			break;
+		case KEY_PAGEDOWN:
+			newdemo_skip(F1_0*10);
+			break;
+		case KEY_0: case KEY_1: case KEY_2: case KEY_3: case KEY_4:
+		case KEY_5: case KEY_6: case KEY_7: case KEY_8: case KEY_9:
+			newdemo_seek_percent(key == KEY_0 ? 0 : (key - KEY_1 + 1) * 10);
+			break;
 
 		KEY_MAC(case KEY_COMMAND+KEY_P:)
 		case KEY_PAUSE:
@@ -667,6 +678,23 @@ int HandleSystemKey(int key)
 				state_restore_all(1);
 			break;
 
+		case KEY_ALTED + KEY_SHIFTED + KEY_F7:
+			if (Profile_enabled)
+				Profile_overlay = !Profile_overlay;
+			break;
+
+		case KEY_ALTED + KEY_SHIFTED + KEY_F8:
+			if (Profile_enabled)
+			{
+				const char *filename = prof_write_trace();
+
+				if (filename)
+					HUD_init_message(HM_DEFAULT, "Profile written to %s", filename);
+				else
+					HUD_init_message_literal(HM_DEFAULT, "Cannot write the profile");
+			}
+			break;
+
 			/*
 			 * Jukebox hotkeys -- MD2211, 2007
 			 * Now for all music
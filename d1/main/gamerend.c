@@ -51,6 +51,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "mission.h"
 #include "gameseq.h"
 #include "args.h"
+#include "profile.h"
 
 #ifdef OGL
 #include "ogl_init.h"
@@ -112,6 +113,31 @@ void show_framerate()
 	gr_printf(SWIDTH-(GameArg.SysMaxFPS>999?FSPACX(43):FSPACX(37)),y,"FPS: %i",fps_rate);
 }
 
+// -profile overlay: the frame and the slowest zones, average and worst frame over the last second
+void show_profile()
+{
+	prof_stat frame, top[8];
+	int i, n, y = LINE_SPACING * 6;
+
+	n = prof_get_stats(&frame, top, sizeof(top) / sizeof(top[0]));
+	if (!frame.name)
+		return;
+
+	gr_set_curfont(GAME_FONT);
+	gr_set_fontcolor(BM_XRGB(0,31,0),-1);
+	gr_printf(FSPACX(1), y, "%s", frame.name);
+	gr_printf(FSPACX(40), y, "%.2f ms", frame.avg_ms);
+	gr_printf(FSPACX(80), y, "max %.2f", frame.max_ms);
+	gr_set_fontcolor(BM_XRGB(20,20,20),-1);
+	for (i = 0; i < n; i++)
+	{
+		y += LINE_SPACING;
+		gr_printf(FSPACX(1), y, "%s", top[i].name);
+		gr_printf(FSPACX(40), y, "%.2f ms", top[i].avg_ms);
+		gr_printf(FSPACX(80), y, "max %.2f", top[i].max_ms);
+	}
+}
+
 void set_font_present() { gr_set_fontcolor(BM_XRGB(25,25,25),-1); }
 void set_font_absent() { gr_set_fontcolor(BM_XRGB(12,12,12),-1); }
 void set_font_newline() { gr_set_fontcolor(255,-1); }
@@ -438,6 +464,14 @@ void game_draw_hud_stuff()
 				gr_setcolor(BM_XRGB(27, 0, 0));
 				gr_disk(i2f(grd_curcanv->cv_bitmap.bm_w / 2), i2f(y + 8), i2f(8));
 			}
+			if (Newdemo_state == ND_STATE_PLAYBACK && Newdemo_show_percentage) {
+				// where the playback is in the demo
+				int w = grd_curcanv->cv_bitmap.bm_w / 4, x = (grd_curcanv->cv_bitmap.bm_w - w) / 2;
+
+				gr_setcolor(BM_XRGB(27, 0, 0));
+				gr_box(x, y + LINE_SPACING, x + w, y + LINE_SPACING + FSPACY(2));
+				gr_rect(x, y + LINE_SPACING, x + w * newdemo_get_percent_done() / 100, y + LINE_SPACING + FSPACY(2));
+			}
 		}
 	}
 
@@ -446,6 +480,9 @@ void game_draw_hud_stuff()
 	if (!is_observer() && GameCfg.FPSIndicator && PlayerCfg.CurrentCockpitMode != CM_REAR_VIEW)
 		show_framerate();
 
+	if (Profile_overlay)
+		show_profile();
+
 	if (Newdemo_state == ND_STATE_PLAYBACK)
 		Game_mode = Newdemo_game_mode;
 
@@ -650,7 +650,8 @@ void LoadLevel(int level_num,int page_in_textures)
 
 	gr_use_palette_table( "palette.256" );
 
-	show_boxed_message(TXT_LOADING, 0);
+	if (!GameArg.SysHeadless)
+		show_boxed_message(TXT_LOADING, 0);
 #ifdef RELEASE
 	timer_delay(F1_0);
 #endif
@@ -675,7 +676,7 @@ void LoadLevel(int level_num,int page_in_textures)
 
 	gr_palette_load(gr_palette);		//actually load the palette
 
-	if ( page_in_textures ) {
+	if ( page_in_textures && !GameArg.SysHeadless ) {
 		piggy_load_level_data();
 #ifdef OGL
 		ogl_cache_level_textures();
@@ -973,7 +974,8 @@ int AdvanceLevel(int secret_flag)
 		if ((Newdemo_state == ND_STATE_RECORDING) || (Newdemo_state == ND_STATE_PAUSED))
 			newdemo_stop_recording(0);
 
-		do_end_briefing_screens(Ending_text_filename);
+		if (!GameArg.SysHeadless)
+			do_end_briefing_screens(Ending_text_filename);
 
 		return 1;
 
@@ -47,6 +47,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "kmatrix.h"
 #include "gauges.h"
 #include "pcx.h"
+#include "args.h"
 
 #ifdef OGL
 #include "ogl_init.h"
@@ -256,9 +257,49 @@ void kmatrix_redraw_coop()
 	gr_palette_load(gr_palette);
 }
 
+// Wait for the others to finish the level and the reactor to blow. Returns 1 when it is time to go on, else 0.
+static int kmatrix_poll(kmatrix_screen *km)
+{
+	int i;
+
+	timer_delay2(50);
+
+	if (km->network)
+		multi_do_protocol_frame(0, 1);
+	
+	km->playing = 0;
+
+	// Check if all connected players are also looking at this screen ...
+	for (i = 0; i < MAX_PLAYERS; i++)
+		if (Netgame.max_numobservers == 0 || i != OBSERVER_PLAYER_ID)
+			if (Players[i].connected)
+				if (Players[i].connected != CONNECT_END_MENU && Players[i].connected != CONNECT_DIED_IN_MINE)
+					km->playing = 1;
+	
+	// ... and let the reactor blow sky high!
+	if (!km->playing)
+		Countdown_seconds_left = -1;
+	
+	// If Reactor is finished and end_time not inited, set the time when we will exit this loop
+	if (km->end_time == -1 && Countdown_seconds_left < 0 && !km->playing)
+		km->end_time = timer_query() + (KMATRIX_VIEW_SEC * F1_0);
+	
+	// Check if end_time has been reached and exit loop
+	if (timer_query() >= km->end_time && km->end_time != -1)
+	{
+		if (km->network)
+			multi_send_endlevel_packet();  // make sure
+		
+		Netgame.numobservers = 0;
+		return 1;
+	}
+
+	return 0;
+}
+
 int kmatrix_handler(window *wind, d_event *event, kmatrix_screen *km)
 {
-	int i = 0, k = 0, choice = 0;
+	int k = 0, choice = 0;
 	
 	switch (event->type)
 	{
@@ -296,36 +337,8 @@ int kmatrix_handler(window *wind, d_event *event, kmatrix_screen *km)
 			break;
 			
 		case EVENT_WINDOW_DRAW:
-			timer_delay2(50);
-
-			if (km->network)
-				multi_do_protocol_frame(0, 1);
-			
-			km->playing = 0;
-
-			// Check if all connected players are also looking at this screen ...
-			for (i = 0; i < MAX_PLAYERS; i++)
-				if (Netgame.max_numobservers == 0 || i != OBSERVER_PLAYER_ID)
-					if (Players[i].connected)
-						if (Players[i].connected != CONNECT_END_MENU && Players[i].connected != CONNECT_DIED_IN_MINE)
-							km->playing = 1;
-			
-			// ... and let the reactor blow sky high!
-			if (!km->playing)
-				Countdown_seconds_left = -1;
-			
-			// If Reactor is finished and end_time not inited, set the time when we will exit this loop
-			if (km->end_time == -1 && Countdown_seconds_left < 0 && !km->playing)
-				km->end_time = timer_query() + (KMATRIX_VIEW_SEC * F1_0);
-			
-			// Check if end_time has been reached and exit loop
-			if (timer_query() >= km->end_time && km->end_time != -1)
+			if (kmatrix_poll(km))
 			{
-				if (km->network)
-					multi_send_endlevel_packet();  // make sure
-				
-				Netgame.numobservers = 0;
-				
 				if (window_exists(wind))
 					window_close(wind);
 				break;
@@ -361,6 +374,18 @@ void kmatrix_view(int network)
 	if (!km)
 		return;
 
+	if (GameArg.MplDedicated) // nobody to show the scores to
+	{
+		km->network = network;
+		km->end_time = -1;
+		km->playing = 0;
+		do
+			timer_update();
+		while (!kmatrix_poll(km));
+		d_free(km);
+		return;
+	}
+
 	gr_init_bitmap_data(&km->background);
 	if (pcx_read_bitmap(STARS_BACKGROUND, &km->background, BM_LINEAR, gr_palette) != PCX_ERROR_NONE)
 	{
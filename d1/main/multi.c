@@ -63,6 +63,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "net_udp.h"
 #endif
 #include "args.h"
+#include "profile.h"
 
 //
 // Local macros and prototypes
@@ -1341,7 +1342,9 @@ void multi_do_protocol_frame(int force, int listen)
 	{
 #ifdef USE_UDP
 		case MULTI_PROTO_UDP:
+			PROF_BEGIN(PROF_NET);
 			net_udp_do_frame(force, listen);
+			PROF_END(PROF_NET);
 			break;
 #endif
 		default:
@@ -64,7 +64,7 @@ extern int multi_protocol; // set and determinate used protocol
 #define MULTI_PROTO_UDP 1 // UDP protocol
 
 // What version of the multiplayer protocol is this? Increment each time something drastic changes in Multiplayer without the version number changes. Can be reset to 0 each time the version of the game changes
-#define MULTI_PROTO_VERSION 30006 // Redux 1.2
+#define MULTI_PROTO_VERSION 30007 // Redux 1.2, game info carries Netgame.DeltaPackets
 
 // PROTOCOL VARIABLES AND DEFINES - END
 
@@ -368,6 +368,7 @@ extern char *RankStrings[];
 #define NETGAME_FLAG_CLOSED             1
 #define NETGAME_FLAG_SHOW_ID            2
 #define NETGAME_FLAG_SHOW_MAP           4
+#define NETGAME_FLAG_COALESCE           128 // peers may bundle their in-game messages (UPID_BUNDLE), same bit as in D2
 
 #define NETGAME_NAME_LEN                15
 
@@ -517,6 +518,7 @@ typedef struct netgame_info
 	ubyte						GaussAmmoStyle;
 	ubyte						team_color[2];
 	ubyte						NewSpawnAlgorithm;
+	ubyte						DeltaPackets;
 } __pack__ netgame_info;
 
 extern int Host_is_obs; // Reminder for host only that they are an observer.  Do not set for other players or observers.
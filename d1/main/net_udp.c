@@ -6,6 +6,10 @@
 
 #ifdef NETWORK
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // for recvmmsg() and sendmmsg()
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -13,11 +17,13 @@
 #ifdef __unix__
 #include <sys/time.h>
 #endif
+#include <SDL.h>
 
 #include "pstypes.h"
 #include "window.h"
 #include "strutil.h"
 #include "args.h"
+#include "profile.h"
 #include "timer.h"
 #include "newmenu.h"
 #include "key.h"
@@ -110,6 +116,10 @@ void net_udp_send_netgame_update();
 void net_udp_do_refuse_stuff (UDP_sequence_packet *their);
 void net_udp_read_sync_packet( ubyte * data, int data_len, struct _sockaddr sender_addr );
 void net_udp_read_object_packet( ubyte *data );
+void net_udp_process_snapshot(ubyte *data, struct _sockaddr sender_addr, int data_len);
+void net_udp_process_snapshot_ack(ubyte *data, struct _sockaddr sender_addr, int data_len);
+static int net_udp_send_snapshot(int player_num);
+static void net_udp_snapshot_reset(void);
 void net_udp_ping_frame(fix64 time);
 void net_udp_p2p_ping_frame(fix64 time); 
 void net_udp_process_ping(ubyte *data, int data_len, struct _sockaddr sender_addr);
@@ -121,6 +131,7 @@ void net_udp_send_obs_mdata(fix64 time);
 void net_udp_process_mdata (ubyte *data, int data_len, struct _sockaddr sender_addr, int needack);
 void net_udp_process_obs_data (ubyte *data, int data_len, struct _sockaddr sender_addr);
 void net_udp_send_pdata();
+void net_udp_reset_delta_pdata();
 void net_udp_process_pdata ( ubyte *data, int data_len, struct _sockaddr sender_addr );
 void net_udp_read_pdata_packet(UDP_frame_info *pd);
 void net_udp_timeout_check(fix64 time);
@@ -132,11 +143,14 @@ void net_udp_noloss_got_ack(ubyte *data, int data_len, struct _sockaddr sender_a
 void net_udp_noloss_got_obs_ack(ubyte *data, int data_len);
 void net_udp_noloss_init_mdata_queue(void);
 void net_udp_noloss_clear_mdata_got(ubyte player_num);
+static void net_udp_reset_delta_pdata_player(int pnum);
 void net_udp_noloss_process_queue(fix64 time);
+void net_udp_noloss_stat(void);
 void net_udp_send_extras ();
 void net_udp_process_p2p_ping(ubyte *data, struct _sockaddr sender_addr, int data_len);
 void net_udp_process_p2p_pong(ubyte *data, struct _sockaddr sender_addr, int data_len);
 void net_udp_process_proxy(ubyte *data, struct _sockaddr sender_addr, int data_len);
+void net_udp_process_bundle(ubyte *data, struct _sockaddr sender_addr, int data_len, int is_proxy);
 void net_udp_send_p2p_pong(int to_player, fix64 time, int initiating_connection);
 void net_udp_send_to_player(ubyte* data, int len, int to_player);
 void net_udp_send_to_player_direct(ubyte* data, int len, int to_player);
@@ -154,6 +168,11 @@ void add_message_to_obs_buffer(ubyte *data, int data_len, int needack);
 void check_obs_buffer(fix64 now);
 void forward_to_observers_nodelay(ubyte *data, int data_len, int needack);
 void net_udp_process_obs_quit(ubyte *data, int data_len, struct _sockaddr sender_addr);
+void net_udp_obs_relay_frame(fix64 now);
+void net_udp_process_obs_relay(ubyte *data, struct _sockaddr sender_addr, int data_len);
+void net_udp_process_obs_relay_list(ubyte *data, struct _sockaddr sender_addr, int data_len);
+void net_udp_process_obs_relay_offer(ubyte *data, struct _sockaddr sender_addr, int data_len);
+void net_udp_process_obs_relay_via(ubyte *data, struct _sockaddr sender_addr, int data_len);
 
 void net_udp_reset_connection_statuses(); 
 
@@ -222,152 +241,346 @@ void clean_pdata(fix64 now);
 int load_preset(newmenu *menu_settings);
 void save_preset(void);
 
-char* msg_name(int type)
+/* Batched socket I/O.
+ * Where recvmmsg()/sendmmsg() exist a socket gets drained with one call into a small batch of datagrams that
+ * udp_receive_packet() then hands out one by one. Between udp_send_batch_begin() and udp_send_batch_end() (one
+ * net_udp_do_frame()) outgoing datagrams are queued and go out together with sendmmsg() when the frame is done,
+ * the queue is full or another socket is used. Elsewhere everything takes the plain sendto()/recvfrom() path.
+ */
+#if defined(__linux__) && defined(_GNU_SOURCE)
+#define UDP_MMSG
+#endif
+
+#define UDP_BATCH_SIZE 32
+
+static SDL_atomic_t UDP_num_syscalls; // counted on both threads with -udp_thread
+
+#ifdef UDP_MMSG
+typedef struct udp_batch
 {
-	switch(type)
-	{
-		case UPID_VERSION_DENY:
-			return "UPID_VERSION_DENY";
-		case UPID_GAME_INFO_REQ:
-			return "UPID_GAME_INFO_REQ";
-		case UPID_GAME_INFO:
-			return "UPID_GAME_INFO";
-		case UPID_GAME_INFO_LITE_REQ:
-			return "UPID_GAME_INFO_LITE_REQ";
-		case UPID_GAME_INFO_LITE:
-			return "UPID_GAME_INFO_LITE";
-		case UPID_DUMP:
-			return "UPID_DUMP";
-		case UPID_ADDPLAYER:
-			return "UPID_ADDPLAYER";
-		case UPID_REQUEST:
-			return "UPID_REQUEST";
-		case UPID_QUIT_JOINING:
-		    return "UPID_QUIT_JOINING";
-		case UPID_SYNC:
-			return "UPID_SYNC";
-		case UPID_OBJECT_DATA:
-			return "UPID_OBJECT_DATA";
-		case UPID_PING:
-			return "UPID_PING";
-		case UPID_PONG:
-			return "UPID_PONG";
-		case UPID_ENDLEVEL_H:
-			return "UPID_ENDLEVEL_H";
-		case UPID_ENDLEVEL_C:
-			return "UPID_ENDLEVEL_C";
-		case UPID_PDATA:
-			return "UPID_PDATA";
-		case UPID_MDATA_PNORM:
-			return "UPID_MDATA_PNORM";
-		case UPID_MDATA_PNEEDACK:
-			return "UPID_MDATA_PNEEDACK";
-		case UPID_MDATA_ACK:
-			return "UPID_MDATA_ACK";
-		case UPID_TRACKER_VERIFY:
-			return "UPID_TRACKER_VERIFY";			
-		case UPID_TRACKER_INCGAME:
-			return "UPID_TRACKER_INCGAME";
+	struct mmsghdr msgs[UDP_BATCH_SIZE];
+	struct iovec iov[UDP_BATCH_SIZE];
+	struct _sockaddr addr[UDP_BATCH_SIZE];
+	ubyte data[UDP_BATCH_SIZE][UPID_MAX_SIZE];
+	int count, next, sockfd;
+} udp_batch;
 
-		case UPID_P2P_PING:
-			return "UPID_P2P_PING"; 		
-		case UPID_P2P_PONG:	
-			return "UPID_P2P_PONG";
+static udp_batch UDP_recv_batch[3], UDP_send_batch;
+static int UDP_send_batch_depth = 0;
 
-		case UPID_PROXY:
-			return "UPID_PROXY";
+static void udp_batch_setup(udp_batch *b, int i, int len)
+{
+	b->iov[i].iov_base = b->data[i];
+	b->iov[i].iov_len = len;
+	memset(&b->msgs[i], 0, sizeof(b->msgs[i]));
+	b->msgs[i].msg_hdr.msg_iov = &b->iov[i];
+	b->msgs[i].msg_hdr.msg_iovlen = 1;
+	b->msgs[i].msg_hdr.msg_name = &b->addr[i];
+	b->msgs[i].msg_hdr.msg_namelen = sizeof(struct _sockaddr);
+}
 
-		case UPID_REATTEMPT_DIRECT:
-			return "UPID_REATTEMPT_DIRECT";
-		case UPID_OBSDATA:
-			return "UPID_OBSDATA";
-		case UPID_OBSQUIT:
-			return "UPID_OBSQUIT";
+static void udp_send_batch_flush()
+{
+	udp_batch *b = &UDP_send_batch;
+	int sent = 0, rv;
 
-		default:
-			return "UNKNOWN";
+	while (sent < b->count)
+	{
+		rv = sendmmsg(b->sockfd, &b->msgs[sent], b->count - sent, 0);
+		SDL_AtomicAdd(&UDP_num_syscalls, 1);
+		if (rv <= 0) // drop the datagram that failed, like a failed sendto() would
+			rv = 1;
+		sent += rv;
 	}
+	b->count = 0;
 }
+#endif
 
-static PHYSFS_file *netlog_fp=NULL;
-static struct timeval program_start; 
+static void udp_send_batch_begin()
+{
+#ifdef UDP_MMSG
+	UDP_send_batch_depth++;
+#endif
+}
 
-static void net_log_close(void)
+static void udp_send_batch_end()
 {
-	if (netlog_fp)
-		PHYSFS_close(netlog_fp);
-	
-	netlog_fp = NULL;
+#ifdef UDP_MMSG
+	udp_send_batch_flush();
+	if (UDP_send_batch_depth > 0)
+		UDP_send_batch_depth--;
+#endif
 }
 
-void net_log_init(void)
+/* General UDP functions - START */
+// send a datagram right away, or queue it while a send batch is open
+static ssize_t udp_send_raw(int sockfd, const void *msg, int len, unsigned int flags, const struct sockaddr *to, socklen_t tolen)
 {
-	if(! netlog_fp) {
-		netlog_fp = PHYSFS_openWrite("netlog.txt");
-		atexit(net_log_close);
+#ifdef UDP_MMSG
+	if (UDP_send_batch_depth && !flags && len <= UPID_MAX_SIZE && tolen <= sizeof(struct _sockaddr))
+	{
+		udp_batch *b = &UDP_send_batch;
 
-		gettimeofday(&program_start, NULL);
+		if (b->count == UDP_BATCH_SIZE || (b->count && b->sockfd != sockfd))
+			udp_send_batch_flush();
+		b->sockfd = sockfd;
+		memcpy(b->data[b->count], msg, len);
+		memcpy(&b->addr[b->count], to, tolen);
+		udp_batch_setup(b, b->count, len);
+		b->msgs[b->count].msg_hdr.msg_namelen = tolen;
+		b->count++;
+		return len;
 	}
+#endif
+
+	SDL_AtomicAdd(&UDP_num_syscalls, 1);
+	return sendto(sockfd, msg, len, flags, to, tolen);
 }
 
+int udp_general_packet_ready(int socknum);
+
+// get the next datagram waiting on a socket, 0 if there is none
+static int udp_recv_raw(int socknum, ubyte *text, int len, struct _sockaddr *sender_addr)
+{
+	socklen_t clen = sizeof (struct _sockaddr);
+	ssize_t msglen;
 
+#ifdef UDP_MMSG
+	udp_batch *b = &UDP_recv_batch[socknum];
+	int i;
 
-void net_log_log(char tx, const void* msg, int len, const struct sockaddr *address, socklen_t addrlen) {
-	//return;
-	if(! GameArg.LogNetTraffic) { return; }
+	(void)clen;
+	if (b->next >= b->count)
+	{
+		b->count = b->next = 0;
+		for (i = 0; i < UDP_BATCH_SIZE; i++)
+			udp_batch_setup(b, i, UPID_MAX_SIZE);
+		msglen = recvmmsg(UDP_Socket[socknum], b->msgs, UDP_BATCH_SIZE, MSG_DONTWAIT, NULL);
+		SDL_AtomicAdd(&UDP_num_syscalls, 1);
+		if (msglen <= 0)
+			return 0;
+		b->count = msglen;
+	}
 
-	net_log_init();
+	i = b->next++;
+	msglen = b->msgs[i].msg_len;
+	if (msglen > len)
+		msglen = len;
+	memcpy(text, b->data[i], msglen);
+	*sender_addr = b->addr[i];
+#else
+	if (!udp_general_packet_ready(socknum))
+		return 0;
+	msglen = recvfrom(UDP_Socket[socknum], text, len, 0, (struct sockaddr *)sender_addr, &clen);
+	SDL_AtomicAdd(&UDP_num_syscalls, 1);
+	if (msglen < 0)
+		return 0;
+#endif
 
-	struct timeval t;
-	gettimeofday(&t, NULL); 
-	long usec = (t.tv_sec - program_start.tv_sec)*1000000L + t.tv_usec - program_start.tv_usec; 
-	
-	if(netlog_fp) {
-		struct sockaddr_in *addrin = (struct sockaddr_in*) address;
-		char *ip = inet_ntoa(addrin->sin_addr); 
-		ushort port = SWAPSHORT(addrin->sin_port);
+	return msglen;
+}
 
-		if(tx) {
-			PHYSFSX_printf(netlog_fp, "%d.%06d Tx ", usec/1000000L, usec%1000000L); 
-		} else {
-			PHYSFSX_printf(netlog_fp, "%d.%06d Rx ",  usec/1000000L, usec%1000000L); 
+/* Network thread.
+ * With -udp_thread a thread owns the sockets while a game runs. It keeps receiving, notes the arrival time of each
+ * datagram and passes them on to the game through one single producer/single consumer ring per socket. Outgoing
+ * datagrams take a ring the other way. Packets are still processed on the game thread in net_udp_listen(), but a
+ * slow frame no longer holds them up in the socket and pings get measured from when a packet really arrived.
+ */
+#define UDP_RING_SIZE 128 // must be a power of 2
+
+typedef struct udp_ring_packet
+{
+	int sockfd; // outgoing only
+	int len;
+	struct _sockaddr addr;
+	socklen_t addrlen;
+	u_int64_t arrival; // SDL_GetPerformanceCounter() when it was received
+	ubyte data[UPID_MAX_SIZE];
+} udp_ring_packet;
+
+typedef struct udp_ring
+{
+	SDL_atomic_t head, tail; // head only moved by the producer, tail only by the consumer
+	udp_ring_packet pkt[UDP_RING_SIZE];
+} udp_ring;
+
+static udp_ring UDP_in_ring[3], UDP_out_ring;
+static SDL_Thread *UDP_thread = NULL;
+static SDL_atomic_t UDP_thread_quit;
+static fix64 UDP_packet_time = 0; // when the packet being processed arrived, in timer_query() time
+
+// slot to fill next, NULL if the ring is full
+static udp_ring_packet *udp_ring_write_slot(udp_ring *r)
+{
+	unsigned head = SDL_AtomicGet(&r->head);
+
+	if (head - (unsigned)SDL_AtomicGet(&r->tail) >= UDP_RING_SIZE)
+		return NULL;
+	return &r->pkt[head & (UDP_RING_SIZE - 1)];
+}
+
+static void udp_ring_push(udp_ring *r)
+{
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicAdd(&r->head, 1);
+}
+
+// oldest slot not read yet, NULL if the ring is empty
+static udp_ring_packet *udp_ring_read_slot(udp_ring *r)
+{
+	unsigned tail = SDL_AtomicGet(&r->tail);
+
+	if (tail == (unsigned)SDL_AtomicGet(&r->head))
+		return NULL;
+	SDL_MemoryBarrierAcquire();
+	return &r->pkt[tail & (UDP_RING_SIZE - 1)];
+}
+
+static void udp_ring_pop(udp_ring *r)
+{
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicAdd(&r->tail, 1);
+}
+
+static int udp_thread_main(void *unused)
+{
+	udp_ring_packet *p;
+	fd_set set;
+	struct timeval tv;
+	int i, maxfd;
+
+	(void)unused;
+	prof_thread_name("udp");
+	for (;;)
+	{
+		PROF_BEGIN(PROF_UDP_SEND);
+		udp_send_batch_begin();
+		while ((p = udp_ring_read_slot(&UDP_out_ring)))
+		{
+			udp_send_raw(p->sockfd, p->data, p->len, 0, (struct sockaddr *)&p->addr, p->addrlen);
+			udp_ring_pop(&UDP_out_ring);
 		}
-		ubyte* cmsg = (ubyte*) msg; 
+		udp_send_batch_end();
+		PROF_END(PROF_UDP_SEND);
 
-		PHYSFSX_printf(netlog_fp, "%d bytes  %s:%d  %s (%d)\n", len, ip, port, msg_name(cmsg[0]), cmsg[0]); 
+		if (SDL_AtomicGet(&UDP_thread_quit))
+			break;
 
-		
-		for(int i = 0; i < len; i++) {
-			PHYSFSX_printf(netlog_fp, "%03d ", cmsg[i]); 
+		// wait a millisecond at most so outgoing packets don't sit around
+		FD_ZERO(&set);
+		maxfd = -1;
+		for (i = 0; i < 3; i++)
+			if (UDP_Socket[i] != -1)
+			{
+				FD_SET(UDP_Socket[i], &set);
+				if (UDP_Socket[i] > maxfd)
+					maxfd = UDP_Socket[i];
+			}
+		tv.tv_sec = 0;
+		tv.tv_usec = 1000;
+		if (maxfd == -1)
+		{
+			SDL_Delay(1);
+			continue;
 		}
-		PHYSFSX_printf(netlog_fp, "\n"); 
+		SDL_AtomicAdd(&UDP_num_syscalls, 1);
+		if (select(maxfd + 1, &set, NULL, NULL, &tv) <= 0)
+			continue;
+
+		PROF_BEGIN(PROF_UDP_RECV);
+		for (i = 0; i < 3; i++)
+			if (UDP_Socket[i] != -1 && FD_ISSET(UDP_Socket[i], &set))
+				while ((p = udp_ring_write_slot(&UDP_in_ring[i]))) // if the game falls behind the rest waits in the socket
+				{
+					p->len = udp_recv_raw(i, p->data, UPID_MAX_SIZE, &p->addr);
+					if (p->len <= 0)
+						break;
+					p->arrival = SDL_GetPerformanceCounter();
+					udp_ring_push(&UDP_in_ring[i]);
+				}
+		PROF_END(PROF_UDP_RECV);
 	}
+
+	return 0;
 }
 
-void net_log_comment(char* comment) {
-	//return;
-	if(! GameArg.LogNetTraffic) { return; }
+static void udp_thread_start()
+{
+	if (UDP_thread || !GameArg.MplUdpThread)
+		return;
 
-	net_log_init();
+	SDL_AtomicSet(&UDP_thread_quit, 0);
+	UDP_thread = SDL_CreateThread(udp_thread_main, "udp", NULL);
+	if (!UDP_thread)
+	{
+		con_printf(CON_NORMAL, "Cannot start network thread: %s\n", SDL_GetError());
+		GameArg.MplUdpThread = 0;
+	}
+}
 
-	struct timeval t;
-	gettimeofday(&t, NULL); 
-	long usec = (t.tv_sec - program_start.tv_sec)*1000000L + t.tv_usec - program_start.tv_usec; 
-	
-	if(netlog_fp) {
-		PHYSFSX_printf(netlog_fp, "%d.%06d %s\n", usec/1000000L, usec%1000000L, comment); 
-	}	
+// the thread sends what is left before it quits. Whatever it received stays in the rings for udp_receive_packet().
+static void udp_thread_stop()
+{
+	if (!UDP_thread)
+		return;
+
+	SDL_AtomicSet(&UDP_thread_quit, 1);
+	SDL_WaitThread(UDP_thread, NULL);
+	UDP_thread = NULL;
 }
 
-/* General UDP functions - START */
-ssize_t dxx_sendto(int sockfd, const void *msg, int len, unsigned int flags, const struct sockaddr *to, socklen_t tolen)
+// A message box may not come back to net_udp_do_frame() for a long time, so send what is queued and stop queueing
+// until udp_send_batch_resume(). The network thread keeps sending on its own.
+static int udp_send_batch_suspend()
+{
+#ifdef UDP_MMSG
+	int depth = UDP_send_batch_depth;
+
+	if (UDP_thread)
+		return -1;
+	udp_send_batch_flush();
+	UDP_send_batch_depth = 0;
+	return depth;
+#else
+	return 0;
+#endif
+}
+
+static void udp_send_batch_resume(int depth)
+{
+#ifdef UDP_MMSG
+	if (depth >= 0 && !UDP_thread)
+		UDP_send_batch_depth = depth;
+#endif
+}
+
+// everything that goes on the wire passes here, after coalescing
+static ssize_t udp_send_datagram(int sockfd, const void *msg, int len, unsigned int flags, const struct sockaddr *to, socklen_t tolen)
 {
-	// Upstream loss simulator
-	//if(rand() % 100 < 10) { return 0; }
+	ssize_t rv;
 
-	net_log_log(1, msg, len, to, tolen); 
+	net_log_log(1, msg, len, to, 0);
+	if (UDP_thread && !flags && len <= UPID_MAX_SIZE && tolen <= sizeof(struct _sockaddr))
+	{
+		udp_ring_packet *p;
 
-	ssize_t rv = sendto(sockfd, msg, len, flags, to, tolen);
+		while (!(p = udp_ring_write_slot(&UDP_out_ring)))
+			SDL_Delay(1); // thread is behind, wait for room
+		p->sockfd = sockfd;
+		p->len = len;
+		memcpy(p->data, msg, len);
+		memcpy(&p->addr, to, tolen);
+		p->addrlen = tolen;
+		udp_ring_push(&UDP_out_ring);
+		rv = len;
+	}
+	else if (UDP_thread) // the thread owns the send batch
+	{
+		rv = sendto(sockfd, msg, len, flags, to, tolen);
+		SDL_AtomicAdd(&UDP_num_syscalls, 1);
+	}
+	else
+		rv = udp_send_raw(sockfd, msg, len, flags, to, tolen);
 
 	UDP_num_sendto++;
 	if (rv > 0)
@@ -376,16 +589,194 @@ ssize_t dxx_sendto(int sockfd, const void *msg, int len, unsigned int flags, con
 	return rv;
 }
 
-ssize_t dxx_recvfrom(int sockfd, void *buf, int len, unsigned int flags, struct sockaddr *from, socklen_t *fromlen)
+/* Message coalescing.
+ * If the host set NETGAME_FLAG_COALESCE, in-game messages sent during one net_udp_do_frame() are appended to a
+ * builder for their destination instead of going out one datagram each. udp_coalesce_end() sends each builder as
+ * one UPID_BUNDLE of at most -udp_mtu bytes, a builder about to overflow goes out early. Receivers split bundles in
+ * net_udp_process_bundle(), so everything else sees the same messages as before.
+ * Only peers that can split bundles get them. Each answers in-game traffic with a UPID_BUNDLE_OFFER now and then,
+ * peers without one, like older builds of the same protocol version, keep getting plain datagrams.
+ */
+#define UDP_COALESCE_DESTS (MAX_PLAYERS+MAX_OBSERVERS)
+#define UDP_COALESCE_OFFER_INTERVAL F1_0 // Offers to a peer are at least that far apart
+#define UDP_COALESCE_OFFER_TIMEOUT (F1_0*3) // No offer from a peer for that long, back to plain datagrams
+
+typedef struct udp_coalesce
 {
-	ssize_t rv = recvfrom(sockfd, buf, len, flags, from, fromlen);
+	struct _sockaddr addr;
+	socklen_t addrlen;
+	int len, count;
+	ubyte data[UPID_MAX_SIZE];
+} udp_coalesce;
 
-	net_log_log(0, buf, rv, from, *fromlen); 
+static udp_coalesce UDP_coalesce[UDP_COALESCE_DESTS];
+static int UDP_coalesce_used = 0, UDP_coalesce_active = 0;
 
-	UDP_num_recvfrom++;
-	UDP_len_recvfrom += rv;
+typedef struct udp_coalesce_peer
+{
+	struct _sockaddr addr;
+	fix64 offer_rx; // last UPID_BUNDLE_OFFER from this peer
+	fix64 offer_tx; // last UPID_BUNDLE_OFFER to this peer
+} udp_coalesce_peer;
 
-	return rv;
+static udp_coalesce_peer UDP_coalesce_peers[UDP_COALESCE_DESTS];
+static int UDP_coalesce_peers_used = 0;
+
+// the entry of addr. If there is none and create is set, a new one, taking over the one unused longest if needed.
+static udp_coalesce_peer *udp_coalesce_peer_find(const struct sockaddr *addr, socklen_t addrlen, int create)
+{
+	udp_coalesce_peer *p = NULL;
+	int i;
+
+	if (addrlen > sizeof(struct _sockaddr))
+		return NULL;
+	for (i = 0; i < UDP_coalesce_peers_used; i++)
+		if (!memcmp(&UDP_coalesce_peers[i].addr, addr, addrlen))
+			return &UDP_coalesce_peers[i];
+	if (!create)
+		return NULL;
+	if (UDP_coalesce_peers_used < UDP_COALESCE_DESTS)
+		p = &UDP_coalesce_peers[UDP_coalesce_peers_used++];
+	else
+		for (i = 0; i < UDP_COALESCE_DESTS; i++)
+			if (!p || max(UDP_coalesce_peers[i].offer_rx, UDP_coalesce_peers[i].offer_tx) < max(p->offer_rx, p->offer_tx))
+				p = &UDP_coalesce_peers[i];
+	memset(p, 0, sizeof(udp_coalesce_peer));
+	memcpy(&p->addr, addr, addrlen);
+	return p;
+}
+
+// may a message of type pid go into a bundle?
+static int udp_coalesce_pid(ubyte pid)
+{
+	switch (pid)
+	{
+		case UPID_PING:
+		case UPID_PONG:
+		case UPID_PDATA:
+		case UPID_MDATA_PNORM:
+		case UPID_MDATA_PNEEDACK:
+		case UPID_MDATA_ACK:
+		case UPID_P2P_PING:
+		case UPID_P2P_PONG:
+		case UPID_PROXY:
+		case UPID_OBSDATA:
+		case UPID_OBS_RELAY:
+		case UPID_OBS_RELAY_OFFER:
+		case UPID_OBS_RELAY_VIA:
+			return 1;
+		default: // may go to someone outside the game
+			return 0;
+	}
+}
+
+static int udp_coalesce_mtu()
+{
+	if (!(Netgame.game_flags & NETGAME_FLAG_COALESCE) || GameArg.MplUdpMtu <= 0)
+		return 0;
+	return (GameArg.MplUdpMtu < UPID_MAX_SIZE) ? GameArg.MplUdpMtu : UPID_MAX_SIZE;
+}
+
+static void udp_coalesce_send(udp_coalesce *c)
+{
+	if (c->count == 1) // nothing to gain from the bundle header
+		udp_send_datagram(UDP_Socket[0], c->data + UPID_BUNDLE_HEADER_SIZE + 2, c->len - UPID_BUNDLE_HEADER_SIZE - 2, 0, (struct sockaddr *)&c->addr, c->addrlen);
+	else if (c->count)
+	{
+		c->data[0] = UPID_BUNDLE;
+		PUT_INTEL_INT(c->data + 1, netgame_token);
+		udp_send_datagram(UDP_Socket[0], c->data, c->len, 0, (struct sockaddr *)&c->addr, c->addrlen);
+	}
+	c->len = UPID_BUNDLE_HEADER_SIZE;
+	c->count = 0;
+}
+
+// queue a message for its destination's bundle. Returns 0 if it has to be sent on its own.
+static int udp_coalesce_add(int sockfd, const ubyte *msg, int len, unsigned int flags, const struct sockaddr *to, socklen_t tolen)
+{
+	udp_coalesce *c = NULL;
+	udp_coalesce_peer *p;
+	int mtu, i;
+
+	if (!UDP_coalesce_active || sockfd != UDP_Socket[0] || flags || tolen > sizeof(struct _sockaddr) || !(mtu = udp_coalesce_mtu()) || UPID_BUNDLE_HEADER_SIZE + 2 + len > mtu)
+		return 0;
+	if (!udp_coalesce_pid(msg[0]))
+		return 0;
+	p = udp_coalesce_peer_find(to, tolen, 0);
+	if (!p || !p->offer_rx || timer_query() > p->offer_rx + UDP_COALESCE_OFFER_TIMEOUT)
+		return 0; // never said it can split bundles, or not lately
+
+	for (i = 0; i < UDP_coalesce_used; i++)
+		if (UDP_coalesce[i].addrlen == tolen && !memcmp(&UDP_coalesce[i].addr, to, tolen))
+		{
+			c = &UDP_coalesce[i];
+			break;
+		}
+	if (!c)
+	{
+		if (UDP_coalesce_used == UDP_COALESCE_DESTS)
+			return 0;
+		c = &UDP_coalesce[UDP_coalesce_used++];
+		memcpy(&c->addr, to, tolen);
+		c->addrlen = tolen;
+		c->len = UPID_BUNDLE_HEADER_SIZE;
+		c->count = 0;
+	}
+
+	if (c->len + 2 + len > mtu)
+		udp_coalesce_send(c);
+	PUT_INTEL_SHORT(c->data + c->len, len);						c->len += 2;
+	memcpy(c->data + c->len, msg, len);						c->len += len;
+	c->count++;
+	return 1;
+}
+
+static void udp_coalesce_begin()
+{
+	UDP_coalesce_active = 1;
+}
+
+static void udp_coalesce_end()
+{
+	int i;
+
+	for (i = 0; i < UDP_coalesce_used; i++)
+		udp_coalesce_send(&UDP_coalesce[i]);
+	UDP_coalesce_used = 0;
+	UDP_coalesce_active = 0;
+}
+
+ssize_t dxx_sendto(int sockfd, const void *msg, int len, unsigned int flags, const struct sockaddr *to, socklen_t tolen)
+{
+	if (udp_coalesce_add(sockfd, msg, len, flags, to, tolen))
+		return len;
+	return udp_send_datagram(sockfd, msg, len, flags, to, tolen);
+}
+
+// in-game traffic from sender_addr. Tell it now and then that it may bundle what it sends us.
+static void net_udp_offer_bundles(ubyte pid, struct _sockaddr sender_addr)
+{
+	udp_coalesce_peer *p;
+	fix64 now = timer_query();
+	ubyte buf[UPID_BUNDLE_OFFER_SIZE];
+
+	if (pid != UPID_BUNDLE && !udp_coalesce_pid(pid))
+		return;
+	p = udp_coalesce_peer_find((struct sockaddr *)&sender_addr, sizeof(struct _sockaddr), 1);
+	if (!p || (p->offer_tx && now < p->offer_tx + UDP_COALESCE_OFFER_INTERVAL && now >= p->offer_tx))
+		return;
+	p->offer_tx = now;
+	buf[0] = UPID_BUNDLE_OFFER;
+	PUT_INTEL_INT(buf + 1, netgame_token);
+	dxx_sendto(UDP_Socket[0], buf, sizeof(buf), 0, (struct sockaddr *)&sender_addr, sizeof(struct _sockaddr));
+}
+
+static void net_udp_process_bundle_offer(struct _sockaddr sender_addr)
+{
+	udp_coalesce_peer *p = udp_coalesce_peer_find((struct sockaddr *)&sender_addr, sizeof(struct _sockaddr), 1);
+
+	if (p)
+		p->offer_rx = timer_query();
 }
 
 void udp_traffic_stat()
@@ -395,8 +786,9 @@ void udp_traffic_stat()
 	if (timer_query() >= last_traf_time + F1_0)
 	{
 		last_traf_time = timer_query();
-		con_printf(CON_VERBOSE, "P#%i TRAFFIC - OUT: %fKB/s %iPPS IN: %fKB/s %iPPS\n",Player_num, (float)UDP_len_sendto/1024, UDP_num_sendto, (float)UDP_len_recvfrom/1024, UDP_num_recvfrom);
+		con_printf(CON_VERBOSE, "P#%i TRAFFIC - OUT: %fKB/s %iPPS IN: %fKB/s %iPPS SYSCALLS: %i/s\n",Player_num, (float)UDP_len_sendto/1024, UDP_num_sendto, (float)UDP_len_recvfrom/1024, UDP_num_recvfrom, SDL_AtomicSet(&UDP_num_syscalls, 0));
 		UDP_num_sendto = UDP_len_sendto = UDP_num_recvfrom = UDP_len_recvfrom = 0;
+		net_udp_noloss_stat();
 	}
 }
 
@@ -454,6 +846,8 @@ int udp_dns_filladdr( char *host, int port, struct _sockaddr *sAddr )
 // Closes an existing udp socket
 void udp_close_socket(int socknum)
 {
+	udp_thread_stop();
+
 	if (UDP_Socket[socknum] != -1)
 	{
 #ifdef _WIN32
@@ -463,11 +857,18 @@ void udp_close_socket(int socknum)
 #endif
 	}
 	UDP_Socket[socknum] = -1;
+#ifdef UDP_MMSG
+	UDP_recv_batch[socknum].count = UDP_recv_batch[socknum].next = 0; // whatever was left came from the old socket
+#endif
+	SDL_AtomicSet(&UDP_in_ring[socknum].head, 0);
+	SDL_AtomicSet(&UDP_in_ring[socknum].tail, 0);
 }
 
 // Open socket
 int udp_open_socket(int socknum, int port)
 {
+	udp_thread_stop();
+
 	int bcast = 1;
 
 	// close stale socket
@@ -595,22 +996,39 @@ int udp_general_packet_ready(int socknum)
 // Gets some text. Returns 0 if nothing on there.
 int udp_receive_packet(int socknum, ubyte *text, int len, struct _sockaddr *sender_addr)
 {
-	socklen_t clen = sizeof (struct _sockaddr);
-	ssize_t msglen = 0;
+	udp_ring_packet *p;
+	u_int64_t arrival = 0;
+	int msglen;
 
 	if (UDP_Socket[socknum] == -1)
 		return -1;
 
-	if (udp_general_packet_ready(socknum))
+	if ((p = udp_ring_read_slot(&UDP_in_ring[socknum])))
+	{
+		msglen = p->len < len ? p->len : len;
+		memcpy(text, p->data, msglen);
+		*sender_addr = p->addr;
+		UDP_packet_time = timer_query_perf(p->arrival);
+		arrival = p->arrival;
+		udp_ring_pop(&UDP_in_ring[socknum]);
+	}
+	else if (UDP_thread)
+		return 0;
+	else
 	{
-		msglen = dxx_recvfrom (UDP_Socket[socknum], text, len, 0, (struct sockaddr *)sender_addr, &clen);
+		msglen = udp_recv_raw(socknum, text, len, sender_addr);
+		UDP_packet_time = timer_query();
+	}
 
-		if (msglen < 0)
-			return 0;
+	if (msglen <= 0)
+		return 0;
 
-		if ((msglen >= 0) && (msglen < len))
-			text[msglen] = 0;
-	}
+	net_log_log(0, text, msglen, (struct sockaddr *)sender_addr, arrival);
+	UDP_num_recvfrom++;
+	UDP_len_recvfrom += msglen;
+
+	if (msglen < len)
+		text[msglen] = 0;
 
 	return msglen;
 }
@@ -868,9 +1286,12 @@ int valid_sender(ubyte *data, int data_len, struct _sockaddr sender_addr) {
 		case UPID_ADDPLAYER:
 		case UPID_SYNC: 
 		case UPID_OBJECT_DATA:
+		case UPID_OBJECT_SNAPSHOT:
 		case UPID_PING: 
 		case UPID_ENDLEVEL_H: 
 		case UPID_REATTEMPT_DIRECT: 
+		case UPID_OBS_RELAY_LIST: 
+		case UPID_OBS_RELAY_VIA: 
 			if(multi_i_am_master()) {
 				drop_rx_packet(data, "received by game master"); 
 				return 0; 
@@ -884,6 +1305,8 @@ int valid_sender(ubyte *data, int data_len, struct _sockaddr sender_addr) {
 		case UPID_QUIT_JOINING: 
 		case UPID_PONG: 
 		case UPID_ENDLEVEL_C: 
+		case UPID_OBS_RELAY_OFFER: 
+		case UPID_OBJECT_SNAPSHOT_ACK: 
 			if(! multi_i_am_master()) {
 				drop_rx_packet(data, "received by non-game master"); 
 				return 0; 				
@@ -910,6 +1333,8 @@ int valid_ip(ubyte *data, int data_len, struct _sockaddr sender_addr) {
 		case UPID_PING: 
 		case UPID_ENDLEVEL_H: 
 		case UPID_REATTEMPT_DIRECT: 
+		case UPID_OBS_RELAY_LIST: 
+		case UPID_OBS_RELAY_VIA: 
 			if(! is_master_ip(sender_addr)) {
 				drop_rx_packet(data, "sent from ip not belonging to game master"); 
 				return 0; 
@@ -944,6 +1369,14 @@ int valid_size(ubyte *data, int data_len, struct _sockaddr sender_addr) {
 		case UPID_GAME_INFO:     		rv = 1; break; // Don't check, it varies
 		case UPID_SYNC: 	    		rv = 1; break; 
 		case UPID_ADDPLAYER:   			rv = 1; break;
+		case UPID_BUNDLE:   			if(data_len < UPID_BUNDLE_HEADER_SIZE + 2 + 1)  { rv = 0; }  break;
+		case UPID_BUNDLE_OFFER:   		if(data_len != UPID_BUNDLE_OFFER_SIZE)  { rv = 0; }  break;
+		case UPID_OBS_RELAY:   			if(data_len < UPID_OBS_RELAY_HEADER_SIZE + 1)  { rv = 0; }  break;
+		case UPID_OBS_RELAY_LIST:   		if(data_len < 7 || data_len > UPID_OBS_RELAY_LIST_MAX_SIZE)  { rv = 0; }  break;
+		case UPID_OBS_RELAY_OFFER:   		if(data_len != UPID_OBS_RELAY_OFFER_SIZE)  { rv = 0; }  break;
+		case UPID_OBS_RELAY_VIA:   		if(data_len != UPID_OBS_RELAY_VIA_SIZE)  { rv = 0; }  break;
+		case UPID_OBJECT_SNAPSHOT:   		if(data_len <= UPID_OBJECT_SNAPSHOT_HEADER_SIZE || data_len > UPID_MAX_SIZE)  { rv = 0; }  break;
+		case UPID_OBJECT_SNAPSHOT_ACK:   	if(data_len != UPID_OBJECT_SNAPSHOT_ACK_SIZE)  { rv = 0; }  break;
 
 		default: rv = 1; 
 	}
@@ -974,6 +1407,12 @@ int valid_token(ubyte *data, int data_len, struct _sockaddr sender_addr) {
 		case UPID_P2P_PING: 
 		case UPID_P2P_PONG: 
 		case UPID_PROXY:
+		case UPID_BUNDLE:
+		case UPID_BUNDLE_OFFER:
+		case UPID_OBS_RELAY:
+		case UPID_OBS_RELAY_LIST:
+		case UPID_OBS_RELAY_OFFER:
+		case UPID_OBS_RELAY_VIA:
 		case UPID_REATTEMPT_DIRECT:		
 		// case UPID_SYNC: // Special case is handled in sync processing
 			rv = GET_INTEL_INT(data + 1) == netgame_token; 
@@ -986,6 +1425,7 @@ int valid_token(ubyte *data, int data_len, struct _sockaddr sender_addr) {
 
 
 		case UPID_OBJECT_DATA:
+		case UPID_OBJECT_SNAPSHOT:
 			rv = GET_INTEL_INT(data + 1) == my_player_token; 
 
 			if(! rv) {				
@@ -1242,6 +1682,49 @@ void net_udp_manual_join_game()
 	newmenu_do1( NULL, "ENTER GAME ADDRESS", nitems, m, (int (*)(newmenu *, d_event *, void *))manual_join_game_handler, dj, 0 );
 }
 
+// -udp_join: join the game at -udp_hostaddr right away, as the manual join menu would but without asking anything
+void net_udp_auto_join_game()
+{
+	direct_join dj;
+	int port = GameArg.MplUdpHostPort ? GameArg.MplUdpHostPort : UDP_PORT_DEFAULT;
+
+	if (!Players[Player_num].callsign[0])
+	{
+		snprintf(Players[Player_num].callsign, CALLSIGN_LEN+1, "%s", GameArg.SysPilot ? GameArg.SysPilot : "player");
+		new_player_config();
+	}
+	if (GameArg.SysHeadless)
+		GameArg.SysUseNiceFPS = 1;
+
+	net_udp_init();
+	snprintf(UDP_MyPort, sizeof(UDP_MyPort), "%d", GameArg.MplUdpMyPort ? GameArg.MplUdpMyPort : UDP_PORT_DEFAULT);
+	if (udp_open_socket(0, atoi(UDP_MyPort)) != 0)
+		return;
+
+	memset(&dj, 0, sizeof(direct_join));
+	if (udp_dns_filladdr((char *)GameArg.MplUdpHostAddr, port, &dj.host_addr) < 0)
+		return;
+
+	multi_new_game();
+	net_udp_reset_connection_statuses();
+	N_players = 0;
+	change_playernum_to(1);
+	memcpy((struct _sockaddr *)&Netgame.players[0].protocol.udp.addr, (struct _sockaddr *)&dj.host_addr, sizeof(struct _sockaddr));
+	con_printf(CON_NORMAL, "Joining %s:%i\n", GameArg.MplUdpHostAddr, port);
+
+	dj.connecting = 2; // skip the game info menu
+	dj.start_time = timer_query();
+	Netgame.protocol.udp.valid = 0;
+	while (dj.connecting)
+	{
+		timer_delay2(50);
+		timer_update();
+		if (net_udp_game_connect(&dj))
+			return; // in the game
+	}
+	net_udp_close();
+}
+
 static char *ljtext;
 
 int net_udp_list_join_poll( newmenu *menu, d_event *event, direct_join *dj )
@@ -1527,6 +2010,7 @@ void net_udp_list_join_game()
 	Network_send_objects = 0;
 	Network_sending_extras=0;
 	Network_rejoined=0;
+	net_udp_snapshot_reset();
 
 	Network_status = NETSTAT_BROWSING; // We are looking at a game menu
 
@@ -1824,6 +2308,7 @@ void net_udp_disconnect_player(int playernum)
 		VerifyPlayerJoined=-1;
 
 	net_udp_noloss_clear_mdata_got(playernum);
+	net_udp_reset_delta_pdata_player(playernum);
 }
 
 void
@@ -1908,6 +2393,7 @@ net_udp_new_player(UDP_sequence_packet *their)
 	multi_send_score();
 
 	net_udp_noloss_clear_mdata_got(pnum);
+	net_udp_reset_delta_pdata_player(pnum);
 }
 
 void net_udp_welcome_player(UDP_sequence_packet *their)
@@ -2077,6 +2563,7 @@ void net_udp_welcome_player(UDP_sequence_packet *their)
 		multi_send_score();
 
 		net_udp_noloss_clear_mdata_got(player_num);
+		net_udp_reset_delta_pdata_player(player_num);
 	}
 
 	Players[player_num].KillGoalCount=0;
@@ -2088,11 +2575,84 @@ void net_udp_welcome_player(UDP_sequence_packet *their)
 	player_tokens[player_num] = UDP_sync_player.token; 	
 	Network_send_objects = 1;
 	Network_send_objnum = -1;
+	net_udp_snapshot_reset();
 	Netgame.players[player_num].LastPacketTime = timer_query();
 
 	net_udp_send_objects();
 }
 
+#define UDP_SNAPSHOT_WINDOW 16 // Snapshot fragments in flight before we wait for an ack
+#define UDP_SNAPSHOT_RESEND (F1_0/5) // No ack for that long, go back to the last acked fragment
+#define UDP_SNAPSHOT_FRAGMENT (UPID_MAX_SIZE - UPID_OBJECT_SNAPSHOT_HEADER_SIZE)
+#define UDP_SNAPSHOT_OBJECT_SIZE (9 + sizeof(object_rw))
+#define UDP_SNAPSHOT_WALL_SIZE 7 // type, flags, state, hps
+#define UDP_SNAPSHOT_MAX_RAW (9 + (MAX_OBJECTS + 2) * UDP_SNAPSHOT_OBJECT_SIZE + 2 + MAX_WALLS * UDP_SNAPSHOT_WALL_SIZE)
+#define UDP_SNAPSHOT_MAX_PACKED(raw) ((raw) + (raw) / 128 + 1) // worst case of net_udp_lz_encode()
+#define UDP_SNAPSHOT_MAX_RESTARTS 3 // objects changed under the snapshot that often, send them one by one instead
+#define UDP_SNAPSHOT_LZ_HASH 4096
+#define UDP_SNAPSHOT_LZ_DEPTH 16 // Earlier places with the same hash the encoder tries
+#define UDP_SNAPSHOT_LZ_MIN 5 // Shorter copies save next to nothing over literals
+
+// With -udp_snapshot the host sends a joining player all objects as one big
+// object packet, followed by the state of all walls, LZ compressed and cut
+// into fragments. The joiner acks how much of it he has in one piece. The
+// host keeps a window of fragments in flight and goes back to the acked
+// offset if the acks stop. The joiner applies the snapshot once it is complete.
+typedef struct UDP_snapshot_tx_state
+{
+	ubyte *buf; // compressed snapshot
+	int size, raw_size, sent, acked;
+	fix64 ack_time;
+	ubyte serial;
+	int walls_valid; // walls holds the walls as sent, until net_udp_send_door_updates() ran
+	int restarts; // snapshots thrown away for this player because objects changed
+	ubyte walls[MAX_WALLS * UDP_SNAPSHOT_WALL_SIZE];
+} UDP_snapshot_tx_state;
+
+typedef struct UDP_snapshot_rx_state
+{
+	ubyte *buf;
+	int size, raw_size, got, applied;
+	ubyte serial;
+	fix64 start_time;
+} UDP_snapshot_rx_state;
+
+static UDP_snapshot_tx_state UDP_snapshot_tx;
+static UDP_snapshot_rx_state UDP_snapshot_rx;
+
+static void net_udp_snapshot_reset(void)
+{
+	ubyte serial = UDP_snapshot_tx.serial;
+
+	if (UDP_snapshot_tx.buf)
+		d_free(UDP_snapshot_tx.buf);
+	if (UDP_snapshot_rx.buf)
+		d_free(UDP_snapshot_rx.buf);
+	memset(&UDP_snapshot_tx, 0, sizeof(UDP_snapshot_tx));
+	memset(&UDP_snapshot_rx, 0, sizeof(UDP_snapshot_rx));
+	UDP_snapshot_tx.serial = serial; // so a new snapshot does not look like the old one
+}
+
+static int net_udp_put_wall(ubyte *buf, int wallnum)
+{
+	buf[0] = Walls[wallnum].type;
+	buf[1] = Walls[wallnum].flags;
+	buf[2] = Walls[wallnum].state;
+	PUT_INTEL_INT(buf + 3, Walls[wallnum].hps);
+	return UDP_SNAPSHOT_WALL_SIZE;
+}
+
+// Did the joining player get the wall as it is now with his snapshot?
+static int net_udp_snapshot_has_wall(int wallnum)
+{
+	ubyte buf[UDP_SNAPSHOT_WALL_SIZE];
+
+	if (!UDP_snapshot_tx.walls_valid)
+		return 0;
+	net_udp_put_wall(buf, wallnum);
+	return !memcmp(buf, UDP_snapshot_tx.walls + wallnum * UDP_SNAPSHOT_WALL_SIZE, UDP_SNAPSHOT_WALL_SIZE);
+}
+
 int net_udp_objnum_is_past(int objnum)
 {
 	// determine whether or not a given object number has already been sent
@@ -2103,6 +2663,8 @@ int net_udp_objnum_is_past(int objnum)
 
 	if (!Network_send_objects)
 		return 0; // We're not sending objects to a new player
+	if (UDP_snapshot_tx.buf)
+		return 1; // It is all in the snapshot, anything that changes needs a new one, up to UDP_SNAPSHOT_MAX_RESTARTS times
 
 	if (obj_mode > Network_send_object_mode)
 		return 0;
@@ -2122,6 +2684,8 @@ void net_udp_send_door_updates(void)
 
 	for (i = 0; i < Num_walls; i++)
 	{
+		if (net_udp_snapshot_has_wall(i))
+			continue; // the joining player has it from his snapshot
 		if ((Walls[i].type == WALL_DOOR) && ((Walls[i].state == WALL_DOOR_OPENING) || (Walls[i].state == WALL_DOOR_WAITING)))
 			multi_send_door_open(Walls[i].segnum, Walls[i].sidenum,0);
 		else if ((Walls[i].type == WALL_BLASTABLE) && (Walls[i].flags & WALL_BLASTED))
@@ -2129,6 +2693,7 @@ void net_udp_send_door_updates(void)
 		else if ((Walls[i].type == WALL_BLASTABLE) && (Walls[i].hps != WALL_HPS))
 			multi_send_hostage_door_status(i);
 	}
+	UDP_snapshot_tx.walls_valid = 0;
 
 }	
 
@@ -2225,6 +2790,56 @@ void net_udp_stop_resync(UDP_sequence_packet *their)
 		Network_rejoined=0;
 		Player_joining_extras=-1;
 		Network_send_objnum = -1;
+		net_udp_snapshot_reset();
+	}
+}
+
+// Does object objnum go to the joining player player_num in the given pass? Pass 0 has the objects he will own, pass 1 all others.
+static int net_udp_object_to_send(int objnum, int mode, int player_num)
+{
+	if ((Objects[objnum].type != OBJ_POWERUP) && (Objects[objnum].type != OBJ_PLAYER) &&
+			(Objects[objnum].type != OBJ_CNTRLCEN) && (Objects[objnum].type != OBJ_GHOST) &&
+			(Objects[objnum].type != OBJ_ROBOT) && (Objects[objnum].type != OBJ_HOSTAGE))
+		return 0;
+	if (mode == 0)
+		return (object_owner[objnum] == -1) || (object_owner[objnum] == player_num);
+	return (object_owner[objnum] != -1) && (object_owner[objnum] != player_num);
+}
+
+// Object entry of an object packet: objnum, owner, remote objnum, object_rw
+static int net_udp_put_object(ubyte *buf, int objnum)
+{
+	sbyte owner;
+	int remote_objnum = objnum_local_to_remote(objnum, &owner);
+
+	Assert(owner == object_owner[objnum]);
+
+	PUT_INTEL_INT(buf, objnum);
+	buf[4] = owner;
+	PUT_INTEL_INT(buf + 5, remote_objnum);
+	// use object_rw to send objects for now. if object sometime contains some day contains something useful the client should know about, we should use it. but by now it's also easier to use object_rw because then we also do not need fix64 timer values.
+	multi_object_to_object_rw(&Objects[objnum], (object_rw *)&buf[9]);
+#ifdef WORDS_BIGENDIAN
+	object_rw_swap((object_rw *)&buf[9], 1);
+#endif
+	return UDP_SNAPSHOT_OBJECT_SIZE;
+}
+
+// Objects are sent, tell the new guy to start
+static void net_udp_send_objects_done(int player_num)
+{
+	// Send sync packet which tells the player who he is and to start!
+	net_udp_send_rejoin_sync(player_num);
+
+	// Turn off send object mode
+	Network_send_objnum = -1;
+	Network_send_objects = 0;
+
+	Network_sending_extras=3; // start to send extras
+	VerifyPlayerJoined = Player_joining_extras = player_num;
+
+	if(UDP_sync_player.player.observer) {
+		VerifyPlayerJoined = -1;
 	}
 }
 
@@ -2232,14 +2847,17 @@ ubyte object_buffer[UPID_MAX_SIZE];
 
 void net_udp_send_objects(void)
 {
-	sbyte owner, player_num = UDP_sync_player.player.connected;
+	sbyte player_num = UDP_sync_player.player.connected;
 
 	if (UDP_sync_player.player.observer) {
 		player_num = OBSERVER_PLAYER_ID;
 	}
+
+	if (GameArg.MplUdpSnapshot && net_udp_send_snapshot(player_num))
+		return;
 	
 	static int obj_count = 0;
-	int loc = 0, i = 0, remote_objnum = 0, obj_count_frame = 0;
+	int loc = 0, i = 0, obj_count_frame = 0;
 	static fix64 last_send_time = 0;
 	
 	if (last_send_time + (F1_0/50) > timer_query())
@@ -2280,13 +2898,7 @@ void net_udp_send_objects(void)
 	
 	for (i = Network_send_objnum; i <= Highest_object_index; i++)
 	{
-		if ((Objects[i].type != OBJ_POWERUP) && (Objects[i].type != OBJ_PLAYER) &&
-				(Objects[i].type != OBJ_CNTRLCEN) && (Objects[i].type != OBJ_GHOST) &&
-				(Objects[i].type != OBJ_ROBOT) && (Objects[i].type != OBJ_HOSTAGE))
-			continue;
-		if ((Network_send_object_mode == 0) && ((object_owner[i] != -1) && (object_owner[i] != player_num)))
-			continue;
-		if ((Network_send_object_mode == 1) && ((object_owner[i] == -1) || (object_owner[i] == player_num)))
+		if (!net_udp_object_to_send(i, Network_send_object_mode, player_num))
 			continue;
 
 		if ( loc + sizeof(object_rw) + 9 > UPID_MAX_SIZE-1 )
@@ -2295,18 +2907,7 @@ void net_udp_send_objects(void)
 		obj_count_frame++;
 		obj_count++;
 
-		remote_objnum = objnum_local_to_remote(i, &owner);
-		Assert(owner == object_owner[i]);
-
-		PUT_INTEL_INT(object_buffer+loc, i);                        loc += 4;
-		object_buffer[loc] = owner;                                 loc += 1;
-		PUT_INTEL_INT(object_buffer+loc, remote_objnum);            loc += 4;
-		// use object_rw to send objects for now. if object sometime contains some day contains something useful the client should know about, we should use it. but by now it's also easier to use object_rw because then we also do not need fix64 timer values.
-		multi_object_to_object_rw(&Objects[i], (object_rw *)&object_buffer[loc]);
-#ifdef WORDS_BIGENDIAN
-		object_rw_swap((object_rw *)&object_buffer[loc], 1);
-#endif
-		loc += sizeof(object_rw);
+		loc += net_udp_put_object(object_buffer + loc, i);
 	}
 
 	if (obj_count_frame) // Send any objects we've buffered
@@ -2338,20 +2939,8 @@ void net_udp_send_objects(void)
 			PUT_INTEL_INT(object_buffer+14, obj_count);
 			dxx_sendto (UDP_Socket[0], object_buffer, 18, 0, (struct sockaddr *)&UDP_sync_player.player.protocol.udp.addr, sizeof(struct _sockaddr));
 
-			// Send sync packet which tells the player who he is and to start!
-			net_udp_send_rejoin_sync(player_num);
-
-			// Turn off send object mode
-			Network_send_objnum = -1;
-			Network_send_objects = 0;
 			obj_count = 0;
-
-			Network_sending_extras=3; // start to send extras
-			VerifyPlayerJoined = Player_joining_extras = player_num;
-
-			if(UDP_sync_player.player.observer) {
-				VerifyPlayerJoined = -1; 
-			}
+			net_udp_send_objects_done(player_num);
 
 			return;
 		} // mode == 1;
@@ -2419,7 +3008,9 @@ void net_udp_read_object_packet( ubyte *data )
 			if (net_udp_verify_objects(remote_objnum, object_count))
 			{
 				// Failed to sync up 
+				int batch = udp_send_batch_suspend();
 				nm_messagebox(NULL, 1, TXT_OK, TXT_NET_SYNC_FAILED);
+				udp_send_batch_resume(batch);
 				Network_status = NETSTAT_MENU;                          
 				return;
 			}
@@ -2464,10 +3055,373 @@ void net_udp_read_object_packet( ubyte *data )
 				else
 					object_owner[objnum] = -1;
 			}
+			else
+				loc += sizeof(object_rw); // no room for it, but the next object comes after it
 		} // For a standard onbject
 	} // For each object in packet
 }
 
+static int net_udp_lz_hash(const ubyte *p)
+{
+	return ((p[0] | (p[1] << 8) | (p[2] << 16)) * 2654435761u) >> (32 - 12) & (UDP_SNAPSHOT_LZ_HASH - 1);
+}
+
+/*
+ * Snapshot compression, a small LZ77. A control byte below 0x80 is followed by that many plus one literal bytes.
+ * From 0x80 up it copies (c & 0x7f) + 3 bytes from the 16 bit little endian distance after it. Objects of one
+ * kind share most of their object_rw, so most of a snapshot turns into copies from the objects before.
+ * Places with the same hash are chained, the longest copy among the last UDP_SNAPSHOT_LZ_DEPTH of them is taken.
+ */
+static int net_udp_lz_encode(const ubyte *src, int len, ubyte *dest)
+{
+	int head[UDP_SNAPSHOT_LZ_HASH], *prev;
+	int s = 0, d = 0, lit = 0, cand, depth, best, dist = 0, m, n, h;
+
+	MALLOC(prev, int, len);
+	for (h = 0; h < UDP_SNAPSHOT_LZ_HASH; h++)
+		head[h] = -1;
+	while (s + 3 <= len)
+	{
+		h = net_udp_lz_hash(src + s);
+		best = 0;
+		for (cand = head[h], depth = 0; cand >= 0 && s - cand <= 0xffff && depth < UDP_SNAPSHOT_LZ_DEPTH; cand = prev[cand], depth++)
+		{
+			for (m = 0; m < 0x7f + 3 && s + m < len && src[cand + m] == src[s + m]; m++)
+				;
+			if (m > best)
+			{
+				best = m;
+				dist = s - cand;
+			}
+		}
+		prev[s] = head[h];
+		head[h] = s;
+		if (best < UDP_SNAPSHOT_LZ_MIN)
+		{
+			s++;
+			continue;
+		}
+		for (; lit < s; lit += n) // literals before the match
+		{
+			n = min(s - lit, 0x80);
+			dest[d++] = n - 1;
+			memcpy(dest + d, src + lit, n);
+			d += n;
+		}
+		dest[d++] = 0x80 | (best - 3);
+		dest[d++] = dist & 0xff;
+		dest[d++] = dist >> 8;
+		for (n = s + 1; n < s + best && n + 3 <= len; n++)
+		{
+			h = net_udp_lz_hash(src + n);
+			prev[n] = head[h];
+			head[h] = n;
+		}
+		s += best;
+		lit = s;
+	}
+	for (; lit < len; lit += n)
+	{
+		n = min(len - lit, 0x80);
+		dest[d++] = n - 1;
+		memcpy(dest + d, src + lit, n);
+		d += n;
+	}
+	d_free(prev);
+	return d;
+}
+
+// Everything net_udp_send_objects() and net_udp_send_door_updates() would send, as a new compressed snapshot
+static int net_udp_build_snapshot(int player_num)
+{
+	ubyte *raw;
+	int loc = 9, i, mode, nobj = 0, obj_count = 0;
+
+	if (UDP_snapshot_tx.buf)
+		d_free(UDP_snapshot_tx.buf);
+	UDP_snapshot_tx.walls_valid = 0;
+
+	MALLOC(raw, ubyte, UDP_SNAPSHOT_MAX_RAW);
+	if (!raw)
+		return 0;
+
+	// One object packet: clear marker, the objects of both passes, count marker
+	raw[0] = UPID_OBJECT_DATA;
+	PUT_INTEL_INT(raw + 1, UDP_sync_player.token);
+	PUT_INTEL_INT(raw + loc, -1);
+	raw[loc + 4] = player_num;
+	PUT_INTEL_INT(raw + loc + 5, 0);
+	loc += 9;
+	nobj++;
+	for (mode = 0; mode < 2; mode++)
+		for (i = 0; i <= Highest_object_index; i++)
+			if (net_udp_object_to_send(i, mode, player_num))
+			{
+				loc += net_udp_put_object(raw + loc, i);
+				nobj++;
+				obj_count++;
+			}
+	PUT_INTEL_INT(raw + loc, -2);
+	raw[loc + 4] = player_num;
+	PUT_INTEL_INT(raw + loc + 5, obj_count);
+	loc += 9;
+	nobj++;
+	PUT_INTEL_INT(raw + 5, nobj);
+
+	PUT_INTEL_SHORT(raw + loc, Num_walls);
+	loc += 2;
+	memset(UDP_snapshot_tx.walls, 0, sizeof(UDP_snapshot_tx.walls));
+	for (i = 0; i < Num_walls; i++)
+		net_udp_put_wall(UDP_snapshot_tx.walls + i * UDP_SNAPSHOT_WALL_SIZE, i);
+	memcpy(raw + loc, UDP_snapshot_tx.walls, Num_walls * UDP_SNAPSHOT_WALL_SIZE);
+	loc += Num_walls * UDP_SNAPSHOT_WALL_SIZE;
+
+	MALLOC(UDP_snapshot_tx.buf, ubyte, UDP_SNAPSHOT_MAX_PACKED(loc));
+	if (!UDP_snapshot_tx.buf)
+	{
+		d_free(raw);
+		return 0;
+	}
+	UDP_snapshot_tx.size = net_udp_lz_encode(raw, loc, UDP_snapshot_tx.buf);
+	UDP_snapshot_tx.raw_size = loc;
+	UDP_snapshot_tx.sent = UDP_snapshot_tx.acked = 0;
+	UDP_snapshot_tx.ack_time = timer_query();
+	UDP_snapshot_tx.serial++;
+	UDP_snapshot_tx.walls_valid = 1;
+	d_free(raw);
+
+	con_printf(CON_VERBOSE, "Snapshot for %s: %i objects, %i bytes, %i compressed\n", UDP_sync_player.player.callsign, obj_count, loc, UDP_snapshot_tx.size);
+	return 1;
+}
+
+// Stream the snapshot to the joining player. Returns 0 if the object packets have to do instead.
+static int net_udp_send_snapshot(int player_num)
+{
+	ubyte buf[UPID_MAX_SIZE];
+	fix64 now = timer_query();
+	int len;
+
+	if (Endlevel_sequence || Control_center_destroyed)
+	{
+		net_udp_snapshot_reset();
+		return 0; // net_udp_send_objects() dumps him
+	}
+
+	if (Network_send_objnum == -1)
+	{
+		// New player, or something in the last snapshot changed
+		if (UDP_snapshot_tx.restarts > UDP_SNAPSHOT_MAX_RESTARTS)
+			return 0; // Gave up on snapshots for this player
+		if (UDP_snapshot_tx.buf && ++UDP_snapshot_tx.restarts > UDP_SNAPSHOT_MAX_RESTARTS)
+		{
+			// Too busy to ever get one through. Any later changes go as multi messages to objects already sent.
+			con_printf(CON_VERBOSE, "Snapshot for %s restarted %i times, sending objects one by one\n", UDP_sync_player.player.callsign, UDP_SNAPSHOT_MAX_RESTARTS);
+			d_free(UDP_snapshot_tx.buf);
+			UDP_snapshot_tx.walls_valid = 0;
+			return 0;
+		}
+		if (!net_udp_build_snapshot(player_num))
+			return 0;
+		Network_send_objnum = 0;
+	}
+	else if (!UDP_snapshot_tx.buf)
+		return 0;
+
+	if (UDP_snapshot_tx.acked == UDP_snapshot_tx.size)
+	{
+		d_free(UDP_snapshot_tx.buf);
+		net_udp_send_objects_done(player_num);
+		return 1;
+	}
+
+	if (now > UDP_snapshot_tx.ack_time + UDP_SNAPSHOT_RESEND)
+	{
+		UDP_snapshot_tx.sent = UDP_snapshot_tx.acked;
+		UDP_snapshot_tx.ack_time = now;
+	}
+
+	buf[0] = UPID_OBJECT_SNAPSHOT;
+	PUT_INTEL_INT(buf + 1, UDP_sync_player.token);
+	buf[5] = UDP_snapshot_tx.serial;
+	PUT_INTEL_INT(buf + 6, UDP_snapshot_tx.size);
+	PUT_INTEL_INT(buf + 10, UDP_snapshot_tx.raw_size);
+	while (UDP_snapshot_tx.sent < UDP_snapshot_tx.size && UDP_snapshot_tx.sent < UDP_snapshot_tx.acked + UDP_SNAPSHOT_WINDOW * UDP_SNAPSHOT_FRAGMENT)
+	{
+		len = min(UDP_SNAPSHOT_FRAGMENT, UDP_snapshot_tx.size - UDP_snapshot_tx.sent);
+		PUT_INTEL_INT(buf + 14, UDP_snapshot_tx.sent);
+		memcpy(buf + UPID_OBJECT_SNAPSHOT_HEADER_SIZE, UDP_snapshot_tx.buf + UDP_snapshot_tx.sent, len);
+		dxx_sendto (UDP_Socket[0], buf, UPID_OBJECT_SNAPSHOT_HEADER_SIZE + len, 0, (struct sockaddr *)&UDP_sync_player.player.protocol.udp.addr, sizeof(struct _sockaddr));
+		UDP_snapshot_tx.sent += len;
+	}
+	return 1;
+}
+
+void net_udp_process_snapshot_ack(ubyte *data, struct _sockaddr sender_addr, int data_len)
+{
+	int got = GET_INTEL_INT(data + 6);
+
+	if (!Network_send_objects || !UDP_snapshot_tx.buf || data[5] != UDP_snapshot_tx.serial)
+		return; // late ack
+	if (GET_INTEL_INT(data + 1) != UDP_sync_player.token || !is_same_addr(&sender_addr, &UDP_sync_player.player.protocol.udp.addr))
+	{
+		drop_rx_packet(data, "snapshot ack not from joining player");
+		return;
+	}
+
+	if (got > UDP_snapshot_tx.acked && got <= UDP_snapshot_tx.size)
+	{
+		UDP_snapshot_tx.acked = got;
+		UDP_snapshot_tx.ack_time = timer_query();
+		if (UDP_snapshot_tx.sent < got)
+			UDP_snapshot_tx.sent = got;
+	}
+}
+
+// Counterpart of net_udp_lz_encode() that stays inside both buffers. Returns the decoded size, -1 if the data is broken.
+static int net_udp_lz_decode(const ubyte *src, int src_len, ubyte *dest, int dest_len)
+{
+	int s = 0, d = 0, n, dist;
+	ubyte c;
+
+	while (s < src_len)
+	{
+		c = src[s++];
+		if (c < 0x80) // literals
+		{
+			n = c + 1;
+			if (s + n > src_len || d + n > dest_len)
+				return -1;
+			memcpy(dest + d, src + s, n);
+			s += n;
+			d += n;
+			continue;
+		}
+		n = (c & 0x7f) + 3;
+		if (s + 2 > src_len)
+			return -1;
+		dist = src[s] | (src[s + 1] << 8);
+		s += 2;
+		if (!dist || dist > d || d + n > dest_len)
+			return -1;
+		for (; n; n--, d++) // may overlap, so byte by byte
+			dest[d] = dest[d - dist];
+	}
+	return d;
+}
+
+// Bring a wall to the state the host had, like the messages from net_udp_send_door_updates() would
+static void net_udp_apply_snapshot_wall(int wallnum, ubyte *buf)
+{
+	wall *w = &Walls[wallnum];
+	segment *seg = &Segments[w->segnum];
+	ubyte type = buf[0], flags = buf[1], state = buf[2];
+	fix hps = GET_INTEL_INT(buf + 3);
+
+	if (((type == WALL_DOOR) && ((state == WALL_DOOR_OPENING) || (state == WALL_DOOR_WAITING))) ||
+		((type == WALL_BLASTABLE) && (flags & WALL_BLASTED)))
+	{
+		if (w->type == WALL_BLASTABLE)
+		{
+			if (!(w->flags & WALL_BLASTED))
+				wall_destroy(seg, w->sidenum);
+		}
+		else if (w->state != WALL_DOOR_OPENING)
+			wall_open_door(seg, w->sidenum);
+	}
+	else if ((type == WALL_BLASTABLE) && (hps != WALL_HPS))
+	{
+		if ((w->type == WALL_BLASTABLE) && (hps >= 0) && (hps < w->hps))
+			wall_damage(seg, w->sidenum, w->hps - hps);
+	}
+}
+
+// All fragments are in, apply the whole snapshot at once
+static void net_udp_apply_snapshot(void)
+{
+	UDP_snapshot_rx_state *rx = &UDP_snapshot_rx;
+	ubyte *raw;
+	int loc = 9, i, nobj = 0, ok;
+
+	MALLOC(raw, ubyte, rx->raw_size);
+	ok = raw && net_udp_lz_decode(rx->buf, rx->size, raw, rx->raw_size) == rx->raw_size;
+	d_free(rx->buf);
+	rx->applied = 1;
+
+	// Walk the objects to find the walls, and make sure nothing is cut off
+	if (ok)
+	{
+		nobj = GET_INTEL_INT(raw + 5);
+		for (i = 0; ok && i < nobj; i++)
+		{
+			if (loc + 9 > rx->raw_size)
+				ok = 0;
+			else
+				loc += ((int)GET_INTEL_INT(raw + loc) < 0) ? 9 : UDP_SNAPSHOT_OBJECT_SIZE; // -1 and -2 are 9 byte markers
+		}
+		ok = ok && nobj > 0 && loc + 2 <= rx->raw_size && GET_INTEL_SHORT(raw + loc) == Num_walls &&
+			loc + 2 + Num_walls * UDP_SNAPSHOT_WALL_SIZE == rx->raw_size;
+	}
+	if (!ok)
+	{
+		con_printf(CON_URGENT, "Dropped broken rejoin snapshot.\n");
+		if (raw)
+			d_free(raw);
+		return;
+	}
+
+	net_udp_read_object_packet(raw);
+	if (Network_status != NETSTAT_MENU)
+		for (i = 0; i < Num_walls; i++)
+			net_udp_apply_snapshot_wall(i, raw + loc + 2 + i * UDP_SNAPSHOT_WALL_SIZE);
+	d_free(raw);
+
+	con_printf(CON_VERBOSE, "Got snapshot: %i objects, %i bytes, %i compressed, in %i ms\n", nobj - 2, rx->raw_size, rx->size, (int)((timer_query() - rx->start_time) * 1000 / F1_0));
+}
+
+void net_udp_process_snapshot(ubyte *data, struct _sockaddr sender_addr, int data_len)
+{
+	UDP_snapshot_rx_state *rx = &UDP_snapshot_rx;
+	ubyte ack[UPID_OBJECT_SNAPSHOT_ACK_SIZE];
+	int size = GET_INTEL_INT(data + 6), raw_size = GET_INTEL_INT(data + 10), offset = GET_INTEL_INT(data + 14);
+	int len = data_len - UPID_OBJECT_SNAPSHOT_HEADER_SIZE;
+
+	if (raw_size <= 0 || raw_size > UDP_SNAPSHOT_MAX_RAW || size <= 0 || size > UDP_SNAPSHOT_MAX_PACKED(raw_size))
+	{
+		drop_rx_packet(data, "illegal snapshot size");
+		return;
+	}
+
+	if ((!rx->buf && !rx->applied) || data[5] != rx->serial || size != rx->size || raw_size != rx->raw_size)
+	{
+		// First fragment of a new snapshot
+		if (rx->buf)
+			d_free(rx->buf);
+		memset(rx, 0, sizeof(UDP_snapshot_rx_state));
+		MALLOC(rx->buf, ubyte, size);
+		if (!rx->buf)
+			return;
+		rx->serial = data[5];
+		rx->size = size;
+		rx->raw_size = raw_size;
+		rx->start_time = timer_query();
+	}
+
+	if (rx->buf && offset == rx->got && len <= size - offset)
+	{
+		memcpy(rx->buf + offset, data + UPID_OBJECT_SNAPSHOT_HEADER_SIZE, len);
+		rx->got += len;
+	}
+
+	ack[0] = UPID_OBJECT_SNAPSHOT_ACK;
+	PUT_INTEL_INT(ack + 1, my_player_token);
+	ack[5] = rx->serial;
+	PUT_INTEL_INT(ack + 6, rx->got);
+	dxx_sendto (UDP_Socket[0], ack, UPID_OBJECT_SNAPSHOT_ACK_SIZE, 0, (struct sockaddr *)&sender_addr, sizeof(struct _sockaddr));
+
+	if (rx->buf && rx->got == rx->size)
+		net_udp_apply_snapshot();
+}
+
 // Finished sending objects
 void net_udp_send_rejoin_sync(int player_num)
 {
@@ -3046,6 +4000,7 @@ void net_udp_send_game_info(struct _sockaddr sender_addr, ubyte info_upid, ubyte
 		buf[len] = Netgame.team_color[0];						len++;
 		buf[len] = Netgame.team_color[1];						len++;
 		buf[len] = Netgame.NewSpawnAlgorithm; len++;
+		buf[len] = Netgame.DeltaPackets; len++;
 
 		if(info_upid == UPID_SYNC) {
 			PUT_INTEL_INT(buf + len, player_token); len += 4; 
@@ -3279,6 +4234,7 @@ int net_udp_process_game_info(ubyte *data, int data_len, struct _sockaddr game_a
 		Netgame.team_color[0] = data[len];						len++;
 		Netgame.team_color[1] = data[len];						len++;
 		Netgame.NewSpawnAlgorithm = data[len]; len++;
+		Netgame.DeltaPackets = data[len]; len++;
 
 		if (Netgame.host_is_obs) {
 			multi_make_player_ghost(0);
@@ -3317,8 +4273,11 @@ int net_udp_process_game_info(ubyte *data, int data_len, struct _sockaddr game_a
 
 void net_udp_process_dump(ubyte *data, int len, struct _sockaddr sender_addr)
 {
+	int batch;
+
 	// Our request for join was denied.  Tell the user why.
 
+	batch = udp_send_batch_suspend(); // what multi_leave_game() sends goes out before the message box
 	switch (data[5])
 	{
 		case DUMP_PKTTIMEOUT:
@@ -3346,6 +4305,7 @@ void net_udp_process_dump(ubyte *data, int len, struct _sockaddr sender_addr)
 			multi_reset_stuff();
 			break;
 	}
+	udp_send_batch_resume(batch);
 }
 
 void net_udp_process_request(UDP_sequence_packet *their)
@@ -3386,6 +4346,10 @@ void net_udp_process_packet(ubyte *data, struct _sockaddr sender_addr, int lengt
 			case UPID_MDATA_PNEEDACK:
             case UPID_OBSDATA:
             case UPID_OBSQUIT:
+            case UPID_BUNDLE: // messages get checked one by one
+            case UPID_BUNDLE_OFFER:
+            case UPID_OBS_RELAY_OFFER:
+            case UPID_OBJECT_SNAPSHOT_ACK:
 				break;
 			default:
 				con_printf(CON_URGENT, "Dropped pid %s: observer sent disallowed packet.\n", msg_name(data[0])); 
@@ -3393,6 +4357,9 @@ void net_udp_process_packet(ubyte *data, struct _sockaddr sender_addr, int lengt
 		}
 	}
 
+	if (!is_proxy)
+		net_udp_offer_bundles(data[0], sender_addr);
+
     if (multi_i_am_master()) {
         switch (data[0])
         {
@@ -3551,6 +4518,38 @@ void net_udp_process_packet(ubyte *data, struct _sockaddr sender_addr, int lengt
 			net_udp_process_proxy( data, sender_addr, length);
 			break;
 
+		case UPID_BUNDLE:
+			net_udp_process_bundle( data, sender_addr, length, is_proxy );
+			break;
+
+		case UPID_BUNDLE_OFFER:
+			net_udp_process_bundle_offer( sender_addr );
+			break;
+
+		case UPID_OBS_RELAY:
+			net_udp_process_obs_relay( data, sender_addr, length );
+			break;
+
+		case UPID_OBS_RELAY_LIST:
+			net_udp_process_obs_relay_list( data, sender_addr, length );
+			break;
+
+		case UPID_OBS_RELAY_OFFER:
+			net_udp_process_obs_relay_offer( data, sender_addr, length );
+			break;
+
+		case UPID_OBS_RELAY_VIA:
+			net_udp_process_obs_relay_via( data, sender_addr, length );
+			break;
+
+		case UPID_OBJECT_SNAPSHOT:
+			net_udp_process_snapshot( data, sender_addr, length );
+			break;
+
+		case UPID_OBJECT_SNAPSHOT_ACK:
+			net_udp_process_snapshot_ack( data, sender_addr, length );
+			break;
+
 		case UPID_REATTEMPT_DIRECT:
 			net_udp_process_p2p_reattempt_direct( data, sender_addr, length);
 			break; 
@@ -3778,7 +4777,7 @@ int net_udp_start_poll( newmenu *menu, d_event *event, void *userdata )
 }
 
 static int opt_cinvul, opt_show_on_map;
-static int opt_show_on_map, opt_difficulty, opt_setpower, opt_playtime, opt_killgoal, opt_port, opt_packets, opt_shortpack, opt_show_names, opt_bright, opt_ffire, opt_retroproto, opt_respawnconcs, opt_allowcolor, opt_faircolors, opt_blackwhite;
+static int opt_show_on_map, opt_difficulty, opt_setpower, opt_playtime, opt_killgoal, opt_port, opt_packets, opt_shortpack, opt_show_names, opt_bright, opt_ffire, opt_retroproto, opt_deltapackets, opt_respawnconcs, opt_allowcolor, opt_faircolors, opt_blackwhite;
 static int opt_primary_dup, opt_secondary_dup, opt_secondary_cap; 
 static int opt_spawn_no_invul, opt_spawn_short_invul, opt_spawn_long_invul, opt_spawn_preview; 
 static int opt_spawn_algorithm;
@@ -3822,9 +4821,9 @@ void net_udp_more_game_options ()
 	char PrimDupText[80],SecDupText[80],SecCapText[80]; 
 	char HomingUpdateRateText[80];
 #ifdef USE_TRACKER
-	newmenu_item m[45];
+	newmenu_item m[46];
 #else
-	newmenu_item m[44];
+	newmenu_item m[45];
 #endif
 
 	snprintf(packstring,sizeof(char)*4,"%d",Netgame.PacketsPerSec);
@@ -3930,6 +4929,8 @@ void net_udp_more_game_options ()
 
 	opt_retroproto = opt;
 	m[opt].type = NM_TYPE_CHECK; m[opt].text = "Retro Protocol (p2p, etc.)"; m[opt].value = Netgame.RetroProtocol; opt++;
+	opt_deltapackets = opt;
+	m[opt].type = NM_TYPE_CHECK; m[opt].text = "Delta Packets (saves upload)"; m[opt].value = Netgame.DeltaPackets; opt++;
 
 
 	m[opt].type = NM_TYPE_TEXT; m[opt].text = ""; opt++;	
@@ -4014,6 +5015,7 @@ menu:
 #endif
 
 	Netgame.RetroProtocol = m[opt_retroproto].value;
+	Netgame.DeltaPackets = m[opt_deltapackets].value;
 	Netgame.RespawnConcs  = m[opt_respawnconcs].value;
 	Netgame.AllowColoredLighting  = m[opt_allowcolor].value;
 	Netgame.FairColors  = m[opt_faircolors].value;
@@ -4344,6 +5346,7 @@ void netgame_set_defaults(void)
 	Netgame.ReducedFlash = 0;
 	Netgame.GaussAmmoStyle = GAUSS_STYLE_DEPLETING;
 	Netgame.NewSpawnAlgorithm = 0;
+	Netgame.DeltaPackets = 0;
 
 #ifdef USE_TRACKER
 	Netgame.Tracker = 1;
@@ -4580,6 +5583,44 @@ int net_udp_setup_game()
 	return choice >= 0;
 }
 
+// Host a game with the current Netgame settings and mission, without the setup menus. Used by -dedicated.
+int net_udp_host_dedicated(void)
+{
+	int i;
+
+	net_udp_init();
+
+	net_udp_reset_connection_statuses();
+
+	change_playernum_to(0);
+
+	for (i=0;i<MAX_PLAYERS;i++)
+		if (i!=Player_num)
+			Players[i].callsign[0]=0;
+
+	if (!Netgame.game_name[0])
+		sprintf( Netgame.game_name, "%s%s", Players[Player_num].callsign, TXT_S_GAME );
+	if (GameArg.MplUdpMyPort != 0)
+		snprintf (UDP_MyPort, sizeof(UDP_MyPort), "%d", GameArg.MplUdpMyPort);
+	else
+		snprintf (UDP_MyPort, sizeof(UDP_MyPort), "%d", UDP_PORT_DEFAULT);
+
+	if (Netgame.gamemode == NETGAME_COOPERATIVE && Netgame.max_numplayers > 4)
+		Netgame.max_numplayers = 4;
+	if ((Netgame.levelnum < Last_secret_level) || (Netgame.levelnum > Last_level) || (Netgame.levelnum == 0))
+		Netgame.levelnum = 1;
+
+	strcpy(Netgame.mission_name, Current_mission_filename);
+	strcpy(Netgame.mission_title, Current_mission_longname);
+	Difficulty_level = Netgame.difficulty;
+
+	if (net_udp_start_game())
+		return 1;
+
+	net_udp_close();
+	return 0;
+}
+
 void net_udp_reset_connection_statuses() {
 	for(int i = 0; i < MAX_PLAYERS; i++) {
 		connection_statuses[i] = CONNECTION_NONE;
@@ -4597,6 +5638,7 @@ void net_udp_reset_connection_statuses() {
 			last_direct_attempt[i][j] = 0; 
 		}
 	}
+	net_udp_reset_delta_pdata();
 
 	netgame_token = my_player_token = generate_token(); 
 	con_printf(CON_DEBUG, "Generated token %d in net_udp_reset_connection_statuses\n", netgame_token); 
@@ -5000,6 +6042,24 @@ net_udp_select_players(void)
 	int save_nplayers;
 
 	net_udp_add_player( &UDP_Seq );
+
+	if (GameArg.MplDedicated) // nobody to pick: the host only watches and the players join the game in progress
+	{
+#ifdef USE_TRACKER
+		if( Netgame.Tracker )
+			udp_tracker_register();
+#endif
+		Netgame.host_is_obs = 1;
+		Host_is_obs = 1;
+		N_players = 1;
+		Game_mode |= GM_OBSERVER;
+		Current_obs_player = 0;
+		for (i = N_players; i < MAX_PLAYERS; i++) {
+			memset(Netgame.players[i].callsign, 0, CALLSIGN_LEN+1);
+			Netgame.players[i].rank=0;
+		}
+		return(1);
+	}
 		
 	for (i=0; i< MAX_PLAYERS; i++ )	{
 		sprintf( text[i], "%d.  %-20s", i+1, "" );
@@ -5164,6 +6224,10 @@ int net_udp_start_game(void)
 #endif
 	d_srand( (fix)timer_query() );
 	Netgame.protocol.udp.GameID=d_rand();
+	if (GameArg.MplUdpMtu > 0)
+		Netgame.game_flags |= NETGAME_FLAG_COALESCE;
+	else
+		Netgame.game_flags &= ~NETGAME_FLAG_COALESCE;
 
 
 	N_players = 0;
@@ -5200,6 +6264,7 @@ net_udp_wait_for_sync(void)
 	char text[60];
 	newmenu_item m[2];
 	int i, choice=0;
+	fix64 start_time = timer_query();
 	
 	Network_status = NETSTAT_WAITING;
 	m[0].type=NM_TYPE_TEXT; m[0].text = text;
@@ -5217,6 +6282,7 @@ net_udp_wait_for_sync(void)
 		timer_update();
 		choice=newmenu_do( NULL, TXT_WAIT, 2, m, net_udp_sync_poll, NULL );
 	}
+	net_udp_snapshot_reset();
 
 
 	if (Network_status != NETSTAT_PLAYING)	
@@ -5233,6 +6299,8 @@ net_udp_wait_for_sync(void)
 		Game_mode = GM_GAME_OVER;
 		return(-1);     // they cancelled
 	}
+
+	con_printf(CON_VERBOSE, "Joined in %i ms\n", (int)((timer_query() - start_time) * 1000 / F1_0));
 	return(0);
 }
 
@@ -5280,6 +6348,20 @@ int net_udp_wait_for_requests(void)
 
 	Players[Player_num].connected = CONNECT_PLAYING;
 
+	if (GameArg.MplDedicated) // nobody to ask, so give the players a while to load the level and go on
+	{
+		d_event event;
+		fix64 give_up = timer_query() + i2f(30);
+
+		event.type = EVENT_WINDOW_DRAW;
+		do
+		{
+			timer_delay2(50);
+			timer_update();
+		} while (net_udp_request_poll(NULL, &event, NULL) != -2 && timer_query() < give_up);
+		return 0;
+	}
+
 menu:
 	choice = newmenu_do(NULL, TXT_WAIT, 1, m, net_udp_request_poll, NULL);	
 
@@ -5315,6 +6397,7 @@ net_udp_level_sync(void)
 
 	memset(&UDP_MData, 0, sizeof(UDP_mdata_info));
 	net_udp_noloss_init_mdata_queue();
+	net_udp_reset_delta_pdata();
 
 //	my_segments_checksum = netmisc_calc_checksum(Segments, sizeof(segment)*(Highest_segment_index+1));
 
@@ -5547,6 +6630,11 @@ void net_udp_do_frame(int force, int listen)
 	if (!(Game_mode&GM_NETWORK) || UDP_Socket[0] == -1)
 		return;
 
+	udp_thread_start();
+	if (!UDP_thread)
+		udp_send_batch_begin();
+	udp_coalesce_begin();
+
 	time = timer_query();
 
 	if (WaitForRefuseAnswer && time>(RefuseTimeLimit+(F1_0*12)))
@@ -5595,6 +6683,7 @@ void net_udp_do_frame(int force, int listen)
 		static fix64 iLastQuery = 0;
 		static int iAttempts = 0;
 		fix64 iNow = timer_query();
+		int batch;
 		
 		// Set the last query to now if we must
 		if( iLastQuery == 0 )
@@ -5619,7 +6708,9 @@ void net_udp_do_frame(int force, int listen)
 			iAttempts = 0;
 			
 			// Warn
+			batch = udp_send_batch_suspend();
 			nm_messagebox( TXT_WARNING, 1, TXT_OK, "No response from tracker!\nPossible causes:\nTracker is down\nYour port is likely not open!\n\nTracker: %s\nGame port: %s", GameArg.MplTrackerAddr, UDP_MyPort );
+			udp_send_batch_resume(batch);
 		}
 	}
 #endif
@@ -5634,7 +6725,8 @@ void net_udp_do_frame(int force, int listen)
 
 	clean_pdata(time); 
 
-	check_observers(time); 
+	check_observers(time);
+	net_udp_obs_relay_frame(time); 
 	check_obs_buffer(time);
 
 	if (listen)
@@ -5647,136 +6739,387 @@ void net_udp_do_frame(int force, int listen)
 			net_udp_send_extras();
 	}
 
+	udp_coalesce_end();
+	if (!UDP_thread)
+		udp_send_batch_end();
+
 	udp_traffic_stat();
 }
 
 /* CODE FOR PACKET LOSS PREVENTION - START */
 /*
- * Adds a packet to our queue. Should be called when an IMPORTANT mdata packet is created.
- * player_ack is an array which should contain 0 for each player that needs to send an ACK signal.
+ * Stored packets are found through a hash of sender and packet number. The resend deadline of each
+ * (stored packet, receiver) pair and the timeout of each stored packet are nodes in a timer wheel, so a
+ * frame only looks at the wheel slots time went past since the last frame instead of every stored
+ * packet for every player. Node n belongs to stored packet n/UDP_NOLOSS_NODES and receiver
+ * n%UDP_NOLOSS_NODES. The last node of a stored packet is its timeout.
  */
-void net_udp_noloss_add_queue_pkt(uint32_t pkt_num, fix64 time, ubyte *data, ushort data_size, ubyte pnum, ubyte player_ack[MAX_PLAYERS])
+#define UDP_NOLOSS_NODES (MAX_OBSERVERS+1) // MAX_OBSERVERS >= MAX_PLAYERS
+#define UDP_NOLOSS_EXPIRE MAX_OBSERVERS
+#define UDP_NOLOSS_HASH_SIZE 4096
+#define UDP_NOLOSS_WHEEL_SIZE 512
+#define UDP_NOLOSS_WHEEL_SHIFT 11 // one wheel slot every 2048/65536 seconds, 16 seconds around
+#define UDP_NOLOSS_RESEND (F1_0/3)
+#define UDP_NOLOSS_NONE -1
+#define UDP_NOLOSS_SCAN_START -2
+
+typedef struct udp_noloss_index
 {
-	int i, found = 0;
+	short		hash_head[UDP_NOLOSS_HASH_SIZE];
+	short		hash_next[UDP_MDATA_STOR_QUEUE_SIZE];	// also links the free slots
+	uint32_t	key[UDP_MDATA_STOR_QUEUE_SIZE];
+	short		age_prev[UDP_MDATA_STOR_QUEUE_SIZE], age_next[UDP_MDATA_STOR_QUEUE_SIZE];
+	short		age_head, age_tail;			// oldest and newest stored packet
+	short		stored;					// number of stored packets
+	short		free_head;
+	short		needack[UDP_MDATA_STOR_QUEUE_SIZE];	// receivers still waiting for this packet
+	short		wheel_head[UDP_NOLOSS_WHEEL_SIZE], wheel_tail[UDP_NOLOSS_WHEEL_SIZE];
+	short		node_prev[UDP_MDATA_STOR_QUEUE_SIZE*UDP_NOLOSS_NODES], node_next[UDP_MDATA_STOR_QUEUE_SIZE*UDP_NOLOSS_NODES];
+	short		node_wheel[UDP_MDATA_STOR_QUEUE_SIZE*UDP_NOLOSS_NODES];	// wheel slot or UDP_NOLOSS_NONE if not pending
+	fix64		node_time[UDP_MDATA_STOR_QUEUE_SIZE*UDP_NOLOSS_NODES];
+	fix64		wheel_tick;				// wheel slot we are at, -1 until something got scheduled
+	short		scan;					// next node to check in that slot
+} udp_noloss_index;
+
+static udp_noloss_index UDP_mdata_index, UDP_mdata_obs_index;
+
+static void net_udp_noloss_index_init(udp_noloss_index *q)
+{
+	int i;
 
-	if (!(Game_mode&GM_NETWORK) || UDP_Socket[0] == -1)
-		return;
+	for (i = 0; i < UDP_NOLOSS_HASH_SIZE; i++)
+		q->hash_head[i] = UDP_NOLOSS_NONE;
+	for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE; i++)
+		q->hash_next[i] = (i < UDP_MDATA_STOR_QUEUE_SIZE-1) ? i+1 : UDP_NOLOSS_NONE;
+	q->free_head = 0;
+	q->age_head = q->age_tail = UDP_NOLOSS_NONE;
+	q->stored = 0;
+	memset(q->needack, 0, sizeof(q->needack));
+	for (i = 0; i < UDP_NOLOSS_WHEEL_SIZE; i++)
+		q->wheel_head[i] = q->wheel_tail[i] = UDP_NOLOSS_NONE;
+	for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE*UDP_NOLOSS_NODES; i++)
+		q->node_wheel[i] = UDP_NOLOSS_NONE;
+	q->wheel_tick = -1;
+	q->scan = UDP_NOLOSS_SCAN_START;
+}
+
+static uint32_t net_udp_noloss_key(ubyte pnum, uint32_t pkt_num)
+{
+	return ((uint32_t)pnum << 24) | (pkt_num & 0xffffff);
+}
 
-	if (!Netgame.PacketLossPrevention)
+static int net_udp_noloss_hash(uint32_t key)
+{
+	return (key ^ (key >> 15)) & (UDP_NOLOSS_HASH_SIZE-1);
+}
+
+static int net_udp_noloss_index_find(udp_noloss_index *q, ubyte pnum, uint32_t pkt_num)
+{
+	uint32_t key = net_udp_noloss_key(pnum, pkt_num);
+	int i;
+
+	for (i = q->hash_head[net_udp_noloss_hash(key)]; i != UDP_NOLOSS_NONE; i = q->hash_next[i])
+		if (q->key[i] == key)
+			return i;
+	return UDP_NOLOSS_NONE;
+}
+
+static void net_udp_noloss_unschedule(udp_noloss_index *q, int node)
+{
+	if (q->node_wheel[node] == UDP_NOLOSS_NONE)
 		return;
+	if (q->scan == node)
+		q->scan = q->node_next[node];
+	if (q->node_prev[node] != UDP_NOLOSS_NONE)
+		q->node_next[q->node_prev[node]] = q->node_next[node];
+	else
+		q->wheel_head[q->node_wheel[node]] = q->node_next[node];
+	if (q->node_next[node] != UDP_NOLOSS_NONE)
+		q->node_prev[q->node_next[node]] = q->node_prev[node];
+	else
+		q->wheel_tail[q->node_wheel[node]] = q->node_prev[node];
+	q->node_wheel[node] = UDP_NOLOSS_NONE;
+}
 
-	for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE; i++) // look for unused or oldest slot
+static void net_udp_noloss_schedule(udp_noloss_index *q, int node, fix64 time)
+{
+	fix64 tick = time >> UDP_NOLOSS_WHEEL_SHIFT;
+	int w;
+
+	net_udp_noloss_unschedule(q, node);
+	if (q->wheel_tick < 0)
+		q->wheel_tick = tick;
+	if (tick < q->wheel_tick)
+		tick = q->wheel_tick;
+	w = tick & (UDP_NOLOSS_WHEEL_SIZE-1);
+	q->node_time[node] = time;
+	q->node_wheel[node] = w;
+	// append, so a scan going through this slot right now still gets to it
+	q->node_next[node] = UDP_NOLOSS_NONE;
+	q->node_prev[node] = q->wheel_tail[w];
+	if (q->wheel_tail[w] != UDP_NOLOSS_NONE)
+		q->node_next[q->wheel_tail[w]] = node;
+	else
+		q->wheel_head[w] = node;
+	q->wheel_tail[w] = node;
+}
+
+/*
+ * Returns the next node due at given time, or UDP_NOLOSS_NONE. The caller must reschedule or remove it.
+ * Stopping early is fine, the next call goes on where this one stopped.
+ */
+static int net_udp_noloss_next_due(udp_noloss_index *q, fix64 time)
+{
+	fix64 now = time >> UDP_NOLOSS_WHEEL_SHIFT;
+	int node;
+
+	if (q->wheel_tick < 0)
+		return UDP_NOLOSS_NONE;
+	if (now - q->wheel_tick >= UDP_NOLOSS_WHEEL_SIZE) // long pause - just visit every slot once
 	{
-		if (UDP_mdata_queue[i].used)
-		{
-			if (UDP_mdata_queue[i].pkt_initial_timestamp > UDP_mdata_queue[found].pkt_initial_timestamp)
-				found = i;
-		}
-		else
+		q->wheel_tick = now - UDP_NOLOSS_WHEEL_SIZE + 1;
+		q->scan = UDP_NOLOSS_SCAN_START;
+	}
+
+	for (;;)
+	{
+		node = (q->scan == UDP_NOLOSS_SCAN_START) ? q->wheel_head[q->wheel_tick & (UDP_NOLOSS_WHEEL_SIZE-1)] : q->scan;
+		for (; node != UDP_NOLOSS_NONE; node = q->node_next[node])
 		{
-			found = i;
-			break;
+			if (q->node_time[node] <= time)
+			{
+				q->scan = q->node_next[node];
+				return node;
+			}
 		}
+		q->scan = UDP_NOLOSS_SCAN_START;
+		if (q->wheel_tick >= now) // stay here, there may be nodes due later in this slot
+			return UDP_NOLOSS_NONE;
+		q->wheel_tick++;
 	}
+}
+
+static int net_udp_noloss_index_add(udp_noloss_index *q, ubyte pnum, uint32_t pkt_num, fix64 time)
+{
+	int i = q->free_head, h;
+
+	q->free_head = q->hash_next[i];
+	q->key[i] = net_udp_noloss_key(pnum, pkt_num);
+	h = net_udp_noloss_hash(q->key[i]);
+	q->hash_next[i] = q->hash_head[h];
+	q->hash_head[h] = i;
+	q->age_next[i] = UDP_NOLOSS_NONE;
+	q->age_prev[i] = q->age_tail;
+	if (q->age_tail != UDP_NOLOSS_NONE)
+		q->age_next[q->age_tail] = i;
+	else
+		q->age_head = i;
+	q->age_tail = i;
+	q->stored++;
+	q->needack[i] = 0;
+	net_udp_noloss_schedule(q, i*UDP_NOLOSS_NODES + UDP_NOLOSS_EXPIRE, time + UDP_TIMEOUT);
+	return i;
+}
+
+static void net_udp_noloss_index_remove(udp_noloss_index *q, int i)
+{
+	short *p = &q->hash_head[net_udp_noloss_hash(q->key[i])];
+	int n;
+
+	while (*p != i)
+		p = &q->hash_next[*p];
+	*p = q->hash_next[i];
+	if (q->age_prev[i] != UDP_NOLOSS_NONE)
+		q->age_next[q->age_prev[i]] = q->age_next[i];
+	else
+		q->age_head = q->age_next[i];
+	if (q->age_next[i] != UDP_NOLOSS_NONE)
+		q->age_prev[q->age_next[i]] = q->age_prev[i];
+	else
+		q->age_tail = q->age_prev[i];
+	for (n = 0; n < UDP_NOLOSS_NODES; n++)
+		net_udp_noloss_unschedule(q, i*UDP_NOLOSS_NODES + n);
+	q->stored--;
+	q->needack[i] = 0;
+	q->hash_next[i] = q->free_head;
+	q->free_head = i;
+}
+
+// receiver r needs an ACK for stored packet i. First resend at given time.
+static void net_udp_noloss_index_expect(udp_noloss_index *q, int i, int r, fix64 time)
+{
+	net_udp_noloss_schedule(q, i*UDP_NOLOSS_NODES + r, time);
+	q->needack[i]++;
+}
 
-	if (UDP_mdata_queue[found].used) // seems the slot we found is used (list is full) so screw  those who still need ack's.
+// receiver r ACK'd stored packet i. Returns the number of receivers still missing.
+static int net_udp_noloss_index_ack(udp_noloss_index *q, int i, int r)
+{
+	int node = i*UDP_NOLOSS_NODES + r;
+
+	if (q->node_wheel[node] != UDP_NOLOSS_NONE)
+	{
+		net_udp_noloss_unschedule(q, node);
+		q->needack[i]--;
+	}
+	return q->needack[i];
+}
+
+// Players we don't need an ACK from: not playing (anymore), *me* and anyone but the host if we are a client.
+static int net_udp_noloss_player_skip(int plc)
+{
+	return Players[plc].connected != CONNECT_PLAYING || plc == Player_num || (!multi_i_am_master() && plc > 0);
+}
+
+static int net_udp_noloss_observer_skip(int plc)
+{
+	return plc >= Netgame.max_numobservers || Netgame.observers[plc].connected == 0;
+}
+
+// We could not get an important packet through as a client. Disable PLP - otherwise we get stuck in an infinite loop here. NOTE: We could as well clean the whole queue to continue protect our disconnect signal bit it's not that important - we just wanna leave.
+static void net_udp_noloss_leave_game(const char *msg)
+{
+	int batch;
+
+	Netgame.PacketLossPrevention = 0;
+	if (Network_status==NETSTAT_PLAYING)
+		multi_leave_game();
+	if (Game_wind)
+		window_set_visible(Game_wind, 0);
+	batch = udp_send_batch_suspend();
+	nm_messagebox(NULL, 1, TXT_OK, msg);
+	udp_send_batch_resume(batch);
+	if (Game_wind)
+		window_set_visible(Game_wind, 1);
+	multi_quit_game = 1;
+	game_leave_menus();
+	multi_reset_stuff();
+}
+
+// Drop stored player packet i. Players who did not ACK it are dumped (or we leave if we are a client).
+static void net_udp_noloss_give_up(int i, const char *msg)
+{
+	int plc;
+
+	if (multi_i_am_master())
 	{
+		for ( plc=1; plc<N_players; plc++ )
+			if (UDP_mdata_queue[i].player_ack[plc] == 0)
+				net_udp_dump_player(Netgame.players[plc].protocol.udp.addr, player_tokens[plc], DUMP_PKTTIMEOUT);
+	}
+	else
+		net_udp_noloss_leave_game(msg);
+}
+
+static void net_udp_noloss_obs_give_up(int i, const char *msg)
+{
+	int plc;
+
+	if (multi_i_am_master())
+	{
+		for (plc = 0; plc < Netgame.max_numobservers; plc++)
+			if (UDP_mdata_obs_queue[i].observer_ack[plc] == 0)
+				net_udp_dump_player(Netgame.observers[plc].protocol.udp.addr, 0, DUMP_PKTTIMEOUT);
+	}
+	else
+		net_udp_noloss_leave_game(msg);
+}
+
+static void net_udp_noloss_remove(int i)
+{
+	if (!UDP_mdata_queue[i].used) // the queue got reset while giving up
+		return;
+	net_udp_noloss_index_remove(&UDP_mdata_index, i);
+	memset(&UDP_mdata_queue[i],0,sizeof(UDP_mdata_store));
+}
+
+static void net_udp_noloss_obs_remove(int i)
+{
+	if (!UDP_mdata_obs_queue[i].used)
+		return;
+	net_udp_noloss_index_remove(&UDP_mdata_obs_index, i);
+	memset(&UDP_mdata_obs_queue[i], 0, sizeof(UDP_mdata_obs_store));
+}
+
+/*
+ * Adds a packet to our queue. Should be called when an IMPORTANT mdata packet is created.
+ * player_ack is an array which should contain 0 for each player that needs to send an ACK signal.
+ */
+void net_udp_noloss_add_queue_pkt(uint32_t pkt_num, fix64 time, ubyte *data, ushort data_size, ubyte pnum, ubyte player_ack[MAX_PLAYERS])
+{
+	int i, found = 0;
+
+	if (!(Game_mode&GM_NETWORK) || UDP_Socket[0] == -1)
+		return;
+
+	if (!Netgame.PacketLossPrevention)
+		return;
+
+	if (UDP_mdata_index.free_head == UDP_NOLOSS_NONE) // list is full so screw those who still need ack's on the oldest packet.
+	{
+		found = UDP_mdata_index.age_head;
 		con_printf(CON_VERBOSE, "P#%i: MData store list is full!\n", Player_num);
-		if (multi_i_am_master())
-		{
-			for ( i=1; i<N_players; i++ )
-				if (UDP_mdata_queue[found].player_ack[i] == 0)
-					net_udp_dump_player(Netgame.players[i].protocol.udp.addr, player_tokens[i], DUMP_PKTTIMEOUT);
-		}
-		else
-		{
-			Netgame.PacketLossPrevention = 0; // Disable PLP - otherwise we get stuck in an infinite loop here. NOTE: We could as well clean the whole queue to continue protect our disconnect signal bit it's not that important - we just wanna leave.
-			if (Network_status==NETSTAT_PLAYING)
-				multi_leave_game();
-			if (Game_wind)
-				window_set_visible(Game_wind, 0);
-			nm_messagebox(NULL, 1, TXT_OK, "You left the game. You failed\nsending important packets (queue full).\nSorry.");
-			if (Game_wind)
-				window_set_visible(Game_wind, 1);
-			multi_quit_game = 1;
-			game_leave_menus();
-			multi_reset_stuff();
-		}
+		net_udp_noloss_give_up(found, "You left the game. You failed\nsending important packets.\nSorry.");
+		net_udp_noloss_remove(found);
 	}
 
 	con_printf(CON_VERBOSE, "P#%i: Adding MData pkt_num %i, type %i from P#%i to MData store list\n", Player_num, pkt_num, data[0], pnum);
+	found = net_udp_noloss_index_add(&UDP_mdata_index, pnum, pkt_num, time);
 	UDP_mdata_queue[found].used = 1;
 	UDP_mdata_queue[found].pkt_initial_timestamp = time;
-	for (i = 0; i < MAX_PLAYERS; i++)
-		UDP_mdata_queue[found].pkt_timestamp[i] = time;
 	UDP_mdata_queue[found].pkt_num = pkt_num;
 	UDP_mdata_queue[found].Player_num = pnum;
-	memcpy( &UDP_mdata_queue[found].player_ack, player_ack, sizeof(ubyte)*MAX_PLAYERS); 
+	memcpy( &UDP_mdata_queue[found].player_ack, player_ack, sizeof(ubyte)*MAX_PLAYERS);
 	memcpy( &UDP_mdata_queue[found].data, data, sizeof(char)*data_size );
 	UDP_mdata_queue[found].data_size = data_size;
+	for (i = 0; i < MAX_PLAYERS; i++)
+	{
+		if (net_udp_noloss_player_skip(i))
+			UDP_mdata_queue[found].player_ack[i] = 1;
+		if (!UDP_mdata_queue[found].player_ack[i])
+			net_udp_noloss_index_expect(&UDP_mdata_index, found, i, time + UDP_NOLOSS_RESEND);
+	}
+	if (!UDP_mdata_index.needack[found])
+		net_udp_noloss_remove(found);
 }
 
 void net_udp_noloss_obs_add_queue_pkt(uint32_t pkt_num, fix64 time, ubyte *data, ushort data_size, ubyte pnum, ubyte observer_ack[MAX_OBSERVERS])
 {
 	int i, found = 0;
 
-	if (!(Game_mode&GM_NETWORK) || UDP_Socket[0] == -1)
+	if (!(Game_mode & GM_NETWORK) || UDP_Socket[0] == -1)
 		return;
 
 	if (!Netgame.PacketLossPrevention)
 		return;
 
-	for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE; i++) // look for unused or oldest slot
-	{
-		if (UDP_mdata_obs_queue[i].used)
-		{
-			if (UDP_mdata_obs_queue[i].pkt_initial_timestamp > UDP_mdata_obs_queue[found].pkt_initial_timestamp)
-				found = i;
-		}
-		else
-		{
-			found = i;
-			break;
-		}
-	}
-
-	if (UDP_mdata_obs_queue[found].used) // seems the slot we found is used (list is full) so screw  those who still need ack's.
+	if (UDP_mdata_obs_index.free_head == UDP_NOLOSS_NONE) // list is full so screw those who still need ack's on the oldest packet.
 	{
+		found = UDP_mdata_obs_index.age_head;
 		con_printf(CON_VERBOSE, "P#%i: MData store list is full!\n", Player_num);
-		if (multi_i_am_master())
-		{
-			for ( i=1; i<Netgame.max_numobservers; i++ )
-				if (UDP_mdata_obs_queue[found].observer_ack[i] == 0)
-					net_udp_dump_player(Netgame.observers[i].protocol.udp.addr, 0, DUMP_PKTTIMEOUT);
-		}
-		else
-		{
-			Netgame.PacketLossPrevention = 0; // Disable PLP - otherwise we get stuck in an infinite loop here. NOTE: We could as well clean the whole queue to continue protect our disconnect signal bit it's not that important - we just wanna leave.
-			if (Network_status==NETSTAT_PLAYING)
-				multi_leave_game();
-			if (Game_wind)
-				window_set_visible(Game_wind, 0);
-			nm_messagebox(NULL, 1, TXT_OK, "You left the game. You failed\nsending important packets (queue full).\nSorry.");
-			if (Game_wind)
-				window_set_visible(Game_wind, 1);
-			multi_quit_game = 1;
-			game_leave_menus();
-			multi_reset_stuff();
-		}
+		net_udp_noloss_obs_give_up(found, "You left the game. You failed\nsending important packets (queue full).\nSorry.");
+		net_udp_noloss_obs_remove(found);
 	}
 
 	con_printf(CON_VERBOSE, "Observer: Adding MData pkt_num %i, type %i from P#%i to MData store list\n", pkt_num, data[0], pnum);
+	found = net_udp_noloss_index_add(&UDP_mdata_obs_index, pnum, pkt_num, time);
 	UDP_mdata_obs_queue[found].used = 1;
 	UDP_mdata_obs_queue[found].pkt_initial_timestamp = time;
-	for (i = 0; i < MAX_PLAYERS; i++)
-		UDP_mdata_obs_queue[found].pkt_timestamp[i] = time;
 	UDP_mdata_obs_queue[found].pkt_num = pkt_num;
 	UDP_mdata_obs_queue[found].Player_num = pnum;
-	memcpy( &UDP_mdata_obs_queue[found].observer_ack, observer_ack, sizeof(ubyte)*MAX_OBSERVERS); 
-	memcpy( &UDP_mdata_obs_queue[found].data, data, sizeof(char)*data_size );
+	memcpy(&UDP_mdata_obs_queue[found].observer_ack, observer_ack, sizeof(ubyte) * MAX_OBSERVERS);
+	memcpy(&UDP_mdata_obs_queue[found].data, data, sizeof(char) * data_size);
 	UDP_mdata_obs_queue[found].data_size = data_size;
+	for (i = 0; i < MAX_OBSERVERS; i++)
+	{
+		if (net_udp_noloss_observer_skip(i))
+			UDP_mdata_obs_queue[found].observer_ack[i] = 1;
+		if (!UDP_mdata_obs_queue[found].observer_ack[i])
+			net_udp_noloss_index_expect(&UDP_mdata_obs_index, found, i, time + UDP_NOLOSS_RESEND);
+	}
+	if (!UDP_mdata_obs_index.needack[found])
+		net_udp_noloss_obs_remove(found);
 }
-
 /*
  * We have received a MDATA packet. Send ACK response to sender!
  * Also check in our UDP_mdata_got list, if we got this packet already. If yes, return 0 so do not process it!
@@ -5834,36 +7177,43 @@ void net_udp_noloss_got_ack(ubyte *data, int data_len, struct _sockaddr sender_a
 	sender_pnum = data[len];													len++;
 	dest_pnum = data[len];														len++;
 	pkt_num = GET_INTEL_INT(&data[len]);										len += 4;
+
 	if (Netgame.max_numobservers > 0 && sender_pnum == OBSERVER_PLAYER_ID) {
-		for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE; i++)
-		{
-			if ((pkt_num == UDP_mdata_obs_queue[i].pkt_num) && (dest_pnum == UDP_mdata_obs_queue[i].Player_num))
-			{
-				int obsnum = -1;
-				for(int j = 0; j < Netgame.max_numobservers; j++) {
-					if(! memcmp(&Netgame.observers[j].protocol.udp.addr, &sender_addr, sizeof(struct _sockaddr))) {
-						obsnum = j;
-						break;
-					}
-				}
-				if (obsnum == -1) {
-					return;
-				}
-				
-				con_printf(CON_VERBOSE, "P#%i: Got MData ACK for pkt_num %i from observer %i for pnum %i\n",Player_num, pkt_num, obsnum, dest_pnum);
-				UDP_mdata_obs_queue[i].observer_ack[obsnum] = 1;
+		int obsnum = -1;
+
+		i = net_udp_noloss_index_find(&UDP_mdata_obs_index, dest_pnum, pkt_num);
+		if (i == UDP_NOLOSS_NONE)
+			return;
+		for (int j = 0; j < Netgame.max_numobservers; j++) {
+			if (!memcmp(&Netgame.observers[j].protocol.udp.addr, &sender_addr, sizeof(struct _sockaddr))) {
+				obsnum = j;
 				break;
 			}
 		}
-	} else {
-		for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE; i++)
+		if (obsnum == -1) {
+			return;
+		}
+
+		con_printf(CON_VERBOSE, "P#%i: Got MData ACK for pkt_num %i from observer %i for pnum %i\n", Player_num, pkt_num, obsnum, dest_pnum);
+		UDP_mdata_obs_queue[i].observer_ack[obsnum] = 1;
+		if (!net_udp_noloss_index_ack(&UDP_mdata_obs_index, i, obsnum))
 		{
-			if ((pkt_num == UDP_mdata_queue[i].pkt_num) && (dest_pnum == UDP_mdata_queue[i].Player_num))
-			{
-				con_printf(CON_VERBOSE, "P#%i: Got MData ACK for pkt_num %i from pnum %i for pnum %i\n",Player_num, pkt_num, sender_pnum, dest_pnum);
-				UDP_mdata_queue[i].player_ack[sender_pnum] = 1;
-				break;
-			}
+			con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: 0\n", Player_num, pkt_num);
+			net_udp_noloss_obs_remove(i);
+		}
+	}
+	else {
+		if (sender_pnum >= MAX_PLAYERS)
+			return;
+		i = net_udp_noloss_index_find(&UDP_mdata_index, dest_pnum, pkt_num);
+		if (i == UDP_NOLOSS_NONE)
+			return;
+		con_printf(CON_VERBOSE, "P#%i: Got MData ACK for pkt_num %i from pnum %i for pnum %i\n", Player_num, pkt_num, sender_pnum, dest_pnum);
+		UDP_mdata_queue[i].player_ack[sender_pnum] = 1;
+		if (!net_udp_noloss_index_ack(&UDP_mdata_index, i, sender_pnum))
+		{
+			con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: 0\n", Player_num, pkt_num);
+			net_udp_noloss_remove(i);
 		}
 	}
 }
@@ -5873,8 +7223,10 @@ void net_udp_noloss_init_mdata_queue(void)
 {
 	con_printf(CON_VERBOSE, "P#%i: Clearing MData store/GOT list\n",Player_num);
 	memset(&UDP_mdata_queue,0,sizeof(UDP_mdata_store)*UDP_MDATA_STOR_QUEUE_SIZE);
-	memset(&UDP_mdata_obs_queue,0,sizeof(UDP_mdata_obs_store)*UDP_MDATA_STOR_QUEUE_SIZE);
+	memset(&UDP_mdata_obs_queue, 0, sizeof(UDP_mdata_obs_store) * UDP_MDATA_STOR_QUEUE_SIZE);
 	memset(&UDP_mdata_got,0,sizeof(UDP_mdata_recv)*MAX_PLAYERS);
+	net_udp_noloss_index_init(&UDP_mdata_index);
+	net_udp_noloss_index_init(&UDP_mdata_obs_index);
 }
 
 /* Reset the trace list for given player when (dis)connect happens */
@@ -5885,13 +7237,23 @@ void net_udp_noloss_clear_mdata_got(ubyte player_num)
 	UDP_mdata_got[player_num].cur_slot = 0;
 }
 
+static int UDP_noloss_resent = 0; // resends since the last net_udp_noloss_stat()
+
+// Goes with the traffic line: packets still waiting for ACKs and how often we had to send one again
+void net_udp_noloss_stat(void)
+{
+	if (Netgame.PacketLossPrevention)
+		con_printf(CON_VERBOSE, "P#%i PLP - QUEUED: %i OBS QUEUED: %i RESENT: %i/s\n", Player_num, UDP_mdata_index.stored, UDP_mdata_obs_index.stored, UDP_noloss_resent);
+	UDP_noloss_resent = 0;
+}
+
 /*
  * The main queue-process function.
- * Check if we can remove a packet from queue, and check if there are packets in queue which we need to re-send
+ * Resend the stored packets whose resend time has come, and drop those which timed out.
  */
 void net_udp_noloss_process_queue(fix64 time)
 {
-	int queuec = 0, plc = 0, total_len = 0;
+	int node, queuec = 0, plc = 0, total_len = 0;
 
 	if (!(Game_mode&GM_NETWORK) || UDP_Socket[0] == -1)
 		return;
@@ -5899,158 +7261,286 @@ void net_udp_noloss_process_queue(fix64 time)
 	if (!Netgame.PacketLossPrevention)
 		return;
 
-	for (queuec = 0; queuec < UDP_MDATA_STOR_QUEUE_SIZE; queuec++)
+	// Send up to half our max packet size
+	while (total_len < (UPID_MAX_SIZE/2) && Netgame.PacketLossPrevention && (node = net_udp_noloss_next_due(&UDP_mdata_index, time)) != UDP_NOLOSS_NONE)
 	{
-		int needack = 0;
-		
-		if (!UDP_mdata_queue[queuec].used)
-			continue;
+		ubyte buf[sizeof(UDP_mdata_info)];
+		int len = 0;
+
+		queuec = node / UDP_NOLOSS_NODES;
+		plc = node % UDP_NOLOSS_NODES;
 
-		// Check if at least one connected player has not ACK'd the packet
-		for (plc = 0; plc < MAX_PLAYERS; plc++)
+		if (plc == UDP_NOLOSS_EXPIRE) // packet timed out but still not all have ack'd. SCREW THEM NOW!
 		{
-			// If player is not playing anymore, we can remove him from list. Also remove *me* (even if that should have been done already). Also make sure Clients do not send to anyone else than Host
-			if ((Players[plc].connected != CONNECT_PLAYING || plc == Player_num) || (!multi_i_am_master() && plc > 0))
-				UDP_mdata_queue[queuec].player_ack[plc] = 1;
+			con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: %i\n",Player_num, UDP_mdata_queue[queuec].pkt_num, UDP_mdata_index.needack[queuec]);
+			net_udp_noloss_give_up(queuec, "You left the game. You failed\nsending important packets (no ack).\nSorry.");
+			net_udp_noloss_remove(queuec);
+			continue;
+		}
 
-			if (!UDP_mdata_queue[queuec].player_ack[plc])
+		// If player is not playing anymore, we can remove him from list.
+		if (net_udp_noloss_player_skip(plc))
+		{
+			UDP_mdata_queue[queuec].player_ack[plc] = 1;
+			if (!net_udp_noloss_index_ack(&UDP_mdata_index, queuec, plc))
 			{
-				// Resend if enough time has passed.
-				if (UDP_mdata_queue[queuec].pkt_timestamp[plc] + (F1_0/3) <= time)
-				{
-					ubyte buf[sizeof(UDP_mdata_info)];
-					int len = 0;
-					
-					con_printf(CON_VERBOSE, "P#%i: Resending pkt_num %i from pnum %i to pnum %i\n",Player_num, UDP_mdata_queue[queuec].pkt_num, UDP_mdata_queue[queuec].Player_num, plc);
-					
-					UDP_mdata_queue[queuec].pkt_timestamp[plc] = time;
-					memset(&buf, 0, sizeof(UDP_mdata_info));
-					
-					// Prepare the packet and send it
-					buf[len] = UPID_MDATA_PNEEDACK;													len++;
-					PUT_INTEL_INT(buf + len, netgame_token); 	len += 4; 
-					buf[len] = UDP_mdata_queue[queuec].Player_num;								len++;
-					PUT_INTEL_INT(buf + len, UDP_mdata_queue[queuec].pkt_num);					len += 4;
-					memcpy(&buf[len], UDP_mdata_queue[queuec].data, sizeof(char)*UDP_mdata_queue[queuec].data_size);
-																								len += UDP_mdata_queue[queuec].data_size;
-					dxx_sendto (UDP_Socket[0], buf, len, 0, (struct sockaddr *)&Netgame.players[plc].protocol.udp.addr, sizeof(struct _sockaddr));
-					total_len += len;
-				}
-				needack++;
+				con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: 0\n",Player_num, UDP_mdata_queue[queuec].pkt_num);
+				net_udp_noloss_remove(queuec);
 			}
+			continue;
+		}
+
+		UDP_noloss_resent++;
+		con_printf(CON_VERBOSE, "P#%i: Resending pkt_num %i from pnum %i to pnum %i\n",Player_num, UDP_mdata_queue[queuec].pkt_num, UDP_mdata_queue[queuec].Player_num, plc);
+
+		net_udp_noloss_schedule(&UDP_mdata_index, node, time + UDP_NOLOSS_RESEND);
+		memset(&buf, 0, sizeof(UDP_mdata_info));
+
+		// Prepare the packet and send it
+		buf[len] = UPID_MDATA_PNEEDACK;													len++;
+		PUT_INTEL_INT(buf + len, netgame_token); 	len += 4; 
+		buf[len] = UDP_mdata_queue[queuec].Player_num;								len++;
+		PUT_INTEL_INT(buf + len, UDP_mdata_queue[queuec].pkt_num);					len += 4;
+		memcpy(&buf[len], UDP_mdata_queue[queuec].data, sizeof(char)*UDP_mdata_queue[queuec].data_size);
+																					len += UDP_mdata_queue[queuec].data_size;
+		dxx_sendto (UDP_Socket[0], buf, len, 0, (struct sockaddr *)&Netgame.players[plc].protocol.udp.addr, sizeof(struct _sockaddr));
+		total_len += len;
+	}
+
+	while (total_len < (UPID_MAX_SIZE / 2) && Netgame.PacketLossPrevention && (node = net_udp_noloss_next_due(&UDP_mdata_obs_index, time)) != UDP_NOLOSS_NONE)
+	{
+		ubyte buf[sizeof(UDP_mdata_info)];
+		int len = 0;
+
+		queuec = node / UDP_NOLOSS_NODES;
+		plc = node % UDP_NOLOSS_NODES;
+
+		if (plc == UDP_NOLOSS_EXPIRE) // packet timed out but still not all have ack'd. SCREW THEM NOW!
+		{
+			con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: %i\n", Player_num, UDP_mdata_obs_queue[queuec].pkt_num, UDP_mdata_obs_index.needack[queuec]);
+			net_udp_noloss_obs_give_up(queuec, "You left the game. You failed\nsending important packets (no ack).\nSorry.");
+			net_udp_noloss_obs_remove(queuec);
+			continue;
 		}
 
-		// Check if we can remove that packet due to to it had no resend's or Timeout
-		if (needack==0 || (UDP_mdata_queue[queuec].pkt_initial_timestamp + UDP_TIMEOUT <= time))
+		// If observer is not connected anymore, we can remove him from list.
+		if (net_udp_noloss_observer_skip(plc))
 		{
-			if (needack) // packet timed out but still not all have ack'd. SCREW THEM NOW!
+			UDP_mdata_obs_queue[queuec].observer_ack[plc] = 1;
+			if (!net_udp_noloss_index_ack(&UDP_mdata_obs_index, queuec, plc))
 			{
-				if (multi_i_am_master())
-				{
-					for ( plc=1; plc<N_players; plc++ )
-						if (UDP_mdata_queue[queuec].player_ack[plc] == 0)
-							net_udp_dump_player(Netgame.players[plc].protocol.udp.addr, player_tokens[plc], DUMP_PKTTIMEOUT);
-				}
-				else
-				{
-					Netgame.PacketLossPrevention = 0; // Disable PLP - otherwise we get stuck in an infinite loop here. NOTE: We could as well clean the whole queue to continue protect our disconnect signal bit it's not that important - we just wanna leave.
-					if (Network_status==NETSTAT_PLAYING)
-						multi_leave_game();
-					if (Game_wind)
-						window_set_visible(Game_wind, 0);
-					nm_messagebox(NULL, 1, TXT_OK, "You left the game. You failed\nsending important packets (no ack).\nSorry.");
-					if (Game_wind)
-						window_set_visible(Game_wind, 1);
-					multi_quit_game = 1;
-					game_leave_menus();
-					multi_reset_stuff();
-				}
+				con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: 0\n", Player_num, UDP_mdata_obs_queue[queuec].pkt_num);
+				net_udp_noloss_obs_remove(queuec);
 			}
-			con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: %i\n",Player_num, UDP_mdata_queue[queuec].pkt_num, needack);
-			memset(&UDP_mdata_queue[queuec],0,sizeof(UDP_mdata_store));
+			continue;
 		}
 
-		// Send up to half our max packet size
-		if (total_len >= (UPID_MAX_SIZE/2))
-			break;
+		UDP_noloss_resent++;
+		con_printf(CON_VERBOSE, "P#%i: Resending pkt_num %i from pnum %i to observer %i\n", Player_num, UDP_mdata_obs_queue[queuec].pkt_num, UDP_mdata_obs_queue[queuec].Player_num, plc);
+
+		net_udp_noloss_schedule(&UDP_mdata_obs_index, node, time + UDP_NOLOSS_RESEND);
+		memset(&buf, 0, sizeof(UDP_mdata_info));
+
+		// Prepare the packet and send it
+		buf[len] = UPID_MDATA_PNEEDACK;													len++;
+		PUT_INTEL_INT(buf + len, netgame_token); 	len += 4;
+		buf[len] = UDP_mdata_obs_queue[queuec].Player_num;								len++;
+		PUT_INTEL_INT(buf + len, UDP_mdata_obs_queue[queuec].pkt_num);					len += 4;
+		memcpy(&buf[len], UDP_mdata_obs_queue[queuec].data, sizeof(char) * UDP_mdata_obs_queue[queuec].data_size);
+		len += UDP_mdata_obs_queue[queuec].data_size;
+		dxx_sendto(UDP_Socket[0], buf, len, 0, (struct sockaddr*) & Netgame.observers[plc].protocol.udp.addr, sizeof(struct _sockaddr));
+		total_len += len;
 	}
+}
 
-	for (queuec = 0; queuec < UDP_MDATA_STOR_QUEUE_SIZE; queuec++)
-	{
-		int needack = 0;
-		
-		if (!UDP_mdata_obs_queue[queuec].used)
-			continue;
+#ifdef BENCHMARKS
+/*
+ * -plpbench: push sustained MDATA traffic with simulated loss through the stored packet index, and through
+ * a plain scan over all stored packets and players like the queue used to do, and print the CPU time per
+ * frame of both. The host sends a few packets each frame to 7 clients. A quarter of all packets and ACKs
+ * get lost. Nothing goes over the network.
+ */
+#define UDP_NOLOSS_BENCH_PKTS 4		// new packets per frame
+#define UDP_NOLOSS_BENCH_LATENCY 3	// frames until an ACK arrives
+#define UDP_NOLOSS_BENCH_EVENTS 65536
 
-		// Check if at least one connected observer has not ACK'd the packet
-		for (plc = 0; plc < Netgame.max_numobservers; plc++)
+typedef struct udp_noloss_bench_scan
+{
+	int		used[UDP_MDATA_STOR_QUEUE_SIZE];
+	uint32_t	pkt_num[UDP_MDATA_STOR_QUEUE_SIZE];
+	fix64		initial[UDP_MDATA_STOR_QUEUE_SIZE];
+	fix64		stamp[UDP_MDATA_STOR_QUEUE_SIZE][MAX_PLAYERS];
+	ubyte		ack[UDP_MDATA_STOR_QUEUE_SIZE][MAX_PLAYERS];
+} udp_noloss_bench_scan;
+
+typedef struct udp_noloss_bench_events
+{
+	uint32_t	pkt_num[UDP_NOLOSS_BENCH_EVENTS];
+	ubyte		pnum[UDP_NOLOSS_BENCH_EVENTS];
+	int		frame[UDP_NOLOSS_BENCH_EVENTS];
+	int		head, tail;
+} udp_noloss_bench_events;
+
+// a packet went to pnum. Unless it or the ACK gets lost, the ACK comes back a few frames later.
+static void net_udp_noloss_bench_send(udp_noloss_bench_events *ev, uint32_t pkt_num, int pnum, int frame)
+{
+	if (d_rand() % 4 == 0)
+		return;
+	if (((ev->tail + 1) & (UDP_NOLOSS_BENCH_EVENTS-1)) == ev->head)
+		return;
+	ev->pkt_num[ev->tail] = pkt_num;
+	ev->pnum[ev->tail] = pnum;
+	ev->frame[ev->tail] = frame + UDP_NOLOSS_BENCH_LATENCY;
+	ev->tail = (ev->tail + 1) & (UDP_NOLOSS_BENCH_EVENTS-1);
+}
+
+static int net_udp_noloss_bench_recv(udp_noloss_bench_events *ev, int frame, uint32_t *pkt_num, int *pnum)
+{
+	if (ev->head == ev->tail || ev->frame[ev->head] > frame)
+		return 0;
+	*pkt_num = ev->pkt_num[ev->head];
+	*pnum = ev->pnum[ev->head];
+	ev->head = (ev->head + 1) & (UDP_NOLOSS_BENCH_EVENTS-1);
+	return 1;
+}
+
+void net_udp_noloss_bench(int frames)
+{
+	udp_noloss_index *q;
+	udp_noloss_bench_scan *s;
+	udp_noloss_bench_events *ev;
+	u_int64_t start, freq = SDL_GetPerformanceFrequency();
+	double t_index, t_scan;
+	int frame, i, plc, node, pnum, resends[2] = { 0, 0 }, timeouts[2] = { 0, 0 };
+	uint32_t pkt_num, next_pkt;
+	fix64 time;
+
+	MALLOC(q, udp_noloss_index, 1);
+	MALLOC(s, udp_noloss_bench_scan, 1);
+	MALLOC(ev, udp_noloss_bench_events, 1);
+	if (!q || !s || !ev)
+		Error("Not enough memory for -plpbench");
+
+	// indexed queue
+	net_udp_noloss_index_init(q);
+	memset(ev, 0, sizeof(*ev));
+	d_srand(1);
+	next_pkt = 0;
+	start = SDL_GetPerformanceCounter();
+	for (frame = 0, time = 0; frame < frames; frame++, time += F1_0/30)
+	{
+		while (net_udp_noloss_bench_recv(ev, frame, &pkt_num, &pnum))
+			if ((i = net_udp_noloss_index_find(q, 0, pkt_num)) != UDP_NOLOSS_NONE && !net_udp_noloss_index_ack(q, i, pnum))
+				net_udp_noloss_index_remove(q, i);
+		for (i = 0; i < UDP_NOLOSS_BENCH_PKTS; i++)
 		{
-			// If observer is not connected anymore, we can remove him from list.
-			if (Netgame.observers[plc].connected == 0)
-				UDP_mdata_obs_queue[queuec].observer_ack[plc] = 1;
+			int slot;
 
-			if (!UDP_mdata_obs_queue[queuec].observer_ack[plc])
+			if (q->free_head == UDP_NOLOSS_NONE)
+				net_udp_noloss_index_remove(q, q->age_head);
+			slot = net_udp_noloss_index_add(q, 0, next_pkt, time);
+			for (plc = 1; plc < MAX_PLAYERS; plc++)
 			{
-				// Resend if enough time has passed.
-				if (UDP_mdata_obs_queue[queuec].pkt_timestamp[plc] + (F1_0/3) <= time)
-				{
-					ubyte buf[sizeof(UDP_mdata_info)];
-					int len = 0;
-					
-					con_printf(CON_VERBOSE, "P#%i: Resending pkt_num %i from pnum %i to observer %i\n", Player_num, UDP_mdata_queue[queuec].pkt_num, UDP_mdata_queue[queuec].Player_num, plc);
-					
-					UDP_mdata_obs_queue[queuec].pkt_timestamp[plc] = time;
-					memset(&buf, 0, sizeof(UDP_mdata_info));
-					
-					// Prepare the packet and send it
-					buf[len] = UPID_MDATA_PNEEDACK;													len++;
-					PUT_INTEL_INT(buf + len, netgame_token); 	len += 4; 
-					buf[len] = UDP_mdata_obs_queue[queuec].Player_num;								len++;
-					PUT_INTEL_INT(buf + len, UDP_mdata_obs_queue[queuec].pkt_num);					len += 4;
-					memcpy(&buf[len], UDP_mdata_obs_queue[queuec].data, sizeof(char)*UDP_mdata_obs_queue[queuec].data_size);
-																								len += UDP_mdata_obs_queue[queuec].data_size;
-					dxx_sendto (UDP_Socket[0], buf, len, 0, (struct sockaddr *)&Netgame.observers[plc].protocol.udp.addr, sizeof(struct _sockaddr));
-					total_len += len;
-				}
-				needack++;
+				net_udp_noloss_index_expect(q, slot, plc, time + UDP_NOLOSS_RESEND);
+				net_udp_noloss_bench_send(ev, next_pkt, plc, frame);
 			}
+			next_pkt++;
 		}
-
-		// Check if we can remove that packet due to to it had no resend's or Timeout
-		if (needack==0 || (UDP_mdata_obs_queue[queuec].pkt_initial_timestamp + UDP_TIMEOUT <= time))
+		while ((node = net_udp_noloss_next_due(q, time)) != UDP_NOLOSS_NONE)
 		{
-			if (needack) // packet timed out but still not all have ack'd. SCREW THEM NOW!
+			i = node / UDP_NOLOSS_NODES;
+			if (node % UDP_NOLOSS_NODES == UDP_NOLOSS_EXPIRE)
 			{
-				if (multi_i_am_master())
+				net_udp_noloss_index_remove(q, i);
+				timeouts[0]++;
+				continue;
+			}
+			net_udp_noloss_schedule(q, node, time + UDP_NOLOSS_RESEND);
+			net_udp_noloss_bench_send(ev, q->key[i] & 0xffffff, node % UDP_NOLOSS_NODES, frame);
+			resends[0]++;
+		}
+	}
+	t_index = (double)(SDL_GetPerformanceCounter() - start) / freq;
+
+	// scan over all stored packets, as before
+	memset(s, 0, sizeof(*s));
+	memset(ev, 0, sizeof(*ev));
+	d_srand(1);
+	next_pkt = 0;
+	start = SDL_GetPerformanceCounter();
+	for (frame = 0, time = 0; frame < frames; frame++, time += F1_0/30)
+	{
+		while (net_udp_noloss_bench_recv(ev, frame, &pkt_num, &pnum))
+			for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE; i++)
+				if (s->used[i] && s->pkt_num[i] == pkt_num)
 				{
-					for ( plc=0; plc < Netgame.max_numobservers; plc++ )
-						if (UDP_mdata_obs_queue[queuec].observer_ack[plc] == 0)
-							net_udp_dump_player(Netgame.observers[plc].protocol.udp.addr, 0, DUMP_PKTTIMEOUT);
+					s->ack[i][pnum] = 1;
+					break;
 				}
-				else
+		for (i = 0; i < UDP_NOLOSS_BENCH_PKTS; i++)
+		{
+			int j, found = 0;
+
+			for (j = 0; j < UDP_MDATA_STOR_QUEUE_SIZE; j++)
+			{
+				if (!s->used[j])
 				{
-					Netgame.PacketLossPrevention = 0; // Disable PLP - otherwise we get stuck in an infinite loop here. NOTE: We could as well clean the whole queue to continue protect our disconnect signal bit it's not that important - we just wanna leave.
-					if (Network_status==NETSTAT_PLAYING)
-						multi_leave_game();
-					if (Game_wind)
-						window_set_visible(Game_wind, 0);
-					nm_messagebox(NULL, 1, TXT_OK, "You left the game. You failed\nsending important packets (no ack).\nSorry.");
-					if (Game_wind)
-						window_set_visible(Game_wind, 1);
-					multi_quit_game = 1;
-					game_leave_menus();
-					multi_reset_stuff();
+					found = j;
+					break;
 				}
+				if (s->initial[j] < s->initial[found])
+					found = j;
+			}
+			s->used[found] = 1;
+			s->pkt_num[found] = next_pkt;
+			s->initial[found] = time;
+			for (plc = 0; plc < MAX_PLAYERS; plc++)
+			{
+				s->stamp[found][plc] = time;
+				s->ack[found][plc] = (plc == 0);
+				if (plc)
+					net_udp_noloss_bench_send(ev, next_pkt, plc, frame);
 			}
-			con_printf(CON_VERBOSE, "P#%i: Removing stored pkt_num %i - missing ACKs: %i\n",Player_num, UDP_mdata_obs_queue[queuec].pkt_num, needack);
-			memset(&UDP_mdata_obs_queue[queuec],0,sizeof(UDP_mdata_obs_store));
+			next_pkt++;
 		}
+		for (i = 0; i < UDP_MDATA_STOR_QUEUE_SIZE; i++)
+		{
+			int needack = 0;
 
-		// Send up to half our max packet size
-		if (total_len >= (UPID_MAX_SIZE/2))
-			break;
+			if (!s->used[i])
+				continue;
+			for (plc = 0; plc < MAX_PLAYERS; plc++)
+			{
+				if (s->ack[i][plc])
+					continue;
+				if (s->stamp[i][plc] + UDP_NOLOSS_RESEND <= time)
+				{
+					s->stamp[i][plc] = time;
+					net_udp_noloss_bench_send(ev, s->pkt_num[i], plc, frame);
+					resends[1]++;
+				}
+				needack++;
+			}
+			if (needack == 0 || s->initial[i] + UDP_TIMEOUT <= time)
+			{
+				if (needack)
+					timeouts[1]++;
+				s->used[i] = 0;
+			}
+		}
 	}
+	t_scan = (double)(SDL_GetPerformanceCounter() - start) / freq;
+
+	con_printf(CON_NORMAL, "PLP bench: %i frames, %i packets to %i players, 25%% loss\n", frames, frames*UDP_NOLOSS_BENCH_PKTS, MAX_PLAYERS-1);
+	con_printf(CON_NORMAL, "PLP bench: index: %.2f us/frame, %i resends, %i timeouts\n", t_index * 1000000 / frames, resends[0], timeouts[0]);
+	con_printf(CON_NORMAL, "PLP bench: scan:  %.2f us/frame, %i resends, %i timeouts\n", t_scan * 1000000 / frames, resends[1], timeouts[1]);
+
+	d_free(ev);
+	d_free(s);
+	d_free(q);
 }
+#endif
+
 /* CODE FOR PACKET LOSS PREVENTION - END */
 
 
@@ -6321,6 +7811,255 @@ void net_udp_process_obs_data (ubyte *data, int data_len, struct _sockaddr sende
 // things in one packet, or building an mdata_nodelay packet which needs to snuggle in with the needack infrastructure
 // For now, I'm accepting the glitch that observer info is outdated for observers by broadcast_delay
 // It isn't outdated for players, which is the main thing.
+/*
+ * Observer relays.
+ * Observers started with -obs_relay offer to pass the observer stream on. The host picks up to UDP_OBS_RELAYS_MAX
+ * of them and hands each up to UDP_OBS_RELAY_FANOUT other observers. What forward_to_observers_nodelay() sends then
+ * goes to each relay once, wrapped in UPID_OBS_RELAY with a mask of the observers to pass it on to, instead of to all
+ * of these observers. Relays pass it on as soon as they get it, so the broadcast delay stays what the host's buffer
+ * makes it. Observers no relay has room for stay with the host. Assignments are redone every frame, so observers of
+ * a relay that stopped offering go elsewhere within UDP_OBS_RELAY_TIMEOUT.
+ */
+#define UDP_OBS_RELAYS_MAX 4
+#define UDP_OBS_RELAY_FANOUT 4
+#define UDP_OBS_RELAY_TIMEOUT (F1_0*3)
+#define UDP_OBS_DIRECT 0 // UDP_obs_relay_of[] holds relay + 1
+
+#if MAX_OBSERVERS > 16
+#error observer relay masks are 16 bits
+#endif
+
+static ubyte UDP_obs_relay_of[MAX_OBSERVERS];			// host: relay serving each observer, relays serve themselves
+static fix64 UDP_obs_relay_offer_time[MAX_OBSERVERS];		// host: last UPID_OBS_RELAY_OFFER of each observer
+static ushort UDP_obs_relay_told[MAX_OBSERVERS];		// host: observers each relay serves, as last sent to it
+static fix64 UDP_obs_relay_told_time[MAX_OBSERVERS];
+static struct _sockaddr UDP_obs_relay_addr[MAX_OBSERVERS];	// relay: addresses of the observers we may serve
+static ushort UDP_obs_relay_known;				// relay: valid entries of UDP_obs_relay_addr
+static struct _sockaddr UDP_obs_relay_via;			// observer: the relay the host says serves us
+static fix64 UDP_obs_relay_via_time;				// observer: when the host last said so
+
+// what relays may pass on, and what observers take from anyone but the host
+static int net_udp_obs_relay_type(ubyte type)
+{
+	switch (type)
+	{
+		case UPID_PDATA:
+		case UPID_MDATA_PNORM:
+		case UPID_MDATA_PNEEDACK:
+		case UPID_OBSDATA:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static int net_udp_obs_relay_usable(int i, fix64 now)
+{
+	return i < Netgame.max_numobservers && Netgame.observers[i].connected == 1 && UDP_obs_relay_offer_time[i] && now - UDP_obs_relay_offer_time[i] < UDP_OBS_RELAY_TIMEOUT;
+}
+
+static void net_udp_send_obs_relay_list(int r, ushort mask, fix64 now)
+{
+	ubyte buf[UPID_OBS_RELAY_LIST_MAX_SIZE];
+	int len = 0, i;
+
+	buf[len] = UPID_OBS_RELAY_LIST;							len++;
+	PUT_INTEL_INT(buf + len, netgame_token);					len += 4;
+	PUT_INTEL_SHORT(buf + len, mask);						len += 2;
+	for (i = 0; i < MAX_OBSERVERS; i++)
+		if (mask & (1 << i))
+		{
+			memcpy(buf + len, &Netgame.observers[i].protocol.udp.addr, sizeof(struct _sockaddr));	len += sizeof(struct _sockaddr);
+		}
+	dxx_sendto (UDP_Socket[0], buf, len, 0, (struct sockaddr *)&Netgame.observers[r].protocol.udp.addr, sizeof(struct _sockaddr));
+	UDP_obs_relay_told[r] = mask;
+	UDP_obs_relay_told_time[r] = now;
+
+	// and its observers where their relayed messages come from
+	len = 0;
+	buf[len] = UPID_OBS_RELAY_VIA;							len++;
+	PUT_INTEL_INT(buf + len, netgame_token);					len += 4;
+	memcpy(buf + len, &Netgame.observers[r].protocol.udp.addr, sizeof(struct _sockaddr));	len += sizeof(struct _sockaddr);
+	for (i = 0; i < MAX_OBSERVERS; i++)
+		if (mask & (1 << i))
+			dxx_sendto (UDP_Socket[0], buf, len, 0, (struct sockaddr *)&Netgame.observers[i].protocol.udp.addr, sizeof(struct _sockaddr));
+}
+
+// host: pick relays and spread the other observers over them
+static void net_udp_obs_relay_update(fix64 now)
+{
+	int i, r, best, relays = 0, load[MAX_OBSERVERS];
+	ushort mask[MAX_OBSERVERS];
+
+	memset(load, 0, sizeof(load));
+	memset(mask, 0, sizeof(mask));
+
+	// keep the relays we have while they offer, then take on new ones
+	for (i = 0; i < MAX_OBSERVERS; i++)
+	{
+		if (i >= Netgame.max_numobservers || Netgame.observers[i].connected != 1)
+			UDP_obs_relay_offer_time[i] = 0; // slot is free, don't let the next one inherit the offer
+		if (UDP_obs_relay_of[i] == i + 1)
+		{
+			if (net_udp_obs_relay_usable(i, now))
+				relays++;
+			else
+				UDP_obs_relay_of[i] = UDP_OBS_DIRECT;
+		}
+	}
+	for (i = 0; i < MAX_OBSERVERS && relays < UDP_OBS_RELAYS_MAX; i++)
+		if (UDP_obs_relay_of[i] != i + 1 && net_udp_obs_relay_usable(i, now))
+		{
+			con_printf(CON_VERBOSE, "Observer %s relays the observer stream\n", Netgame.observers[i].callsign);
+			UDP_obs_relay_of[i] = i + 1;
+			relays++;
+		}
+
+	// observers stay with their relay while it has room, the others go to the least busy one
+	for (i = 0; i < MAX_OBSERVERS; i++)
+	{
+		r = UDP_obs_relay_of[i] - 1;
+		if (r == i)
+			continue;
+		if (r >= 0 && Netgame.observers[i].connected == 1 && i < Netgame.max_numobservers && UDP_obs_relay_of[r] == r + 1 && load[r] < UDP_OBS_RELAY_FANOUT)
+		{
+			load[r]++;
+			mask[r] |= 1 << i;
+		}
+		else
+			UDP_obs_relay_of[i] = UDP_OBS_DIRECT;
+	}
+	for (i = 0; i < Netgame.max_numobservers; i++)
+	{
+		if (UDP_obs_relay_of[i] != UDP_OBS_DIRECT || Netgame.observers[i].connected != 1)
+			continue;
+		best = -1;
+		for (r = 0; r < MAX_OBSERVERS; r++)
+			if (UDP_obs_relay_of[r] == r + 1 && load[r] < UDP_OBS_RELAY_FANOUT && (best < 0 || load[r] < load[best]))
+				best = r;
+		if (best < 0)
+			break;
+		UDP_obs_relay_of[i] = best + 1;
+		load[best]++;
+		mask[best] |= 1 << i;
+	}
+
+	// relays and their observers need the addresses before the first packet for them arrives, and again now and then in case that got lost
+	for (r = 0; r < MAX_OBSERVERS; r++)
+	{
+		if (UDP_obs_relay_of[r] != r + 1)
+			UDP_obs_relay_told[r] = 0;
+		else if (mask[r] != UDP_obs_relay_told[r] || now > UDP_obs_relay_told_time[r] + F1_0 || now < UDP_obs_relay_told_time[r])
+			net_udp_send_obs_relay_list(r, mask[r], now);
+	}
+}
+
+void net_udp_obs_relay_frame(fix64 now)
+{
+	static fix64 last_offer = 0;
+
+	if (multi_i_am_master())
+	{
+		if (Netgame.max_numobservers)
+			net_udp_obs_relay_update(now);
+	}
+	else if (is_observer() && GameArg.MplObsRelay && (now > last_offer + F1_0 || now < last_offer))
+	{
+		ubyte buf[UPID_OBS_RELAY_OFFER_SIZE];
+
+		buf[0] = UPID_OBS_RELAY_OFFER;
+		PUT_INTEL_INT(buf + 1, netgame_token);
+		net_udp_send_to_player_direct(buf, sizeof(buf), 0);
+		last_offer = now;
+	}
+}
+
+// host: send a message for the observers of relay r to r
+static void net_udp_send_obs_relay(int r, ubyte *data, int data_len)
+{
+	ubyte buf[UPID_MAX_SIZE];
+	int len = 0;
+
+	buf[len] = UPID_OBS_RELAY;							len++;
+	PUT_INTEL_INT(buf + len, netgame_token);					len += 4;
+	PUT_INTEL_SHORT(buf + len, UDP_obs_relay_told[r]);				len += 2;
+	memcpy(buf + len, data, data_len);						len += data_len;
+	dxx_sendto (UDP_Socket[0], buf, len, 0, (struct sockaddr *)&Netgame.observers[r].protocol.udp.addr, sizeof(struct _sockaddr));
+}
+
+void net_udp_process_obs_relay_offer(ubyte *data, struct _sockaddr sender_addr, int data_len)
+{
+	for (int i = 0; i < Netgame.max_numobservers; i++)
+		if (Netgame.observers[i].connected == 1 && is_same_addr(&Netgame.observers[i].protocol.udp.addr, &sender_addr))
+		{
+			UDP_obs_relay_offer_time[i] = timer_query();
+			return;
+		}
+	drop_rx_packet(data, "not received from any observer ip");
+}
+
+void net_udp_process_obs_relay_list(ubyte *data, struct _sockaddr sender_addr, int data_len)
+{
+	int len = 5, i;
+	ushort mask;
+
+	if (!is_observer() || !GameArg.MplObsRelay)
+	{
+		drop_rx_packet(data, "not relaying");
+		return;
+	}
+	mask = GET_INTEL_SHORT(data + len);						len += 2;
+	UDP_obs_relay_known = 0;
+	for (i = 0; i < MAX_OBSERVERS; i++)
+		if (mask & (1 << i))
+		{
+			if (len + sizeof(struct _sockaddr) > data_len)
+			{
+				drop_rx_packet(data, "truncated relay list");
+				return;
+			}
+			memcpy(&UDP_obs_relay_addr[i], data + len, sizeof(struct _sockaddr));	len += sizeof(struct _sockaddr);
+			UDP_obs_relay_known |= 1 << i;
+		}
+}
+
+void net_udp_process_obs_relay_via(ubyte *data, struct _sockaddr sender_addr, int data_len)
+{
+	if (!is_observer())
+	{
+		drop_rx_packet(data, "not an observer");
+		return;
+	}
+	memcpy(&UDP_obs_relay_via, data + 5, sizeof(struct _sockaddr));
+	UDP_obs_relay_via_time = timer_query();
+}
+
+// pass a relayed message on if the host asked us to, then take it as if it came from the host
+void net_udp_process_obs_relay(ubyte *data, struct _sockaddr sender_addr, int data_len)
+{
+	ushort mask = GET_INTEL_SHORT(data + 5);
+	fix64 now = timer_query();
+
+	if (!is_observer() || multi_i_am_master() || !net_udp_obs_relay_type(data[UPID_OBS_RELAY_HEADER_SIZE]))
+	{
+		drop_rx_packet(data, "bad relayed message");
+		return;
+	}
+	if (!is_master_ip(sender_addr) && !(UDP_obs_relay_via_time && now >= UDP_obs_relay_via_time && now < UDP_obs_relay_via_time + UDP_OBS_RELAY_TIMEOUT && is_same_addr(&UDP_obs_relay_via, &sender_addr)))
+	{
+		drop_rx_packet(data, "relayed by neither the host nor our relay");
+		return;
+	}
+	if (mask && GameArg.MplObsRelay && is_master_ip(sender_addr))
+	{
+		PUT_INTEL_SHORT(data + 5, 0); // our observers pass nothing on
+		for (int i = 0; i < MAX_OBSERVERS; i++)
+			if (mask & UDP_obs_relay_known & (1 << i))
+				dxx_sendto (UDP_Socket[0], data, data_len, 0, (struct sockaddr *)&UDP_obs_relay_addr[i], sizeof(struct _sockaddr));
+	}
+	net_udp_process_packet(data + UPID_OBS_RELAY_HEADER_SIZE, Netgame.players[0].protocol.udp.addr, data_len - UPID_OBS_RELAY_HEADER_SIZE, 0);
+}
+
 void forward_to_observers(ubyte *data, int data_len, int needack) {
 	if(Netgame.max_numobservers == 0) { return; }
 
@@ -6402,16 +8141,344 @@ void check_obs_buffer(fix64 now) {
 
 void forward_to_observers_nodelay(ubyte *data, int data_len, int needack) {
 	if (multi_i_am_master()) {
-		ubyte pack[MAX_OBSERVERS];
+		int relay = net_udp_obs_relay_type(data[0]) && data_len + UPID_OBS_RELAY_HEADER_SIZE <= UPID_MAX_SIZE;
 		for (int i = 0; i < Netgame.max_numobservers; i++) {
 			if (Netgame.observers[i].connected) {
-				dxx_sendto (UDP_Socket[0], data, data_len, 0, (struct sockaddr *)&Netgame.observers[i].protocol.udp.addr, sizeof(struct _sockaddr));
-				pack[i] = 1;
+				int r = UDP_obs_relay_of[i] - 1;
+
+				if (relay && UDP_obs_relay_told[i])
+					net_udp_send_obs_relay(i, data, data_len);
+				else if (!relay || r < 0 || r == i || !(UDP_obs_relay_told[r] & (1 << i))) // not one of the observers a relay passes this on to
+					dxx_sendto (UDP_Socket[0], data, data_len, 0, (struct sockaddr *)&Netgame.observers[i].protocol.udp.addr, sizeof(struct _sockaddr));
 			}
 		}
 	}
 }
 
+/*
+ * Delta player packets (Netgame.DeltaPackets)
+ *
+ * The player state gets quantized: orientation as smallest three quaternion in 32 bits, position
+ * relative to vertex 0 of the segment like shortpos, velocity and rotational velocity with reduced
+ * precision. Every pdata packet carries the serial of the last pdata we got from its receiver. Knowing
+ * which state the receiver has, the sender only encodes the fields which changed since, as variable
+ * length deltas. Without a usable ACK the full state goes out as keyframe. So do packets the host
+ * relays (observers, clients without Retro Protocol) since their receivers never ACK'd the sender.
+ * Both sides only keep states of the last second or so around, so a delta never refers to an older
+ * state with the same serial.
+ */
+#define UDP_PDATA_NONE 0xff
+#define UDP_PDATA_VEL_SHIFT 12
+#define UDP_PDATA_ROTVEL_SHIFT 8
+#define UDP_PDATA_QUAT_RANGE 511 // 10 bits per component
+#define UDP_PDATA_QUAT_MAX 23170 // the three smallest components of a unit quaternion are within 32768/sqrt(2)
+#define UDP_PDATA_MAX_AGE F1_0
+#define UDP_PDATA_SEGNUM 1
+#define UDP_PDATA_POS 2
+#define UDP_PDATA_VEL 4
+#define UDP_PDATA_ROTVEL 8
+#define UDP_PDATA_ORIENT 16
+#define UDP_PDATA_ALL (UDP_PDATA_SEGNUM|UDP_PDATA_POS|UDP_PDATA_VEL|UDP_PDATA_ROTVEL|UDP_PDATA_ORIENT)
+
+static UDP_pdata_state UDP_pdata_sent[MAX_LOSS_BUFFER];		// our state as sent with each serial
+static fix64 UDP_pdata_sent_time[MAX_LOSS_BUFFER];
+static ubyte UDP_pdata_ack[MAX_PLAYERS];			// last serial each player got from us
+static UDP_pdata_state UDP_pdata_got[MAX_PLAYERS][MAX_LOSS_BUFFER];	// states we got from each player
+static fix64 UDP_pdata_got_time[MAX_PLAYERS][MAX_LOSS_BUFFER];
+static ubyte UDP_pdata_got_last[MAX_PLAYERS];			// serial we ACK to each player
+
+void net_udp_reset_delta_pdata()
+{
+	memset(UDP_pdata_sent_time, 0, sizeof(UDP_pdata_sent_time));
+	memset(UDP_pdata_got_time, 0, sizeof(UDP_pdata_got_time));
+	memset(UDP_pdata_ack, UDP_PDATA_NONE, sizeof(UDP_pdata_ack));
+	memset(UDP_pdata_got_last, UDP_PDATA_NONE, sizeof(UDP_pdata_got_last));
+}
+
+// Someone (re)joined as pnum. He has none of our states and we ACK none of his.
+static void net_udp_reset_delta_pdata_player(int pnum)
+{
+	UDP_pdata_ack[pnum] = UDP_PDATA_NONE;
+	UDP_pdata_got_last[pnum] = UDP_PDATA_NONE;
+}
+
+static uint32_t net_udp_pack_quaternion(const vms_quaternion *q)
+{
+	int c[4], i, n = 0, big = 0;
+	uint32_t packed;
+
+	c[0] = q->w; c[1] = q->x; c[2] = q->y; c[3] = q->z;
+	for (i = 1; i < 4; i++)
+		if (abs(c[i]) > abs(c[big]))
+			big = i;
+	packed = big;
+	for (i = 0; i < 4; i++)
+	{
+		int v;
+
+		if (i == big)
+			continue;
+		v = (c[big] < 0) ? -c[i] : c[i]; // q and -q are the same rotation, so the largest one is always positive
+		v = (v * UDP_PDATA_QUAT_RANGE + (v < 0 ? -UDP_PDATA_QUAT_MAX/2 : UDP_PDATA_QUAT_MAX/2)) / UDP_PDATA_QUAT_MAX;
+		if (v > UDP_PDATA_QUAT_RANGE)
+			v = UDP_PDATA_QUAT_RANGE;
+		if (v < -UDP_PDATA_QUAT_RANGE)
+			v = -UDP_PDATA_QUAT_RANGE;
+		packed |= (uint32_t)(v + UDP_PDATA_QUAT_RANGE) << (2 + 10*n++);
+	}
+	return packed;
+}
+
+static void net_udp_unpack_quaternion(vms_quaternion *q, uint32_t packed)
+{
+	int c[4], i, n = 0, big = packed & 3, sum = 0;
+
+	for (i = 0; i < 4; i++)
+	{
+		if (i == big)
+			continue;
+		c[i] = ((int)((packed >> (2 + 10*n++)) & 1023) - UDP_PDATA_QUAT_RANGE) * UDP_PDATA_QUAT_MAX / UDP_PDATA_QUAT_RANGE;
+		sum += c[i] * c[i];
+	}
+	c[big] = (sum < 32767*32767) ? long_sqrt(32767*32767 - sum) : 0;
+	q->w = c[0]; q->x = c[1]; q->y = c[2]; q->z = c[3];
+}
+
+static void net_udp_create_pdata_state(UDP_pdata_state *s, object *objp)
+{
+	vms_vector *v0 = &Vertices[Segments[objp->segnum].verts[0]];
+	vms_quaternion q;
+
+	s->segnum = objp->segnum;
+	s->pos[0] = (objp->pos.x - v0->x) >> RELPOS_PRECISION;
+	s->pos[1] = (objp->pos.y - v0->y) >> RELPOS_PRECISION;
+	s->pos[2] = (objp->pos.z - v0->z) >> RELPOS_PRECISION;
+	s->vel[0] = objp->mtype.phys_info.velocity.x >> UDP_PDATA_VEL_SHIFT;
+	s->vel[1] = objp->mtype.phys_info.velocity.y >> UDP_PDATA_VEL_SHIFT;
+	s->vel[2] = objp->mtype.phys_info.velocity.z >> UDP_PDATA_VEL_SHIFT;
+	s->rotvel[0] = objp->mtype.phys_info.rotvel.x >> UDP_PDATA_ROTVEL_SHIFT;
+	s->rotvel[1] = objp->mtype.phys_info.rotvel.y >> UDP_PDATA_ROTVEL_SHIFT;
+	s->rotvel[2] = objp->mtype.phys_info.rotvel.z >> UDP_PDATA_ROTVEL_SHIFT;
+	vms_quaternion_from_matrix(&q, &objp->orient);
+	s->orient = net_udp_pack_quaternion(&q);
+}
+
+static void net_udp_extract_pdata_state(object *objp, UDP_pdata_state *s)
+{
+	vms_vector *v0 = &Vertices[Segments[s->segnum].verts[0]];
+	vms_quaternion q;
+
+	net_udp_unpack_quaternion(&q, s->orient);
+	vms_matrix_from_quaternion(&objp->orient, &q);
+	objp->pos.x = (s->pos[0] << RELPOS_PRECISION) + v0->x;
+	objp->pos.y = (s->pos[1] << RELPOS_PRECISION) + v0->y;
+	objp->pos.z = (s->pos[2] << RELPOS_PRECISION) + v0->z;
+	objp->mtype.phys_info.velocity.x = s->vel[0] << UDP_PDATA_VEL_SHIFT;
+	objp->mtype.phys_info.velocity.y = s->vel[1] << UDP_PDATA_VEL_SHIFT;
+	objp->mtype.phys_info.velocity.z = s->vel[2] << UDP_PDATA_VEL_SHIFT;
+	objp->mtype.phys_info.rotvel.x = s->rotvel[0] << UDP_PDATA_ROTVEL_SHIFT;
+	objp->mtype.phys_info.rotvel.y = s->rotvel[1] << UDP_PDATA_ROTVEL_SHIFT;
+	objp->mtype.phys_info.rotvel.z = s->rotvel[2] << UDP_PDATA_ROTVEL_SHIFT;
+
+	obj_relink(objp-Objects, s->segnum);
+}
+
+// signed values as zigzag varint: 7 bits per byte, small magnitudes take one byte
+static int net_udp_put_varint(ubyte *buf, int len, int v)
+{
+	uint32_t u = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+
+	while (u >= 0x80)
+	{
+		buf[len] = (u & 0x7f) | 0x80;						len++;
+		u >>= 7;
+	}
+	buf[len] = u;									len++;
+	return len;
+}
+
+static int net_udp_get_varint(ubyte *data, int *len, int data_len, int *v)
+{
+	uint32_t u = 0;
+	int shift;
+
+	for (shift = 0; shift < 35; shift += 7)
+	{
+		if (*len >= data_len)
+			return 0;
+		u |= (uint32_t)(data[*len] & 0x7f) << shift;
+		if (!(data[(*len)++] & 0x80))
+		{
+			*v = (int)(u >> 1) ^ -(int)(u & 1);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int net_udp_put_delta_vec(ubyte *buf, int len, const int *v, const int *base)
+{
+	int i;
+
+	for (i = 0; i < 3; i++)
+		len = net_udp_put_varint(buf, len, base ? v[i] - base[i] : v[i]);
+	return len;
+}
+
+static int net_udp_get_delta_vec(ubyte *data, int *len, int data_len, int *v, const int *base)
+{
+	int i, d;
+
+	for (i = 0; i < 3; i++)
+	{
+		if (!net_udp_get_varint(data, len, data_len, &d))
+			return 0;
+		v[i] = base ? base[i] + d : d;
+	}
+	return 1;
+}
+
+/*
+ * Appends serial, ACK, base serial, changed fields and the fields themselves. base may be NULL for a keyframe.
+ * The position is relative to the base only if the segment did not change.
+ */
+static int net_udp_put_delta_pdata(ubyte *buf, int len, const UDP_pdata_state *s, ubyte serial, ubyte ack, const UDP_pdata_state *base, ubyte base_serial)
+{
+	int fields = UDP_PDATA_ALL;
+
+	if (base)
+	{
+		fields = 0;
+		if (s->segnum != base->segnum)
+			fields |= UDP_PDATA_SEGNUM|UDP_PDATA_POS;
+		if (memcmp(s->pos, base->pos, sizeof(s->pos)))
+			fields |= UDP_PDATA_POS;
+		if (memcmp(s->vel, base->vel, sizeof(s->vel)))
+			fields |= UDP_PDATA_VEL;
+		if (memcmp(s->rotvel, base->rotvel, sizeof(s->rotvel)))
+			fields |= UDP_PDATA_ROTVEL;
+		if (s->orient != base->orient)
+			fields |= UDP_PDATA_ORIENT;
+	}
+
+	buf[len] = serial;								len++;
+	buf[len] = ack;									len++;
+	buf[len] = base ? base_serial : UDP_PDATA_NONE;					len++;
+	buf[len] = fields;								len++;
+	if (fields & UDP_PDATA_SEGNUM)
+		len = net_udp_put_varint(buf, len, base ? s->segnum - base->segnum : s->segnum);
+	if (fields & UDP_PDATA_POS)
+		len = net_udp_put_delta_vec(buf, len, s->pos, (base && s->segnum == base->segnum) ? base->pos : NULL);
+	if (fields & UDP_PDATA_VEL)
+		len = net_udp_put_delta_vec(buf, len, s->vel, base ? base->vel : NULL);
+	if (fields & UDP_PDATA_ROTVEL)
+		len = net_udp_put_delta_vec(buf, len, s->rotvel, base ? base->rotvel : NULL);
+	if (fields & UDP_PDATA_ORIENT)
+	{
+		PUT_INTEL_INT(buf + len, s->orient);					len += 4;
+	}
+	return len;
+}
+
+// Our state player pnum is known to have, or NULL if we have to send a keyframe.
+static const UDP_pdata_state *net_udp_delta_pdata_base(int pnum, ubyte *serial)
+{
+	ubyte ack = UDP_pdata_ack[pnum];
+
+	if (ack >= MAX_LOSS_BUFFER || ack == current_pdata || !UDP_pdata_sent_time[ack] || UDP_pdata_sent_time[ack] + UDP_PDATA_MAX_AGE < timer_query())
+		return NULL;
+	*serial = ack;
+	return &UDP_pdata_sent[ack];
+}
+
+// send our state in UDP_pdata_sent[current_pdata] to everyone, encoded for each receiver. buf holds the packet header.
+static void net_udp_send_delta_pdata(ubyte *buf, int len)
+{
+	ubyte pkt[UPID_PDATA_D_MAX_SIZE], base_serial = 0;
+	const UDP_pdata_state *s = &UDP_pdata_sent[current_pdata];
+	int i, pkt_len;
+
+	for (i = 0; i < MAX_PLAYERS; i++)
+	{
+		if (i == Player_num)
+			continue;
+		if (Netgame.RetroProtocol ? !Players[i].connected : (multi_i_am_master() ? Players[i].connected == CONNECT_DISCONNECTED : i != 0))
+			continue;
+
+		memcpy(pkt, buf, len);
+		pkt_len = net_udp_put_delta_pdata(pkt, len, s, current_pdata, UDP_pdata_got_last[i], net_udp_delta_pdata_base(i, &base_serial), base_serial);
+		if (Netgame.RetroProtocol)
+			net_udp_send_to_player(pkt, pkt_len, i);
+		else
+			dxx_sendto (UDP_Socket[0], pkt, pkt_len, 0, (struct sockaddr *)&Netgame.players[i].protocol.udp.addr, sizeof(struct _sockaddr));
+	}
+
+	if (Netgame.RetroProtocol && multi_i_am_master())
+	{
+		memcpy(pkt, buf, len);
+		pkt_len = net_udp_put_delta_pdata(pkt, len, s, current_pdata, UDP_PDATA_NONE, NULL, 0);
+		forward_to_observers(pkt, pkt_len, 0);
+	}
+}
+
+/*
+ * Decode the delta part of a pdata packet from pd->Player_num into pd->ptype.dpp. len is the end of the common header.
+ * Returns 0 if the packet is broken or refers to a state we don't have.
+ */
+static int net_udp_get_delta_pdata(ubyte *data, int data_len, int len, UDP_frame_info *pd, ubyte *serial, ubyte *ack)
+{
+	UDP_pdata_state *s = &pd->ptype.dpp;
+	const UDP_pdata_state *base = NULL;
+	int pnum = pd->Player_num, fields, segnum;
+	ubyte base_serial;
+
+	if (data_len < len + 4)
+		return 0;
+	*serial = data[len];								len++;
+	*ack = data[len];								len++;
+	base_serial = data[len];							len++;
+	fields = data[len];								len++;
+	if (*serial >= MAX_LOSS_BUFFER)
+		return 0;
+	if (base_serial != UDP_PDATA_NONE)
+	{
+		if (base_serial >= MAX_LOSS_BUFFER || !UDP_pdata_got_time[pnum][base_serial] || UDP_pdata_got_time[pnum][base_serial] + 2*UDP_PDATA_MAX_AGE < timer_query())
+			return 0;
+		base = &UDP_pdata_got[pnum][base_serial];
+		*s = *base;
+	}
+	else if (fields != UDP_PDATA_ALL)
+		return 0;
+
+	if (fields & UDP_PDATA_SEGNUM)
+	{
+		if (!net_udp_get_varint(data, &len, data_len, &segnum))
+			return 0;
+		segnum += base ? base->segnum : 0;
+		if (segnum < 0 || segnum > Highest_segment_index)
+			return 0;
+		s->segnum = segnum;
+	}
+	if ((fields & UDP_PDATA_POS) && !net_udp_get_delta_vec(data, &len, data_len, s->pos, (base && s->segnum == base->segnum) ? base->pos : NULL))
+		return 0;
+	if ((fields & UDP_PDATA_VEL) && !net_udp_get_delta_vec(data, &len, data_len, s->vel, base ? base->vel : NULL))
+		return 0;
+	if ((fields & UDP_PDATA_ROTVEL) && !net_udp_get_delta_vec(data, &len, data_len, s->rotvel, base ? base->rotvel : NULL))
+		return 0;
+	if (fields & UDP_PDATA_ORIENT)
+	{
+		if (data_len < len + 4)
+			return 0;
+		s->orient = GET_INTEL_INT(&data[len]);					len += 4;
+	}
+	if (len != data_len || s->segnum < 0 || s->segnum > Highest_segment_index)
+		return 0;
+
+	UDP_pdata_got[pnum][*serial] = *s;
+	UDP_pdata_got_time[pnum][*serial] = timer_query();
+	return 1;
+}
+
 void net_udp_send_pdata()
 {
 	if(is_observer()) { return; }
@@ -6432,7 +8499,12 @@ void net_udp_send_pdata()
 	PUT_INTEL_INT(buf + len, netgame_token);					len += 4; 
 	buf[len] = Player_num;										len++;
 	buf[len] = Players[Player_num].connected;							len++; // 3
-	if(Netgame.RetroProtocol) 
+	if (Netgame.DeltaPackets)
+	{
+		net_udp_create_pdata_state(&UDP_pdata_sent[current_pdata], Objects+Players[Player_num].objnum);
+		UDP_pdata_sent_time[current_pdata] = timer_query();
+	}
+	else if(Netgame.RetroProtocol) 
 	{
 		object* player = Objects+Players[Player_num].objnum;
 
@@ -6492,7 +8564,9 @@ void net_udp_send_pdata()
 		buf[len] = current_pdata; len++;
 	}
 
-	if(Netgame.RetroProtocol) {
+	if (Netgame.DeltaPackets) {
+		net_udp_send_delta_pdata(buf, len);
+	} else if(Netgame.RetroProtocol) {
 		for (i = 0; i < MAX_PLAYERS; i++) {
 			if (Players[i].connected && i != Player_num) {
 				net_udp_send_to_player(buf, len, i); 
@@ -6631,7 +8705,7 @@ void net_udp_process_pdata ( ubyte *data, int data_len, struct _sockaddr sender_
 	
 
 	if(! Netgame.RetroProtocol ) {
-		if ((Netgame.ShortPackets && data_len != UPID_PDATA_S_SIZE) || (!Netgame.ShortPackets && data_len != UPID_PDATA_Q_SIZE))
+		if (Netgame.DeltaPackets ? data_len > UPID_PDATA_D_MAX_SIZE : ((Netgame.ShortPackets && data_len != UPID_PDATA_S_SIZE) || (!Netgame.ShortPackets && data_len != UPID_PDATA_Q_SIZE)))
 			return;
 
 		if (memcmp((struct _sockaddr *)&sender_addr, (struct _sockaddr *)&Netgame.players[((multi_i_am_master())?(data[len]):(0))].protocol.udp.addr, sizeof(struct _sockaddr)))
@@ -6658,8 +8732,16 @@ void net_udp_process_pdata ( ubyte *data, int data_len, struct _sockaddr sender_
 	//
 	//}
 
-	ubyte packet_num = 0; 
-	if(Netgame.RetroProtocol) 
+	ubyte packet_num = 0, pdata_ack = UDP_PDATA_NONE; 
+	if (Netgame.DeltaPackets)
+	{
+		if (!net_udp_get_delta_pdata(data, data_len, len, &pd, &packet_num, &pdata_ack))
+		{
+			drop_rx_packet(data, "undecodable delta pdata");
+			return;
+		}
+	}
+	else if(Netgame.RetroProtocol) 
 	{
 		pd.ptype.upp.orient.rvec.x = GET_INTEL_INT(&data[len]); len += 4; 
 		pd.ptype.upp.orient.rvec.y = GET_INTEL_INT(&data[len]); len += 4; 
@@ -6732,6 +8814,23 @@ void net_udp_process_pdata ( ubyte *data, int data_len, struct _sockaddr sender_
 
 	received_pdata_num(pd.Player_num, packet_num); 
 
+	if (Netgame.DeltaPackets)
+	{
+		UDP_pdata_got_last[pd.Player_num] = packet_num;
+		UDP_pdata_ack[pd.Player_num] = pdata_ack; // UDP_PDATA_NONE gets him a keyframe
+
+		// whoever we pass this on to never ACK'd the sender, so relay and forward it as keyframe
+		if (multi_i_am_master())
+		{
+			ubyte keyframe[UPID_PDATA_D_MAX_SIZE];
+
+			memcpy(keyframe, data, len);
+			data_len = net_udp_put_delta_pdata(keyframe, len, &pd.ptype.dpp, packet_num, UDP_PDATA_NONE, NULL, 0);
+			data = keyframe;
+			forward_to_observers(data, data_len, 0);
+		}
+	}
+
 	if(! Netgame.RetroProtocol) {
 		if (multi_i_am_master()) // I am host - must relay this packet to others!
 		{
@@ -6790,6 +8889,7 @@ void net_udp_read_pdata_packet(UDP_frame_info *pd)
 			multi_send_score();
 
 			net_udp_noloss_clear_mdata_got(TheirPlayernum);
+			net_udp_reset_delta_pdata_player(TheirPlayernum);
 		}
 	}
 
@@ -6814,7 +8914,9 @@ void net_udp_read_pdata_packet(UDP_frame_info *pd)
 
 	//------------ Read the player's ship's object info ----------------------
 
-	if(Netgame.RetroProtocol)
+	if (Netgame.DeltaPackets)
+		net_udp_extract_pdata_state(TheirObj, &pd->ptype.dpp);
+	else if(Netgame.RetroProtocol)
 		extract_uncompressedpos(TheirObj, &pd->ptype.upp, 0);
 	else if (Netgame.ShortPackets)
 		extract_shortpos(TheirObj, &pd->ptype.spp, 0);
@@ -7004,7 +9106,7 @@ void net_udp_process_p2p_pong(ubyte *data, struct _sockaddr sender_addr, int dat
 	int direct_pong = data[len]; len++;
 
 	// Get the ping time
-	Netgame.players[from_player].ping = f2i(fixmul(timer_query() - sent_time,i2f(1000)));
+	Netgame.players[from_player].ping = f2i(fixmul(UDP_packet_time - sent_time,i2f(1000)));
 	
 	if (Netgame.players[from_player].ping < 0)
 		Netgame.players[from_player].ping = 0;
@@ -7116,6 +9218,29 @@ void net_udp_send_to_player_proxy(ubyte* data, int data_len, int to_player, int
 	free(buf);
 }
 
+// split a UPID_BUNDLE into the messages it carries and process each like a datagram of its own
+void net_udp_process_bundle(ubyte *data, struct _sockaddr sender_addr, int data_len, int is_proxy)
+{
+	int len = UPID_BUNDLE_HEADER_SIZE, msg_len;
+
+	while (len < data_len)
+	{
+		if (len + 2 > data_len)
+		{
+			drop_rx_packet(data, "truncated bundle");
+			return;
+		}
+		msg_len = GET_INTEL_SHORT(data + len);					len += 2;
+		if (msg_len < 1 || len + msg_len > data_len || data[len] == UPID_BUNDLE)
+		{
+			drop_rx_packet(data, "broken bundle");
+			return;
+		}
+		net_udp_process_packet(data + len, sender_addr, msg_len, is_proxy);
+		len += msg_len;
+	}
+}
+
 void net_udp_process_proxy(ubyte* data, struct _sockaddr sender_addr, int data_len) {
 	int from_player = data[6];
 	if (from_player < 0 || from_player > MAX_PLAYERS - 1) {
@@ -7273,7 +9398,7 @@ void net_udp_process_pong(ubyte *data, int data_len, struct _sockaddr sender_add
 		return;
 	
 	memcpy(&client_pong_time, &data[2], 8);
-	Netgame.players[data[1]].ping = f2i(fixmul(timer_query() - client_pong_time,i2f(1000)));
+	Netgame.players[data[1]].ping = f2i(fixmul(UDP_packet_time - client_pong_time,i2f(1000)));
 	
 	if (Netgame.players[data[1]].ping < 0)
 		Netgame.players[data[1]].ping = 0;
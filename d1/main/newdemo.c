@@ -25,6 +25,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <time.h>
 #include <errno.h>
 #include <ctype.h>
+#include <SDL.h>
 
 #include "u_mem.h"
 #include "inferno.h"
@@ -200,7 +201,7 @@ int newdemo_get_percent_done()	{
 		return (PHYSFS_tell(infile) * 100) / nd_playback_v_demosize;
 	}
 	if ( Newdemo_state == ND_STATE_RECORDING ) {
-		return PHYSFS_tell(outfile);
+		return Newdemo_num_written;
 	}
 	return 0;
 }
@@ -248,6 +249,23 @@ int newdemo_read( void *buffer, int elsize, int nelem )
 }
 
 int newdemo_find_object( int signature )
+{
+	return obj_find_signature(signature);
+}
+
+#ifdef BENCHMARKS
+/*
+ *  -sigbench: after each frame read during playback every object in it is
+ *  looked up by its signature, through the signature index and by going
+ *  through all objects like newdemo_find_object() used to.  The time both
+ *  took and any different results are printed when playback stops.  Meant to
+ *  be run with -timedemo on a busy anarchy demo.
+ */
+
+static u_int64_t nd_sigbench_index = 0, nd_sigbench_scan = 0;
+static int nd_sigbench_lookups = 0, nd_sigbench_mismatches = 0;
+
+static int newdemo_scan_object( int signature )
 {
 	int i;
 	object * objp;
@@ -259,6 +277,161 @@ int newdemo_find_object( int signature )
 	return -1;
 }
 
+static void newdemo_sigbench_frame()
+{
+	static int sigs[MAX_OBJECTS], found[MAX_OBJECTS];
+	u_int64_t t0, t1, t2;
+	int i, n = 0;
+
+	for (i = 0; i <= Highest_object_index; i++)
+		if (Objects[i].type != OBJ_NONE)
+			sigs[n++] = Objects[i].signature;
+
+	t0 = SDL_GetPerformanceCounter();
+	for (i = 0; i < n; i++)
+		found[i] = obj_find_signature(sigs[i]);
+	t1 = SDL_GetPerformanceCounter();
+	for (i = 0; i < n; i++)
+		nd_sigbench_mismatches += newdemo_scan_object(sigs[i]) != found[i];
+	t2 = SDL_GetPerformanceCounter();
+
+	nd_sigbench_index += t1 - t0;
+	nd_sigbench_scan += t2 - t1;
+	nd_sigbench_lookups += n;
+}
+
+static void newdemo_sigbench_report()
+{
+	double freq = SDL_GetPerformanceFrequency();
+
+	if (!nd_sigbench_lookups)
+		return;
+	con_printf(CON_NORMAL, "Signature lookups: %i objects, index %.3f ms, all objects %.3f ms, %i different results\n",
+		nd_sigbench_lookups, nd_sigbench_index * 1000 / freq, nd_sigbench_scan * 1000 / freq, nd_sigbench_mismatches);
+	nd_sigbench_index = nd_sigbench_scan = 0;
+	nd_sigbench_lookups = nd_sigbench_mismatches = 0;
+}
+#endif
+
+/*
+ *  Recording goes through a writer thread.  newdemo_write() only copies into
+ *  a ring, and at the start of each frame the bytes of the last frame are
+ *  handed to the writer, which puts them into the file.  If the ring is full
+ *  the game waits for the writer.  A failed write is seen by the next
+ *  newdemo_write() and ends the recording as if the disk were full.
+ */
+
+#define ND_WRITER_RING_SIZE	(1024*1024)	// must be a power of 2, many seconds of even a busy game
+
+static ubyte *nd_writer_ring = NULL;
+static unsigned nd_writer_put_pos = 0; // bytes ever put into the ring, game thread only
+static SDL_atomic_t nd_writer_head; // bytes ever handed to the writer, only moved by the game thread
+static SDL_atomic_t nd_writer_flushed; // bytes ever written to the file, only moved by the writer thread
+static SDL_atomic_t nd_writer_failed, nd_writer_quit;
+static SDL_sem *nd_writer_sem = NULL;
+static SDL_Thread *nd_writer_thread = NULL;
+
+static int newdemo_writer_main(void *unused)
+{
+	unsigned flushed, head, off, n;
+	int quit;
+
+	(void)unused;
+	do
+	{
+		quit = SDL_AtomicGet(&nd_writer_quit);
+		flushed = SDL_AtomicGet(&nd_writer_flushed);
+		head = SDL_AtomicGet(&nd_writer_head);
+		if (flushed == head)
+		{
+			if (!quit)
+				SDL_SemWaitTimeout(nd_writer_sem, 100);
+			continue;
+		}
+		SDL_MemoryBarrierAcquire();
+		while (flushed != head)
+		{
+			off = flushed & (ND_WRITER_RING_SIZE - 1);
+			n = min(head - flushed, ND_WRITER_RING_SIZE - off);
+			if (!SDL_AtomicGet(&nd_writer_failed) && PHYSFS_write(outfile, nd_writer_ring + off, 1, n) != n)
+				SDL_AtomicSet(&nd_writer_failed, 1);
+			flushed += n;
+		}
+		SDL_MemoryBarrierRelease();
+		SDL_AtomicSet(&nd_writer_flushed, flushed);
+	} while (!quit);
+
+	return 0;
+}
+
+// hand what was put into the ring so far to the writer
+static void newdemo_writer_commit()
+{
+	if (!nd_writer_thread || (unsigned)SDL_AtomicGet(&nd_writer_head) == nd_writer_put_pos)
+		return;
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&nd_writer_head, nd_writer_put_pos);
+	SDL_SemPost(nd_writer_sem);
+}
+
+static void newdemo_writer_put(const void *data, unsigned len)
+{
+	unsigned off = nd_writer_put_pos & (ND_WRITER_RING_SIZE - 1), n = min(len, ND_WRITER_RING_SIZE - off);
+
+	while (nd_writer_put_pos + len - (unsigned)SDL_AtomicGet(&nd_writer_flushed) > ND_WRITER_RING_SIZE)
+	{
+		newdemo_writer_commit();
+		SDL_Delay(1);
+	}
+	SDL_MemoryBarrierAcquire();
+	memcpy(nd_writer_ring + off, data, n);
+	memcpy(nd_writer_ring, (const ubyte *)data + n, len - n);
+	nd_writer_put_pos += len;
+
+	// a frame bigger than this goes in parts, so waiting for room above always ends
+	if (nd_writer_put_pos - (unsigned)SDL_AtomicGet(&nd_writer_head) >= ND_WRITER_RING_SIZE / 4)
+		newdemo_writer_commit();
+}
+
+// without the thread, newdemo_write() writes the file itself
+static void newdemo_writer_start()
+{
+	MALLOC(nd_writer_ring, ubyte, ND_WRITER_RING_SIZE);
+	if (!nd_writer_ring)
+		return;
+	nd_writer_put_pos = 0;
+	SDL_AtomicSet(&nd_writer_head, 0);
+	SDL_AtomicSet(&nd_writer_flushed, 0);
+	SDL_AtomicSet(&nd_writer_failed, 0);
+	SDL_AtomicSet(&nd_writer_quit, 0);
+	if ((nd_writer_sem = SDL_CreateSemaphore(0)))
+		nd_writer_thread = SDL_CreateThread(newdemo_writer_main, "demo", NULL);
+	if (!nd_writer_thread)
+	{
+		con_printf(CON_NORMAL, "Cannot start demo writer: %s\n", SDL_GetError());
+		if (nd_writer_sem)
+			SDL_DestroySemaphore(nd_writer_sem);
+		nd_writer_sem = NULL;
+		d_free(nd_writer_ring);
+	}
+}
+
+// write out the rest. Returns 0 if a write failed.
+static int newdemo_writer_stop()
+{
+	if (!nd_writer_thread)
+		return 1;
+	newdemo_writer_commit();
+	SDL_AtomicSet(&nd_writer_quit, 1);
+	SDL_SemPost(nd_writer_sem);
+	SDL_WaitThread(nd_writer_thread, NULL);
+	nd_writer_thread = NULL;
+	SDL_DestroySemaphore(nd_writer_sem);
+	nd_writer_sem = NULL;
+	d_free(nd_writer_ring);
+	return !SDL_AtomicGet(&nd_writer_failed);
+}
+
 int newdemo_write(const void *buffer, int elsize, int nelem )
 {
 	int num_written, total_size;
@@ -267,10 +440,21 @@ int newdemo_write(const void *buffer, int elsize, int nelem )
 	nd_record_v_framebytes_written += total_size;
 	Newdemo_num_written += total_size;
 	Assert(outfile != NULL);
-	num_written = PHYSFS_write(outfile, buffer, elsize, nelem);
+	if (nd_writer_thread)
+	{
+		if (!SDL_AtomicGet(&nd_writer_failed) && !nd_record_v_no_space)
+		{
+			newdemo_writer_put(buffer, total_size);
+			return nelem;
+		}
+	}
+	else
+	{
+		num_written = PHYSFS_write(outfile, buffer, elsize, nelem);
 
-	if (num_written == nelem && !nd_record_v_no_space)
-		return num_written;
+		if (num_written == nelem && !nd_record_v_no_space)
+			return num_written;
+	}
 
 	nd_record_v_no_space=2;
 	newdemo_stop_recording(0);
@@ -463,6 +647,8 @@ void nd_read_object(object *obj)
 	nd_read_byte((sbyte *) &(obj->flags));
 	nd_read_short(&shortsig);
 	obj->signature = shortsig;  // It's OKAY! We made sure, obj->signature is never has a value which short cannot handle!!! We cannot do this otherwise, without breaking the demo format!
+	if (obj >= Objects && obj < Objects + MAX_OBJECTS)
+		obj_sig_update(obj-Objects);
 	nd_read_shortpos(obj);
 
 	obj->attached_obj = -1;
@@ -899,6 +1085,8 @@ void newdemo_record_start_frame(fix frame_time )
 		return;
 	}
 
+	newdemo_writer_commit(); // the last frame is done
+
 	// Make demo recording waste a bit less space.
 	// First check if if at least REC_DELAY has passed since last recorded frame. If yes, record frame and set nd_record_v_recordframe true.
 	// nd_record_v_recordframe will be used for various other frame-by-frame events to drop some unnecessary bytes.
@@ -1635,14 +1823,216 @@ void newdemo_pop_ctrlcen_triggers()
 	}
 }
 
+/*
+ *  Keyframe index for seeking.  Every frame read forward past the end of the
+ *  index adds its file position and recorded time, and every
+ *  ND_KEYFRAME_INTERVAL of recorded time (and at each new level) the state
+ *  the frames only change a bit at a time -- walls, doors, side textures,
+ *  players and views -- is kept as a keyframe.  The objects are recorded in
+ *  full every frame, so they are not kept.  Seeking restores the last
+ *  keyframe before the target and reads the frames from there, instead of
+ *  undoing the frames one by one.  The demo file is not changed, so every
+ *  demo can be indexed.
+ */
+
+#define ND_KEYFRAME_INTERVAL	(F1_0*5)
+#define ND_SEEK_ANY		0x7fffffff
+
+typedef struct nd_keyframe
+{
+	int frame; // in the index
+	int framecount;
+	fix recorded_time;
+	sbyte level, cntrlcen_destroyed;
+	ubyte dead, rear;
+	int n_players;
+	player players[MAX_PLAYERS];
+	int num_walls, num_open_doors;
+	wall walls[MAX_WALLS];
+	active_door doors[MAX_DOORS];
+	short *tmaps; // tmap_num and tmap_num2 of every side
+} nd_keyframe;
+
+static int *nd_index_pos = NULL;
+static fix *nd_index_time = NULL;
+static int nd_index_num = 0, nd_index_max = 0;
+static nd_keyframe **nd_index_keyframes = NULL;
+static int nd_index_num_keyframes = 0, nd_index_max_keyframes = 0;
+
+static void newdemo_index_free()
+{
+	int i;
+
+	for (i = 0; i < nd_index_num_keyframes; i++)
+	{
+		d_free(nd_index_keyframes[i]->tmaps);
+		d_free(nd_index_keyframes[i]);
+	}
+	if (nd_index_keyframes)
+		d_free(nd_index_keyframes);
+	if (nd_index_pos)
+		d_free(nd_index_pos);
+	if (nd_index_time)
+		d_free(nd_index_time);
+	nd_index_num = nd_index_max = nd_index_num_keyframes = nd_index_max_keyframes = 0;
+}
+
+static void newdemo_add_keyframe()
+{
+	nd_keyframe *kf, **keyframes;
+	short *tmap;
+	int segnum, side;
+
+	if (nd_index_num_keyframes == nd_index_max_keyframes)
+	{
+		keyframes = d_realloc(nd_index_keyframes, sizeof(nd_keyframe *) * (nd_index_max_keyframes ? nd_index_max_keyframes * 2 : 64));
+		if (!keyframes)
+			return;
+		nd_index_keyframes = keyframes;
+		nd_index_max_keyframes = nd_index_max_keyframes ? nd_index_max_keyframes * 2 : 64;
+	}
+	MALLOC(kf, nd_keyframe, 1);
+	if (!kf)
+		return;
+	MALLOC(kf->tmaps, short, (Highest_segment_index + 1) * MAX_SIDES_PER_SEGMENT * 2);
+	if (!kf->tmaps)
+	{
+		d_free(kf);
+		return;
+	}
+
+	kf->frame = nd_index_num - 1;
+	kf->framecount = nd_playback_v_framecount;
+	kf->recorded_time = nd_recorded_time;
+	kf->level = Current_level_num;
+	kf->cntrlcen_destroyed = nd_playback_v_cntrlcen_destroyed;
+	kf->dead = nd_playback_v_dead;
+	kf->rear = nd_playback_v_rear;
+	kf->n_players = N_players;
+	memcpy(kf->players, Players, sizeof(Players));
+	kf->num_walls = Num_walls;
+	memcpy(kf->walls, Walls, sizeof(wall) * Num_walls);
+	kf->num_open_doors = Num_open_doors;
+	memcpy(kf->doors, ActiveDoors, sizeof(active_door) * Num_open_doors);
+	tmap = kf->tmaps;
+	for (segnum = 0; segnum <= Highest_segment_index; segnum++)
+		for (side = 0; side < MAX_SIDES_PER_SEGMENT; side++)
+		{
+			*tmap++ = Segments[segnum].sides[side].tmap_num;
+			*tmap++ = Segments[segnum].sides[side].tmap_num2;
+		}
+
+	nd_index_keyframes[nd_index_num_keyframes++] = kf;
+}
+
+static void newdemo_restore_keyframe(nd_keyframe *kf)
+{
+	short *tmap;
+	int segnum, side;
+
+	if (kf->level != Current_level_num)
+		LoadLevel(kf->level, 1);
+
+	nd_playback_v_cntrlcen_destroyed = kf->cntrlcen_destroyed;
+	nd_playback_v_dead = kf->dead;
+	nd_playback_v_rear = kf->rear;
+	N_players = kf->n_players;
+	memcpy(Players, kf->players, sizeof(Players));
+	Num_walls = kf->num_walls;
+	memcpy(Walls, kf->walls, sizeof(wall) * Num_walls);
+	Num_open_doors = kf->num_open_doors;
+	memcpy(ActiveDoors, kf->doors, sizeof(active_door) * Num_open_doors);
+	tmap = kf->tmaps;
+	for (segnum = 0; segnum <= Highest_segment_index; segnum++)
+		for (side = 0; side < MAX_SIDES_PER_SEGMENT; side++)
+		{
+			Segments[segnum].sides[side].tmap_num = *tmap++;
+			Segments[segnum].sides[side].tmap_num2 = *tmap++;
+		}
+
+	PHYSFS_seek(infile, nd_index_pos[kf->frame]);
+	nd_playback_v_framecount = kf->framecount;
+	nd_recorded_time = kf->recorded_time;
+	nd_playback_v_at_eof = 0;
+}
+
+// start the index where the playback is now, after the first frames
+static void newdemo_index_start()
+{
+	newdemo_index_free();
+	if (Newdemo_state != ND_STATE_PLAYBACK || nd_playback_v_at_eof)
+		return;
+
+	MALLOC(nd_index_pos, int, 4096);
+	MALLOC(nd_index_time, fix, 4096);
+	if (!nd_index_pos || !nd_index_time)
+	{
+		newdemo_index_free();
+		return;
+	}
+	nd_index_max = 4096;
+	nd_index_pos[0] = PHYSFS_tell(infile);
+	nd_index_time[0] = 0;
+	nd_index_num = 1;
+	newdemo_add_keyframe();
+	if (!nd_index_num_keyframes)
+		newdemo_index_free();
+}
+
+// a frame was read forward from the end of the index
+static void newdemo_index_frame()
+{
+	nd_keyframe *last = nd_index_keyframes[nd_index_num_keyframes - 1];
+
+	if (nd_index_num == nd_index_max)
+	{
+		int *pos = d_realloc(nd_index_pos, sizeof(int) * nd_index_max * 2);
+		fix *time;
+
+		if (!pos)
+			return;
+		nd_index_pos = pos;
+		if (!(time = d_realloc(nd_index_time, sizeof(fix) * nd_index_max * 2)))
+			return;
+		nd_index_time = time;
+		nd_index_max *= 2;
+	}
+	nd_index_pos[nd_index_num] = PHYSFS_tell(infile);
+	nd_index_time[nd_index_num] = nd_index_time[nd_index_num - 1] + nd_recorded_time;
+	nd_index_num++;
+
+	if (last->level != Current_level_num || nd_index_time[nd_index_num - 1] - nd_index_time[last->frame] >= ND_KEYFRAME_INTERVAL)
+		newdemo_add_keyframe();
+}
+
+// the indexed frame the playback is at, or -1 if it is past the end of the index
+static int newdemo_index_current()
+{
+	int pos, lo = 0, hi = nd_index_num - 1, mid;
+
+	if (!nd_index_num || (pos = PHYSFS_tell(infile)) > nd_index_pos[hi])
+		return -1;
+	while (lo < hi)
+	{
+		mid = (lo + hi + 1) / 2;
+		if (nd_index_pos[mid] <= pos)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
 int newdemo_read_frame_information(int rewrite)
 {
 	int done, segnum, side, objnum, soundno, angle, volume, i;
+	int index_start;
 	object *obj;
 	sbyte c;
 	bool shields_updated = 0, energy_updated = 0; // Flags to indicate if shields or energy has already been updated when rewinding.  Rewinds should only take the first update.
 
 	done = 0;
+	index_start = (nd_index_num && !rewrite) ? PHYSFS_tell(infile) : -1;
 
 	if (Newdemo_vcr_state != ND_STATE_PAUSED)
 		for (segnum=0; segnum <= Highest_segment_index; segnum++)
@@ -2649,6 +3039,15 @@ int newdemo_read_frame_information(int rewrite)
 			select_cockpit(PlayerCfg.PreferredCockpitMode);
 	}
 
+#ifdef BENCHMARKS
+	if (done == 1 && GameArg.DbgSigBench && !rewrite)
+		newdemo_sigbench_frame();
+#endif
+
+	if (done == 1 && nd_index_num && index_start == nd_index_pos[nd_index_num - 1] &&
+		((Newdemo_vcr_state == ND_STATE_PLAYBACK) || (Newdemo_vcr_state == ND_STATE_FASTFORWARD) || (Newdemo_vcr_state == ND_STATE_ONEFRAMEFORWARD)))
+		newdemo_index_frame();
+
 	if (nd_playback_v_bad_read) {
 		nm_messagebox( NULL, 1, TXT_OK, "%s %s", TXT_DEMO_ERR_READING, TXT_DEMO_OLD_CORRUPT );
 		free_mission();
@@ -2822,6 +3221,71 @@ void newdemo_back_frames(int frames)
 
 }
 
+// go to the first frame at or past frame, the recorded time or the file position pos
+static void newdemo_seek(int frame, fix time, int pos)
+{
+	int cur = newdemo_index_current(), state = Newdemo_vcr_state, lo = 0, hi = nd_index_num, mid, k;
+
+	if (cur < 0)
+		return;
+
+	// the first indexed frame at the target, or nd_index_num if it is past the index
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (mid >= frame || nd_index_time[mid] >= time || nd_index_pos[mid] >= pos)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	if (!lo)
+	{
+		newdemo_goto_beginning();
+		if (state != ND_STATE_REWINDING)
+			Newdemo_vcr_state = state;
+		return;
+	}
+
+	// from the last keyframe before it, or from here if that is closer
+	for (k = nd_index_num_keyframes - 1; nd_index_keyframes[k]->frame >= lo; k--)
+		;
+	if (nd_playback_v_at_eof || cur >= lo || cur < nd_index_keyframes[k]->frame || PHYSFS_tell(infile) != nd_index_pos[cur])
+	{
+		newdemo_restore_keyframe(nd_index_keyframes[k]);
+		cur = nd_index_keyframes[k]->frame;
+	}
+
+	Newdemo_vcr_state = ND_STATE_FASTFORWARD;
+	do {
+		if (newdemo_read_frame_information(0) == -1) {
+			if (!nd_playback_v_at_eof) {
+				newdemo_stop_playback();
+				return;
+			}
+			break;
+		}
+		cur++;
+	} while (cur < nd_index_num && cur < frame && nd_index_time[cur] < time && nd_index_pos[cur] < pos);
+
+	Newdemo_vcr_state = nd_playback_v_at_eof ? ND_STATE_PAUSED : state;
+	nd_recorded_total = nd_playback_total = nd_index_time[min(cur, nd_index_num - 1)];
+	nd_playback_v_style = NORMAL_PLAYBACK;
+}
+
+// skip time forward or, if negative, back
+void newdemo_skip(fix time)
+{
+	int cur = newdemo_index_current();
+
+	if (cur >= 0)
+		newdemo_seek(ND_SEEK_ANY, nd_index_time[cur] + time, ND_SEEK_ANY);
+}
+
+void newdemo_seek_percent(int percent)
+{
+	newdemo_seek(ND_SEEK_ANY, ND_SEEK_ANY, (u_int64_t)nd_playback_v_demosize * percent / 100);
+}
+
 /*
  *  routine to interpolate the viewer position.  the current position is
  *  stored in the Viewer object.  Save this position, and read the next
@@ -2868,52 +3332,51 @@ void interpolate_frame(fix d_play, fix d_recorded)
 	if (InterpolStep <= 0)
 	{
 		for (i = 0; i <= num_cur_objs; i++) {
-			for (j = 0; j <= Highest_object_index; j++) {
-				if (cur_objs[i].signature == Objects[j].signature) {
-					sbyte render_type = cur_objs[i].render_type;
-					fix delta_x, delta_y, delta_z;
-
-					//  Extract the angles from the object orientation matrix.
-					//  Some of this code taken from ai_turn_towards_vector
-					//  Don't do the interpolation on certain render types which don't use an orientation matrix
-
-					if (!((render_type == RT_LASER) || (render_type == RT_FIREBALL) || (render_type == RT_POWERUP))) {
-						vms_vector  fvec1, fvec2, rvec1, rvec2;
-						fix         mag1;
-
-						fvec1 = cur_objs[i].orient.fvec;
-						vm_vec_scale(&fvec1, F1_0-factor);
-						fvec2 = Objects[j].orient.fvec;
-						vm_vec_scale(&fvec2, factor);
-						vm_vec_add2(&fvec1, &fvec2);
-						mag1 = vm_vec_normalize_quick(&fvec1);
-						if (mag1 > F1_0/256) {
-							rvec1 = cur_objs[i].orient.rvec;
-							vm_vec_scale(&rvec1, F1_0-factor);
-							rvec2 = Objects[j].orient.rvec;
-							vm_vec_scale(&rvec2, factor);
-							vm_vec_add2(&rvec1, &rvec2);
-							vm_vec_normalize_quick(&rvec1); // Note: Doesn't matter if this is null, if null, vm_vector_2_matrix will just use fvec1
-							vm_vector_2_matrix(&cur_objs[i].orient, &fvec1, NULL, &rvec1);
-						}
-					}
+			sbyte render_type = cur_objs[i].render_type;
+			fix delta_x, delta_y, delta_z;
+
+			if (cur_objs[i].type == OBJ_NONE || (j = obj_find_signature(cur_objs[i].signature)) == -1)
+				continue;
+
+			//  Extract the angles from the object orientation matrix.
+			//  Some of this code taken from ai_turn_towards_vector
+			//  Don't do the interpolation on certain render types which don't use an orientation matrix
+
+			if (!((render_type == RT_LASER) || (render_type == RT_FIREBALL) || (render_type == RT_POWERUP))) {
+				vms_vector  fvec1, fvec2, rvec1, rvec2;
+				fix         mag1;
+
+				fvec1 = cur_objs[i].orient.fvec;
+				vm_vec_scale(&fvec1, F1_0-factor);
+				fvec2 = Objects[j].orient.fvec;
+				vm_vec_scale(&fvec2, factor);
+				vm_vec_add2(&fvec1, &fvec2);
+				mag1 = vm_vec_normalize_quick(&fvec1);
+				if (mag1 > F1_0/256) {
+					rvec1 = cur_objs[i].orient.rvec;
+					vm_vec_scale(&rvec1, F1_0-factor);
+					rvec2 = Objects[j].orient.rvec;
+					vm_vec_scale(&rvec2, factor);
+					vm_vec_add2(&rvec1, &rvec2);
+					vm_vec_normalize_quick(&rvec1); // Note: Doesn't matter if this is null, if null, vm_vector_2_matrix will just use fvec1
+					vm_vector_2_matrix(&cur_objs[i].orient, &fvec1, NULL, &rvec1);
+				}
+			}
 
-					// Interpolate the object position.  This is just straight linear
-					// interpolation.
+			// Interpolate the object position.  This is just straight linear
+			// interpolation.
 
-					delta_x = Objects[j].pos.x - cur_objs[i].pos.x;
-					delta_y = Objects[j].pos.y - cur_objs[i].pos.y;
-					delta_z = Objects[j].pos.z - cur_objs[i].pos.z;
+			delta_x = Objects[j].pos.x - cur_objs[i].pos.x;
+			delta_y = Objects[j].pos.y - cur_objs[i].pos.y;
+			delta_z = Objects[j].pos.z - cur_objs[i].pos.z;
 
-					delta_x = fixmul(delta_x, factor);
-					delta_y = fixmul(delta_y, factor);
-					delta_z = fixmul(delta_z, factor);
+			delta_x = fixmul(delta_x, factor);
+			delta_y = fixmul(delta_y, factor);
+			delta_z = fixmul(delta_z, factor);
 
-					cur_objs[i].pos.x += delta_x;
-					cur_objs[i].pos.y += delta_y;
-					cur_objs[i].pos.z += delta_z;
-				}
-			}
+			cur_objs[i].pos.x += delta_x;
+			cur_objs[i].pos.y += delta_y;
+			cur_objs[i].pos.z += delta_z;
 		}
 		InterpolStep = fl2f(.01);
 	}
@@ -2929,8 +3392,10 @@ void interpolate_frame(fix d_play, fix d_recorded)
 		newdemo_stop_playback();
 	Newdemo_vcr_state = ND_STATE_PLAYBACK;
 
-	for (i = 0; i <= num_cur_objs; i++)
+	for (i = 0; i <= num_cur_objs; i++) {
 		memcpy(&(Objects[i]), &(cur_objs[i]), sizeof(object));
+		obj_sig_update(i);
+	}
 	Highest_object_index = num_cur_objs;
 	d_free(cur_objs);
 }
@@ -2968,6 +3433,12 @@ void newdemo_playback_one_frame()
 			frames_back = 10;
 		else
 			frames_back = 1;
+		if ((i = newdemo_index_current()) >= 0) {
+			newdemo_seek(i - frames_back, ND_SEEK_ANY, ND_SEEK_ANY);
+			if (Newdemo_vcr_state == ND_STATE_ONEFRAMEBACKWARD)
+				Newdemo_vcr_state = ND_STATE_PAUSED;
+			return;
+		}
 		if (nd_playback_v_at_eof) {
 			PHYSFS_seek(infile, PHYSFS_tell(infile) + (shareware ? -2 : +11));
 		}
@@ -3082,13 +3553,10 @@ void newdemo_playback_one_frame()
 					//  interpolated position and orientation can be preserved.
 
 					for (i = 0; i <= num_objs; i++) {
-						for (j = 0; j <= Highest_object_index; j++) {
-							if (cur_objs[i].signature == Objects[j].signature) {
-								memcpy(&(Objects[j].orient), &(cur_objs[i].orient), sizeof(vms_matrix));
-								memcpy(&(Objects[j].pos), &(cur_objs[i].pos), sizeof(vms_vector));
-								break;
-							}
-						}
+						if (cur_objs[i].type == OBJ_NONE || (j = obj_find_signature(cur_objs[i].signature)) == -1)
+							continue;
+						memcpy(&(Objects[j].orient), &(cur_objs[i].orient), sizeof(vms_matrix));
+						memcpy(&(Objects[j].pos), &(cur_objs[i].pos), sizeof(vms_vector));
 					}
 					d_free(cur_objs);
 					d_recorded += nd_recorded_time;
@@ -3117,6 +3585,12 @@ void newdemo_playback_one_frame()
 	}
 }
 
+// how long the last frame played back took when it was recorded
+fix newdemo_recorded_frame_time()
+{
+	return nd_recorded_time;
+}
+
 void newdemo_start_recording(int is_autorecord)
 {
 	Newdemo_num_written = 0;
@@ -3138,7 +3612,10 @@ void newdemo_start_recording(int is_autorecord)
 		nm_messagebox(NULL, 1, TXT_OK, "Cannot open demo temp file");
 	}
 	else
+	{
+		newdemo_writer_start();
 		newdemo_record_start_demo();
+	}
 }
 
 void newdemo_write_end()
@@ -3346,6 +3823,8 @@ void newdemo_stop_recording(int is_manual)
 		newdemo_write_end();
 	}
 
+	if (!newdemo_writer_stop())
+		nd_record_v_no_space = 2;
 	PHYSFS_close(outfile);
 	outfile = NULL;
 	Newdemo_state = ND_STATE_NORMAL;
@@ -3466,6 +3945,7 @@ void newdemo_start_playback(char * filename)
 		hide_menus();
 	newdemo_playback_one_frame();       // this one loads new level
 	newdemo_playback_one_frame();       // get all of the objects to renderb game
+	newdemo_index_start();
 	if (!Game_wind)
 		Game_wind = game_setup();							// create game environment
 }
@@ -3473,6 +3953,10 @@ void newdemo_start_playback(char * filename)
 void newdemo_stop_playback()
 {
 	PHYSFS_close(infile);
+	newdemo_index_free();
+#ifdef BENCHMARKS
+	newdemo_sigbench_report();
+#endif
 	Newdemo_state = ND_STATE_NORMAL;
 #ifdef NETWORK
 	change_playernum_to(0);             //this is reality
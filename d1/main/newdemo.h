@@ -98,8 +98,11 @@ extern void newdemo_record_laser_level(sbyte old_level, sbyte new_level);
 // Functions called during playback process...
 extern void newdemo_object_move_all();
 extern void newdemo_playback_one_frame();
+extern fix newdemo_recorded_frame_time();
 extern void newdemo_goto_end(int to_rewrite);
 extern void newdemo_goto_beginning();
+extern void newdemo_skip(fix time);
+extern void newdemo_seek_percent(int percent);
 
 // Interactive functions to control playback/record;
 extern void newdemo_start_playback( char * filename );
@@ -782,6 +782,73 @@ void reset_player_object()
 }
 
 
+//	------------------------------------------------------------------------------------------------------------------
+//	Objects hashed by signature, for finding the object with a signature without looking at all of them.
+//	obj_link() files an object under its signature and obj_free() takes it out, anything that gives a
+//	linked object a new signature calls obj_sig_update(). Lookups check the signature and type of what
+//	they find, so an entry left behind by an object overwritten some other way is harmless.
+#define	OBJ_SIG_BUCKETS		1024		//	signatures are handed out in order, so the low bits spread them
+
+static short Obj_sig_head[OBJ_SIG_BUCKETS];
+static short Obj_sig_next[MAX_OBJECTS], Obj_sig_prev[MAX_OBJECTS];
+static short Obj_sig_bucket[MAX_OBJECTS];	//	-1 if not filed
+static int Obj_sig_key[MAX_OBJECTS];
+
+static void obj_sig_clear(void)
+{
+	memset(Obj_sig_head, -1, sizeof(Obj_sig_head));
+	memset(Obj_sig_bucket, -1, sizeof(Obj_sig_bucket));
+}
+
+void obj_sig_remove(int objnum)
+{
+	int	b = Obj_sig_bucket[objnum];
+
+	if (b == -1)
+		return;
+	if (Obj_sig_prev[objnum] == -1)
+		Obj_sig_head[b] = Obj_sig_next[objnum];
+	else
+		Obj_sig_next[Obj_sig_prev[objnum]] = Obj_sig_next[objnum];
+	if (Obj_sig_next[objnum] != -1)
+		Obj_sig_prev[Obj_sig_next[objnum]] = Obj_sig_prev[objnum];
+	Obj_sig_bucket[objnum] = -1;
+}
+
+//	file an object under its current signature
+void obj_sig_update(int objnum)
+{
+	int	sig = Objects[objnum].signature, b;
+
+	if (Obj_sig_bucket[objnum] != -1) {
+		if (Obj_sig_key[objnum] == sig)
+			return;
+		obj_sig_remove(objnum);
+	}
+
+	b = sig & (OBJ_SIG_BUCKETS-1);
+	Obj_sig_key[objnum] = sig;
+	Obj_sig_bucket[objnum] = b;
+	Obj_sig_prev[objnum] = -1;
+	Obj_sig_next[objnum] = Obj_sig_head[b];
+	if (Obj_sig_head[b] != -1)
+		Obj_sig_prev[Obj_sig_head[b]] = objnum;
+	Obj_sig_head[b] = objnum;
+}
+
+//	Get the object with the given signature, the lowest numbered one if there are several, just like a
+//	loop over all objects would. Returns -1 if there is none.
+int obj_find_signature(int signature)
+{
+	int	objnum, found = -1;
+
+	for (objnum=Obj_sig_head[signature & (OBJ_SIG_BUCKETS-1)]; objnum!=-1; objnum=Obj_sig_next[objnum])
+		if (Objects[objnum].signature == signature && Objects[objnum].type != OBJ_NONE && (found == -1 || objnum < found))
+			found = objnum;
+
+	return found;
+}
+
 //make object0 the player, setting all relevant fields
 void init_player_object()
 {
@@ -807,6 +874,7 @@ void init_objects()
 	int i;
 
 	collide_init();
+	obj_sig_clear();
 
 	for (i=0;i<MAX_OBJECTS;i++) {
 		free_obj_list[i] = i;
@@ -993,6 +1061,8 @@ void obj_link(int objnum,int segnum)
 	Assert(Objects[0].prev != 0);
 	if (Objects[0].prev == 0)
 		Objects[0].prev = -1;
+
+	obj_sig_update(objnum);
 }
 
 void obj_unlink(int objnum)
@@ -1081,6 +1151,7 @@ void obj_free(int objnum)
 {
 	free_obj_list[--num_objects] = objnum;
 	Assert(num_objects >= 0);
+	obj_sig_remove(objnum);
 
 	if (objnum == Highest_object_index)
 		while (Objects[--Highest_object_index].type == OBJ_NONE);
@@ -1306,6 +1377,7 @@ int obj_create_copy(int objnum, vms_vector *new_pos, int newsegnum)
 	obj_link(newobjnum,newsegnum);
 
 	obj->signature				= obj_get_signature();
+	obj_sig_update(newobjnum);
 
 	//we probably should initialize sub-structures here
 
@@ -1990,6 +2062,7 @@ void reset_objects(int n_objs)
 
 	for (i=num_objects;i<MAX_OBJECTS;i++) {
 		free_obj_list[i] = i;
+		obj_sig_remove(i);
 		Objects[i].type = OBJ_NONE;
 		Objects[i].segnum = -1;
 	}
@@ -415,6 +415,13 @@ void obj_link(int objnum,int segnum);
 // unlinks an object from a segment's list of objects
 void obj_unlink(int objnum);
 
+// keep the signature index up to date, obj_link() and obj_free() do it
+void obj_sig_update(int objnum);
+void obj_sig_remove(int objnum);
+
+// get the lowest numbered object with the given signature, or -1. does not look at all objects
+int obj_find_signature(int signature);
+
 // initialize a new object.  adds to the list for the given segment
 // returns the object number
 int obj_create(enum object_type_t type, ubyte id, int segnum, vms_vector *pos,
@@ -31,6 +31,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "bm.h"
 #include "hash.h"
 #include "args.h"
+#include "profile.h"
 #include "palette.h"
 #include "gamefont.h"
 #include "rle.h"
@@ -630,6 +631,7 @@ void piggy_bitmap_page_in( bitmap_index bitmap )
 
 	if ( bmp->bm_flags & BM_FLAG_PAGED_OUT ) {
 		stop_time();
+		PROF_BEGIN(PROF_PAGE_IN);
 
 	ReDoIt:
 		descent_critical_error = 0;
@@ -696,6 +698,7 @@ void piggy_bitmap_page_in( bitmap_index bitmap )
 
 		compute_average_rgb(bmp, bmp->avg_color_rgb);
 
+		PROF_END(PROF_PAGE_IN);
 		start_time();
 	}
 
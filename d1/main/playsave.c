@@ -1378,6 +1378,98 @@ void read_netgame_profile(netgame_info *ng)
 	read_netgame_settings_file(filename, ng, 0);
 }
 
+// set one netgame setting, as written in a ngp or preset file. Returns 0 if token is unknown.
+int netgame_setting_set(netgame_info *ng, const char *token, const char *value, int no_name)
+{
+	if (!strcmp(token, "game_name") && !no_name)
+	{
+		char * p;
+		strncpy( ng->game_name, value, NETGAME_NAME_LEN+1 );
+		p = strchr( ng->game_name, '\n');
+		if ( p ) *p = 0;
+	}
+	else if (!strcmp(token, "gamemode"))
+		ng->gamemode = strtol(value, NULL, 10);
+	else if (!strcmp(token, "RefusePlayers"))
+		ng->RefusePlayers = strtol(value, NULL, 10);
+	else if (!strcmp(token, "difficulty"))
+		ng->difficulty = strtol(value, NULL, 10);
+	else if (!strcmp(token, "max_numplayers"))
+		ng->max_numplayers = strtol(value, NULL, 10);
+	else if (!strcmp(token, "max_numobservers"))
+		ng->max_numobservers = strtol(value, NULL, 10);			
+	else if (!strcmp(token, "game_flags"))
+		ng->game_flags = strtol(value, NULL, 10);
+	else if (!strcmp(token, "AllowedItems"))
+		ng->AllowedItems = strtol(value, NULL, 10);
+	else if (!strcmp(token, "ShowEnemyNames"))
+		ng->ShowEnemyNames = strtol(value, NULL, 10);
+	else if (!strcmp(token, "BrightPlayers"))
+		ng->BrightPlayers = strtol(value, NULL, 10);
+	else if (!strcmp(token, "SpawnStyle"))
+		ng->SpawnStyle = strtol(value, NULL, 10);
+	else if (!strcmp(token, "NewSpawnAlgorithm"))
+		ng->NewSpawnAlgorithm = strtol(value, NULL, 10);
+	else if (!strcmp(token, "GaussAmmoStyle"))
+		ng->GaussAmmoStyle = strtol(value, NULL, 10);
+	else if (!strcmp(token, "KillGoal"))
+		ng->KillGoal = strtol(value, NULL, 10);
+	else if (!strcmp(token, "PlayTimeAllowed"))
+		ng->PlayTimeAllowed = strtol(value, NULL, 10);
+	else if (!strcmp(token, "control_invul_time"))
+		ng->control_invul_time = strtol(value, NULL, 10);
+	else if (!strcmp(token, "PacketsPerSec"))
+		ng->PacketsPerSec = strtol(value, NULL, 10);
+	else if (!strcmp(token, "ShortPackets"))
+		ng->ShortPackets = strtol(value, NULL, 10);
+	else if (!strcmp(token, "NoFriendlyFire"))
+		ng->NoFriendlyFire = strtol(value, NULL, 10);
+	else if (!strcmp(token, "RetroProtocol"))
+		ng->RetroProtocol = strtol(value, NULL, 10);
+	else if (!strcmp(token, "DeltaPackets"))
+		ng->DeltaPackets = strtol(value, NULL, 10);
+	else if (!strcmp(token, "RespawnConcs"))
+		ng->RespawnConcs = strtol(value, NULL, 10);	
+	//else if (!strcmp(token, "DarkSmartBlobs"))
+	//	ng->DarkSmartBlobs = strtol(value, NULL, 10);
+	else if (!strcmp(token, "LowVulcan"))
+		ng->LowVulcan = strtol(value, NULL, 10);
+	else if (!strcmp(token, "AllowPreferredColors"))
+		ng->AllowPreferredColors = strtol(value, NULL, 10);		
+	else if (!strcmp(token, "AllowColoredLighting"))
+		ng->AllowColoredLighting = strtol(value, NULL, 10);			
+	else if (!strcmp(token, "FairColors"))
+		ng->FairColors = strtol(value, NULL, 10);	
+	else if (!strcmp(token, "BlackAndWhitePyros"))
+		ng->BlackAndWhitePyros = strtol(value, NULL, 10);		
+	else if (!strcmp(token, "PrimaryDupFactor"))
+		ng->PrimaryDupFactor = strtol(value, NULL, 10);
+	else if (!strcmp(token, "SecondaryDupFactor"))
+		ng->SecondaryDupFactor = strtol(value, NULL, 10);
+	else if (!strcmp(token, "SecondaryCapFactor"))
+		ng->SecondaryCapFactor = strtol(value, NULL, 10);
+	else if (!strcmp(token, "obs_delay"))
+		ng->obs_delay = strtol(value, NULL, 10);																	
+	else if (!strcmp(token, "obs_min"))
+		ng->obs_min = strtol(value, NULL, 10);
+	else if (!strcmp(token, "HomingUpdateRate"))
+		ng->HomingUpdateRate = strtol(value, NULL, 10);
+	else if (!strcmp(token, "RemoteHitSpark"))
+		ng->RemoteHitSpark = strtol(value, NULL, 10);
+	else if (!strcmp(token, "AllowCustomModelsTextures"))
+		ng->AllowCustomModelsTextures = strtol(value, NULL, 10);
+	else if (!strcmp(token, "ReducedFlash"))
+		ng->ReducedFlash = strtol(value, NULL, 10);
+#ifdef USE_TRACKER
+	else if (!strcmp(token, "Tracker"))
+		ng->Tracker = strtol(value, NULL, 10);
+#endif
+	else
+		return 0;
+
+	return 1;
+}
+
 // returns 0 if ok or errno if failed
 int read_netgame_settings_file(const char *filename, netgame_info *ng, int no_name)
 {
@@ -1403,87 +1495,7 @@ int read_netgame_settings_file(const char *filename, netgame_info *ng, int no_na
 			value = strtok(NULL, "=");
 			if (!value)
 				value = "";
-			if (!strcmp(token, "game_name") && !no_name)
-			{
-				char * p;
-				strncpy( ng->game_name, value, NETGAME_NAME_LEN+1 );
-				p = strchr( ng->game_name, '\n');
-				if ( p ) *p = 0;
-			}
-			else if (!strcmp(token, "gamemode"))
-				ng->gamemode = strtol(value, NULL, 10);
-			else if (!strcmp(token, "RefusePlayers"))
-				ng->RefusePlayers = strtol(value, NULL, 10);
-			else if (!strcmp(token, "difficulty"))
-				ng->difficulty = strtol(value, NULL, 10);
-			else if (!strcmp(token, "max_numplayers"))
-				ng->max_numplayers = strtol(value, NULL, 10);
-			else if (!strcmp(token, "max_numobservers"))
-				ng->max_numobservers = strtol(value, NULL, 10);			
-			else if (!strcmp(token, "game_flags"))
-				ng->game_flags = strtol(value, NULL, 10);
-			else if (!strcmp(token, "AllowedItems"))
-				ng->AllowedItems = strtol(value, NULL, 10);
-			else if (!strcmp(token, "ShowEnemyNames"))
-				ng->ShowEnemyNames = strtol(value, NULL, 10);
-			else if (!strcmp(token, "BrightPlayers"))
-				ng->BrightPlayers = strtol(value, NULL, 10);
-			else if (!strcmp(token, "SpawnStyle"))
-				ng->SpawnStyle = strtol(value, NULL, 10);
-			else if (!strcmp(token, "NewSpawnAlgorithm"))
-				ng->NewSpawnAlgorithm = strtol(value, NULL, 10);
-			else if (!strcmp(token, "GaussAmmoStyle"))
-				ng->GaussAmmoStyle = strtol(value, NULL, 10);
-			else if (!strcmp(token, "KillGoal"))
-				ng->KillGoal = strtol(value, NULL, 10);
-			else if (!strcmp(token, "PlayTimeAllowed"))
-				ng->PlayTimeAllowed = strtol(value, NULL, 10);
-			else if (!strcmp(token, "control_invul_time"))
-				ng->control_invul_time = strtol(value, NULL, 10);
-			else if (!strcmp(token, "PacketsPerSec"))
-				ng->PacketsPerSec = strtol(value, NULL, 10);
-			else if (!strcmp(token, "ShortPackets"))
-				ng->ShortPackets = strtol(value, NULL, 10);
-			else if (!strcmp(token, "NoFriendlyFire"))
-				ng->NoFriendlyFire = strtol(value, NULL, 10);
-			else if (!strcmp(token, "RetroProtocol"))
-				ng->RetroProtocol = strtol(value, NULL, 10);
-			else if (!strcmp(token, "RespawnConcs"))
-				ng->RespawnConcs = strtol(value, NULL, 10);	
-			//else if (!strcmp(token, "DarkSmartBlobs"))
-			//	ng->DarkSmartBlobs = strtol(value, NULL, 10);
-			else if (!strcmp(token, "LowVulcan"))
-				ng->LowVulcan = strtol(value, NULL, 10);
-			else if (!strcmp(token, "AllowPreferredColors"))
-				ng->AllowPreferredColors = strtol(value, NULL, 10);		
-			else if (!strcmp(token, "AllowColoredLighting"))
-				ng->AllowColoredLighting = strtol(value, NULL, 10);			
-			else if (!strcmp(token, "FairColors"))
-				ng->FairColors = strtol(value, NULL, 10);	
-			else if (!strcmp(token, "BlackAndWhitePyros"))
-				ng->BlackAndWhitePyros = strtol(value, NULL, 10);		
-			else if (!strcmp(token, "PrimaryDupFactor"))
-				ng->PrimaryDupFactor = strtol(value, NULL, 10);
-			else if (!strcmp(token, "SecondaryDupFactor"))
-				ng->SecondaryDupFactor = strtol(value, NULL, 10);
-			else if (!strcmp(token, "SecondaryCapFactor"))
-				ng->SecondaryCapFactor = strtol(value, NULL, 10);
-			else if (!strcmp(token, "obs_delay"))
-				ng->obs_delay = strtol(value, NULL, 10);																	
-			else if (!strcmp(token, "obs_min"))
-				ng->obs_min = strtol(value, NULL, 10);
-			else if (!strcmp(token, "HomingUpdateRate"))
-				ng->HomingUpdateRate = strtol(value, NULL, 10);
-			else if (!strcmp(token, "RemoteHitSpark"))
-				ng->RemoteHitSpark = strtol(value, NULL, 10);
-			else if (!strcmp(token, "AllowCustomModelsTextures"))
-				ng->AllowCustomModelsTextures = strtol(value, NULL, 10);
-			else if (!strcmp(token, "ReducedFlash"))
-				ng->ReducedFlash = strtol(value, NULL, 10);
-#ifdef USE_TRACKER
-			else if (!strcmp(token, "Tracker"))
-				ng->Tracker = strtol(value, NULL, 10);
-#endif
+			netgame_setting_set(ng, token, value, no_name);
 		}
 	}
 
@@ -1534,6 +1546,7 @@ int write_netgame_settings_file(const char *filename, netgame_info *ng, int no_n
 	PHYSFSX_printf(file, "ShortPackets=%i\n", ng->ShortPackets);
 	PHYSFSX_printf(file, "NoFriendlyFire=%i\n", ng->NoFriendlyFire);
 	PHYSFSX_printf(file, "RetroProtocol=%i\n", ng->RetroProtocol);
+	PHYSFSX_printf(file, "DeltaPackets=%i\n", ng->DeltaPackets);
 	PHYSFSX_printf(file, "RespawnConcs=%i\n", ng->RespawnConcs);
 	//PHYSFSX_printf(file, "DarkSmartBlobs=%i\n", ng->DarkSmartBlobs);
 	PHYSFSX_printf(file, "LowVulcan=%i\n", ng->LowVulcan);
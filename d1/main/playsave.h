@@ -167,6 +167,7 @@ void read_netgame_profile(netgame_info *ng);
 void write_netgame_profile(netgame_info *ng);
 
 int read_netgame_settings_file(const char *filename, netgame_info *ng, int no_name);
+int netgame_setting_set(netgame_info *ng, const char *token, const char *value, int no_name);
 int write_netgame_settings_file(const char *filename, netgame_info *ng, int no_name);
 
 #endif
@@ -0,0 +1,47 @@
+/*
+ *
+ * Frame profiler.
+ *
+ */
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+// zones, see prof_zone_names in profile.c
+#define PROF_GAME		0	// GameProcessFrame()
+#define PROF_OBJECTS		1	// object_move_all()
+#define PROF_AI			2	// do_ai_frame_all()
+#define PROF_SOUNDS		3	// digi_sync_sounds()
+#define PROF_MULTI		4	// multi_do_frame()
+#define PROF_NET		5	// net_udp_do_frame()
+#define PROF_RENDER		6	// render_frame()
+#define PROF_SEGLIST		7	// build_segment_list()
+#define PROF_LIGHTING		8	// set_dynamic_light()
+#define PROF_PAGE_IN		9	// piggy_bitmap_page_in() reading a bitmap from the pig file
+#define PROF_TEXTURE		10	// ogl_loadtexture()
+#define PROF_UDP_SEND		11	// udp thread sending the queued datagrams
+#define PROF_UDP_RECV		12	// udp thread reading the sockets
+#define PROF_ZONES		13
+
+// Mark the start and end of a zone. Zones nest and must end in the order they started, on the thread that started
+// them. Costs a test of Profile_enabled when -profile is not given.
+#define PROF_BEGIN(zone) do { if (Profile_enabled) prof_begin(zone); } while (0)
+#define PROF_END(zone) do { if (Profile_enabled) prof_end(zone); } while (0)
+
+typedef struct prof_stat
+{
+	const char *name;
+	double avg_ms, max_ms; // per frame, over the last second
+} prof_stat;
+
+extern int Profile_enabled, Profile_overlay;
+
+void prof_init(void);
+void prof_thread_name(const char *name);
+void prof_begin(int zone);
+void prof_end(int zone);
+void prof_frame(void);
+int prof_get_stats(prof_stat *frame, prof_stat *top, int n);
+const char *prof_write_trace(void);
+
+#endif
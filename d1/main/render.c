@@ -55,6 +55,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "ogl_init.h"
 #endif
 #include "args.h"
+#include "profile.h"
 
 #define INITIAL_LOCAL_LIGHT (F1_0/4)    // local light value in segment of occurence (of light emission)
 
@@ -1371,6 +1372,8 @@ void render_frame(fix eye_offset)
 		return;
 	}
 
+	PROF_BEGIN(PROF_RENDER);
+
 	if ( Newdemo_state == ND_STATE_RECORDING )	{
 		if (eye_offset >= 0 )	{
 			newdemo_record_start_frame(FrameTime );
@@ -1432,6 +1435,7 @@ void render_frame(fix eye_offset)
 	render_mine(start_seg_num,eye_offset);
 
 	g3_end_frame();
+	PROF_END(PROF_RENDER);
 }
 
 int first_terminal_seg;
@@ -1675,7 +1679,9 @@ void render_mine(int start_seg_num,fix eye_offset)
 	else
 	#endif
 		//NOTE LINK TO ABOVE!!
+		PROF_BEGIN(PROF_SEGLIST);
 		build_segment_list(start_seg_num);		//fills in Render_list & N_render_segs
+		PROF_END(PROF_SEGLIST);
 
 	//render away
 
@@ -1704,7 +1710,9 @@ void render_mine(int start_seg_num,fix eye_offset)
 		build_object_lists(N_render_segs);
 
 	if (eye_offset<=0) // Do for left eye or zero.
+		PROF_BEGIN(PROF_LIGHTING);
 		set_dynamic_light();
+		PROF_END(PROF_LIGHTING);
 
 	if (!_search_mode && Clear_window == 2) {
 		if (first_terminal_seg < N_render_segs) {
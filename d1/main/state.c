@@ -676,7 +676,6 @@ int state_save_old_game(int slotnum, char * sg_name, player_rw * sg_player,
 	PHYSFS_file * fp;
 #ifdef OGL
 	int j;
-	GLint gl_draw_buffer;
 #endif
 
 	snprintf( filename, PATH_MAX, (GameArg.SysUsePlayersDir?"Players/%s.sg%d":"%s.sg%d"), sg_player->callsign, slotnum );
@@ -712,8 +711,7 @@ int state_save_old_game(int slotnum, char * sg_name, player_rw * sg_player,
 #ifdef OGL
 		buf = d_malloc(THUMBNAIL_W * THUMBNAIL_H * 4);
 #ifndef OGLES
- 		glGetIntegerv(GL_DRAW_BUFFER, &gl_draw_buffer);
- 		glReadBuffer(gl_draw_buffer);
+ 		ogl_state_read_buffer(ogl_state_get_draw_buffer());
 #endif
 		glReadPixels(0, SHEIGHT - THUMBNAIL_H, THUMBNAIL_W, THUMBNAIL_H, GL_RGBA, GL_UNSIGNED_BYTE, buf);
 		k = THUMBNAIL_H;
@@ -823,9 +821,6 @@ int state_save_all_sub(char *filename, char *desc)
 	PHYSFS_file *fp;
 	grs_canvas * cnv;
 	char mission_filename[9];
-#ifdef OGL
-	GLint gl_draw_buffer;
-#endif
 	fix tmptime32 = 0;
 
 	#ifndef NDEBUG
@@ -876,8 +871,7 @@ int state_save_all_sub(char *filename, char *desc)
 #if defined(OGL)
 		buf = d_malloc(THUMBNAIL_W * THUMBNAIL_H * 4);
 #ifndef OGLES
- 		glGetIntegerv(GL_DRAW_BUFFER, &gl_draw_buffer);
- 		glReadBuffer(gl_draw_buffer);
+ 		ogl_state_read_buffer(ogl_state_get_draw_buffer());
 #endif
 		glReadPixels(0, SHEIGHT - THUMBNAIL_H, THUMBNAIL_W, THUMBNAIL_H, GL_RGBA, GL_UNSIGNED_BYTE, buf);
 		k = THUMBNAIL_H;
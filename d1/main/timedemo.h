@@ -0,0 +1,22 @@
+/*
+ *
+ * Timedemo benchmark.
+ *
+ */
+
+#ifndef _TIMEDEMO_H
+#define _TIMEDEMO_H
+
+// where a frame spends its time
+#define TIMEDEMO_DEMO		0	// reading the recorded frame
+#define TIMEDEMO_GAME		1	// the rest of GameProcessFrame()
+#define TIMEDEMO_RENDER		2	// game_render_frame()
+#define TIMEDEMO_PRESENT	3	// flipping, events and anything else until the next frame
+#define TIMEDEMO_STAGES		4
+
+void timedemo_start(void);
+void timedemo_frame(void);
+void timedemo_stage(int stage);
+void timedemo_report(void);
+
+#endif
@@ -0,0 +1,70 @@
+#!/bin/sh
+#
+# jointime.sh - time players joining a game over loopback
+#
+# Starts a dedicated host and lets headless players join it one after the
+# other with -udp_join. Every player stays, so each one joins a fuller game
+# than the one before. At the end the join times the players reported are
+# printed, together with the snapshot size when the host sent one.
+#
+# usage: jointime.sh <game> [players] [host options]
+#
+#   jointime.sh ./d1x-redux 7                  objects sent the old way
+#   jointime.sh ./d1x-redux 7 -udp_snapshot    objects sent as a snapshot
+#
+# Options for every instance, such as -hogdir, go into GAMEARGS. The host
+# listens on PORT (default 42424), the players on the ports after it.
+#
+# This program is licensed under the terms of the GPL, version 2 or later
+
+game=$1
+players=${2:-4}
+if [ -z "$game" ]; then
+	echo "usage: $0 <game> [players] [host options]"
+	exit 1
+fi
+shift
+[ $# -gt 0 ] && shift
+port=${PORT:-42424}
+tmp=$(mktemp -d)
+pids=
+trap 'exec 3>&-; kill $pids 2>/dev/null; rm -rf "$tmp"' EXIT
+
+# wait_for <file> <text> <seconds>
+wait_for()
+{
+	n=0
+	while ! grep -q "$2" "$1" 2>/dev/null; do
+		[ $n -ge $3 ] && return 1
+		sleep 1
+		n=$((n + 1))
+	done
+}
+
+# the host reads commands from the pipe until it gets quit
+mkfifo "$tmp/cmd"
+$game $GAMEARGS -dedicated -udp_myport $port -verbose "$@" < "$tmp/cmd" > "$tmp/host.log" 2>&1 &
+pids=$!
+exec 3> "$tmp/cmd"
+if ! wait_for "$tmp/host.log" "^Hosting" 60; then
+	echo "the host did not start a game:"
+	tail "$tmp/host.log"
+	exit 1
+fi
+
+i=1
+while [ $i -le $players ]; do
+	$game $GAMEARGS -headless -udp_join -udp_hostaddr 127.0.0.1 -udp_hostport $port -udp_myport $((port + i)) -pilot join$i -verbose > "$tmp/player$i.log" 2>&1 &
+	pids="$pids $!"
+	if wait_for "$tmp/player$i.log" "^Joined in" 60; then
+		printf "player %i: %s" $i "$(grep -o "^Joined in [0-9]* ms" "$tmp/player$i.log")"
+		grep -o "^Got snapshot: .*bytes" "$tmp/player$i.log" | sed 's/^Got snapshot:/, snapshot/' | tr -d '\n'
+		echo
+	else
+		echo "player $i: did not join within 60 seconds"
+	fi
+	i=$((i + 1))
+done
+
+echo quit >&3
+cat "$tmp"/player*.log | grep -o "^Joined in [0-9]*" | awk '{ n++; t += $3; if ($3 > max) max = $3 } END { if (n) printf("%i joins, %.0f ms average, %i ms max\n", n, t / n, max) }'
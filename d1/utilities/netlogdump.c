@@ -0,0 +1,126 @@
+/*
+ * netlogdump - prints the network traffic captured with -netlog or
+ * -netlog_crash, one packet per entry, the way netlog.txt used to look.
+ *
+ * This program is licensed under the terms of the GPL, version 2 or later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net_udp.h"
+
+typedef struct capture
+{
+	FILE *f;
+	int swap;
+} capture;
+
+static unsigned int get32(capture *c, const unsigned char *p)
+{
+	if (c->swap)
+		return p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+	return p[3] << 24 | p[2] << 16 | p[1] << 8 | p[0];
+}
+
+static void print_address(const unsigned char *hdr)
+{
+	int port = hdr[2] << 8 | hdr[3], i;
+
+	if (hdr[1] == 4)
+		printf("%i.%i.%i.%i:%i", hdr[4], hdr[5], hdr[6], hdr[7], port);
+	else if (hdr[1] == 6)
+	{
+		printf("[");
+		for (i = 0; i < 16; i += 2)
+			printf(i ? ":%x" : "%x", hdr[4 + i] << 8 | hdr[5 + i]);
+		printf("]:%i", port);
+	}
+	else
+		printf("?");
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char head[24], rec[16], data[65536];
+	unsigned int sec, usec, len, first_sec = 0, first_usec = 0, n = 0;
+	long t;
+	int nodata = 0, i;
+	const char *name = NULL;
+	capture c;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-nodata"))
+			nodata = 1;
+		else
+			name = argv[i];
+	}
+	if (!name)
+	{
+		printf("Usage: netlogdump [-nodata] file.pcap\n");
+		return 1;
+	}
+
+	if (!(c.f = fopen(name, "rb")))
+	{
+		perror(name);
+		return 1;
+	}
+	if (fread(head, sizeof(head), 1, c.f) != 1)
+	{
+		fprintf(stderr, "%s: not a capture\n", name);
+		return 1;
+	}
+	c.swap = 0;
+	if (get32(&c, head) != 0xa1b2c3d4)
+		c.swap = 1;
+	if (get32(&c, head) != 0xa1b2c3d4 || get32(&c, head + 20) != NETLOG_LINKTYPE)
+	{
+		fprintf(stderr, "%s: not a capture from -netlog\n", name);
+		return 1;
+	}
+
+	while (fread(rec, sizeof(rec), 1, c.f) == 1)
+	{
+		sec = get32(&c, rec);
+		usec = get32(&c, rec + 4);
+		len = get32(&c, rec + 8);
+		if (len < NETLOG_HDR_SIZE || len > sizeof(data) || fread(data, len, 1, c.f) != 1)
+		{
+			fprintf(stderr, "%s: truncated after %u packets\n", name, n);
+			break;
+		}
+		if (!n++)
+		{
+			first_sec = sec;
+			first_usec = usec;
+		}
+		t = (long)(sec - first_sec) * 1000000L + (long)usec - (long)first_usec;
+		len -= NETLOG_HDR_SIZE;
+
+		printf("%ld.%06ld ", t / 1000000L, t % 1000000L);
+		if (data[0] == NETLOG_NOTE)
+		{
+			while (len && data[NETLOG_HDR_SIZE + len - 1] == '\n')
+				len--;
+			printf("%.*s\n", (int)len, (char *)data + NETLOG_HDR_SIZE);
+			continue;
+		}
+
+		printf("%s %u bytes  ", data[0] == NETLOG_TX ? "Tx" : "Rx", len);
+		print_address(data);
+		if (len)
+			printf("  %s (%i)", msg_name(data[NETLOG_HDR_SIZE]), data[NETLOG_HDR_SIZE]);
+		printf("\n");
+		if (nodata)
+			continue;
+		for (i = 0; i < (int)len; i++)
+			printf("%03d ", data[NETLOG_HDR_SIZE + i]);
+		printf("\n");
+	}
+
+	fclose(c.f);
+	return 0;
+}
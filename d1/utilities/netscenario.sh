@@ -0,0 +1,125 @@
+#!/bin/sh
+#
+# netscenario.sh - play a game over a bad connection and sum up how it went
+#
+# Starts a dedicated host, udpproxy in front of it and headless players
+# joining through the proxy. The proxy runs a scenario and quits at its end,
+# then the packets resent, the packets waiting for ACKs and the bandwidth are
+# printed, for the whole game as the proxy saw it and for each player from
+# what the player itself counted.
+#
+# usage: netscenario.sh <game> <udpproxy> [scenario] [players] [host options]
+#
+#   netscenario.sh ./d1x-redux ./udpproxy                 4 players, 5% loss
+#   netscenario.sh ./d1x-redux ./udpproxy lag 8
+#   netscenario.sh ./d1x-redux ./udpproxy mine.txt 2 -udp_snapshot
+#
+# The scenario is one of the ones below or a udpproxy -script file:
+#
+#   loss5     5% loss for a minute
+#   loss20    20% loss for a minute
+#   lag       150 ms latency and 50 ms jitter for a minute
+#   reorder   10% reordered and 5% duplicated packets for a minute
+#   mixed     half a minute at 5% loss, then another one with added lag
+#
+# Options for every instance, such as -hogdir, go into GAMEARGS. The host
+# listens on PORT (default 42424), the proxy on the port after it and the
+# players on the ports after that.
+#
+# This program is licensed under the terms of the GPL, version 2 or later
+
+game=$1
+proxy=$2
+scenario=${3:-loss5}
+players=${4:-4}
+if [ -z "$game" ] || [ -z "$proxy" ]; then
+	echo "usage: $0 <game> <udpproxy> [scenario] [players] [host options]"
+	exit 1
+fi
+shift 2
+[ $# -gt 0 ] && shift
+[ $# -gt 0 ] && shift
+port=${PORT:-42424}
+tmp=$(mktemp -d)
+pids=
+trap 'exec 3>&-; kill $pids 2>/dev/null; rm -rf "$tmp"' EXIT
+
+case $scenario in
+loss5)
+	printf "0 loss 5\n60 end\n" > "$tmp/script" ;;
+loss20)
+	printf "0 loss 20\n60 end\n" > "$tmp/script" ;;
+lag)
+	printf "0 latency 150\n0 jitter 50\n60 end\n" > "$tmp/script" ;;
+reorder)
+	printf "0 reorder 10\n0 dup 5\n60 end\n" > "$tmp/script" ;;
+mixed)
+	printf "0 loss 5\n30 latency 150\n30 jitter 50\n60 end\n" > "$tmp/script" ;;
+*)
+	if [ ! -f "$scenario" ]; then
+		echo "no scenario $scenario"
+		exit 1
+	fi
+	cp "$scenario" "$tmp/script" ;;
+esac
+
+# wait_for <file> <text> <seconds>
+wait_for()
+{
+	n=0
+	while ! grep -q "$2" "$1" 2>/dev/null; do
+		[ $n -ge $3 ] && return 1
+		sleep 1
+		n=$((n + 1))
+	done
+}
+
+# the host reads commands from the pipe until it gets quit
+mkfifo "$tmp/cmd"
+$game $GAMEARGS -dedicated -udp_myport $port -verbose "$@" < "$tmp/cmd" > "$tmp/host.log" 2>&1 &
+pids=$!
+exec 3> "$tmp/cmd"
+if ! wait_for "$tmp/host.log" "^Hosting" 60; then
+	echo "the host did not start a game:"
+	tail "$tmp/host.log"
+	exit 1
+fi
+
+# the scenario clock starts now, so the players join under it as well
+$proxy -port $((port + 1)) -host 127.0.0.1 $port -script "$tmp/script" -interval 0 > "$tmp/proxy.log" 2>&1 &
+proxypid=$!
+pids="$pids $proxypid"
+
+i=1
+while [ $i -le $players ]; do
+	$game $GAMEARGS -headless -udp_join -udp_hostaddr 127.0.0.1 -udp_hostport $((port + 1)) -udp_myport $((port + 1 + i)) -pilot net$i -verbose > "$tmp/player$i.log" 2>&1 &
+	pids="$pids $!"
+	i=$((i + 1))
+done
+
+wait $proxypid
+echo quit >&3
+
+echo "scenario $scenario, $players players"
+echo
+# the last table the proxy printed, then its totals
+awk '/^type/ { table = "" } { table = table $0 "\n" } END { printf("%s", table) }' "$tmp/proxy.log"
+echo
+
+i=1
+while [ $i -le $players ]; do
+	if ! grep -q "^Joined in" "$tmp/player$i.log"; then
+		echo "player $i: did not join"
+	else
+		# per second lines from the game: P#n TRAFFIC - OUT: x.xKB/s ... and P#n PLP - QUEUED: n OBS QUEUED: n RESENT: n/s
+		awk -v i=$i '
+			/ TRAFFIC - OUT:/ { s = $0; sub(/.*OUT: /, "", s); out += s + 0; s = $0; sub(/.*IN: /, "", s); in_ += s + 0; t++ }
+			/ PLP - QUEUED:/ { q = $5 + 0; sum += q; if (q > max) max = q; resent += $10 + 0; n++ }
+			END {
+				printf("player %i: %i resent, %.1f queued average, %i max", i, resent, n ? sum / n : 0, max)
+				printf(", %.1f kB/s out, %.1f kB/s in\n", t ? out / t : 0, t ? in_ / t : 0)
+			}' "$tmp/player$i.log"
+	fi
+	i=$((i + 1))
+done
+awk '/ PLP - QUEUED:/ { q = $5 + 0; if (q > max) max = q; resent += $10 + 0 } END { printf("host: %i resent, %i queued max\n", resent, max) }' "$tmp/host.log"
@@ -56,7 +56,7 @@ int xmodel_load_gl(void *model) {
 		CBitmap& bm = rm.m.m_textures.m_bitmaps[i];
 		if (!bm.Width() || (!rm.bmvertcount[i] && !bm.Team()))
 			continue;
-		glBindTexture(GL_TEXTURE_2D, rm.bmtex[i]);
+		ogl_state_bind_texture(GL_TEXTURE_2D, rm.bmtex[i]);
 		if (bm.BPP() == 4)
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
 				bm.Width(), bm.Height(), 0, GL_RGBA, GL_UNSIGNED_BYTE,
@@ -85,6 +85,8 @@ void xmodel_free_gl(void *model) {
 	if (!rm.glloaded)
 		return;
 	glDeleteTextures(rm.m.m_textures.m_nBitmaps, rm.bmtex);
+	for (int i = 0; i < rm.m.m_textures.m_nBitmaps; i++)
+		ogl_state_forget_texture(rm.bmtex[i]);
 	memset(rm.bmtex, 0, rm.m.m_textures.m_nBitmaps * sizeof(rm.bmtex[0]));
 	glDeleteBuffers(1, &rm.vbo);
 	rm.vbo = 0;
@@ -177,7 +179,7 @@ void xmodel_show(void *model, int mpcolor, g3s_lrgb *light) {
 	int num_bitmaps = rm.m.m_textures.m_nBitmaps;
 
 	if (GameCfg.ClassicDepth && !(Game_mode & GM_MULTI))
-		glEnable(GL_DEPTH_TEST);
+		ogl_state_enable(GL_DEPTH_TEST);
 
 	float color_alpha;
 	if (tmap_drawer_ptr == draw_tmap_flat) { // cloaked effect
@@ -193,8 +195,8 @@ void xmodel_show(void *model, int mpcolor, g3s_lrgb *light) {
 	glBindBuffer(GL_ARRAY_BUFFER, rm.vbo);
 	glVertexPointer(3, GL_FLOAT, sizeof(vert), (void *)0);
 	glTexCoordPointer(2, GL_FLOAT, sizeof(vert), (void *)offsetof(vert, tex));
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 	int team = mpcolor == -1 ? 0 : mpcolor >= 7 ? 1 : mpcolor + 2;
 	for (int i = 0; i < num_bitmaps; i++) {
 		if (!rm.bmvertcount[i])
@@ -202,16 +204,16 @@ void xmodel_show(void *model, int mpcolor, g3s_lrgb *light) {
 		if (rm.m.m_textures.m_bitmaps[i].Team() && team && rm.m.m_textures.m_bitmaps[i].Team() != team) {
 			for (int j = 0; j < num_bitmaps; j++)
 				if (rm.m.m_textures.m_bitmaps[j].Team() == team)
-					glBindTexture(GL_TEXTURE_2D, rm.bmtex[j]);
+					ogl_state_bind_texture(GL_TEXTURE_2D, rm.bmtex[j]);
 		} else
-			glBindTexture(GL_TEXTURE_2D, rm.bmtex[i]);
+			ogl_state_bind_texture(GL_TEXTURE_2D, rm.bmtex[i]);
 		glDrawArrays(GL_TRIANGLES, rm.bmvertofs[i], rm.bmvertcount[i]);
 	}
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	if (GameCfg.ClassicDepth && !(Game_mode & GM_MULTI))
-		glDisable(GL_DEPTH_TEST);
+		ogl_state_disable(GL_DEPTH_TEST);
 }
 
 #if 0
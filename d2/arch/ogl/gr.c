@@ -570,8 +570,8 @@ int gr_toggle_fullscreen(void)
 #endif
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();//clear matrix
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		ogl_state_enable(GL_BLEND);
+		ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		ogl_smash_texture_list_internal();//if we are or were fullscreen, changing vid mode will invalidate current textures
 #ifdef OGL_MERGE
 		ogl_init_prog();
@@ -603,8 +603,8 @@ static void ogl_init_state(void)
 #endif
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();//clear matrix
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	ogl_state_enable(GL_BLEND);
+	ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	gr_palette_step_up(0,0,0);//in case its left over from in game
 
 	ogl_init_pixel_buffers(grd_curscreen->sc_w, grd_curscreen->sc_h);
@@ -614,7 +614,7 @@ static void ogl_init_state(void)
 void gr_set_draw_buffer(int buf)
 {
 #ifndef OGLES
-	glDrawBuffer((buf == 0) ? GL_FRONT : GL_BACK);
+	ogl_state_draw_buffer((buf == 0) ? GL_FRONT : GL_BACK);
 #endif
 }
 
@@ -856,9 +856,9 @@ void gr_set_attributes(void)
 	SDL_GL_SetAttribute(SDL_GL_ACCUM_ALPHA_SIZE,0);
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER,1);
 #if SDL_VERSION_ATLEAST(2, 0, 0)
-	SDL_GL_SetSwapInterval(GameCfg.VSync);
+	SDL_GL_SetSwapInterval(GameCfg.VSync && !GameArg.SysTimeDemo);
 #else
-	SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL,GameCfg.VSync);
+	SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL,GameCfg.VSync && !GameArg.SysTimeDemo); // the timedemo runs without VSync
 #endif
 	if (GameCfg.Multisample)
 	{
@@ -1017,23 +1017,21 @@ void ogl_upixelc(int x, int y, int c)
 	r_upixelc++;
 	OGL_DISABLE(TEXTURE_2D);
 	glPointSize(linedotscale);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glDrawArrays(GL_POINTS, 0, 1);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 }
 
 unsigned char ogl_ugpixel( grs_bitmap * bitmap, int x, int y )
 {
-	GLint gl_draw_buffer;
 	ubyte buf[4];
 
 #ifndef OGLES
-	glGetIntegerv(GL_DRAW_BUFFER, &gl_draw_buffer);
-	glReadBuffer(gl_draw_buffer);
+	ogl_state_read_buffer(ogl_state_get_draw_buffer());
 #endif
 
 	glReadPixels(bitmap->bm_x + x, SHEIGHT - bitmap->bm_y - y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, buf);
@@ -1048,8 +1046,8 @@ void ogl_urect(int left,int top,int right,int bot)
 	GLfloat vertex_array[] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
 	int c=COLOR;
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 
 	xo=(left+grd_curcanv->cv_bitmap.bm_x)/(float)last_width;
 	xf = (right + 1 + grd_curcanv->cv_bitmap.bm_x) / (float)last_width;
@@ -1084,7 +1082,7 @@ void ogl_urect(int left,int top,int right,int bot)
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
-	glDisableClientState(GL_VERTEX_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
 }
 
 void ogl_ulinec(int left,int top,int right,int bot,int c)
@@ -1093,8 +1091,8 @@ void ogl_ulinec(int left,int top,int right,int bot,int c)
 	GLfloat color_array[] = { CPAL2Tr(c), CPAL2Tg(c), CPAL2Tb(c), (grd_curcanv->cv_fade_level >= GR_FADE_OFF)?1.0:1.0 - (float)grd_curcanv->cv_fade_level / ((float)GR_FADE_LEVELS - 1.0), CPAL2Tr(c), CPAL2Tg(c), CPAL2Tb(c), (grd_curcanv->cv_fade_level >= GR_FADE_OFF)?1.0:1.0 - (float)grd_curcanv->cv_fade_level / ((float)GR_FADE_LEVELS - 1.0), CPAL2Tr(c), CPAL2Tg(c), CPAL2Tb(c), 1.0, CPAL2Tr(c), CPAL2Tg(c), CPAL2Tb(c), (grd_curcanv->cv_fade_level >= GR_FADE_OFF)?1.0:1.0 - (float)grd_curcanv->cv_fade_level / ((float)GR_FADE_LEVELS - 1.0) };
 	GLfloat vertex_array[] = { 0.0, 0.0, 0.0, 0.0 };
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	
 	xo = (left + grd_curcanv->cv_bitmap.bm_x + 0.5) / (float)last_width;
 	xf = (right + grd_curcanv->cv_bitmap.bm_x + 0.5) / (float)last_width;
@@ -1111,8 +1109,8 @@ void ogl_ulinec(int left,int top,int right,int bot,int c)
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glDrawArrays(GL_LINES, 0, 2);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 }
 
 GLfloat last_r=0, last_g=0, last_b=0;
@@ -1125,13 +1123,13 @@ void ogl_do_palfx(void)
 
 	OGL_DISABLE(TEXTURE_2D);
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
  
 	if (do_pal_step)
 	{
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_ONE,GL_ONE);
+		ogl_state_enable(GL_BLEND);
+		ogl_state_blend_func(GL_ONE, GL_ONE);
 	}
 	else
 		return;
@@ -1139,10 +1137,10 @@ void ogl_do_palfx(void)
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_enable(GL_BLEND);
+	ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 int ogl_brightness_ok = 0;
@@ -1325,7 +1323,7 @@ void save_screen_shot(int automap_flag)
 		HUD_init_message(HM_DEFAULT, "%s '%s'", TXT_DUMPING_SCREEN, savename + strlen(SCRNS_DIR));
 
 #ifndef OGLES
-	glReadBuffer(GL_FRONT);
+	ogl_state_read_buffer(GL_FRONT);
 #endif
 
 	write_bmp(savename,grd_curscreen->sc_w,grd_curscreen->sc_h);
@@ -56,6 +56,7 @@
 #include "gauges.h"
 #include "playsave.h"
 #include "args.h"
+#include "profile.h"
 #include "xmodel.h"
 #include "oglprog.h"
 #include "inferno.h"
@@ -83,7 +84,6 @@
 unsigned char *ogl_pal=gr_palette;
 
 int last_width=-1,last_height=-1;
-int GL_TEXTURE_2D_enabled=-1;
 int GL_texclamp_enabled=-1;
 GLfloat ogl_maxanisotropy = 0;
 
@@ -98,10 +98,10 @@ int ogl_rgb_internalformat = GL_RGB8;
 GLfloat *sphere_va = NULL, *circle_va = NULL, *disk_va = NULL;
 GLfloat *secondary_lva[3]={NULL, NULL, NULL};
 int r_polyc,r_tpolyc,r_bitmapc,r_ubitbltc,r_upixelc;
+int r_drawc,r_texbindc,r_batchfacec,r_batchc;
 extern int linedotscale;
 #define f2glf(x) (f2fl(x))
 
-#define OGL_BINDTEXTURE(a) glBindTexture(GL_TEXTURE_2D, a);
 
 
 ogl_texture ogl_texture_list[OGL_TEXTURE_LIST_SIZE];
@@ -118,6 +118,7 @@ void ogl_filltexbuf(unsigned char *data, GLubyte *texp, int truewidth, int width
 void ogl_loadbmtexture(grs_bitmap *bm);
 int ogl_loadtexture(unsigned char *data, int dxo, int dyo, ogl_texture *tex, int bm_flags, int data_format, int texfilt);
 void ogl_freetexture(ogl_texture *gltexture);
+static void ogl_batch_free(void);
 
 #ifdef OGLES
 // Replacement for gluPerspective
@@ -223,6 +224,7 @@ void ogl_init_texture_list_internal(void){
 	ogl_texture_list_cur=0;
 	for (i=0;i<OGL_TEXTURE_LIST_SIZE;i++)
 		ogl_reset_texture(&ogl_texture_list[i]);
+	ogl_state_invalidate();
 }
 
 void ogl_smash_texture_list_internal(void){
@@ -256,8 +258,14 @@ void ogl_smash_texture_list_internal(void){
 		}
 		ogl_texture_list[i].wrapstate = -1;
 	}
+	ogl_state_invalidate();
 
 	xmodel_free_gl_all();
+	ogl_batch_free();
+	ogl_levelmesh_invalidate();
+#ifdef OGL_MERGE
+	ogl_texarray_free();
+#endif
 
 #ifdef OGL_MERGE
 	ogl_done_prog();
@@ -273,6 +281,7 @@ void ogl_smash_png_textures(void){
 	for (i=0;i<OGL_TEXTURE_LIST_SIZE;i++){
 		if (ogl_texture_list[i].handle>0 && ogl_texture_list[i].is_png){
 			glDeleteTextures( 1, &ogl_texture_list[i].handle );
+			ogl_state_forget_texture(ogl_texture_list[i].handle);
 			ogl_texture_list[i].handle=0;
 		}
 	}
@@ -346,6 +355,17 @@ void ogl_texture_stats(void)
 	gr_printf(FSPACX(2), FSPACY(1)+LINE_SPACING, "%i(%i,%i,%i,%i) %iK(%iK wasted) (%i postcachedtex)", used, usedrgba, usedrgb, usedidx, usedother, truebytes / 1024, (truebytes - databytes) / 1024, r_texcount - r_cachedtexcount);
 	gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*2), "%ibpp(r%i,g%i,b%i,a%i)x%i=%iK depth%i=%iK", idx, r, g, b, a, dbl, colorsize / 1024, depth, depthsize / 1024);
 	gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*3), "total=%iK", (colorsize + depthsize + truebytes) / 1024);
+	gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*4), "%i draws %i binds (%i faces in %i batches)", r_drawc, r_texbindc, r_batchfacec, r_batchc);
+	gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*5), "%i state calls %i elided %i queries", ogl_state_issued, ogl_state_elided, ogl_state_queries);
+#ifdef OGL_MERGE
+	if (ogl_texarray_count)
+	{
+		int layers, maxlayers, bytes, fallbacks;
+
+		ogl_texarray_stats(&layers, &maxlayers, &bytes, &fallbacks);
+		gr_printf(FSPACX(2), FSPACY(1)+(LINE_SPACING*6), "%i texarrays %i/%i layers %iK (%i not in arrays)", ogl_texarray_count, layers, maxlayers, bytes / 1024, fallbacks);
+	}
+#endif
 }
 
 void ogl_bindbmtex(grs_bitmap *bm){
@@ -358,14 +378,426 @@ void ogl_bindbmtex(grs_bitmap *bm){
 //gltexture MUST be bound first
 void ogl_texwrap(ogl_texture *gltexture,int state)
 {
-	if (gltexture->wrapstate != state || gltexture->numrend < 1)
+	if (gltexture->wrapstate != state)
 	{
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, state);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, state);
 		gltexture->wrapstate = state;
+		ogl_state_issued += 2;
+	}
+	else
+		ogl_state_elided += 2;
+}
+
+/*
+ * World geometry batching.
+ * Between ogl_world_batch_begin() and ogl_world_batch_end() textured level faces
+ * are not drawn one by one, but triangulated into a single vertex stream. On flush
+ * the faces are grouped by texture/overlay/blend state and drawn with a few large
+ * glDrawArrays calls out of a streaming VBO.
+ * Unordered batches may reorder opaque faces freely (the depth buffer takes care
+ * of them), but blended faces are kept in submission order after everything else.
+ * Ordered batches (transparent geometry) never reorder and only merge neighbouring
+ * faces with identical state, so the back-to-front rules still hold.
+ */
+#define OGL_BATCH_STRIDE 13 // x,y,z, r,g,b,a, u,v, u2,v2, layer,layer2 (texture arrays)
+#define OGL_BATCH_LAYER_BASE 0
+#define OGL_BATCH_LAYER_OVERLAY 1 // second pass of two-pass overlays (no OGL_MERGE)
+#define OGL_BATCH_LAYER_BLENDED 2 // anything not using normal blending, drawn last and in order
+
+typedef struct ogl_batch_face {
+	ogl_texture *tex, *ovl, *mask;
+	int layer, blend, seq;
+	GLfloat alpha_ref;
+	int arr, arr2; // texture arrays of base and overlay, -1 for regular textures
+	int first, count;
+} ogl_batch_face;
+
+static int ogl_batch_active = 0, ogl_batch_ordered = 0;
+GLfloat ogl_alpha_ref = 0.02;
+static ogl_batch_face *ogl_batch_faces = NULL;
+static int ogl_batch_nfaces = 0, ogl_batch_maxfaces = 0;
+static GLfloat *ogl_batch_verts = NULL, *ogl_batch_sorted = NULL;
+static int ogl_batch_nverts = 0, ogl_batch_maxverts = 0;
+static GLuint ogl_batch_vbo = 0;
+
+static void ogl_batch_free(void)
+{
+	if (ogl_batch_vbo)
+		glDeleteBuffers(1, &ogl_batch_vbo);
+	ogl_batch_vbo = 0;
+	if (ogl_batch_faces)
+		d_free(ogl_batch_faces);
+	if (ogl_batch_verts)
+		d_free(ogl_batch_verts);
+	if (ogl_batch_sorted)
+		d_free(ogl_batch_sorted);
+	ogl_batch_nfaces = ogl_batch_maxfaces = 0;
+	ogl_batch_nverts = ogl_batch_maxverts = 0;
+}
+
+//set the alpha test reference value. Use this instead of glAlphaFunc() while batching so faces keep the value they were submitted with.
+void ogl_alpha_func(GLfloat ref)
+{
+	ogl_alpha_ref = ref;
+	glAlphaFunc(GL_GEQUAL, ref);
+}
+
+static int ogl_batch_cmp(const void *va, const void *vb)
+{
+	const ogl_batch_face *a = va, *b = vb;
+
+	if (a->layer != b->layer)
+		return a->layer - b->layer;
+	if (a->layer != OGL_BATCH_LAYER_BLENDED)
+	{
+		if (a->alpha_ref != b->alpha_ref)
+			return a->alpha_ref < b->alpha_ref ? -1 : 1;
+		if (a->arr != b->arr)
+			return a->arr - b->arr;
+		if (a->arr >= 0)
+		{
+			if (a->arr2 != b->arr2)
+				return a->arr2 - b->arr2;
+			return a->seq - b->seq;
+		}
+		if ((a->ovl == NULL) != (b->ovl == NULL))
+			return a->ovl == NULL ? -1 : 1;
+		if ((a->mask == NULL) != (b->mask == NULL))
+			return a->mask == NULL ? -1 : 1;
+		if (a->tex->handle != b->tex->handle)
+			return a->tex->handle < b->tex->handle ? -1 : 1;
+		if (a->ovl && a->ovl->handle != b->ovl->handle)
+			return a->ovl->handle < b->ovl->handle ? -1 : 1;
+		if (a->mask && a->mask->handle != b->mask->handle)
+			return a->mask->handle < b->mask->handle ? -1 : 1;
+	}
+	return a->seq - b->seq;
+}
+
+static int ogl_batch_same_state(const ogl_batch_face *a, const ogl_batch_face *b)
+{
+	if (a->arr >= 0 || b->arr >= 0)
+		return a->arr == b->arr && a->arr2 == b->arr2 && a->blend == b->blend && a->alpha_ref == b->alpha_ref;
+	return a->tex->handle == b->tex->handle &&
+		(a->ovl ? (b->ovl && a->ovl->handle == b->ovl->handle) : !b->ovl) &&
+		(a->mask ? (b->mask && a->mask->handle == b->mask->handle) : !b->mask) &&
+		a->blend == b->blend && a->alpha_ref == b->alpha_ref;
+}
+
+static void ogl_batch_set_blend(int blend)
+{
+	switch (blend)
+	{
+		case GR_BLEND_ADDITIVE_A:
+			ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE);
+			break;
+		case GR_BLEND_ADDITIVE_C:
+			ogl_state_blend_func(GL_ONE, GL_ONE);
+			break;
+		case GR_BLEND_NORMAL:
+		default:
+			ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			break;
 	}
 }
 
+// switch between fixed function (single texture), program (merged overlay) and texture array vertex setup. 0 = none
+static void ogl_batch_set_mode(int *cur, int mode)
+{
+	if (*cur == mode)
+		return;
+	if (*cur == 1) {
+		ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+		ogl_state_client_array(GL_COLOR_ARRAY, 0);
+		ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
+	}
+#ifdef OGL_MERGE
+	else if (*cur == 2 || *cur == 3) {
+		glDisableVertexAttribArray(OGL_APOS);
+		glDisableVertexAttribArray(OGL_ACOLOR);
+		glDisableVertexAttribArray(OGL_ATEXCOORD);
+		glDisableVertexAttribArray(OGL_ATEXCOORD2);
+		if (*cur == 3)
+			glDisableVertexAttribArray(OGL_ALAYER);
+		glUseProgram(0);
+	}
+#endif
+	if (mode == 1) {
+		ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+		ogl_state_client_array(GL_COLOR_ARRAY, 1);
+		ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
+		glVertexPointer(3, GL_FLOAT, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)0);
+		glColorPointer(4, GL_FLOAT, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)(3 * sizeof(GLfloat)));
+		glTexCoordPointer(2, GL_FLOAT, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)(7 * sizeof(GLfloat)));
+		OGL_ENABLE(TEXTURE_2D);
+	}
+#ifdef OGL_MERGE
+	else if (mode == 2 || mode == 3) {
+		glVertexAttribPointer(OGL_APOS, 3, GL_FLOAT, GL_FALSE, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)0);
+		glEnableVertexAttribArray(OGL_APOS);
+		glVertexAttribPointer(OGL_ACOLOR, 4, GL_FLOAT, GL_FALSE, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)(3 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(OGL_ACOLOR);
+		glVertexAttribPointer(OGL_ATEXCOORD, 2, GL_FLOAT, GL_FALSE, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)(7 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(OGL_ATEXCOORD);
+		glVertexAttribPointer(OGL_ATEXCOORD2, 2, GL_FLOAT, GL_FALSE, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)(9 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(OGL_ATEXCOORD2);
+		if (mode == 3) {
+			glVertexAttribPointer(OGL_ALAYER, 2, GL_FLOAT, GL_FALSE, OGL_BATCH_STRIDE * sizeof(GLfloat), (void *)(11 * sizeof(GLfloat)));
+			glEnableVertexAttribArray(OGL_ALAYER);
+			glUseProgram(ogl_prog_texarray);
+		}
+	}
+#endif
+	*cur = mode;
+}
+
+// draw everything collected so far. The batch stays active.
+void ogl_world_batch_flush(void)
+{
+	int i, j, n, mode = 0;
+	ogl_batch_face *f;
+	GLfloat *dst;
+
+	ogl_levelmesh_flush();
+	if (!ogl_batch_nfaces)
+		return;
+
+	if (!ogl_batch_ordered)
+	{
+		qsort(ogl_batch_faces, ogl_batch_nfaces, sizeof(ogl_batch_face), ogl_batch_cmp);
+		// rewrite the vertex stream in sorted order so every group is contiguous
+		for (i = 0, n = 0, dst = ogl_batch_sorted; i < ogl_batch_nfaces; i++)
+		{
+			f = &ogl_batch_faces[i];
+			memcpy(dst, &ogl_batch_verts[f->first * OGL_BATCH_STRIDE], f->count * OGL_BATCH_STRIDE * sizeof(GLfloat));
+			dst += f->count * OGL_BATCH_STRIDE;
+			f->first = n;
+			n += f->count;
+		}
+		dst = ogl_batch_sorted;
+	}
+	else
+		dst = ogl_batch_verts;
+
+	if (!ogl_batch_vbo)
+		glGenBuffers(1, &ogl_batch_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, ogl_batch_vbo);
+	glBufferData(GL_ARRAY_BUFFER, ogl_batch_nverts * OGL_BATCH_STRIDE * sizeof(GLfloat), dst, GL_STREAM_DRAW);
+
+	for (i = 0; i < ogl_batch_nfaces; i = j)
+	{
+		f = &ogl_batch_faces[i];
+		n = f->count;
+		for (j = i + 1; j < ogl_batch_nfaces && ogl_batch_same_state(f, &ogl_batch_faces[j]); j++)
+			n += ogl_batch_faces[j].count;
+
+		ogl_batch_set_blend(f->blend);
+		glAlphaFunc(GL_GEQUAL, f->alpha_ref);
+#ifdef OGL_MERGE
+		if (f->arr >= 0)
+		{
+			ogl_batch_set_mode(&mode, 3);
+			ogl_texarray_bind(0, f->arr);
+			if (f->arr2 >= 0)
+				ogl_texarray_bind(1, f->arr2);
+		}
+		else if (f->ovl)
+		{
+			ogl_batch_set_mode(&mode, 2);
+			glUseProgram(f->mask ? ogl_prog_tex2m : ogl_prog_tex2);
+			OGL_BINDTEXTURE(f->tex->handle);
+			ogl_texwrap(f->tex, GL_REPEAT);
+			ogl_state_active_texture(GL_TEXTURE1);
+			OGL_BINDTEXTURE(f->ovl->handle);
+			ogl_texwrap(f->ovl, GL_REPEAT);
+			if (f->mask)
+			{
+				ogl_state_active_texture(GL_TEXTURE2);
+				OGL_BINDTEXTURE(f->mask->handle);
+				ogl_texwrap(f->mask, GL_REPEAT);
+			}
+			ogl_state_active_texture(GL_TEXTURE0);
+		}
+		else
+#endif
+		{
+			ogl_batch_set_mode(&mode, 1);
+			OGL_BINDTEXTURE(f->tex->handle);
+			ogl_texwrap(f->tex, GL_REPEAT);
+		}
+		OGL_DRAWARRAYS(GL_TRIANGLES, f->first, n);
+		r_batchc++;
+	}
+
+	ogl_batch_set_mode(&mode, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	ogl_set_blending();
+	glAlphaFunc(GL_GEQUAL, ogl_alpha_ref);
+
+	ogl_batch_nfaces = 0;
+	ogl_batch_nverts = 0;
+}
+
+//start collecting level faces. ordered: keep submission order (for transparent geometry)
+void ogl_world_batch_begin(int ordered)
+{
+	if (ogl_batch_active)
+		ogl_world_batch_flush();
+	ogl_batch_active = 1;
+	ogl_batch_ordered = ordered;
+}
+
+void ogl_world_batch_end(void)
+{
+	ogl_world_batch_flush();
+	ogl_batch_active = 0;
+}
+
+//anything drawn directly while a batch is pending needs the faces behind it on screen first
+#define OGL_BATCH_SYNC() {if (ogl_batch_nfaces || ogl_levelmesh_nfaces) ogl_world_batch_flush();}
+
+static ogl_batch_face *ogl_batch_new_face(int nv, ogl_texture *tex, ogl_texture *ovl, ogl_texture *mask, int layer)
+{
+	ogl_batch_face *f;
+	int count = (nv - 2) * 3;
+
+	if (ogl_batch_nfaces == ogl_batch_maxfaces)
+	{
+		ogl_batch_maxfaces = ogl_batch_maxfaces ? ogl_batch_maxfaces * 2 : 1024;
+		ogl_batch_faces = d_realloc(ogl_batch_faces, ogl_batch_maxfaces * sizeof(ogl_batch_face));
+	}
+	if (ogl_batch_nverts + count > ogl_batch_maxverts)
+	{
+		while (ogl_batch_nverts + count > ogl_batch_maxverts)
+			ogl_batch_maxverts = ogl_batch_maxverts ? ogl_batch_maxverts * 2 : 8192;
+		ogl_batch_verts = d_realloc(ogl_batch_verts, ogl_batch_maxverts * OGL_BATCH_STRIDE * sizeof(GLfloat));
+		ogl_batch_sorted = d_realloc(ogl_batch_sorted, ogl_batch_maxverts * OGL_BATCH_STRIDE * sizeof(GLfloat));
+		if (!ogl_batch_faces || !ogl_batch_verts || !ogl_batch_sorted)
+			Error("OGL: not enough memory for world batch");
+	}
+
+	f = &ogl_batch_faces[ogl_batch_nfaces];
+	f->tex = tex;
+	f->ovl = ovl;
+	f->mask = mask;
+	f->blend = grd_curcanv->cv_blend_func;
+	f->layer = (f->blend != GR_BLEND_NORMAL || grd_curcanv->cv_fade_level < GR_FADE_OFF) ? OGL_BATCH_LAYER_BLENDED : layer;
+	f->alpha_ref = ogl_alpha_ref;
+	f->arr = f->arr2 = -1;
+	f->seq = ogl_batch_nfaces;
+	f->first = ogl_batch_nverts;
+	f->count = count;
+	ogl_batch_nfaces++;
+	ogl_batch_nverts += count;
+	r_batchfacec++;
+	return f;
+}
+
+//triangulate the fan into the batch. vtx holds 11 floats per fan vertex
+static void ogl_batch_put_fan(ogl_batch_face *f, int nv, const GLfloat *vtx)
+{
+	GLfloat *dst = &ogl_batch_verts[f->first * OGL_BATCH_STRIDE];
+	int c;
+
+	for (c = 1; c < nv - 1; c++)
+	{
+		memcpy(dst, vtx, OGL_BATCH_STRIDE * sizeof(GLfloat));
+		dst += OGL_BATCH_STRIDE;
+		memcpy(dst, vtx + c * OGL_BATCH_STRIDE, OGL_BATCH_STRIDE * 2 * sizeof(GLfloat));
+		dst += OGL_BATCH_STRIDE * 2;
+	}
+}
+
+static void ogl_batch_overlay_uv(int orient, const g3s_uvl *uvl, GLfloat *uv)
+{
+	switch(orient){
+		case 1:
+			uv[0] = 1.0-f2glf(uvl->v);
+			uv[1] = f2glf(uvl->u);
+			break;
+		case 2:
+			uv[0] = 1.0-f2glf(uvl->u);
+			uv[1] = 1.0-f2glf(uvl->v);
+			break;
+		case 3:
+			uv[0] = f2glf(uvl->v);
+			uv[1] = 1.0-f2glf(uvl->u);
+			break;
+		default:
+			uv[0] = f2glf(uvl->u);
+			uv[1] = f2glf(uvl->v);
+			break;
+	}
+}
+
+//queue a level face. bmovl may be NULL. clamp: saturate light like g3_draw_tmap_2 does
+static void ogl_batch_add(int nv, const g3s_point **pointlist, g3s_uvl *uvl_list, g3s_lrgb *light_rgb, grs_bitmap *bm, grs_bitmap *bmovl, int orient, int layer, int clamp)
+{
+	GLfloat vtx[MAX_VERTS * OGL_BATCH_STRIDE], *v;
+	GLfloat color_alpha = (grd_curcanv->cv_fade_level >= GR_FADE_OFF)?1.0:(1.0 - (float)grd_curcanv->cv_fade_level / ((float)GR_FADE_LEVELS - 1.0));
+	ogl_texture *mask = NULL;
+	ogl_batch_face *f;
+	int c, nolight, arr = -1, arr2 = -1, l1 = 0, l2 = -1;
+
+	if (bm->gltexture == NULL || bm->gltexture->handle <= 0)
+		ogl_loadbmtexture(bm);
+	bm->gltexture->numrend++;
+	if (bmovl)
+	{
+		if (bmovl->gltexture == NULL || bmovl->gltexture->handle <= 0)
+			ogl_loadbmtexture(bmovl);
+		bmovl->gltexture->numrend++;
+		if (bmovl->bm_flags & BM_FLAG_SUPER_TRANSPARENT)
+			mask = bmovl->gltexture_mask;
+	}
+	nolight = bm->bm_flags & BM_FLAG_NO_LIGHTING;
+#ifdef OGL_MERGE
+	// masked overlays need their mask texture, those stay on the regular path
+	if (ogl_texarray_count && layer == OGL_BATCH_LAYER_BASE && !mask)
+	{
+		arr = ogl_texarray_lookup(bm, &l1);
+		if (arr >= 0 && bmovl && (arr2 = ogl_texarray_lookup(bmovl, &l2)) < 0)
+			arr = -1;
+	}
+#endif
+
+	for (c = 0, v = vtx; c < nv; c++, v += OGL_BATCH_STRIDE)
+	{
+		v[0] = f2glf(pointlist[c]->p3_vec.x);
+		v[1] = f2glf(pointlist[c]->p3_vec.y);
+		v[2] = -f2glf(pointlist[c]->p3_vec.z);
+		v[3] = nolight ? 1.0 : (clamp ? minf(1.0, f2glf(light_rgb[c].r)) : f2glf(light_rgb[c].r));
+		v[4] = nolight ? 1.0 : (clamp ? minf(1.0, f2glf(light_rgb[c].g)) : f2glf(light_rgb[c].g));
+		v[5] = nolight ? 1.0 : (clamp ? minf(1.0, f2glf(light_rgb[c].b)) : f2glf(light_rgb[c].b));
+		v[6] = color_alpha;
+		if (bmovl && layer == OGL_BATCH_LAYER_OVERLAY)
+			ogl_batch_overlay_uv(orient, &uvl_list[c], &v[7]);
+		else
+		{
+			v[7] = f2glf(uvl_list[c].u);
+			v[8] = f2glf(uvl_list[c].v);
+		}
+		if (bmovl)
+			ogl_batch_overlay_uv(orient, &uvl_list[c], &v[9]);
+		else
+			v[9] = v[10] = 0;
+		v[11] = l1;
+		v[12] = l2;
+	}
+
+	if (layer == OGL_BATCH_LAYER_OVERLAY)
+		f = ogl_batch_new_face(nv, bmovl->gltexture, NULL, NULL, layer);
+	else
+		f = ogl_batch_new_face(nv, bm->gltexture, bmovl ? bmovl->gltexture : NULL, mask, layer);
+	if (arr >= 0)
+	{
+		f->arr = arr;
+		f->arr2 = bmovl ? arr2 : -1;
+	}
+	ogl_batch_put_fan(f, nv, vtx);
+}
+
 void ogl_cache_polymodel_textures(int model_num)
 {
 	polymodel *po;
@@ -394,6 +826,9 @@ void ogl_cache_level_textures(void)
 			ogl_loadbmtexture(&GameBitmaps[i]);
 	}
 
+#ifdef OGL_MERGE
+	ogl_texarray_build();
+#endif
 	xmodel_load_gl_all();
 	glmprintf((0,"finished caching\n"));
 	r_cachedtexcount = r_texcount;
@@ -406,9 +841,10 @@ bool g3_draw_line(const g3s_point *p0,const g3s_point *p1)
 	GLfloat color_array[] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
 	GLfloat vertex_array[] = { f2glf(p0->p3_vec.x),f2glf(p0->p3_vec.y),-f2glf(p0->p3_vec.z), f2glf(p1->p3_vec.x),f2glf(p1->p3_vec.y),-f2glf(p1->p3_vec.z) };
   
+	OGL_BATCH_SYNC();
 	c=grd_curcanv->cv_color;
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	OGL_DISABLE(TEXTURE_2D);
 	color_r = PAL2Tr(c);
 	color_g = PAL2Tg(c);
@@ -419,19 +855,19 @@ bool g3_draw_line(const g3s_point *p0,const g3s_point *p1)
 	color_array[3] = color_array[7] = 1.0;
 	glVertexPointer(3, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
-	glDrawArrays(GL_LINES, 0, 2);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	OGL_DRAWARRAYS(GL_LINES, 0, 2);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 
 	return 1;
 }
 
 void ogl_drawcircle(int nsides, int type, GLfloat *vertex_array)
 {
-	glEnableClientState(GL_VERTEX_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
-	glDrawArrays(type, 0, nsides);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	OGL_DRAWARRAYS(type, 0, nsides);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
 }
 
 GLfloat *circle_array_init(int nsides)
@@ -557,9 +993,9 @@ void ogl_draw_vertex_reticle(int cross,int primary,int secondary,int color,int a
 
 	glLineWidth(linedotscale*2);
 	OGL_DISABLE(TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_disable(GL_CULL_FACE);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	
 	//cross
 	if(cross)
@@ -567,7 +1003,7 @@ void ogl_draw_vertex_reticle(int cross,int primary,int secondary,int color,int a
 	else
 		glColorPointer(4, GL_FLOAT, 0, dark_lca);
 	glVertexPointer(2, GL_FLOAT, 0, cross_lva);
-	glDrawArrays(GL_LINES, 0, 8);
+	OGL_DRAWARRAYS(GL_LINES, 0, 8);
 	
 	//left primary bar
 	if(primary == 0)
@@ -575,26 +1011,26 @@ void ogl_draw_vertex_reticle(int cross,int primary,int secondary,int color,int a
 	else
 		glColorPointer(4, GL_FLOAT, 0, primary_lca[0]);
 	glVertexPointer(2, GL_FLOAT, 0, primary_lva[0]);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	OGL_DRAWARRAYS(GL_TRIANGLE_STRIP, 0, 4);
 	if(primary != 2)
 		glColorPointer(4, GL_FLOAT, 0, dark_lca);
 	else
 		glColorPointer(4, GL_FLOAT, 0, primary_lca[1]);
 	glVertexPointer(2, GL_FLOAT, 0, primary_lva[1]);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	OGL_DRAWARRAYS(GL_TRIANGLE_STRIP, 0, 4);
 	//right primary bar
 	if(primary == 0)
 		glColorPointer(4, GL_FLOAT, 0, dark_lca);
 	else
 		glColorPointer(4, GL_FLOAT, 0, primary_lca[0]);
 	glVertexPointer(2, GL_FLOAT, 0, primary_lva[2]);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	OGL_DRAWARRAYS(GL_TRIANGLE_STRIP, 0, 4);
 	if(primary != 2)
 		glColorPointer(4, GL_FLOAT, 0, dark_lca);
 	else
 		glColorPointer(4, GL_FLOAT, 0, primary_lca[1]);
 	glVertexPointer(2, GL_FLOAT, 0, primary_lva[3]);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	OGL_DRAWARRAYS(GL_TRIANGLE_STRIP, 0, 4);
 	
 	if (secondary<=2){
 		//left secondary
@@ -625,8 +1061,8 @@ void ogl_draw_vertex_reticle(int cross,int primary,int secondary,int color,int a
 		ogl_drawcircle(16, GL_LINE_LOOP, secondary_lva[2]);
 	}
 	
-	//glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	//ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 	glPopMatrix();
 	glLineWidth(linedotscale);
 }
@@ -639,6 +1075,7 @@ int g3_draw_sphere(g3s_point *pnt,fix rad){
 	float scale = ((float)grd_curcanv->cv_bitmap.bm_w/grd_curcanv->cv_bitmap.bm_h);
 	GLfloat color_array[20*4];
 	
+	OGL_BATCH_SYNC();
 	for (i = 0; i < 20*4; i += 4)
 	{
 		color_array[i] = CPAL2Tr(c);
@@ -647,7 +1084,7 @@ int g3_draw_sphere(g3s_point *pnt,fix rad){
 		color_array[i+3] = 1.0;
 	}
 	OGL_DISABLE(TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
+	ogl_state_disable(GL_CULL_FACE);
 	glPushMatrix();
 	glTranslatef(f2glf(pnt->p3_vec.x),f2glf(pnt->p3_vec.y),-f2glf(pnt->p3_vec.z));
 	if (scale >= 1)
@@ -662,10 +1099,10 @@ int g3_draw_sphere(g3s_point *pnt,fix rad){
 	}
 	if(!sphere_va)
 		sphere_va = circle_array_init(20);
-	glEnableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	ogl_drawcircle(20, GL_TRIANGLE_FAN, sphere_va);
-	glDisableClientState(GL_COLOR_ARRAY);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 	glPopMatrix();
 	return 0;
 }
@@ -725,8 +1162,9 @@ bool g3_draw_poly(int nv,const g3s_point **pointlist)
 		Error("Too many vertices %d", nv);
 
 	r_polyc++;
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	OGL_BATCH_SYNC();
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	c = grd_curcanv->cv_color;
 	OGL_DISABLE(TEXTURE_2D);
 	color_r = PAL2Tr(c);
@@ -752,9 +1190,9 @@ bool g3_draw_poly(int nv,const g3s_point **pointlist)
 
 	glVertexPointer(3, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
-	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
+	OGL_DRAWARRAYS(GL_TRIANGLE_FAN, 0, nv);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
 
 	return 0;
 }
@@ -782,11 +1220,18 @@ bool g3_draw_tmap(int nv,const g3s_point **pointlist,g3s_uvl *uvl_list,g3s_lrgb
 	if (nv > MAX_VERTS)
 		Error("Too many vertices: %d", nv);
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
+	if (ogl_batch_active && tmap_drawer_ptr == draw_tmap) {
+		ogl_batch_add(nv, pointlist, uvl_list, light_rgb, bm, NULL, 0, OGL_BATCH_LAYER_BASE, 0);
+		r_tpolyc++;
+		return 0;
+	}
+	OGL_BATCH_SYNC();
+
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
 	
 	if (tmap_drawer_ptr == draw_tmap) {
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 		OGL_ENABLE(TEXTURE_2D);
 		ogl_bindbmtex(bm);
 		ogl_texwrap(bm->gltexture, GL_REPEAT);
@@ -831,11 +1276,11 @@ bool g3_draw_tmap(int nv,const g3s_point **pointlist,g3s_uvl *uvl_list,g3s_lrgb
 		glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array);  
 	}
 	
-	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
+	OGL_DRAWARRAYS(GL_TRIANGLE_FAN, 0, nv);
 	
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 
 	return 0;
 }
@@ -855,12 +1300,24 @@ bool g3_draw_tmap_2(int nv, const g3s_point **pointlist, g3s_uvl *uvl_list, g3s_
 	if (nv > MAX_VERTS)
 		Error("Too many vertices: %d", nv);
 
+	if (ogl_batch_active) {
+#ifndef OGL_MERGE
+		g3_draw_tmap(nv,pointlist,uvl_list,light_rgb,bmbot);
+		ogl_batch_add(nv, pointlist, uvl_list, light_rgb, bmbot, bmovl, orient, OGL_BATCH_LAYER_OVERLAY, 1);
+#else
+		ogl_batch_add(nv, pointlist, uvl_list, light_rgb, bmbot, bmovl, orient, OGL_BATCH_LAYER_BASE, 1);
+		r_tpolyc++;
+#endif
+		return 0;
+	}
+	OGL_BATCH_SYNC();
+
 #ifndef OGL_MERGE
 	g3_draw_tmap(nv,pointlist,uvl_list,light_rgb,bmbot);//draw the bottom texture first.. could be optimized with multitexturing..
 	
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 	
 	OGL_ENABLE(TEXTURE_2D);
 	ogl_bindbmtex(bmovl);
@@ -869,17 +1326,17 @@ bool g3_draw_tmap_2(int nv, const g3s_point **pointlist, g3s_uvl *uvl_list, g3s_
 	ogl_bindbmtex(bmbot);
 	ogl_texwrap(bmbot->gltexture,GL_REPEAT);
 
-	glActiveTexture(GL_TEXTURE1);
+	ogl_state_active_texture(GL_TEXTURE1);
 	ogl_bindbmtex(bmovl);
 	ogl_texwrap(bmovl->gltexture,GL_REPEAT);
 
 	if (super) {
-		glActiveTexture(GL_TEXTURE2);
+		ogl_state_active_texture(GL_TEXTURE2);
 		OGL_BINDTEXTURE(bmovl->gltexture_mask->handle);
 		ogl_texwrap(bmovl->gltexture_mask,GL_REPEAT);
 	}
 
-	glActiveTexture(GL_TEXTURE0);
+	ogl_state_active_texture(GL_TEXTURE0);
 #endif
 	
 	for (c=0; c<nv; c++) {
@@ -925,10 +1382,10 @@ bool g3_draw_tmap_2(int nv, const g3s_point **pointlist, g3s_uvl *uvl_list, g3s_
 	glVertexPointer(3, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoordovl_array);
-	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	OGL_DRAWARRAYS(GL_TRIANGLE_FAN, 0, nv);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 #else
 	glUseProgram(super ? ogl_prog_tex2m : ogl_prog_tex2);
 
@@ -941,7 +1398,7 @@ bool g3_draw_tmap_2(int nv, const g3s_point **pointlist, g3s_uvl *uvl_list, g3s_
 	glVertexAttribPointer(OGL_ATEXCOORD2, 2, GL_FLOAT, GL_FALSE, 0, texcoordovl_array);
 	glEnableVertexAttribArray(OGL_ATEXCOORD2);
 
-	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
+	OGL_DRAWARRAYS(GL_TRIANGLE_FAN, 0, nv);
 
 	glDisableVertexAttribArray(OGL_APOS);
 	glDisableVertexAttribArray(OGL_ACOLOR);
@@ -965,11 +1422,12 @@ bool g3_draw_bitmap_full(vms_vector *pos,fix width,fix height,grs_bitmap *bm,
 	GLfloat vertex_array[12], color_array[16], texcoord_array[8];
 
 	r_bitmapc++;
+	OGL_BATCH_SYNC();
 	v1.z=0;
 	
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 
 	OGL_ENABLE(TEXTURE_2D);
 	ogl_bindbmtex(bm);
@@ -1019,10 +1477,10 @@ bool g3_draw_bitmap_full(vms_vector *pos,fix width,fix height,grs_bitmap *bm,
 	glVertexPointer(3, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array);  
-	glDrawArrays(GL_TRIANGLE_FAN, 0, 4); // Replaced GL_QUADS
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	OGL_DRAWARRAYS(GL_TRIANGLE_FAN, 0, 4); // Replaced GL_QUADS
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 
 	return 0;
 }
@@ -1051,9 +1509,9 @@ bool ogl_ubitblt_i(int dw,int dh,int dx,int dy, int sw, int sh, int sx, int sy,
 	ogl_texture tex;
 	r_ubitbltc++;
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 
 	ogl_init_texture(&tex, sw, sh, OGL_FLAG_ALPHA);
 	tex.prio = 0.0;
@@ -1098,11 +1556,11 @@ bool ogl_ubitblt_i(int dw,int dh,int dx,int dy, int sw, int sh, int sx, int sy,
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array);  
-	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
+	OGL_DRAWARRAYS(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
 
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 	ogl_freetexture(&tex);
 	return 0;
 }
@@ -1117,9 +1575,9 @@ bool ogl_ubitblt(int w,int h,int dx,int dy, int sx, int sy, grs_bitmap * src, gr
 void ogl_toggle_depth_test(int enable)
 {
 	if (enable)
-		glEnable(GL_DEPTH_TEST);
+		ogl_state_enable(GL_DEPTH_TEST);
 	else
-		glDisable(GL_DEPTH_TEST);
+		ogl_state_disable(GL_DEPTH_TEST);
 }
 
 /* 
@@ -1130,44 +1588,46 @@ void ogl_set_blending()
 	switch ( grd_curcanv->cv_blend_func )
 	{
 		case GR_BLEND_ADDITIVE_A:
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE );
+			ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE);
 			break;
 		case GR_BLEND_ADDITIVE_C:
-			glBlendFunc( GL_ONE, GL_ONE );
+			ogl_state_blend_func(GL_ONE, GL_ONE);
 			break;
 		case GR_BLEND_NORMAL:
 		default:
-			glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+			ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 			break;
 	}
 }
 
 GLubyte *pixels = NULL;
 
-void ogl_start_frame(void){
-	#ifdef OGL_MERGE
-	GLfloat mat[16];
-	#endif
+#ifdef OGL_MERGE
+GLfloat ogl_proj_mat[16];
+#endif
 
+void ogl_start_frame(void){
 	r_polyc=0;r_tpolyc=0;r_bitmapc=0;r_ubitbltc=0;r_upixelc=0;
+	r_drawc=0;r_texbindc=0;r_batchfacec=0;r_batchc=0;
+	ogl_state_reset_counters();
 
 	OGL_VIEWPORT(grd_curcanv->cv_bitmap.bm_x,grd_curcanv->cv_bitmap.bm_y,Canvas_width,Canvas_height);
 	glClearColor(0.0, 0.0, 0.0, 0.0);
 
 	glLineWidth(linedotscale);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	ogl_state_enable(GL_BLEND);
+	ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glEnable(GL_ALPHA_TEST);
-	glAlphaFunc(GL_GEQUAL,0.02);
+	ogl_state_enable(GL_ALPHA_TEST);
+	ogl_alpha_func(0.02);
 
 	if (!GameCfg.ClassicDepth || (Game_mode & GM_MULTI))
-		glEnable(GL_DEPTH_TEST);
+		ogl_state_enable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LEQUAL);
 
 	glClear(GL_DEPTH_BUFFER_BIT);
 
-	glEnable(GL_CULL_FACE);
+	ogl_state_enable(GL_CULL_FACE);
 	glFrontFace(GL_CW);
 
 	glShadeModel(GL_SMOOTH);
@@ -1194,8 +1654,8 @@ void ogl_start_frame(void){
 	glLoadIdentity();//clear matrix
 
 #ifdef OGL_MERGE
-	glGetFloatv(GL_PROJECTION_MATRIX, mat);
-	ogl_prog_set_matrix(mat);
+	glGetFloatv(GL_PROJECTION_MATRIX, ogl_proj_mat);
+	ogl_prog_set_matrix(ogl_proj_mat);
 #endif
 }
 
@@ -1210,8 +1670,8 @@ void ogl_end_frame(void){
 #endif
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();//clear matrix
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
+	ogl_state_disable(GL_CULL_FACE);
+	ogl_state_disable(GL_DEPTH_TEST);
 
 #ifdef OGL_MERGE
 	ogl_prog_set_matrix(ogl_mat_ortho);
@@ -1551,6 +2011,8 @@ void tex_set_size(ogl_texture *tex){
 int ogl_loadtexture (unsigned char *data, int dxo, int dyo, ogl_texture *tex, int bm_flags, int data_format, int texfilt)
 {
 	GLubyte	*bufP = texbuf;
+
+	PROF_BEGIN(PROF_TEXTURE);
 	tex->tw = pow2ize (tex->w);
 	tex->th = pow2ize (tex->h);//calculate smallest texture size that can accomodate us (must be multiples of 2)
 
@@ -1587,6 +2049,7 @@ int ogl_loadtexture (unsigned char *data, int dxo, int dyo, ogl_texture *tex, in
 	}
 	// Generate OpenGL texture IDs.
 	glGenTextures (1, &tex->handle);
+	tex->wrapstate = -1; // the handle may have been recycled
 #ifndef OGLES
 	//set priority
 	glPrioritizeTextures (1, &tex->handle, &tex->prio);
@@ -1634,6 +2097,7 @@ int ogl_loadtexture (unsigned char *data, int dxo, int dyo, ogl_texture *tex, in
 
 	tex_set_size (tex);
 	r_texcount++;
+	PROF_END(PROF_TEXTURE);
 	return 0;
 }
 
@@ -1853,9 +2317,11 @@ void ogl_loadbmtexture(grs_bitmap *bm)
 void ogl_freetexture(ogl_texture *gltexture)
 {
 	if (gltexture->handle>0) {
+		OGL_BATCH_SYNC(); // queued faces may still reference it
 		r_texcount--;
 		glmprintf((0,"ogl_freetexture(%p):%i (%i left)\n",gltexture,gltexture->handle,r_texcount));
 		glDeleteTextures( 1, &gltexture->handle );
+		ogl_state_forget_texture(gltexture->handle);
 //		gltexture->handle=0;
 		ogl_reset_texture(gltexture);
 	}
@@ -1888,9 +2354,9 @@ bool ogl_ubitmapm_cs(int x, int y,int dw, int dh, grs_bitmap *bm,int c, int scal
 	yo=1.0-y/(float)last_height;
 	yf=1.0-(bm->bm_h+y)/(float)last_height;
 
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+	ogl_state_client_array(GL_COLOR_ARRAY, 1);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
 
 	if (dw < 0)
 		dw = grd_curcanv->cv_bitmap.bm_w;
@@ -1969,10 +2435,10 @@ bool ogl_ubitmapm_cs(int x, int y,int dw, int dh, grs_bitmap *bm,int c, int scal
 	glVertexPointer(2, GL_FLOAT, 0, vertex_array);
 	glColorPointer(4, GL_FLOAT, 0, color_array);
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array);  
-	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	OGL_DRAWARRAYS(GL_TRIANGLE_FAN, 0, 4);//replaced GL_QUADS
+	ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+	ogl_state_client_array(GL_COLOR_ARRAY, 0);
+	ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
 	
 	return 0;
 }
@@ -1984,12 +2450,12 @@ void ogl_update_window_clip()
 
 	if (!Window_clip_left && !Window_clip_top &&
 		Window_clip_right == cw - 1 && Window_clip_bot == ch - 1) {
-		glDisable(GL_SCISSOR_TEST);
+		ogl_state_disable(GL_SCISSOR_TEST);
 	} else {
-		glScissor(Window_clip_left + grd_curcanv->cv_bitmap.bm_x,
+		ogl_state_scissor(Window_clip_left + grd_curcanv->cv_bitmap.bm_x,
 			grd_curscreen->sc_h - grd_curcanv->cv_bitmap.bm_y - Window_clip_bot - 1,
 			Window_clip_right - Window_clip_left + 1,
 			Window_clip_bot - Window_clip_top + 1);
-		glEnable(GL_SCISSOR_TEST);
+		ogl_state_enable(GL_SCISSOR_TEST);
 	}
 }
@@ -0,0 +1,526 @@
+/*
+ *
+ * Static level mesh for OpenGL.
+ *
+ * All sides of the level are converted into one vertex buffer when the level
+ * is first rendered: four corners per side in world space with their texture
+ * and overlay coordinates. Sides only get re-uploaded when something changes
+ * them (ogl_levelmesh_mark_side()), so a frame does not need to transform and
+ * re-send the geometry of every visible side.
+ * Lighting lives in a second, per-corner color stream. Static and dynamic
+ * light are combined for the visible sides only and just the corners whose
+ * value actually changed since the last frame are sent to the card.
+ * The visible sides are drawn as index ranges, grouped by texture.
+ *
+ */
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#include <stddef.h>
+#endif
+#include <GL/glew.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "3d.h"
+#include "../../3d/globvars.h"
+#include "dxxerror.h"
+#include "u_mem.h"
+#include "console.h"
+#include "segment.h"
+#include "gameseg.h"
+#include "piggy.h"
+#include "internal.h"
+#include "oglprog.h"
+
+#define f2glf(x) (f2fl(x))
+
+#define OGL_MESH_STRIDE 7 // x,y,z, u,v, u2,v2
+#define OGL_MESH_CORNERS 4
+#define OGL_MESH_LAYER_BASE 0
+#define OGL_MESH_LAYER_OVERLAY 1 // second pass of two-pass overlays (no OGL_MERGE)
+
+typedef struct ogl_mesh_face {
+	ogl_texture *tex, *ovl, *mask;
+	int layer;
+	GLfloat alpha_ref;
+	int side, faces;
+} ogl_mesh_face;
+
+int ogl_levelmesh_nfaces = 0;
+
+static int ogl_mesh_built = 0, ogl_mesh_nsides = 0;
+static GLuint ogl_mesh_vbo = 0, ogl_mesh_cbo = 0, ogl_mesh_ibo = 0;
+static GLfloat *ogl_mesh_verts = NULL;
+static GLubyte *ogl_mesh_colors = NULL;
+static ubyte *ogl_mesh_orient = NULL, *ogl_mesh_dirty = NULL;
+static int *ogl_mesh_vdirty = NULL, *ogl_mesh_cdirty = NULL;
+static int ogl_mesh_nvdirty = 0, ogl_mesh_ncdirty = 0;
+static ogl_mesh_face *ogl_mesh_faces = NULL;
+static int ogl_mesh_maxfaces = 0;
+static GLuint *ogl_mesh_index = NULL;
+static int ogl_mesh_maxindex = 0;
+
+#define OGL_MESH_VDIRTY 1
+#define OGL_MESH_CDIRTY 2
+
+// throw away the mesh. It is rebuilt from Segments[] next time it gets used.
+void ogl_levelmesh_invalidate(void)
+{
+	if (ogl_mesh_vbo)
+		glDeleteBuffers(1, &ogl_mesh_vbo);
+	if (ogl_mesh_cbo)
+		glDeleteBuffers(1, &ogl_mesh_cbo);
+	if (ogl_mesh_ibo)
+		glDeleteBuffers(1, &ogl_mesh_ibo);
+	ogl_mesh_vbo = ogl_mesh_cbo = ogl_mesh_ibo = 0;
+	if (ogl_mesh_verts)
+		d_free(ogl_mesh_verts);
+	if (ogl_mesh_colors)
+		d_free(ogl_mesh_colors);
+	if (ogl_mesh_orient)
+		d_free(ogl_mesh_orient);
+	if (ogl_mesh_dirty)
+		d_free(ogl_mesh_dirty);
+	if (ogl_mesh_vdirty)
+		d_free(ogl_mesh_vdirty);
+	if (ogl_mesh_cdirty)
+		d_free(ogl_mesh_cdirty);
+	if (ogl_mesh_faces)
+		d_free(ogl_mesh_faces);
+	if (ogl_mesh_index)
+		d_free(ogl_mesh_index);
+	ogl_mesh_maxfaces = ogl_mesh_maxindex = 0;
+	ogl_mesh_nvdirty = ogl_mesh_ncdirty = 0;
+	ogl_levelmesh_nfaces = 0;
+	ogl_mesh_nsides = 0;
+	ogl_mesh_built = 0;
+}
+
+static void ogl_mesh_overlay_uv(int orient, const uvl *uvl, GLfloat *uv)
+{
+	switch(orient){
+		case 1:
+			uv[0] = 1.0-f2glf(uvl->v);
+			uv[1] = f2glf(uvl->u);
+			break;
+		case 2:
+			uv[0] = 1.0-f2glf(uvl->u);
+			uv[1] = 1.0-f2glf(uvl->v);
+			break;
+		case 3:
+			uv[0] = f2glf(uvl->v);
+			uv[1] = 1.0-f2glf(uvl->u);
+			break;
+		default:
+			uv[0] = f2glf(uvl->u);
+			uv[1] = f2glf(uvl->v);
+			break;
+	}
+}
+
+// (re)generate the four corners of a side from the level data
+static void ogl_mesh_fill_side(int s)
+{
+	segment *segp = &Segments[s / MAX_SIDES_PER_SEGMENT];
+	int sidenum = s % MAX_SIDES_PER_SEGMENT;
+	side *sidep = &segp->sides[sidenum];
+	GLfloat *v = &ogl_mesh_verts[s * OGL_MESH_CORNERS * OGL_MESH_STRIDE];
+	int vertnum_list[4], c, orient = ((sidep->tmap_num2&0xC000)>>14) & 3;
+
+	get_side_verts(vertnum_list, s / MAX_SIDES_PER_SEGMENT, sidenum);
+	for (c = 0; c < OGL_MESH_CORNERS; c++, v += OGL_MESH_STRIDE)
+	{
+		v[0] = f2glf(Vertices[vertnum_list[c]].x);
+		v[1] = f2glf(Vertices[vertnum_list[c]].y);
+		v[2] = f2glf(Vertices[vertnum_list[c]].z);
+		v[3] = f2glf(sidep->uvls[c].u);
+		v[4] = f2glf(sidep->uvls[c].v);
+		ogl_mesh_overlay_uv(orient, &sidep->uvls[c], &v[5]);
+	}
+	ogl_mesh_orient[s] = orient;
+}
+
+static void ogl_mesh_build(void)
+{
+	int s;
+
+	ogl_mesh_nsides = (Highest_segment_index + 1) * MAX_SIDES_PER_SEGMENT;
+	if (ogl_mesh_nsides <= 0)
+		return;
+
+	MALLOC(ogl_mesh_verts, GLfloat, ogl_mesh_nsides * OGL_MESH_CORNERS * OGL_MESH_STRIDE);
+	MALLOC(ogl_mesh_colors, GLubyte, ogl_mesh_nsides * OGL_MESH_CORNERS * 4);
+	MALLOC(ogl_mesh_orient, ubyte, ogl_mesh_nsides);
+	MALLOC(ogl_mesh_dirty, ubyte, ogl_mesh_nsides);
+	MALLOC(ogl_mesh_vdirty, int, ogl_mesh_nsides);
+	MALLOC(ogl_mesh_cdirty, int, ogl_mesh_nsides);
+	if (!ogl_mesh_verts || !ogl_mesh_colors || !ogl_mesh_orient || !ogl_mesh_dirty || !ogl_mesh_vdirty || !ogl_mesh_cdirty)
+		Error("OGL: not enough memory for level mesh");
+
+	for (s = 0; s < ogl_mesh_nsides; s++)
+		ogl_mesh_fill_side(s);
+	memset(ogl_mesh_colors, 0, ogl_mesh_nsides * OGL_MESH_CORNERS * 4);
+	memset(ogl_mesh_dirty, 0, ogl_mesh_nsides);
+
+	glGenBuffers(1, &ogl_mesh_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, ogl_mesh_vbo);
+	glBufferData(GL_ARRAY_BUFFER, ogl_mesh_nsides * OGL_MESH_CORNERS * OGL_MESH_STRIDE * sizeof(GLfloat), ogl_mesh_verts, GL_STATIC_DRAW);
+	glGenBuffers(1, &ogl_mesh_cbo);
+	glBindBuffer(GL_ARRAY_BUFFER, ogl_mesh_cbo);
+	glBufferData(GL_ARRAY_BUFFER, ogl_mesh_nsides * OGL_MESH_CORNERS * 4, ogl_mesh_colors, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glGenBuffers(1, &ogl_mesh_ibo);
+
+	ogl_mesh_built = 1;
+	con_printf(CON_DEBUG, "OGL: level mesh built, %i sides\n", ogl_mesh_nsides);
+}
+
+//the side changed texture coordinates or orientation, re-send it with the next flush
+void ogl_levelmesh_mark_side(int segnum, int sidenum)
+{
+	int s = segnum * MAX_SIDES_PER_SEGMENT + sidenum;
+
+	if (!ogl_mesh_built || s < 0 || s >= ogl_mesh_nsides)
+		return;
+	if (!(ogl_mesh_dirty[s] & OGL_MESH_VDIRTY))
+	{
+		ogl_mesh_dirty[s] |= OGL_MESH_VDIRTY;
+		ogl_mesh_vdirty[ogl_mesh_nvdirty++] = s;
+	}
+}
+
+static int ogl_mesh_int_cmp(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+// send the listed sides of a buffer, merging sides that are close to each other into one upload
+static void ogl_mesh_upload(GLuint buf, int *list, int n, const char *src, int side_bytes)
+{
+	int i, j;
+
+	if (!n)
+		return;
+	qsort(list, n, sizeof(int), ogl_mesh_int_cmp);
+	glBindBuffer(GL_ARRAY_BUFFER, buf);
+	for (i = 0; i < n; i = j)
+	{
+		for (j = i + 1; j < n && list[j] - list[j - 1] <= 8; j++)
+			;
+		glBufferSubData(GL_ARRAY_BUFFER, list[i] * side_bytes, (list[j - 1] - list[i] + 1) * side_bytes, src + list[i] * side_bytes);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//queue the visible triangles of a side (faces bit 0: first triangle, bit 1: second one).
+//returns 0 if the side can't be drawn from the mesh and has to go the regular way.
+int ogl_levelmesh_add_side(int segnum, int sidenum, int faces, g3s_lrgb *light, grs_bitmap *bm, grs_bitmap *bm2)
+{
+	int s = segnum * MAX_SIDES_PER_SEGMENT + sidenum, c, layers, l;
+	GLubyte col[OGL_MESH_CORNERS * 4], *dst;
+#ifdef OGL_MERGE
+	ogl_texture *mask = NULL;
+#endif
+	ogl_mesh_face *f;
+
+	if (!ogl_mesh_built)
+		ogl_mesh_build();
+	if (!ogl_mesh_built || s >= ogl_mesh_nsides)
+		return 0;
+	if (!faces)
+		return 1;
+
+	if (bm->gltexture == NULL || bm->gltexture->handle <= 0)
+		ogl_loadbmtexture(bm);
+	bm->gltexture->numrend++;
+	if (bm2)
+	{
+		if (bm2->gltexture == NULL || bm2->gltexture->handle <= 0)
+			ogl_loadbmtexture(bm2);
+		bm2->gltexture->numrend++;
+#ifdef OGL_MERGE
+		if (bm2->bm_flags & BM_FLAG_SUPER_TRANSPARENT)
+			mask = bm2->gltexture_mask;
+#endif
+	}
+
+	if (ogl_mesh_orient[s] != (((Segments[segnum].sides[sidenum].tmap_num2&0xC000)>>14) & 3))
+		ogl_levelmesh_mark_side(segnum, sidenum);
+
+	for (c = 0; c < OGL_MESH_CORNERS; c++)
+	{
+		if (bm->bm_flags & BM_FLAG_NO_LIGHTING)
+			col[c * 4] = col[c * 4 + 1] = col[c * 4 + 2] = 255;
+		else
+		{
+			col[c * 4] = light[c].r >= F1_0 ? 255 : (GLubyte)((light[c].r * 255 + F1_0 / 2) >> 16);
+			col[c * 4 + 1] = light[c].g >= F1_0 ? 255 : (GLubyte)((light[c].g * 255 + F1_0 / 2) >> 16);
+			col[c * 4 + 2] = light[c].b >= F1_0 ? 255 : (GLubyte)((light[c].b * 255 + F1_0 / 2) >> 16);
+		}
+		col[c * 4 + 3] = 255;
+	}
+	dst = &ogl_mesh_colors[s * OGL_MESH_CORNERS * 4];
+	if (memcmp(dst, col, sizeof(col)))
+	{
+		memcpy(dst, col, sizeof(col));
+		if (!(ogl_mesh_dirty[s] & OGL_MESH_CDIRTY))
+		{
+			ogl_mesh_dirty[s] |= OGL_MESH_CDIRTY;
+			ogl_mesh_cdirty[ogl_mesh_ncdirty++] = s;
+		}
+	}
+
+#ifdef OGL_MERGE
+	layers = 1;
+#else
+	layers = bm2 ? 2 : 1;
+#endif
+	if (ogl_levelmesh_nfaces + layers > ogl_mesh_maxfaces)
+	{
+		ogl_mesh_maxfaces = ogl_mesh_maxfaces ? ogl_mesh_maxfaces * 2 : 1024;
+		ogl_mesh_faces = d_realloc(ogl_mesh_faces, ogl_mesh_maxfaces * sizeof(ogl_mesh_face));
+		if (!ogl_mesh_faces)
+			Error("OGL: not enough memory for level mesh");
+	}
+	for (l = 0; l < layers; l++)
+	{
+		f = &ogl_mesh_faces[ogl_levelmesh_nfaces++];
+		f->layer = l ? OGL_MESH_LAYER_OVERLAY : OGL_MESH_LAYER_BASE;
+		f->tex = l ? bm2->gltexture : bm->gltexture;
+#ifdef OGL_MERGE
+		f->ovl = bm2 ? bm2->gltexture : NULL;
+		f->mask = mask;
+#else
+		f->ovl = f->mask = NULL;
+#endif
+		f->alpha_ref = ogl_alpha_ref;
+		f->side = s;
+		f->faces = faces;
+		r_batchfacec++;
+	}
+	r_tpolyc += (faces & 1) + ((faces >> 1) & 1);
+	return 1;
+}
+
+static int ogl_mesh_face_cmp(const void *va, const void *vb)
+{
+	const ogl_mesh_face *a = va, *b = vb;
+
+	if (a->layer != b->layer)
+		return a->layer - b->layer;
+	if (a->alpha_ref != b->alpha_ref)
+		return a->alpha_ref < b->alpha_ref ? -1 : 1;
+	if ((a->ovl == NULL) != (b->ovl == NULL))
+		return a->ovl == NULL ? -1 : 1;
+	if ((a->mask == NULL) != (b->mask == NULL))
+		return a->mask == NULL ? -1 : 1;
+	if (a->tex->handle != b->tex->handle)
+		return a->tex->handle < b->tex->handle ? -1 : 1;
+	if (a->ovl && a->ovl->handle != b->ovl->handle)
+		return a->ovl->handle < b->ovl->handle ? -1 : 1;
+	if (a->mask && a->mask->handle != b->mask->handle)
+		return a->mask->handle < b->mask->handle ? -1 : 1;
+	return a->side - b->side;
+}
+
+static int ogl_mesh_same_state(const ogl_mesh_face *a, const ogl_mesh_face *b)
+{
+	return a->layer == b->layer && a->tex->handle == b->tex->handle &&
+		(a->ovl ? (b->ovl && a->ovl->handle == b->ovl->handle) : !b->ovl) &&
+		(a->mask ? (b->mask && a->mask->handle == b->mask->handle) : !b->mask) &&
+		a->alpha_ref == b->alpha_ref;
+}
+
+// modelview matrix doing what g3_rotate_point() does, plus the z flip of the OpenGL backend
+static void ogl_mesh_view_matrix(GLfloat *m)
+{
+	double px = f2fl(View_position.x), py = f2fl(View_position.y), pz = f2fl(View_position.z);
+	const vms_matrix *vm = &View_matrix;
+
+	m[0] = f2fl(vm->rvec.x); m[4] = f2fl(vm->rvec.y); m[8] = f2fl(vm->rvec.z);
+	m[1] = f2fl(vm->uvec.x); m[5] = f2fl(vm->uvec.y); m[9] = f2fl(vm->uvec.z);
+	m[2] = -f2fl(vm->fvec.x); m[6] = -f2fl(vm->fvec.y); m[10] = -f2fl(vm->fvec.z);
+	m[12] = -(m[0] * px + m[4] * py + m[8] * pz);
+	m[13] = -(m[1] * px + m[5] * py + m[9] * pz);
+	m[14] = -(m[2] * px + m[6] * py + m[10] * pz);
+	m[3] = m[7] = m[11] = 0;
+	m[15] = 1;
+}
+
+// switch between fixed function and program vertex setup. 0 = none
+static void ogl_mesh_set_mode(int *cur, int mode)
+{
+	if (*cur == mode)
+		return;
+	if (*cur == 1 || *cur == 3) {
+		ogl_state_client_array(GL_VERTEX_ARRAY, 0);
+		ogl_state_client_array(GL_COLOR_ARRAY, 0);
+		ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 0);
+	}
+#ifdef OGL_MERGE
+	else if (*cur == 2) {
+		glDisableVertexAttribArray(OGL_APOS);
+		glDisableVertexAttribArray(OGL_ACOLOR);
+		glDisableVertexAttribArray(OGL_ATEXCOORD);
+		glDisableVertexAttribArray(OGL_ATEXCOORD2);
+		glUseProgram(0);
+	}
+#endif
+	if (mode == 1 || mode == 3) {
+		// 3 is the overlay pass, which takes its coordinates from u2,v2
+		ogl_state_client_array(GL_VERTEX_ARRAY, 1);
+		ogl_state_client_array(GL_COLOR_ARRAY, 1);
+		ogl_state_client_array(GL_TEXTURE_COORD_ARRAY, 1);
+		glBindBuffer(GL_ARRAY_BUFFER, ogl_mesh_cbo);
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, (void *)0);
+		glBindBuffer(GL_ARRAY_BUFFER, ogl_mesh_vbo);
+		glVertexPointer(3, GL_FLOAT, OGL_MESH_STRIDE * sizeof(GLfloat), (void *)0);
+		glTexCoordPointer(2, GL_FLOAT, OGL_MESH_STRIDE * sizeof(GLfloat), (void *)((mode == 3 ? 5 : 3) * sizeof(GLfloat)));
+		OGL_ENABLE(TEXTURE_2D);
+	}
+#ifdef OGL_MERGE
+	else if (mode == 2) {
+		glBindBuffer(GL_ARRAY_BUFFER, ogl_mesh_cbo);
+		glVertexAttribPointer(OGL_ACOLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void *)0);
+		glEnableVertexAttribArray(OGL_ACOLOR);
+		glBindBuffer(GL_ARRAY_BUFFER, ogl_mesh_vbo);
+		glVertexAttribPointer(OGL_APOS, 3, GL_FLOAT, GL_FALSE, OGL_MESH_STRIDE * sizeof(GLfloat), (void *)0);
+		glEnableVertexAttribArray(OGL_APOS);
+		glVertexAttribPointer(OGL_ATEXCOORD, 2, GL_FLOAT, GL_FALSE, OGL_MESH_STRIDE * sizeof(GLfloat), (void *)(3 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(OGL_ATEXCOORD);
+		glVertexAttribPointer(OGL_ATEXCOORD2, 2, GL_FLOAT, GL_FALSE, OGL_MESH_STRIDE * sizeof(GLfloat), (void *)(5 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(OGL_ATEXCOORD2);
+	}
+#endif
+	*cur = mode;
+}
+
+//draw all queued sides
+void ogl_levelmesh_flush(void)
+{
+	int i, j, n, nindex, mode = 0, s, base;
+	GLfloat mv[16];
+#ifdef OGL_MERGE
+	GLfloat mvp[16];
+	int k;
+#endif
+	ogl_mesh_face *f;
+	GLuint *idx;
+
+	if (!ogl_levelmesh_nfaces)
+		return;
+
+	// patch what changed since the last frame
+	for (i = 0; i < ogl_mesh_nvdirty; i++)
+		ogl_mesh_fill_side(ogl_mesh_vdirty[i]);
+	ogl_mesh_upload(ogl_mesh_vbo, ogl_mesh_vdirty, ogl_mesh_nvdirty, (const char *)ogl_mesh_verts, OGL_MESH_CORNERS * OGL_MESH_STRIDE * sizeof(GLfloat));
+	ogl_mesh_upload(ogl_mesh_cbo, ogl_mesh_cdirty, ogl_mesh_ncdirty, (const char *)ogl_mesh_colors, OGL_MESH_CORNERS * 4);
+	for (i = 0; i < ogl_mesh_nvdirty; i++)
+		ogl_mesh_dirty[ogl_mesh_vdirty[i]] = 0;
+	for (i = 0; i < ogl_mesh_ncdirty; i++)
+		ogl_mesh_dirty[ogl_mesh_cdirty[i]] = 0;
+	ogl_mesh_nvdirty = ogl_mesh_ncdirty = 0;
+
+	qsort(ogl_mesh_faces, ogl_levelmesh_nfaces, sizeof(ogl_mesh_face), ogl_mesh_face_cmp);
+
+	// build the index ranges. Every group of sides sharing a state is contiguous
+	if (ogl_levelmesh_nfaces * 6 > ogl_mesh_maxindex)
+	{
+		ogl_mesh_maxindex = ogl_levelmesh_nfaces * 6 * 2;
+		ogl_mesh_index = d_realloc(ogl_mesh_index, ogl_mesh_maxindex * sizeof(GLuint));
+		if (!ogl_mesh_index)
+			Error("OGL: not enough memory for level mesh");
+	}
+	for (i = 0, idx = ogl_mesh_index; i < ogl_levelmesh_nfaces; i++)
+	{
+		f = &ogl_mesh_faces[i];
+		s = f->side;
+		base = s * OGL_MESH_CORNERS;
+		if (Segments[s / MAX_SIDES_PER_SEGMENT].sides[s % MAX_SIDES_PER_SEGMENT].type == SIDE_IS_TRI_13)
+		{
+			if (f->faces & 1) {
+				*idx++ = base; *idx++ = base + 1; *idx++ = base + 3;
+			}
+			if (f->faces & 2) {
+				*idx++ = base + 1; *idx++ = base + 2; *idx++ = base + 3;
+			}
+		}
+		else
+		{
+			if (f->faces & 1) {
+				*idx++ = base; *idx++ = base + 1; *idx++ = base + 2;
+			}
+			if (f->faces & 2) {
+				*idx++ = base; *idx++ = base + 2; *idx++ = base + 3;
+			}
+		}
+		f->faces = idx - ogl_mesh_index; // from here on: end of the range
+	}
+	nindex = idx - ogl_mesh_index;
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ogl_mesh_ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, nindex * sizeof(GLuint), ogl_mesh_index, GL_STREAM_DRAW);
+
+	ogl_mesh_view_matrix(mv);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadMatrixf(mv);
+#ifdef OGL_MERGE
+	for (i = 0; i < 4; i++)
+		for (j = 0; j < 4; j++)
+			for (k = 0, mvp[i * 4 + j] = 0; k < 4; k++)
+				mvp[i * 4 + j] += ogl_proj_mat[k * 4 + j] * mv[i * 4 + k];
+	ogl_prog_set_matrix(mvp);
+#endif
+
+	ogl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	for (i = 0, n = 0; i < ogl_levelmesh_nfaces; i = j)
+	{
+		f = &ogl_mesh_faces[i];
+		for (j = i + 1; j < ogl_levelmesh_nfaces && ogl_mesh_same_state(f, &ogl_mesh_faces[j]); j++)
+			;
+
+		glAlphaFunc(GL_GEQUAL, f->alpha_ref);
+#ifdef OGL_MERGE
+		if (f->ovl)
+		{
+			ogl_mesh_set_mode(&mode, 2);
+			glUseProgram(f->mask ? ogl_prog_tex2m : ogl_prog_tex2);
+			OGL_BINDTEXTURE(f->tex->handle);
+			ogl_texwrap(f->tex, GL_REPEAT);
+			ogl_state_active_texture(GL_TEXTURE1);
+			OGL_BINDTEXTURE(f->ovl->handle);
+			ogl_texwrap(f->ovl, GL_REPEAT);
+			if (f->mask)
+			{
+				ogl_state_active_texture(GL_TEXTURE2);
+				OGL_BINDTEXTURE(f->mask->handle);
+				ogl_texwrap(f->mask, GL_REPEAT);
+			}
+			ogl_state_active_texture(GL_TEXTURE0);
+		}
+		else
+#endif
+		{
+			ogl_mesh_set_mode(&mode, f->layer == OGL_MESH_LAYER_OVERLAY ? 3 : 1);
+			OGL_BINDTEXTURE(f->tex->handle);
+			ogl_texwrap(f->tex, GL_REPEAT);
+		}
+		OGL_DRAWELEMENTS(GL_TRIANGLES, ogl_mesh_faces[j - 1].faces - n, GL_UNSIGNED_INT, (void *)(n * sizeof(GLuint)));
+		n = ogl_mesh_faces[j - 1].faces;
+		r_batchc++;
+	}
+
+	ogl_mesh_set_mode(&mode, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glPopMatrix();
+#ifdef OGL_MERGE
+	ogl_prog_set_matrix(ogl_proj_mat);
+#endif
+	ogl_set_blending();
+	glAlphaFunc(GL_GEQUAL, ogl_alpha_ref);
+
+	ogl_levelmesh_nfaces = 0;
+}
@@ -2,8 +2,8 @@
 #include "oglprog.h"
 #include "dxxerror.h"
 
-GLuint ogl_prog_tex2, ogl_prog_tex2m;
-GLuint ogl_tex2_mat, ogl_tex2m_mat;
+GLuint ogl_prog_tex2, ogl_prog_tex2m, ogl_prog_texarray;
+GLuint ogl_tex2_mat, ogl_tex2m_mat, ogl_texarray_mat;
 
 GLfloat ogl_mat_ortho[16] = {
 	1, 0, 0, 0,
@@ -52,6 +52,7 @@ GLuint ogl_mk_prog(const char *vert_src, const char *frag_src) {
 	glBindAttribLocation(prog, OGL_ACOLOR, "acolor");
 	glBindAttribLocation(prog, OGL_ATEXCOORD, "atexcoord");
 	glBindAttribLocation(prog, OGL_ATEXCOORD2, "atexcoord2");
+	glBindAttribLocation(prog, OGL_ALAYER, "alayer");
 	glLinkProgram(prog);
 	glGetProgramiv(prog, GL_LINK_STATUS, &val);
 	if (!val) {
@@ -129,7 +130,54 @@ void ogl_init_prog() {
 	glUseProgram(0);
 }
 
+// only built when texture arrays are used, older drivers can't compile it
+void ogl_init_prog_texarray() {
+	GLfloat mat[16];
+
+	ogl_prog_texarray = ogl_mk_prog("attribute vec3 apos;"
+		"\n attribute vec4 acolor;"
+		"\n attribute vec2 atexcoord;"
+		"\n attribute vec2 atexcoord2;"
+		"\n attribute vec2 alayer;"
+		"\n varying vec2 vtexcoord;"
+		"\n varying vec2 vtexcoord2;"
+		"\n varying vec2 vlayer;"
+		"\n varying vec4 vcolor;"
+		"\n uniform mat4 umat;"
+		"\n void main() {"
+		"\n  gl_Position = umat * vec4(apos, 1.0);"
+		"\n  vcolor = acolor; vtexcoord = atexcoord; vtexcoord2 = atexcoord2; vlayer = alayer;"
+		"\n }",
+		"#extension GL_EXT_texture_array : enable"
+		"\n varying vec2 vtexcoord;"
+		"\n varying vec2 vtexcoord2;"
+		"\n varying vec2 vlayer;"
+		"\n varying vec4 vcolor;"
+		"\n uniform sampler2DArray utex;"
+		"\n uniform sampler2DArray utex2;"
+		"\n void main() {"
+		"\n  vec4 bot = texture2DArray(utex, vec3(vtexcoord, vlayer.x)), ovl = vec4(0.0);"
+		"\n  if (vlayer.y >= 0.0)" // no overlay: layer -1
+		"\n   ovl = texture2DArray(utex2, vec3(vtexcoord2, vlayer.y));"
+		"\n  vec4 c = vec4(mix(bot.rgb, ovl.rgb, ovl.a), bot.a + ovl.a - bot.a * ovl.a);"
+		"\n  gl_FragColor = vcolor * c;"
+		"\n }");
+
+	ogl_texarray_mat = glGetUniformLocation(ogl_prog_texarray, "umat");
+
+	glUseProgram(ogl_prog_texarray);
+	glUniform1i(glGetUniformLocation(ogl_prog_texarray, "utex"), 0);
+	glUniform1i(glGetUniformLocation(ogl_prog_texarray, "utex2"), 1);
+	glGetUniformfv(ogl_prog_tex2, ogl_tex2_mat, mat);
+	glUniformMatrix4fv(ogl_texarray_mat, 1, GL_FALSE, mat);
+	glUseProgram(0);
+}
+
 void ogl_done_prog() {
+	if (ogl_prog_texarray) {
+		glDeleteProgram(ogl_prog_texarray);
+		ogl_prog_texarray = 0;
+	}
 	if (ogl_prog_tex2m) {
 		glDeleteProgram(ogl_prog_tex2m);
 		ogl_prog_tex2m = 0;
@@ -151,5 +199,10 @@ void ogl_prog_set_matrix(GLfloat *mat) {
 		glUniformMatrix4fv(ogl_tex2m_mat, 1, GL_FALSE, mat);
 	}
 
+	if (ogl_prog_texarray) {
+		glUseProgram(ogl_prog_texarray);
+		glUniformMatrix4fv(ogl_texarray_mat, 1, GL_FALSE, mat);
+	}
+
 	glUseProgram(0);
 }
@@ -2,6 +2,10 @@
 #define OGL_ACOLOR 1
 #define OGL_ATEXCOORD 2
 #define OGL_ATEXCOORD2 3
+#define OGL_ALAYER 4
+
+extern GLuint ogl_prog_texarray;
+void ogl_init_prog_texarray();
 
 extern GLuint ogl_prog_tex2, ogl_prog_tex2m;
 extern GLfloat ogl_mat_ortho[];
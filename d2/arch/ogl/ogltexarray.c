@@ -0,0 +1,268 @@
+/*
+ *
+ * Level texture arrays for OpenGL.
+ *
+ * With -gl_texarray the level wall textures are copied into a few
+ * GL_TEXTURE_2D_ARRAY textures, one per texture size. Batched level faces
+ * then carry the array layer of their texture instead of a texture handle,
+ * so faces with different textures can be drawn with a single call and
+ * without rebinding anything.
+ * Textures that don't fit (odd sized PNG replacements, arrays full) stay
+ * regular textures and take the usual path.
+ *
+ */
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#include <stddef.h>
+#endif
+#include <GL/glew.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "gr.h"
+#include "dxxerror.h"
+#include "u_mem.h"
+#include "console.h"
+#include "piggy.h"
+#include "textures.h"
+#include "args.h"
+#include "config.h"
+#include "internal.h"
+#include "oglprog.h"
+
+#define OGL_TEXARRAY_MAX 8
+#define OGL_TEXARRAY_SPARE 16 // room for textures paged in after the level was loaded
+
+#define OGL_TEXARRAY_UNTRIED -1
+#define OGL_TEXARRAY_NONE -2
+
+typedef struct ogl_texarray {
+	GLuint handle;
+	int w, h;
+	int layers, maxlayers;
+	int mipmap_dirty;
+} ogl_texarray;
+
+extern const char *gl_version, *gl_extensions;
+
+int ogl_texarray_count = 0;
+static ogl_texarray ogl_texarrays[OGL_TEXARRAY_MAX];
+static short ogl_texarray_of[MAX_BITMAP_FILES], ogl_texarray_layer[MAX_BITMAP_FILES];
+static int ogl_texarray_supported = -1;
+
+void ogl_texarray_free(void)
+{
+	int i;
+
+	for (i = 0; i < ogl_texarray_count; i++)
+		if (ogl_texarrays[i].handle)
+		{
+			glDeleteTextures(1, &ogl_texarrays[i].handle);
+			ogl_state_forget_texture(ogl_texarrays[i].handle);
+		}
+	memset(ogl_texarrays, 0, sizeof(ogl_texarrays));
+	ogl_texarray_count = 0;
+}
+
+static int ogl_texarray_check_support(void)
+{
+	if (ogl_texarray_supported < 0)
+	{
+		ogl_texarray_supported = (gl_version && atoi(gl_version) >= 3) || (gl_extensions && strstr(gl_extensions, "GL_EXT_texture_array"));
+		if (!ogl_texarray_supported)
+			con_printf(CON_NORMAL, "OpenGL: texture arrays not supported, -gl_texarray ignored\n");
+	}
+	if (ogl_texarray_supported && !ogl_prog_texarray)
+		ogl_init_prog_texarray();
+	return ogl_texarray_supported;
+}
+
+// can the texture of this bitmap go into an array at all? Arrays repeat the whole layer, so only unpadded textures work.
+static int ogl_texarray_eligible(grs_bitmap *bm)
+{
+	ogl_texture *t = bm->gltexture;
+
+	return t && t->handle > 0 && t->w == t->tw && t->h == t->th && t->format == GL_RGBA;
+}
+
+static void ogl_texarray_filter(void)
+{
+	if (GameCfg.TexFilt)
+	{
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, (GameCfg.TexFilt>=2?GL_LINEAR_MIPMAP_LINEAR:GL_LINEAR_MIPMAP_NEAREST));
+		if (GameCfg.TexFilt >= 3 && ogl_maxanisotropy > 1.0)
+			glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY_EXT, ogl_maxanisotropy);
+	}
+	else
+	{
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+// copy the already loaded texture of bitmap i into a free layer of a matching array
+static void ogl_texarray_add(int i)
+{
+	grs_bitmap *bm = &GameBitmaps[i];
+	ogl_texarray *a;
+	GLubyte *buf;
+	int n;
+
+	ogl_texarray_of[i] = OGL_TEXARRAY_NONE;
+	if (!ogl_texarray_eligible(bm))
+		return;
+	for (n = 0; n < ogl_texarray_count; n++)
+		if (ogl_texarrays[n].w == bm->gltexture->tw && ogl_texarrays[n].h == bm->gltexture->th)
+			break;
+	if (n == ogl_texarray_count)
+		return;
+	a = &ogl_texarrays[n];
+	if (!a->handle || a->layers >= a->maxlayers)
+		return;
+
+	MALLOC(buf, GLubyte, a->w * a->h * 4);
+	if (!buf)
+		return;
+	ogl_state_bind_texture(GL_TEXTURE_2D, bm->gltexture->handle);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, buf);
+	ogl_state_bind_texture(GL_TEXTURE_2D_ARRAY, a->handle);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, a->layers, a->w, a->h, 1, GL_RGBA, GL_UNSIGNED_BYTE, buf);
+	ogl_state_bind_texture(GL_TEXTURE_2D_ARRAY, 0);
+	ogl_state_bind_texture(GL_TEXTURE_2D, 0);
+	d_free(buf);
+
+	ogl_texarray_of[i] = n;
+	ogl_texarray_layer[i] = a->layers++;
+	a->mipmap_dirty = 1;
+}
+
+//pack the wall textures of the level into arrays. Called after the level textures got cached.
+void ogl_texarray_build(void)
+{
+	int i, n, idx, count[OGL_TEXARRAY_MAX];
+	GLint maxlayers = 256;
+	ubyte *seen;
+
+	ogl_texarray_free();
+	for (i = 0; i < MAX_BITMAP_FILES; i++)
+		ogl_texarray_of[i] = OGL_TEXARRAY_UNTRIED;
+
+	if (!GameArg.OglTexArray || !ogl_texarray_check_support())
+		return;
+
+	MALLOC(seen, ubyte, MAX_BITMAP_FILES);
+	if (!seen)
+		return;
+	memset(seen, 0, MAX_BITMAP_FILES);
+	memset(count, 0, sizeof(count));
+
+	// find out which sizes are worth an array
+	for (i = 0; i < NumTextures; i++)
+	{
+		idx = Textures[i].index;
+		if (seen[idx] || (GameBitmaps[idx].bm_flags & BM_FLAG_PAGED_OUT) || !ogl_texarray_eligible(&GameBitmaps[idx]))
+			continue;
+		seen[idx] = 1;
+		for (n = 0; n < ogl_texarray_count; n++)
+			if (ogl_texarrays[n].w == GameBitmaps[idx].gltexture->tw && ogl_texarrays[n].h == GameBitmaps[idx].gltexture->th)
+				break;
+		if (n == ogl_texarray_count)
+		{
+			if (n == OGL_TEXARRAY_MAX)
+				continue;
+			ogl_texarrays[n].w = GameBitmaps[idx].gltexture->tw;
+			ogl_texarrays[n].h = GameBitmaps[idx].gltexture->th;
+			ogl_texarray_count++;
+		}
+		count[n]++;
+	}
+
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxlayers);
+	for (n = 0; n < ogl_texarray_count; n++)
+	{
+		ogl_texarray *a = &ogl_texarrays[n];
+
+		// a single texture of some size gains nothing
+		if (count[n] < 2)
+			continue;
+		a->maxlayers = count[n] + OGL_TEXARRAY_SPARE;
+		if (a->maxlayers > maxlayers)
+			a->maxlayers = maxlayers;
+		glGenTextures(1, &a->handle);
+		ogl_state_bind_texture(GL_TEXTURE_2D_ARRAY, a->handle);
+		ogl_texarray_filter();
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, a->w, a->h, a->maxlayers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	ogl_state_bind_texture(GL_TEXTURE_2D_ARRAY, 0);
+
+	for (i = 0; i < NumTextures; i++)
+	{
+		idx = Textures[i].index;
+		if (seen[idx] == 1)
+		{
+			seen[idx] = 2;
+			ogl_texarray_add(idx);
+		}
+	}
+	d_free(seen);
+
+	for (n = 0, i = 0; n < ogl_texarray_count; n++)
+		i += ogl_texarrays[n].layers;
+	con_printf(CON_VERBOSE, "OpenGL: %i level textures in %i texture arrays\n", i, ogl_texarray_count);
+}
+
+//get the array and layer of a bitmap. Returns -1 if it has to be drawn as a regular texture.
+int ogl_texarray_lookup(grs_bitmap *bm, int *layer)
+{
+	int i = bm - GameBitmaps;
+
+	if (!ogl_texarray_count || i < 0 || i >= MAX_BITMAP_FILES)
+		return -1;
+	if (ogl_texarray_of[i] == OGL_TEXARRAY_UNTRIED)
+		ogl_texarray_add(i);
+	if (ogl_texarray_of[i] < 0)
+		return -1;
+	*layer = ogl_texarray_layer[i];
+	return ogl_texarray_of[i];
+}
+
+void ogl_texarray_bind(int unit, int n)
+{
+	ogl_texarray *a = &ogl_texarrays[n];
+
+	if (unit)
+		ogl_state_active_texture(GL_TEXTURE1);
+	if (ogl_state_bind_texture(GL_TEXTURE_2D_ARRAY, a->handle))
+		r_texbindc++;
+	if (a->mipmap_dirty)
+	{
+		if (GameCfg.TexFilt)
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		a->mipmap_dirty = 0;
+	}
+	if (unit)
+		ogl_state_active_texture(GL_TEXTURE0);
+}
+
+void ogl_texarray_stats(int *layers, int *maxlayers, int *bytes, int *fallbacks)
+{
+	int n, i;
+
+	*layers = *maxlayers = *bytes = *fallbacks = 0;
+	for (n = 0; n < ogl_texarray_count; n++)
+	{
+		ogl_texarray *a = &ogl_texarrays[n];
+
+		*layers += a->layers;
+		*maxlayers += a->maxlayers;
+		*bytes += a->w * a->h * 4 * a->maxlayers * (GameCfg.TexFilt ? 4 : 3) / 3;
+	}
+	for (i = 0; i < MAX_BITMAP_FILES; i++)
+		if (ogl_texarray_of[i] == OGL_TEXARRAY_NONE)
+			(*fallbacks)++;
+}
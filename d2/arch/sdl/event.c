@@ -217,7 +217,8 @@ void event_process(void)
 			wind = window_get_next(wind);
 	}
 
-	gr_flip();
+	if (!GameArg.SysHeadless)
+		gr_flip();
 #ifdef OGL
 	if (VR_briefing_active)
 		vr_openvr_submit_mono_from_screen(1);
@@ -226,6 +227,9 @@ void event_process(void)
 
 void event_toggle_focus(int activate_focus)
 {
+	if (GameArg.SysHeadless) // there is no window to grab
+		return;
+
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 	SDL_Window *window = SDL_GetMouseFocus();
 	if (!window)
@@ -11,6 +11,7 @@
 #include "config.h"
 
 static fix64 F64_RunTime = 0;
+static u_int64_t Perf_at_update = 0;
 
 void timer_update(void)
 {
@@ -27,6 +28,7 @@ void timer_update(void)
 	if (last_tv < cur_tv) // in case SDL_GetTicks wraps, don't update and have a little hickup
 		F64_RunTime += (cur_tv - last_tv); // increment! this value will overflow long after we are all dead... so why bother checking?
 	last_tv = cur_tv;
+	Perf_at_update = SDL_GetPerformanceCounter();
 }
 
 fix64 timer_query(void)
@@ -34,6 +36,12 @@ fix64 timer_query(void)
 	return (F64_RunTime);
 }
 
+// convert a SDL_GetPerformanceCounter() value, which may come from another thread, to timer_query() time
+fix64 timer_query_perf(u_int64_t perf)
+{
+	return F64_RunTime + (fix64)((int64_t)(perf - Perf_at_update) * F1_0 / (int64_t)SDL_GetPerformanceFrequency());
+}
+
 void timer_delay(fix seconds)
 {
 	SDL_Delay(f2i(fixmul(seconds, i2f(1000))));
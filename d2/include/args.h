@@ -50,6 +50,10 @@ typedef struct Arg
 	int SysNoBorders;
 	int SysAutoDemo;
 	int SysNoMovies;
+	char *SysTimeDemo;
+	const char *SysTimeDemoJSON;
+	int SysTimeDemoNoRender;
+	int SysHeadless; // -dedicated, -headless or -timedemo_norender: no window, sound or input
 	int CtlNoCursor;
 	int CtlNoMouse;
 	int CtlNoJoystick;
@@ -62,12 +66,23 @@ typedef struct Arg
 	int GfxHiresGFXAvailable;
 	int GfxHiresFNTAvailable;
 	int GfxVREnabled;
+	int GfxConnectedLight;
 #ifdef OGL
 	int OglFixedFont;
+	int OglLevelMesh;
+	int OglTexArray;
 #endif
 	const char *MplUdpHostAddr;
 	int MplUdpHostPort;
 	int MplUdpMyPort;
+	int MplUdpJoin;
+	int MplUdpThread;
+	int MplUdpMtu;
+	int MplUdpSnapshot;
+	int MplObsRelay;
+	int MplDedicated;
+	const char *MplDedicatedCmd;
+	int MplDedicatedTick;
 #ifdef USE_TRACKER
 	const char *MplTrackerAddr;
 	int MplTrackerPort;
@@ -79,6 +94,13 @@ typedef struct Arg
 	int DbgSafelog;
 	int DbgNoRun;
 	int DbgRenderStats;
+#ifdef BENCHMARKS
+	int DbgPointSegBench;
+	int DbgObjListStress;
+	int DbgPlpBench;
+	int DbgSigBench;
+#endif
+	int DbgProfile;
 	char *DbgAltTex;
 	char *DbgTexMap;
 	int DbgShowMemInfo;
@@ -97,6 +119,7 @@ typedef struct Arg
 	int DbgSdlASyncBlit;
 #endif
 	int LogNetTraffic; 	
+	int LogNetCrash;
 	int GameLogTimeStamp;
 	int GameLogSplit;
 } Arg;
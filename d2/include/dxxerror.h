@@ -36,6 +36,7 @@ int error_init(void (*func)(const char *));    //init error system, returns 0=ok
 void Warning(char *fmt,...);				//print out warning message to user
 void set_warn_func(void (*f)(char *s));//specifies the function to call with warning messages
 void clear_warn_func(void (*f)(char *s));//say this function no longer valid
+void set_crash_func(void (*f)(void));//specifies a function to call before Error() exits
 void Error(const char *fmt,...) __noreturn __attribute_gcc_format((printf, 1, 2));				//exit with error code=1, print message
 #define Assert assert
 #ifndef NDEBUG		//macros for debugging
@@ -13,19 +13,15 @@ extern ogl_texture ogl_texture_list[OGL_TEXTURE_LIST_SIZE];
 void ogl_init_texture_list_internal(void);
 void ogl_smash_texture_list_internal(void);
 void ogl_vivify_texture_list_internal(void);
+void ogl_loadbmtexture(grs_bitmap *bm);
+void ogl_texwrap(ogl_texture *gltexture,int state);
 
 extern int ogl_brightness_ok;
 extern int ogl_brightness_r, ogl_brightness_g, ogl_brightness_b;
 extern int ogl_fullscreen;
 
-extern int GL_TEXTURE_2D_enabled;
-#define OGL_ENABLE2(a,f) {if (a ## _enabled!=1) {f;a ## _enabled=1;}}
-#define OGL_DISABLE2(a,f) {if (a ## _enabled!=0) {f;a ## _enabled=0;}}
-
-//#define OGL_ENABLE(a) OGL_ENABLE2(a,glEnable(a))
-//#define OGL_DISABLE(a) OGL_DISABLE2(a,glDisable(a))
-#define OGL_ENABLE(a) OGL_ENABLE2(GL_ ## a,glEnable(GL_ ## a))
-#define OGL_DISABLE(a) OGL_DISABLE2(GL_ ## a,glDisable(GL_ ## a))
+#define OGL_ENABLE(a) ogl_state_enable(GL_ ## a)
+#define OGL_DISABLE(a) ogl_state_disable(GL_ ## a)
 
 //#define OGL_TEXCLAMP() OGL_ENABLE2(GL_texclamp,glTexParameteri(GL_TEXTURE_2D,  GL_TEXTURE_WRAP_S, GL_CLAMP);glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,    GL_CLAMP);)
 //#define OGL_TEXREPEAT() OGL_DISABLE2(GL_texclamp,glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);)
@@ -33,8 +29,30 @@ extern int GL_TEXTURE_2D_enabled;
 //#define OGL_TEXENV(p,m) OGL_SETSTATE(p,m,glTexEnvi(GL_TEXTURE_ENV, p,m));
 //#define OGL_TEXPARAM(p,m) OGL_SETSTATE(p,m,glTexParameteri(GL_TEXTURE_2D,p,m))
 
+extern int r_polyc,r_tpolyc,r_drawc,r_texbindc,r_batchfacec,r_batchc;
+#define OGL_BINDTEXTURE(a) {if (ogl_state_bind_texture(GL_TEXTURE_2D, a)) r_texbindc++;}
+#define OGL_DRAWARRAYS(m,f,c) {glDrawArrays(m,f,c);r_drawc++;}
+#define OGL_DRAWELEMENTS(m,c,t,i) {glDrawElements(m,c,t,i);r_drawc++;}
+
+extern GLfloat ogl_alpha_ref;
+#ifdef OGL_MERGE
+extern GLfloat ogl_proj_mat[16];
+#endif
+
+extern int ogl_levelmesh_nfaces; // sides queued for the level mesh
+void ogl_levelmesh_flush(void);
+
+#ifdef OGL_MERGE
+extern int ogl_texarray_count;
+void ogl_texarray_build(void);
+void ogl_texarray_free(void);
+int ogl_texarray_lookup(grs_bitmap *bm, int *layer);
+void ogl_texarray_bind(int unit, int n);
+void ogl_texarray_stats(int *layers, int *maxlayers, int *bytes, int *fallbacks);
+#endif
+
 extern int last_width,last_height;
-#define OGL_VIEWPORT(x,y,w,h){if (w!=last_width || h!=last_height){glViewport(x,grd_curscreen->sc_canvas.cv_bitmap.bm_h-y-h,w,h);last_width=w;last_height=h;}}
+#define OGL_VIEWPORT(x,y,w,h){ogl_state_viewport(x,grd_curscreen->sc_canvas.cv_bitmap.bm_h-y-h,w,h);last_width=w;last_height=h;}
 
 //platform specific funcs
 extern void ogl_swap_buffers_internal(void);
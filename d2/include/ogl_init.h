@@ -111,6 +111,43 @@ bool g3_draw_tmap_2(int nv,const g3s_point **pointlist,g3s_uvl *uvl_list,g3s_lrg
 void ogl_draw_vertex_reticle(int cross,int primary,int secondary,int color,int alpha,int size_offs);
 void ogl_toggle_depth_test(int enable);
 void ogl_set_blending();
+void ogl_alpha_func(GLfloat ref);
+void ogl_world_batch_begin(int ordered);
+void ogl_world_batch_flush(void);
+void ogl_world_batch_end(void);
+void ogl_levelmesh_invalidate(void);
+void ogl_levelmesh_mark_side(int segnum, int sidenum);
+int ogl_levelmesh_add_side(int segnum, int sidenum, int faces, g3s_lrgb *light, grs_bitmap *bm, grs_bitmap *bm2);
 int pow2ize(int x);//from ogl.c
 
+/* GL state cache (oglstate.c). Anything that changes this state directly has to call ogl_state_invalidate() afterwards. */
+extern int ogl_state_issued, ogl_state_elided, ogl_state_queries;
+void ogl_state_invalidate(void);
+void ogl_state_reset_counters(void);
+void ogl_state_set(GLenum cap, int on);
+void ogl_state_enable(GLenum cap);
+void ogl_state_disable(GLenum cap);
+int ogl_state_enabled(GLenum cap);
+void ogl_state_blend_func(GLenum src, GLenum dst);
+void ogl_state_client_array(GLenum array, int on);
+void ogl_state_active_texture(GLenum unit);
+int ogl_state_bind_texture(GLenum target, GLuint handle);
+void ogl_state_forget_texture(GLuint handle);
+#ifdef GL_FRAMEBUFFER
+void ogl_state_bind_framebuffer(GLenum target, GLuint fbo);
+GLuint ogl_state_framebuffer(GLenum target);
+void ogl_state_forget_framebuffer(GLuint fbo);
+#endif
+void ogl_state_viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+void ogl_state_get_viewport(GLint *v);
+void ogl_state_scissor(GLint x, GLint y, GLsizei w, GLsizei h);
+void ogl_state_get_scissor(GLint *v);
+void ogl_state_read_buffer(GLenum mode);
+void ogl_state_draw_buffer(GLenum mode);
+GLenum ogl_state_get_read_buffer(void);
+GLenum ogl_state_get_draw_buffer(void);
+void ogl_state_pixel_store(GLenum pname, GLint v);
+GLint ogl_state_get_pixel_store(GLenum pname);
+int ogl_state_doublebuffer(void);
+
 #endif /* _OGL_INIT_H_ */
@@ -396,20 +396,22 @@ void do_ai_frame(object *obj)
 			vis_vec_pos = obj->pos;
 			compute_vis_and_vec(obj, &vis_vec_pos, ailp, &vec_to_player, &player_visibility, robptr, &visibility_and_vec_computed);
 			if (player_visibility) {
-				int ii, min_obj = -1;
+				int ii, i, min_obj = -1;
 				fix min_dist = F1_0*200, cur_dist;
 
-				for (ii=0; ii<=Highest_object_index; ii++)
-					if ((Objects[ii].type == OBJ_ROBOT) && (ii != objnum)) {
+				for (i=0; i<Obj_type_count[OBJ_ROBOT]; i++) {
+					ii = Obj_type_list[OBJ_ROBOT][i];
+					if (ii != objnum) {
 						cur_dist = vm_vec_dist_quick(&obj->pos, &Objects[ii].pos);
 
 						if (cur_dist < F1_0*100)
 							if (object_to_object_visibility(obj, &Objects[ii], FQ_TRANSWALL))
-								if (cur_dist < min_dist) {
+								if (cur_dist < min_dist || (cur_dist == min_dist && ii < min_obj)) {
 									min_obj = ii;
 									min_dist = cur_dist;
 								}
 					}
+				}
 				if (min_obj != -1) {
 					Believed_player_pos = Objects[min_obj].pos;
 					Believed_player_seg = Objects[min_obj].segnum;
@@ -1371,14 +1373,19 @@ void create_awareness_event(object *objp, int type)
 }
 
 sbyte New_awareness[MAX_SEGMENTS];
+static short New_awareness_segs[MAX_SEGMENTS]; // the segments New_awareness got set for
+static int Num_new_awareness_segs = 0;
 
 // ----------------------------------------------------------------------------------
 void pae_aux(int segnum, int type, int level)
 {
 	int j;
 
-	if (New_awareness[segnum] < type)
+	if (New_awareness[segnum] < type) {
+		if (!New_awareness[segnum])
+			New_awareness_segs[Num_new_awareness_segs++] = segnum;
 		New_awareness[segnum] = type;
+	}
 
 	// Process children.
 	for (j=0; j<MAX_SIDES_PER_SEGMENT; j++)
@@ -1400,6 +1407,7 @@ void process_awareness_events(void)
 {
 	int i;
 
+	Num_new_awareness_segs = 0;
 	if (!(Game_mode & GM_MULTI) || (Game_mode & GM_MULTI_ROBOTS)) {
 		memset(New_awareness, 0, sizeof(New_awareness[0]) * (Highest_segment_index+1));
 
@@ -1414,21 +1422,23 @@ void process_awareness_events(void)
 // ----------------------------------------------------------------------------------
 void set_player_awareness_all(void)
 {
-	int i;
+	int i, j;
 
 	process_awareness_events();
 
-	for (i=0; i<=Highest_object_index; i++)
-		if (Objects[i].control_type == CT_AI && Objects[i].segnum != -1) {
-			if (New_awareness[Objects[i].segnum] > Ai_local_info[i].player_awareness_type) {
-				Ai_local_info[i].player_awareness_type = New_awareness[Objects[i].segnum];
-				Ai_local_info[i].player_awareness_time = PLAYER_AWARENESS_INITIAL_TIME;
-			}
+	// Awareness spreads through segments, not by distance, so only robots in the segments it reached can change.
+	for (j=0; j<Num_new_awareness_segs; j++)
+		for (i=Segments[New_awareness_segs[j]].objects; i!=-1; i=Objects[i].next)
+			if (Objects[i].control_type == CT_AI) {
+				if (New_awareness[Objects[i].segnum] > Ai_local_info[i].player_awareness_type) {
+					Ai_local_info[i].player_awareness_type = New_awareness[Objects[i].segnum];
+					Ai_local_info[i].player_awareness_time = PLAYER_AWARENESS_INITIAL_TIME;
+				}
 
-			// Clear the bit that says this robot is only awake because a camera woke it up.
-			if (New_awareness[Objects[i].segnum] > Ai_local_info[i].player_awareness_type)
-				Objects[i].ctype.ai_info.SUB_FLAGS &= ~SUB_FLAGS_CAMERA_AWAKE;
-		}
+				// Clear the bit that says this robot is only awake because a camera woke it up.
+				if (New_awareness[Objects[i].segnum] > Ai_local_info[i].player_awareness_type)
+					Objects[i].ctype.ai_info.SUB_FLAGS &= ~SUB_FLAGS_CAMERA_AWAKE;
+			}
 }
 
 #ifndef NDEBUG
@@ -1485,9 +1495,8 @@ void do_ai_frame_all(void)
 			int i;
 
 			Ai_last_missile_camera = -1;
-			for (i=0; i<=Highest_object_index; i++)
-				if (Objects[i].type == OBJ_ROBOT)
-					Objects[i].ctype.ai_info.SUB_FLAGS &= ~SUB_FLAGS_CAMERA_AWAKE;
+			for (i=0; i<Obj_type_count[OBJ_ROBOT]; i++)
+				Objects[Obj_type_list[OBJ_ROBOT][i]].ctype.ai_info.SUB_FLAGS &= ~SUB_FLAGS_CAMERA_AWAKE;
 		}
 	}
 
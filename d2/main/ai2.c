@@ -1740,10 +1740,9 @@ int create_gated_robot( int segnum, int object_id, vms_vector *pos)
 	if (GameTime64 - Last_gate_time < Gate_interval)
 		return -1;
 
-	for (i=0; i<=Highest_object_index; i++)
-		if (Objects[i].type == OBJ_ROBOT)
-			if (Objects[i].matcen_creator == BOSS_GATE_MATCEN_NUM)
-				count++;
+	for (i=0; i<Obj_type_count[OBJ_ROBOT]; i++)
+		if (Objects[Obj_type_list[OBJ_ROBOT][i]].matcen_creator == BOSS_GATE_MATCEN_NUM)
+			count++;
 
 	if (count > 2*Difficulty_level + 6) {
 		Last_gate_time = GameTime64 - 3*Gate_interval/4;
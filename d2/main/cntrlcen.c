@@ -457,7 +457,7 @@ void init_controlcen_for_level(void)
 
 	if ( (boss_objnum != -1) && !((Game_mode & GM_MULTI) && !(Game_mode & GM_MULTI_ROBOTS)) ) {
 		if (cntrlcen_objnum != -1) {
-			Objects[cntrlcen_objnum].type = OBJ_GHOST;
+			obj_set_type(cntrlcen_objnum, OBJ_GHOST);
 			Objects[cntrlcen_objnum].render_type = RT_NONE;
 			Control_center_present = 0;
 		}
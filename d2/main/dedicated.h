@@ -0,0 +1,12 @@
+/*
+ *
+ * Headless dedicated host.
+ *
+ */
+
+#ifndef _DEDICATED_H
+#define _DEDICATED_H
+
+void dedicated_main(void);
+
+#endif
@@ -441,10 +441,9 @@ void robotmaker_proc( FuelCenter * robotcen )
 			object *obj;
 
 			//	Make sure this robotmaker hasn't put out its max without having any of them killed.
-			for (i=0; i<=Highest_object_index; i++)
-				if (Objects[i].type == OBJ_ROBOT)
-					if ((Objects[i].matcen_creator^0x80) == my_station_num)
-						count++;
+			for (i=0; i<Obj_type_count[OBJ_ROBOT]; i++)
+				if ((Objects[Obj_type_list[OBJ_ROBOT][i]].matcen_creator^0x80) == my_station_num)
+					count++;
 			if (count > Difficulty_level + 3) {
 				robotcen->Timer /= 2;
 				return;
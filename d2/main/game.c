@@ -60,6 +60,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "weapon.h"
 #include "sounds.h"
 #include "args.h"
+#include "profile.h"
 #include "gameseq.h"
 #include "automap.h"
 #include "text.h"
@@ -91,6 +92,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "movie.h"
 #include "event.h"
 #include "window.h"
+#include "timedemo.h"
 
 #ifdef OGL
 #include "ogl_init.h"
@@ -400,17 +402,22 @@ void calc_frame_time()
 	timer_value = timer_query();
 	FrameTime = timer_value - last_timer_value;
 
-	while (FrameTime < f1_0 / (GameCfg.VSync?MAXIMUM_FPS:PlayerCfg.maxFps))
+	if (GameArg.SysTimeDemo && Newdemo_state == ND_STATE_PLAYBACK) // as fast as we can, GameProcessFrame() puts in the recorded time once the frame is read
+		FrameTime = last_frametime;
+	else
 	{
-		if (GameArg.SysUseNiceFPS && !GameCfg.VSync)
-			timer_delay(f1_0 / PlayerCfg.maxFps - FrameTime);
-		timer_update();
-		timer_value = timer_query();
-		FrameTime = timer_value - last_timer_value;
-	}
+		while (FrameTime < f1_0 / (GameCfg.VSync?MAXIMUM_FPS:PlayerCfg.maxFps))
+		{
+			if (GameArg.SysUseNiceFPS && !GameCfg.VSync)
+				timer_delay(f1_0 / PlayerCfg.maxFps - FrameTime);
+			timer_update();
+			timer_value = timer_query();
+			FrameTime = timer_value - last_timer_value;
+		}
 
-	if ( cheats.turbo )
-		FrameTime *= 2;
+		if ( cheats.turbo )
+			FrameTime *= 2;
+	}
 
 	last_timer_value = timer_value;
 
@@ -944,7 +951,7 @@ void show_newdemo_help()
 	newmenu_item *m;
 	int nitems = 0;
 
-	MALLOC(m, newmenu_item, 15);
+	MALLOC(m, newmenu_item, 17);
 	if (!m)
 		return;
 
@@ -961,6 +968,8 @@ void show_newdemo_help()
 	m[nitems].type = NM_TYPE_TEXT; m[nitems++].text = "SHIFT-LEFT\t  FAST BACKWARD";
 	m[nitems].type = NM_TYPE_TEXT; m[nitems++].text = "CTRL-RIGHT\t  JUMP TO END";
 	m[nitems].type = NM_TYPE_TEXT; m[nitems++].text = "CTRL-LEFT\t  JUMP TO START";
+	m[nitems].type = NM_TYPE_TEXT; m[nitems++].text = "PGUP/PGDN\t  SKIP 10 SECONDS";
+	m[nitems].type = NM_TYPE_TEXT; m[nitems++].text = "0-9\t  JUMP TO 0-90%";
 #if (defined(__APPLE__) || defined(macintosh))
 	m[nitems].type = NM_TYPE_TEXT; m[nitems++].text = "";
 	m[nitems].type = NM_TYPE_TEXT; m[nitems++].text = "(Use \x85-# for F#. e.g. \x85-1 for F1)";
@@ -1161,14 +1170,19 @@ int game_handler(window *wind, d_event *event, void *data)
 
 		case EVENT_WINDOW_DRAW:
 			calc_frame_time();
+			timedemo_frame();
+			prof_frame();
 
 			if (!time_paused)
 			{
 				calc_game_time();
+				PROF_BEGIN(PROF_GAME);
 				GameProcessFrame();
+				PROF_END(PROF_GAME);
 			}
+			timedemo_stage(TIMEDEMO_GAME);
 
-			if (!Automap_active)		// efficiency hack
+			if (!Automap_active && !GameArg.SysHeadless)		// efficiency hack, and headless there is no screen
 			{
 				if (force_cockpit_redraw) {			//screen need redrawing?
 					init_cockpit();
@@ -1176,6 +1190,7 @@ int game_handler(window *wind, d_event *event, void *data)
 				}
 				game_render_frame();
 			}
+			timedemo_stage(TIMEDEMO_RENDER);
 			break;
 
 		case EVENT_WINDOW_CLOSE:
@@ -1353,7 +1368,9 @@ void GameProcessFrame(void)
 #ifdef NETWORK
 	if (Game_mode & GM_MULTI)
 	{
+		PROF_BEGIN(PROF_MULTI);
 		multi_do_frame();
+		PROF_END(PROF_MULTI);
 		if (Netgame.PlayTimeAllowed && ThisLevelTime>=i2f((Netgame.PlayTimeAllowed*5*60)))
 			multi_check_for_killgoal_winner();
 	}
@@ -1372,7 +1389,9 @@ void GameProcessFrame(void)
 		ThisLevelTime +=FrameTime;
 #endif
 
+	PROF_BEGIN(PROF_SOUNDS);
 	digi_sync_sounds();
+	PROF_END(PROF_SOUNDS);
 
 	if (Endlevel_sequence) {
 		do_endlevel_frame();
@@ -1397,19 +1416,28 @@ void GameProcessFrame(void)
 	flash_frame();
 
 	if ( Newdemo_state == ND_STATE_PLAYBACK ) {
+		timedemo_stage(TIMEDEMO_GAME);
 		newdemo_playback_one_frame();
+		timedemo_stage(TIMEDEMO_DEMO);
 		if ( Newdemo_state != ND_STATE_PLAYBACK )		{
 			if (Game_wind)
 				window_close(Game_wind);		// Go back to menu
 			return;
 		}
+		if (GameArg.SysTimeDemo) // the frame just read lasts as long as it was recorded
+		{
+			GameTime64 += newdemo_recorded_frame_time() - FrameTime;
+			FrameTime = newdemo_recorded_frame_time();
+		}
 	}
 	else
 	{ // Note the link to above!
 
 		Players[Player_num].homing_object_dist = -1;		//	Assume not being tracked.  Laser_do_weapon_sequence modifies this.
 
+		PROF_BEGIN(PROF_OBJECTS);
 		object_move_all();
+		PROF_END(PROF_OBJECTS);
 		powerup_grab_cheat_all();
 
 		if (Endlevel_sequence)	//might have been started during move
@@ -1417,7 +1445,9 @@ void GameProcessFrame(void)
 
 		fuelcen_update_all();
 
+		PROF_BEGIN(PROF_AI);
 		do_ai_frame_all();
+		PROF_END(PROF_AI);
 
 		if (allowed_to_fire_laser())
 			FireLaser();				// Fire Laser!
@@ -1576,6 +1606,9 @@ void slide_textures(void)
 									Segments[segnum].sides[sidenum].uvls[j].v += f1_0;
 							}
 						}
+#ifdef OGL
+						ogl_levelmesh_mark_side(segnum, sidenum);
+#endif
 					}
 				}
 			}
@@ -45,6 +45,9 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "piggy.h"
 #include "byteswap.h"
 #include "gamesave.h"
+#ifdef OGL
+#include "ogl_init.h"
+#endif
 
 #define REMOVE_EXT(s)  (*(strchr( (s), '.' ))='\0')
 
@@ -1104,6 +1107,12 @@ int load_mine_data_compiled(PHYSFS_file *LoadFile)
 	}
 
 	reset_objects(1);		//one object, the player
+	flush_conn_tables();
+	invalidate_segment_grid();
+
+#ifdef OGL
+	ogl_levelmesh_invalidate();	// new geometry, the level mesh gets rebuilt when first rendered
+#endif
 
 	return 0;
 }
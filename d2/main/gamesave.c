@@ -57,6 +57,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "byteswap.h"
 #include "multi.h"
 #include "makesig.h"
+#include "args.h"
 
 char Gamesave_current_filename[PATH_MAX];
 
@@ -1023,7 +1024,7 @@ int load_game_data(PHYSFS_file *LoadFile)
 			int objsegnum = Objects[i].segnum;
 
 			if (objsegnum > Highest_segment_index)		//bogus object
-				Objects[i].type = OBJ_NONE;
+				obj_set_type(i, OBJ_NONE);
 			else {
 				Objects[i].segnum = -1;			//avoid Assert()
 				obj_link(i,objsegnum);
@@ -1033,6 +1034,11 @@ int load_game_data(PHYSFS_file *LoadFile)
 
 	clear_transient_objects(1);		//1 means clear proximity bombs
 
+#ifdef BENCHMARKS
+	if (GameArg.DbgObjListStress)
+		stress_object_lists(GameArg.DbgObjListStress);
+#endif
+
 	// Make sure non-transparent doors are set correctly.
 	for (i=0; i< Num_segments; i++)
 		for (j=0;j<MAX_SIDES_PER_SEGMENT;j++) {
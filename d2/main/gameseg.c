@@ -34,6 +34,11 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "fvi.h"
 #include "byteswap.h"
 #include "mission.h"
+#include "args.h"
+#include "timer.h"
+#ifdef EDITOR
+#include "editor/editor.h"
+#endif
 
 // How far a point can be from a plane, and still be "in" the plane
 #define PLANE_DIST_TOLERANCE	250
@@ -302,9 +307,12 @@ void create_abs_vertex_lists(int *num_faces, int *vertices, int segnum, int side
 }
 
 
+#ifdef BENCHMARKS
 //returns 3 different bitmasks with info telling if this sphere is in
-//this segment.  See segmasks structure for info on fields  
-segmasks get_seg_masks(const vms_vector *checkp, int segnum, fix rad, char *calling_file, int calling_linenum)
+//this segment.  See segmasks structure for info on fields
+//Works from the vertices, get_seg_masks() gives the same from the compiled planes.
+//Only -pointsegbench still uses these two, as the reference to check the planes against.
+static segmasks get_seg_masks_by_vertices(const vms_vector *checkp, int segnum, fix rad, char *calling_file, int calling_linenum)
 {
 	int			sn,facebit,sidebit;
 	segmasks		masks;
@@ -451,7 +459,7 @@ segmasks get_seg_masks(const vms_vector *checkp, int segnum, fix rad, char *call
 //this was converted from get_seg_masks()...it fills in an array of 6
 //elements for the distace behind each side, or zero if not behind
 //only gets centermask, and assumes zero rad
-static ubyte get_side_dists(const vms_vector *checkp,int segnum,fix *side_dists)
+static ubyte get_side_dists_by_vertices(const vms_vector *checkp,int segnum,fix *side_dists)
 {
 	int			sn,facebit,sidebit;
 	ubyte			mask;
@@ -591,6 +599,7 @@ static ubyte get_side_dists(const vms_vector *checkp,int segnum,fix *side_dists)
 	return mask;
 
 }
+#endif
 
 #ifndef NDEBUG
 #ifndef COMPACT_SEGS
@@ -699,6 +708,246 @@ int check_segment_connections(void)
 #endif
 #endif
 
+//	----------------------------------------------------------------------------------------------------------
+//	Compiled side planes for get_seg_masks() and get_side_dists().
+//	Instead of building vertex lists and finding plane points for every test, the planes of all faces of a
+//	segment are kept side by side, face 2*side+n in slot 2*side+n just like in the facemask. A point test
+//	is then twelve plane distances computed just like vm_dist_to_plane(), so the masks come out the same.
+//	Built with the segment normals in validate_segment_all() and refreshed by validate_segment().
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SEG_PLANES_SSE
+#include <smmintrin.h>
+#endif
+
+#define	SEG_PLANE_FACES		(MAX_SIDES_PER_SEGMENT*2)
+#define	SEG_PLANE_EVEN_FACES	0x555
+
+typedef struct seg_planes {
+	fix	px[SEG_PLANE_FACES], py[SEG_PLANE_FACES], pz[SEG_PLANE_FACES];	//	point on the plane, the same for both faces of a side
+	fix	nx[SEG_PLANE_FACES], ny[SEG_PLANE_FACES], nz[SEG_PLANE_FACES];	//	face normal, 0 for the missing second face of a quad side
+	short	faces;		//	bit per existing face
+	short	behind_one;	//	bit of the first face of each side where being behind one face is enough (quad or poking out)
+} seg_planes;
+
+static seg_planes *Seg_planes;
+static int Num_seg_planes;
+#ifdef SEG_PLANES_SSE
+static int Seg_planes_sse = -1;
+#endif
+
+//	----------------------------------------------------------------------------------------------------------
+static void compile_seg_planes(int segnum)
+{
+	seg_planes	*sp = &Seg_planes[segnum];
+	segment	*seg = &Segments[segnum];
+	int	sn, fn, i, num_faces, vertnum, vertex_list[6];
+
+	memset(sp, 0, sizeof(*sp));
+
+	for (sn=0; sn<MAX_SIDES_PER_SEGMENT; sn++) {
+		side	*s = &seg->sides[sn];
+		int	f = sn*2;
+
+		create_abs_vertex_lists(&num_faces, vertex_list, segnum, sn, __FILE__, __LINE__);
+
+		//	the same plane points and side shapes get_seg_masks_by_vertices() uses
+		if (num_faces==2) {
+			fix	dist;
+
+			vertnum = min(vertex_list[0],vertex_list[2]);
+			if (vertex_list[4] < vertex_list[1])
+				dist = vm_dist_to_plane(&Vertices[vertex_list[4]],&s->normals[0],&Vertices[vertnum]);
+			else
+				dist = vm_dist_to_plane(&Vertices[vertex_list[1]],&s->normals[1],&Vertices[vertnum]);
+			if (dist > PLANE_DIST_TOLERANCE)
+				sp->behind_one |= 1 << f;
+		} else {
+			vertnum = vertex_list[0];
+			for (i=1;i<4;i++)
+				if (vertex_list[i] < vertnum)
+					vertnum = vertex_list[i];
+			sp->behind_one |= 1 << f;
+		}
+
+		for (fn=0; fn<num_faces; fn++) {
+			sp->px[f+fn] = Vertices[vertnum].x;
+			sp->py[f+fn] = Vertices[vertnum].y;
+			sp->pz[f+fn] = Vertices[vertnum].z;
+			sp->nx[f+fn] = s->normals[fn].x;
+			sp->ny[f+fn] = s->normals[fn].y;
+			sp->nz[f+fn] = s->normals[fn].z;
+			sp->faces |= 1 << (f+fn);
+		}
+	}
+}
+
+//	----------------------------------------------------------------------------------------------------------
+static void build_seg_planes(void)
+{
+	int	s;
+
+	if (Seg_planes)
+		d_free(Seg_planes);
+	Num_seg_planes = Highest_segment_index+1;
+	MALLOC(Seg_planes, seg_planes, Num_seg_planes);
+	if (!Seg_planes)
+		Error("Not enough memory for segment planes");
+	memset(Seg_planes, 0, sizeof(seg_planes)*Num_seg_planes);
+	for (s=0; s<Num_seg_planes; s++)
+		#ifdef EDITOR
+		if (Segments[s].segnum != -1)
+		#endif
+			compile_seg_planes(s);
+
+#ifdef SEG_PLANES_SSE
+	if (Seg_planes_sse == -1)
+		Seg_planes_sse = __builtin_cpu_supports("sse4.1") != 0;
+#endif
+}
+
+static seg_planes *get_seg_planes(int segnum)
+{
+	if (segnum >= Num_seg_planes)	//	the editor added segments
+		build_seg_planes();
+	return &Seg_planes[segnum];
+}
+
+//	----------------------------------------------------------------------------------------------------------
+//	Distances of p to all face planes, with bits for the faces p is behind (cbits) and the faces a sphere of
+//	radius rad pokes through (sbits).
+static void seg_plane_dists(const seg_planes *sp, const vms_vector *p, fix rad, fix *dists, int *cbits, int *sbits)
+{
+	int	f;
+
+	*cbits = *sbits = 0;
+	for (f=0; f<SEG_PLANE_FACES; f++) {
+		fix	dx = p->x - sp->px[f], dy = p->y - sp->py[f], dz = p->z - sp->pz[f];
+		fix	dist = ((long long) dx * sp->nx[f] + (long long) dy * sp->ny[f] + (long long) dz * sp->nz[f]) >> 16;
+
+		dists[f] = dist;
+		if (dist < -PLANE_DIST_TOLERANCE)
+			*cbits |= 1 << f;
+		if (dist-rad < -PLANE_DIST_TOLERANCE)
+			*sbits |= 1 << f;
+	}
+	*sbits &= sp->faces;
+}
+
+#ifdef SEG_PLANES_SSE
+//	The same four faces at a time.
+__attribute__((target("sse4.1")))
+static void seg_plane_dists_sse(const seg_planes *sp, const vms_vector *p, fix rad, fix *dists, int *cbits, int *sbits)
+{
+	__m128i	x = _mm_set1_epi32(p->x), y = _mm_set1_epi32(p->y), z = _mm_set1_epi32(p->z);
+	__m128i	tol = _mm_set1_epi32(-PLANE_DIST_TOLERANCE), r = _mm_set1_epi32(rad);
+	int	f;
+
+	*cbits = *sbits = 0;
+	for (f=0; f<SEG_PLANE_FACES; f+=4) {
+		__m128i	dx = _mm_sub_epi32(x, _mm_loadu_si128((const __m128i *) &sp->px[f]));
+		__m128i	dy = _mm_sub_epi32(y, _mm_loadu_si128((const __m128i *) &sp->py[f]));
+		__m128i	dz = _mm_sub_epi32(z, _mm_loadu_si128((const __m128i *) &sp->pz[f]));
+		__m128i	nx = _mm_loadu_si128((const __m128i *) &sp->nx[f]);
+		__m128i	ny = _mm_loadu_si128((const __m128i *) &sp->ny[f]);
+		__m128i	nz = _mm_loadu_si128((const __m128i *) &sp->nz[f]);
+		__m128i	even, odd, dist;
+
+		//	64 bit dot products of faces 0 and 2, then of faces 1 and 3
+		even = _mm_add_epi64(_mm_add_epi64(_mm_mul_epi32(dx, nx), _mm_mul_epi32(dy, ny)), _mm_mul_epi32(dz, nz));
+		odd = _mm_add_epi64(_mm_add_epi64(_mm_mul_epi32(_mm_srli_epi64(dx, 32), _mm_srli_epi64(nx, 32)),
+			_mm_mul_epi32(_mm_srli_epi64(dy, 32), _mm_srli_epi64(ny, 32))), _mm_mul_epi32(_mm_srli_epi64(dz, 32), _mm_srli_epi64(nz, 32)));
+		//	bits 16 to 47 of each product are the fix result, move them to the low resp. high half of the lanes
+		dist = _mm_blend_epi16(_mm_srli_epi64(even, 16), _mm_slli_epi64(odd, 16), 0xcc);
+
+		_mm_storeu_si128((__m128i *) &dists[f], dist);
+		*cbits |= _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(dist, tol))) << f;
+		*sbits |= _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(_mm_sub_epi32(dist, r), tol))) << f;
+	}
+	*sbits &= sp->faces;
+}
+#endif
+
+//	----------------------------------------------------------------------------------------------------------
+//	Sides from face bits: behind both faces, or behind one where that is enough.
+static int seg_plane_sides(const seg_planes *sp, int bits)
+{
+	int	first = bits & SEG_PLANE_EVEN_FACES, second = (bits >> 1) & SEG_PLANE_EVEN_FACES;
+	int	behind = ((first | second) & sp->behind_one) | (first & second & ~sp->behind_one);
+	int	sn, sides = 0;
+
+	for (sn=0; sn<MAX_SIDES_PER_SEGMENT; sn++)
+		sides |= ((behind >> (sn*2)) & 1) << sn;
+
+	return sides;
+}
+
+static void get_seg_plane_dists(const seg_planes *sp, const vms_vector *p, fix rad, fix *dists, int *cbits, int *sbits)
+{
+#ifdef SEG_PLANES_SSE
+	if (Seg_planes_sse) {
+		seg_plane_dists_sse(sp, p, rad, dists, cbits, sbits);
+		return;
+	}
+#endif
+	seg_plane_dists(sp, p, rad, dists, cbits, sbits);
+}
+
+//returns 3 different bitmasks with info telling if this sphere is in
+//this segment.  See segmasks structure for info on fields  
+segmasks get_seg_masks(const vms_vector *checkp, int segnum, fix rad, char *calling_file, int calling_linenum)
+{
+	seg_planes	*sp;
+	segmasks	masks;
+	fix		dists[SEG_PLANE_FACES];
+	int		cbits, sbits;
+	extern int Current_level_num;
+
+	if (segnum < 0 || segnum > Highest_segment_index)
+		Error("segnum == %i (%i) in get_seg_masks() \ncheckp: %i,%i,%i, rad: %i \nfrom file: %s, line: %i \nMission: %s (%i) \nPlease report this bug.\n",segnum,Highest_segment_index,checkp->x,checkp->y,checkp->z,rad,calling_file,calling_linenum, Current_mission_filename, Current_level_num);
+
+	sp = get_seg_planes(segnum);
+	get_seg_plane_dists(sp, checkp, rad, dists, &cbits, &sbits);
+
+	masks.facemask = sbits;
+	masks.sidemask = seg_plane_sides(sp, sbits);
+	masks.centermask = seg_plane_sides(sp, cbits);
+
+	return masks;
+}
+
+//this was converted from get_seg_masks()...it fills in an array of 6
+//elements for the distace behind each side, or zero if not behind
+//only gets centermask, and assumes zero rad
+static ubyte get_side_dists(const vms_vector *checkp,int segnum,fix *side_dists)
+{
+	seg_planes	*sp;
+	fix		dists[SEG_PLANE_FACES];
+	int		cbits, sbits, sn;
+
+	Assert((segnum <= Highest_segment_index) && (segnum >= 0));
+
+	if (segnum==-1)
+		Error("segnum == -1 in get_seg_dists()");
+
+	sp = get_seg_planes(segnum);
+	get_seg_plane_dists(sp, checkp, 0, dists, &cbits, &sbits);
+
+	for (sn=0; sn<MAX_SIDES_PER_SEGMENT; sn++) {
+		int	f = sn*2;
+
+		side_dists[sn] = 0;
+		if (cbits & (1 << f))
+			side_dists[sn] += dists[f];
+		if (cbits & (2 << f)) {
+			side_dists[sn] += dists[f+1];
+			if (cbits & (1 << f))
+				side_dists[sn] /= 2;		//get average
+		}
+	}
+
+	return seg_plane_sides(sp, cbits);
+}
+
 // Used to become a constant based on editor, but I wanted to be able to set
 // this for omega blob find_point_seg calls.
 // Would be better to pass a paremeter to the routine...--MK, 01/17/96
@@ -713,7 +962,7 @@ static int trace_segs(const vms_vector *p0, int oldsegnum, int recursion_count)
 	fix side_dists[6];
 	fix biggest_val;
 	int sidenum, bit, check, biggest_side;
-	static ubyte visited [MAX_SEGMENTS];
+	static unsigned visited [MAX_SEGMENTS], visit_id;	// visited by the search with this id
 
 	Assert((oldsegnum <= Highest_segment_index) && (oldsegnum >= 0));
 
@@ -721,11 +970,13 @@ static int trace_segs(const vms_vector *p0, int oldsegnum, int recursion_count)
 		con_printf (CON_DEBUG, "trace_segs: Segment not found\n");
 		return -1;
 	}
-	if (recursion_count == 0)
+	if (recursion_count == 0 && ++visit_id == 0) {
 		memset (visited, 0, sizeof (visited));
-	if (visited [oldsegnum])
+		visit_id = 1;
+	}
+	if (visited [oldsegnum] == visit_id)
 		return -1;
-	visited [oldsegnum] = 1;
+	visited [oldsegnum] = visit_id;
 
 	centermask = get_side_dists(p0,oldsegnum,side_dists);		//check old segment
 	if (centermask == 0) // we are in the old segment
@@ -755,6 +1006,276 @@ static int trace_segs(const vms_vector *p0, int oldsegnum, int recursion_count)
 }
 
 
+//	----------------------------------------------------------------------------------------------------------
+//	Uniform grid over the bounding boxes of all segments. Finding the segment of a point without tracing only
+//	tests the segments whose boxes contain the point, instead of every segment in the mine.
+//	The boxes are padded since a segment with sides poking in reaches a bit beyond its vertices.
+//	Cells list their segments in increasing order, so the first one found is the one a test of all
+//	segments in order would have found. Built when first needed after the mine was loaded.
+#define	SEG_GRID_MAX_DIM	64
+
+typedef struct seg_grid {
+	int		valid;
+	fix64		min[3], cell[3];
+	int		dim[3];
+	int		*start;		//	segments of cell i are segs[start[i]] to segs[start[i+1]-1]
+	short		*segs;
+} seg_grid;
+
+static seg_grid Seg_grid;
+
+//	----------------------------------------------------------------------------------------------------------
+//	The mine changed, build the grid again when it's needed next.
+void invalidate_segment_grid(void)
+{
+	if (Seg_grid.start)
+		d_free(Seg_grid.start);
+	if (Seg_grid.segs)
+		d_free(Seg_grid.segs);
+	Seg_grid.valid = 0;
+}
+
+//	----------------------------------------------------------------------------------------------------------
+static void get_segment_box(int segnum, fix64 *bmin, fix64 *bmax)
+{
+	int	v, i;
+
+	for (i=0; i<3; i++) {
+		bmin[i] = 0x7fffffff;
+		bmax[i] = -0x7fffffff;
+	}
+	for (v=0; v<MAX_VERTICES_PER_SEGMENT; v++) {
+		vms_vector_array	*vp = (vms_vector_array *) &Vertices[Segments[segnum].verts[v]];
+
+		for (i=0; i<3; i++) {
+			if (vp->xyz[i] < bmin[i])
+				bmin[i] = vp->xyz[i];
+			if (vp->xyz[i] > bmax[i])
+				bmax[i] = vp->xyz[i];
+		}
+	}
+	for (i=0; i<3; i++) {
+		fix64	pad = (bmax[i] - bmin[i]) / 8 + F1_0;
+
+		bmin[i] -= pad;
+		bmax[i] += pad;
+	}
+}
+
+//	----------------------------------------------------------------------------------------------------------
+//	Range of grid cells covered by the box, clamped to the grid.
+static void get_grid_cells(fix64 *bmin, fix64 *bmax, int *c0, int *c1)
+{
+	int	i;
+
+	for (i=0; i<3; i++) {
+		fix64	d0 = (bmin[i] - Seg_grid.min[i]) / Seg_grid.cell[i], d1 = (bmax[i] - Seg_grid.min[i]) / Seg_grid.cell[i];
+
+		c0[i] = d0 < 0 ? 0 : d0 >= Seg_grid.dim[i] ? Seg_grid.dim[i]-1 : d0;
+		c1[i] = d1 < 0 ? 0 : d1 >= Seg_grid.dim[i] ? Seg_grid.dim[i]-1 : d1;
+	}
+}
+
+//	----------------------------------------------------------------------------------------------------------
+static void build_segment_grid(void)
+{
+	fix64	lmin[3], lmax[3], bmin[3], bmax[3];
+	int	num_segs = Highest_segment_index+1, pass, segnum, i, x, y, z, c0[3], c1[3];
+	double	volume, cell;
+
+	invalidate_segment_grid();
+
+	for (i=0; i<3; i++) {
+		lmin[i] = 0x7fffffff;
+		lmax[i] = -0x7fffffff;
+	}
+	for (segnum=0; segnum<num_segs; segnum++) {
+		get_segment_box(segnum, bmin, bmax);
+		for (i=0; i<3; i++) {
+			if (bmin[i] < lmin[i])
+				lmin[i] = bmin[i];
+			if (bmax[i] > lmax[i])
+				lmax[i] = bmax[i];
+		}
+	}
+
+	//	about as many cells as segments
+	volume = (double) (lmax[0]-lmin[0]) * (lmax[1]-lmin[1]) * (lmax[2]-lmin[2]) / num_segs;
+	for (cell = F1_0; cell*cell*cell < volume; cell *= 1.25)
+		;
+	for (i=0; i<3; i++) {
+		Seg_grid.dim[i] = (int) ((lmax[i]-lmin[i]) / cell) + 1;
+		if (Seg_grid.dim[i] > SEG_GRID_MAX_DIM)
+			Seg_grid.dim[i] = SEG_GRID_MAX_DIM;
+		Seg_grid.cell[i] = (lmax[i]-lmin[i]) / Seg_grid.dim[i] + 1;
+		Seg_grid.min[i] = lmin[i];
+	}
+
+	MALLOC(Seg_grid.start, int, Seg_grid.dim[0]*Seg_grid.dim[1]*Seg_grid.dim[2]+1);
+	if (!Seg_grid.start)
+		Error("Not enough memory for segment grid");
+	memset(Seg_grid.start, 0, sizeof(int)*(Seg_grid.dim[0]*Seg_grid.dim[1]*Seg_grid.dim[2]+1));
+
+	//	count the segments of each cell, then put them in place
+	for (pass=0; pass<2; pass++) {
+		for (segnum=0; segnum<num_segs; segnum++) {
+			get_segment_box(segnum, bmin, bmax);
+			get_grid_cells(bmin, bmax, c0, c1);
+			for (z=c0[2]; z<=c1[2]; z++)
+				for (y=c0[1]; y<=c1[1]; y++)
+					for (x=c0[0]; x<=c1[0]; x++) {
+						int	c = (z*Seg_grid.dim[1] + y)*Seg_grid.dim[0] + x;
+
+						if (pass == 0)
+							Seg_grid.start[c+1]++;
+						else
+							Seg_grid.segs[Seg_grid.start[c]++] = segnum;
+					}
+		}
+
+		if (pass == 0) {
+			for (i=0; i<Seg_grid.dim[0]*Seg_grid.dim[1]*Seg_grid.dim[2]; i++)
+				Seg_grid.start[i+1] += Seg_grid.start[i];
+			MALLOC(Seg_grid.segs, short, Seg_grid.start[i]);
+			if (!Seg_grid.segs)
+				Error("Not enough memory for segment grid");
+		} else {
+			//	start[c] got moved to the end of cell c, which is where cell c+1 starts
+			for (i=Seg_grid.dim[0]*Seg_grid.dim[1]*Seg_grid.dim[2]; i>0; i--)
+				Seg_grid.start[i] = Seg_grid.start[i-1];
+			Seg_grid.start[0] = 0;
+		}
+	}
+
+	Seg_grid.valid = 1;
+	con_printf(CON_VERBOSE, "Segment grid: %ix%ix%i cells, %i entries for %i segments\n", Seg_grid.dim[0], Seg_grid.dim[1], Seg_grid.dim[2], Seg_grid.start[Seg_grid.dim[0]*Seg_grid.dim[1]*Seg_grid.dim[2]], num_segs);
+}
+
+//	----------------------------------------------------------------------------------------------------------
+static int grid_point_seg(const vms_vector *p)
+{
+	vms_vector_array	*pa = (vms_vector_array *) p;
+	int	c[3], i, cell;
+
+	for (i=0; i<3; i++) {
+		fix64	d = ((fix64) pa->xyz[i] - Seg_grid.min[i]) / Seg_grid.cell[i];
+
+		if (d < 0 || d >= Seg_grid.dim[i])
+			return -1;
+		c[i] = d;
+	}
+
+	cell = (c[2]*Seg_grid.dim[1] + c[1])*Seg_grid.dim[0] + c[0];
+	for (i=Seg_grid.start[cell]; i<Seg_grid.start[cell+1]; i++)
+		if (get_seg_masks(p, Seg_grid.segs[i], 0, __FILE__, __LINE__).centermask == 0)
+			return Seg_grid.segs[i];
+
+	return -1;
+}
+
+#if defined(EDITOR) || defined(BENCHMARKS)
+//	----------------------------------------------------------------------------------------------------------
+//	Test every segment in order, what find_point_seg() does if there is no grid.
+static int scan_point_seg(const vms_vector *p)
+{
+	int	segnum;
+
+	for (segnum=0; segnum <= Highest_segment_index; segnum++)
+		if (get_seg_masks(p, segnum, 0, __FILE__, __LINE__).centermask == 0)
+			return segnum;
+
+	return -1;
+}
+#endif
+
+#ifdef BENCHMARKS
+//	----------------------------------------------------------------------------------------------------------
+//	-pointsegbench: locate random points in the mine with the grid and by testing all segments, compare
+//	the results and the time it took.
+static void bench_point_seg(int num_points)
+{
+	vms_vector	*points;
+	short		*grid_segs;
+	int	i, n, found = 0, mismatches = 0;
+	fix64	t0, t1, t2;
+
+	MALLOC(points, vms_vector, num_points);
+	MALLOC(grid_segs, short, num_points);
+	if (!points || !grid_segs)
+		Error("Not enough memory for -pointsegbench");
+	for (n=0; n<num_points; n++) {
+		vms_vector_array	*pa = (vms_vector_array *) &points[n];
+
+		for (i=0; i<3; i++)
+			pa->xyz[i] = Seg_grid.min[i] + Seg_grid.cell[i] * Seg_grid.dim[i] * ((d_rand() << 15) | d_rand()) / (1 << 30);
+	}
+
+	timer_update();
+	t0 = timer_query();
+	for (n=0; n<num_points; n++)
+		grid_segs[n] = grid_point_seg(&points[n]);
+	timer_update();
+	t1 = timer_query();
+	for (n=0; n<num_points; n++) {
+		int	segnum = scan_point_seg(&points[n]);
+
+		found += segnum != -1;
+		mismatches += segnum != grid_segs[n];
+	}
+	timer_update();
+	t2 = timer_query();
+
+	con_printf(CON_NORMAL, "find_point_seg: %i random points, %i in the mine: grid %ims, all segments %ims, %i different results\n", num_points, found, f2i((t1-t0)*1000), f2i((t2-t1)*1000), mismatches);
+
+	//	masks from the compiled planes against the ones from the vertices, for the segment of the point or a random one
+	for (n=0; n<num_points; n++)
+		if (grid_segs[n] == -1)
+			grid_segs[n] = d_rand() % (Highest_segment_index+1);
+
+	mismatches = 0;
+	for (n=0; n<num_points; n++) {
+		fix	rad = d_rand() * 16, side_dists[6], ref_side_dists[6];
+		segmasks	m = get_seg_masks(&points[n], grid_segs[n], rad, __FILE__, __LINE__);
+		segmasks	ref = get_seg_masks_by_vertices(&points[n], grid_segs[n], rad, __FILE__, __LINE__);
+
+		if (m.facemask != ref.facemask || m.sidemask != ref.sidemask || m.centermask != ref.centermask)
+			mismatches++;
+		else if (get_side_dists(&points[n], grid_segs[n], side_dists) != get_side_dists_by_vertices(&points[n], grid_segs[n], ref_side_dists) || memcmp(side_dists, ref_side_dists, sizeof(side_dists)))
+			mismatches++;
+#ifdef SEG_PLANES_SSE
+		else if (Seg_planes_sse) {
+			fix	dists[SEG_PLANE_FACES], sse_dists[SEG_PLANE_FACES];
+			int	cbits, sbits, sse_cbits, sse_sbits;
+
+			seg_plane_dists(get_seg_planes(grid_segs[n]), &points[n], rad, dists, &cbits, &sbits);
+			seg_plane_dists_sse(get_seg_planes(grid_segs[n]), &points[n], rad, sse_dists, &sse_cbits, &sse_sbits);
+			if (cbits != sse_cbits || sbits != sse_sbits || memcmp(dists, sse_dists, sizeof(dists)))
+				mismatches++;
+		}
+#endif
+	}
+
+	timer_update();
+	t0 = timer_query();
+	for (n=0; n<num_points; n++)
+		found += get_seg_masks(&points[n], grid_segs[n], F1_0, __FILE__, __LINE__).centermask;
+	timer_update();
+	t1 = timer_query();
+	for (n=0; n<num_points; n++)
+		found += get_seg_masks_by_vertices(&points[n], grid_segs[n], F1_0, __FILE__, __LINE__).centermask;
+	timer_update();
+	t2 = timer_query();
+
+#ifdef SEG_PLANES_SSE
+	con_printf(CON_NORMAL, "get_seg_masks: compiled planes (%s) %ims, from vertices %ims, %i different results\n", Seg_planes_sse ? "sse4.1" : "scalar", f2i((t1-t0)*1000), f2i((t2-t1)*1000), mismatches);
+#else
+	con_printf(CON_NORMAL, "get_seg_masks: compiled planes %ims, from vertices %ims, %i different results\n", f2i((t1-t0)*1000), f2i((t2-t1)*1000), mismatches);
+#endif
+	d_free(grid_segs);
+	d_free(points);
+}
+#endif
+
 int	Exhaustive_count=0, Exhaustive_failed_count=0;
 
 //Tries to find a segment for a point, in the following way:
@@ -783,11 +1304,19 @@ int find_point_seg(const vms_vector *p,int segnum)
 	//	slowing down lighting, and in about 98% of cases, it would just return -1 anyway.
 	//	Matt: This really should be fixed, though.  We're probably screwing up our lighting in a few places.
 	if (!Doing_lighting_hack_flag) {
-		for (newseg=0;newseg <= Highest_segment_index;newseg++)
-			if (get_seg_masks(p, newseg, 0, __FILE__, __LINE__).centermask == 0)
-				return newseg;
+#ifdef EDITOR
+		if (EditorWindow)	//	the mine can change at any time
+			return scan_point_seg(p);
+#endif
+		if (!Seg_grid.valid) {
+			build_segment_grid();
+#ifdef BENCHMARKS
+			if (GameArg.DbgPointSegBench)
+				bench_point_seg(GameArg.DbgPointSegBench);
+#endif
+		}
 
-		return -1;		//no segment found
+		return grid_point_seg(p);
 	} else
 		return -1;
 }
@@ -866,208 +1395,321 @@ int find_point_seg(const vms_vector *p,int segnum)
 
 int	Connected_segment_distance;
 
-#define	MIN_CACHE_FCD_DIST	(F1_0*80)	//	Must be this far apart for cache lookup to succeed.  Recognizes small changes in distance matter at small distances.
-#define	MAX_FCD_CACHE	8
-
-typedef struct {
-	int	seg0, seg1, csd;
-	fix	dist;
-} fcd_data;
-
-int	Fcd_index = 0;
-fcd_data Fcd_cache[MAX_FCD_CACHE];
-fix64	Last_fcd_flush_time;
+//	----------------------------------------------------------------------------------------------------------
+//	Connectivity tables for find_connected_distance().
+//	A table holds a complete breadth first search from one segment through the sides passable with one
+//	wid_flag, visiting the sides in the same order find_connected_distance() always did. For every segment
+//	reached it keeps the depth, the previous segment, the first segment after the source and the path
+//	length between the centers of those two, so a query only needs two more vm_vec_dist_quick() calls.
+//	The search order also tells where a search with a smaller max_depth would have given up, so one table
+//	answers every max_depth.
+//	Walls are looked at once per game frame and every change is logged with the segment the wall is in.
+//	A table only has to be searched again if it reached one of those segments: it never looked at the
+//	walls of the segments it didn't reach.
+#define	CONN_TABLES			32
+#define	CONN_MAX_DEPTH		(MAX_LOC_POINT_SEGS-2)	//	deeper than this find_connected_distance() never searched
+#define	CONN_WALL_LOG		64
+#define	CONN_WALL_UNKNOWN	0xff
+#define	CONN_NEVER			0x7fff
+
+typedef struct conn_node {
+	fix	len;		//	path length from the center of first to the center of this segment
+	short	first;	//	first segment after the source
+	short	parent;	//	previous segment on the path
+	short	order;	//	position in the search, the source is 0
+	short	depth;	//	number of steps from the source, -1 if not reached
+} conn_node;
+
+typedef struct conn_table {
+	int	seg0, wid_flag;
+	int	num_nodes;		//	Highest_segment_index+1 at the time of the search
+	unsigned	epoch;		//	wall changes up to this one are accounted for
+	unsigned	last_used;
+	short	expander[CONN_MAX_DEPTH];	//	order of the first segment at each depth that reached a new segment
+	conn_node	*node;		//	NULL if the table is unused
+} conn_table;
+
+typedef struct conn_wall_change {
+	short	segnum;
+	ubyte	before, after;	//	WALL_IS_DOORWAY() values
+} conn_wall_change;
+
+static conn_table Conn_tables[CONN_TABLES];
+static conn_wall_change Conn_wall_log[CONN_WALL_LOG];
+static ubyte Conn_wall_state[MAX_WALLS];
+static unsigned Conn_epoch, Conn_use;
+static int Conn_walls_checked;
+static fix64 Conn_walls_time;
+static unsigned Conn_lookups, Conn_hits, Conn_searches, Conn_kept, Conn_redone;
 
 //	----------------------------------------------------------------------------------------------------------
-void flush_fcd_cache(void)
+//	Forget all connectivity tables, needed whenever the mine changed.
+void flush_conn_tables(void)
 {
 	int	i;
 
-	Fcd_index = 0;
+	if (Conn_lookups)
+		con_printf(CON_VERBOSE, "Connectivity: %u lookups, %.1f%% from tables, %u searches, %u tables kept and %u searched again after wall changes\n", Conn_lookups, Conn_hits*100.0/Conn_lookups, Conn_searches, Conn_kept, Conn_redone);
+	Conn_lookups = Conn_hits = Conn_searches = Conn_kept = Conn_redone = 0;
 
-	for (i=0; i<MAX_FCD_CACHE; i++)
-		Fcd_cache[i].seg0 = -1;
+	for (i=0; i<CONN_TABLES; i++)
+		if (Conn_tables[i].node)
+			d_free(Conn_tables[i].node);
+	memset(Conn_wall_state, CONN_WALL_UNKNOWN, sizeof(Conn_wall_state));
+	Conn_walls_checked = 0;
 }
 
 //	----------------------------------------------------------------------------------------------------------
-void add_to_fcd_cache(int seg0, int seg1, int depth, fix dist)
+//	Doors opened, closed or disappeared, look at the walls again before the next lookup.
+void conn_walls_changed(void)
 {
-	if (dist > MIN_CACHE_FCD_DIST) {
-		Fcd_cache[Fcd_index].seg0 = seg0;
-		Fcd_cache[Fcd_index].seg1 = seg1;
-		Fcd_cache[Fcd_index].csd = depth;
-		Fcd_cache[Fcd_index].dist = dist;
+	Conn_walls_checked = 0;
+}
 
-		Fcd_index++;
+//	----------------------------------------------------------------------------------------------------------
+static void check_conn_walls(void)
+{
+	int	i;
 
-		if (Fcd_index >= MAX_FCD_CACHE)
-			Fcd_index = 0;
-	} else {
-		//	If it's in the cache, remove it.
-		int	i;
+	for (i=0; i<Num_walls; i++) {
+		ubyte	state;
 
-		for (i=0; i<MAX_FCD_CACHE; i++)
-			if (Fcd_cache[i].seg0 == seg0)
-				if (Fcd_cache[i].seg1 == seg1) {
-					Fcd_cache[Fcd_index].seg0 = -1;
-					break;
-				}
+		if (Walls[i].segnum < 0 || Walls[i].segnum > Highest_segment_index)
+			continue;
+		state = WALL_IS_DOORWAY(&Segments[Walls[i].segnum], Walls[i].sidenum);
+		if (state != Conn_wall_state[i]) {
+			if (Conn_wall_state[i] != CONN_WALL_UNKNOWN) {
+				conn_wall_change	*c = &Conn_wall_log[++Conn_epoch % CONN_WALL_LOG];
+
+				c->segnum = Walls[i].segnum;
+				c->before = Conn_wall_state[i];
+				c->after = state;
+			}
+			Conn_wall_state[i] = state;
+		}
 	}
 
+	Conn_walls_checked = 1;
+	Conn_walls_time = GameTime64;
 }
 
 //	----------------------------------------------------------------------------------------------------------
-//	Determine whether seg0 and seg1 are reachable in a way that allows sound to pass.
-//	Search up to a maximum depth of max_depth.
-//	Return the distance.
-fix find_connected_distance(vms_vector *p0, int seg0, vms_vector *p1, int seg1, int max_depth, int wid_flag)
+//	Is the table still right, ie. did none of the walls it looked at change since the search?
+static int conn_table_current(conn_table *t)
 {
-	int		cur_seg;
-	int		sidenum;
-	int		qtail = 0, qhead = 0;
-	int		i;
-	sbyte   visited[MAX_SEGMENTS];
-	seg_seg	seg_queue[MAX_SEGMENTS];
-	short		depth[MAX_SEGMENTS];
-	int		cur_depth;
-	int		num_points;
-	point_seg	point_segs[MAX_LOC_POINT_SEGS];
-	fix		dist;
+	unsigned	e;
 
-	//	If > this, will overrun point_segs buffer
-#ifdef WINDOWS
-	if (max_depth == -1) max_depth = 200;
-#endif	
+	if (Conn_epoch - t->epoch > CONN_WALL_LOG)
+		return 0;
 
-	if (max_depth > MAX_LOC_POINT_SEGS-2) {
-		max_depth = MAX_LOC_POINT_SEGS-2;
-	}
+	for (e = t->epoch+1; e != Conn_epoch+1; e++) {
+		conn_wall_change	*c = &Conn_wall_log[e % CONN_WALL_LOG];
 
-	if (seg0 == seg1) {
-		Connected_segment_distance = 0;
-		return vm_vec_dist_quick(p0, p1);
-	} else {
-		int	conn_side;
-		if ((conn_side = find_connect_side(&Segments[seg0], &Segments[seg1])) != -1) {
-			if (WALL_IS_DOORWAY(&Segments[seg1], conn_side) & wid_flag) {
-				Connected_segment_distance = 1;
-				return vm_vec_dist_quick(p0, p1);
-			}
-		}
+		if (c->segnum < t->num_nodes && t->node[c->segnum].depth >= 0)
+			if (!(c->before & t->wid_flag) != !(c->after & t->wid_flag))
+				return 0;
 	}
 
-	//	Periodically flush cache.
-	if ((GameTime64 - Last_fcd_flush_time > F1_0*2) || (GameTime64 < Last_fcd_flush_time)) {
-		flush_fcd_cache();
-		Last_fcd_flush_time = GameTime64;
-	}
+	return 1;
+}
 
-	//	Can't quickly get distance, so see if in Fcd_cache.
-	for (i=0; i<MAX_FCD_CACHE; i++)
-		if ((Fcd_cache[i].seg0 == seg0) && (Fcd_cache[i].seg1 == seg1)) {
-			Connected_segment_distance = Fcd_cache[i].csd;
-			return Fcd_cache[i].dist;
-		}
+//	----------------------------------------------------------------------------------------------------------
+static void search_conn_table(conn_table *t)
+{
+	short		queue[MAX_SEGMENTS];
+	int		qhead = 0, qtail = 0, i, sidenum;
+	conn_node	*node = t->node;
+	vms_vector	center, parent_center;
+
+	for (i=0; i<t->num_nodes; i++)
+		node[i].depth = -1;
+	for (i=0; i<CONN_MAX_DEPTH; i++)
+		t->expander[i] = CONN_NEVER;
+
+	node[t->seg0].depth = 0;
+	node[t->seg0].order = 0;
+	node[t->seg0].first = node[t->seg0].parent = -1;
+	node[t->seg0].len = 0;
+	queue[qtail++] = t->seg0;
+
+	while (qhead < qtail) {
+		int		cur_seg = queue[qhead++];
+		segment	*segp = &Segments[cur_seg];
+		conn_node	*cur = &node[cur_seg];
 
-	num_points = 0;
+		compute_segment_center(&parent_center, segp);
+
+		for (sidenum = 0; sidenum < MAX_SIDES_PER_SEGMENT; sidenum++) {
+			int		this_seg;
+			conn_node	*n;
+
+			if (!(WALL_IS_DOORWAY(segp, sidenum) & t->wid_flag))
+				continue;
+			this_seg = segp->children[sidenum];
+			n = &node[this_seg];
+			if (n->depth >= 0)
+				continue;
+
+			if (cur->depth < CONN_MAX_DEPTH && t->expander[cur->depth] == CONN_NEVER)
+				t->expander[cur->depth] = cur->order;
+			n->depth = cur->depth+1;
+			n->order = qtail;
+			n->parent = cur_seg;
+			if (cur_seg == t->seg0) {
+				n->first = this_seg;
+				n->len = 0;
+			} else {
+				compute_segment_center(&center, &Segments[this_seg]);
+				n->first = cur->first;
+				n->len = cur->len + vm_vec_dist_quick(&parent_center, &center);
+			}
+			queue[qtail++] = this_seg;
+		}
+	}
+}
 
-	memset(visited, 0, Highest_segment_index+1);
-	memset(depth, 0, sizeof(depth[0]) * (Highest_segment_index+1));
+//	----------------------------------------------------------------------------------------------------------
+//	Get the table for seg0 and wid_flag, searching only if there is none or walls it depends on changed.
+static conn_table *get_conn_table(int seg0, int wid_flag)
+{
+	conn_table	*t, *lru = &Conn_tables[0];
+	int		i, reuse = 1;
 
-	cur_seg = seg0;
-	visited[cur_seg] = 1;
-	cur_depth = 0;
+#ifdef EDITOR
+	if (EditorWindow)	//	the mine can change at any time
+		reuse = 0;
+#endif
 
-	while (cur_seg != seg1) {
-		segment	*segp = &Segments[cur_seg];
+	if (!Conn_walls_checked || Conn_walls_time != GameTime64)
+		check_conn_walls();
 
-		for (sidenum = 0; sidenum < MAX_SIDES_PER_SEGMENT; sidenum++) {
+	Conn_lookups++;
+	Conn_use++;
 
-			int	snum = sidenum;
-
-			if (WALL_IS_DOORWAY(segp, snum) & wid_flag) {
-				int	this_seg = segp->children[snum];
-
-				if (!visited[this_seg]) {
-					seg_queue[qtail].start = cur_seg;
-					seg_queue[qtail].end = this_seg;
-					visited[this_seg] = 1;
-					depth[qtail++] = cur_depth+1;
-					if (max_depth != -1) {
-						if (depth[qtail-1] == max_depth) {
-							Connected_segment_distance = 1000;
-							add_to_fcd_cache(seg0, seg1, Connected_segment_distance, F1_0*1000);
-							return -1;
-						}
-					} else if (this_seg == seg1) {
-						goto fcd_done1;
-					}
+	for (i=0; i<CONN_TABLES; i++) {
+		t = &Conn_tables[i];
+		if (reuse && t->node && t->seg0 == seg0 && t->wid_flag == wid_flag && t->num_nodes == Highest_segment_index+1) {
+			if (t->epoch != Conn_epoch) {
+				if (!conn_table_current(t)) {
+					Conn_redone++;
+					lru = t;
+					break;
 				}
-
+				Conn_kept++;
+				t->epoch = Conn_epoch;
 			}
-		}	//	for (sidenum...
-
-		if (qhead >= qtail) {
-			Connected_segment_distance = 1000;
-			add_to_fcd_cache(seg0, seg1, Connected_segment_distance, F1_0*1000);
-			return -1;
+			t->last_used = Conn_use;
+			Conn_hits++;
+			return t;
 		}
+		if (lru->node && (!t->node || t->last_used < lru->last_used))
+			lru = t;
+	}
 
-		cur_seg = seg_queue[qhead].end;
-		cur_depth = depth[qhead];
-		qhead++;
-
-fcd_done1: ;
-	}	//	while (cur_seg ...
+	t = lru;
+	if (t->node && t->num_nodes != Highest_segment_index+1)
+		d_free(t->node);
+	if (!t->node) {
+		MALLOC(t->node, conn_node, Highest_segment_index+1);
+		if (!t->node)
+			Error("Not enough memory for connectivity table");
+	}
+	t->seg0 = seg0;
+	t->wid_flag = wid_flag;
+	t->num_nodes = Highest_segment_index+1;
+	t->epoch = Conn_epoch;
+	t->last_used = Conn_use;
+	search_conn_table(t);
+	Conn_searches++;
+
+	return t;
+}
 
-	//	Set qtail to the segment which ends at the goal.
-	while (seg_queue[--qtail].end != seg1)
-		if (qtail < 0) {
-			Connected_segment_distance = 1000;
-			add_to_fcd_cache(seg0, seg1, Connected_segment_distance, F1_0*1000);
-			return -1;
-		}
+//	----------------------------------------------------------------------------------------------------------
+//	Shared by the single and batched queries, looks up the table in *tp only when one is needed.
+static int conn_path(conn_table **tp, vms_vector *p0, int seg0, int seg1, int max_depth, int wid_flag, fix *dist, vms_vector *last)
+{
+	conn_node	*n;
+	vms_vector	center;
+	int		conn_side;
 
-	while (qtail >= 0) {
-		int	parent_seg, this_seg;
+	*dist = 0;
+	*last = *p0;
 
-		this_seg = seg_queue[qtail].end;
-		parent_seg = seg_queue[qtail].start;
-		point_segs[num_points].segnum = this_seg;
-		compute_segment_center(&point_segs[num_points].point,&Segments[this_seg]);
-		num_points++;
+	if (seg0 == seg1)
+		return 0;
+	if ((conn_side = find_connect_side(&Segments[seg0], &Segments[seg1])) != -1)
+		if (WALL_IS_DOORWAY(&Segments[seg1], conn_side) & wid_flag)
+			return 1;
+
+	if (!*tp)
+		*tp = get_conn_table(seg0, wid_flag);
+	n = &(*tp)->node[seg1];
+	if (n->depth < 0)
+		return -1;
 
-		if (parent_seg == seg0)
-			break;
+	//	A limited search gave up as soon as it reached a segment max_depth steps away,
+	//	so seg1 was only found if it came before the first segment that got there.
+	if (max_depth > CONN_MAX_DEPTH)
+		max_depth = CONN_MAX_DEPTH;
+	if (max_depth > 0 && n->order > (*tp)->expander[max_depth-1])
+		return -1;
 
-		while (seg_queue[--qtail].end != parent_seg)
-			Assert(qtail >= 0);
+	if (n->depth == 1) {
+		compute_segment_center(&center, &Segments[seg1]);
+		compute_segment_center(last, &Segments[seg0]);
+	} else {
+		compute_segment_center(&center, &Segments[n->first]);
+		compute_segment_center(last, &Segments[n->parent]);
+		*dist = (*tp)->node[n->parent].len;
 	}
+	*dist += vm_vec_dist_quick(p0, &center);
 
-	point_segs[num_points].segnum = seg0;
-	compute_segment_center(&point_segs[num_points].point,&Segments[seg0]);
-	num_points++;
+	return n->depth+1;
+}
 
-	if (num_points == 1) {
-		Connected_segment_distance = num_points;
-		return vm_vec_dist_quick(p0, p1);
-	} else {
-		dist = vm_vec_dist_quick(p1, &point_segs[1].point);
-		dist += vm_vec_dist_quick(p0, &point_segs[num_points-2].point);
+//	----------------------------------------------------------------------------------------------------------
+//	Path from p0 in seg0 to segment seg1, all but its last leg: the connected distance to any point p in seg1
+//	is *dist + vm_vec_dist_quick(p, last). Returns the number of segments on the path, -1 if seg1 can't be
+//	reached within max_depth.
+int find_connected_path(vms_vector *p0, int seg0, int seg1, int max_depth, int wid_flag, fix *dist, vms_vector *last)
+{
+	conn_table	*t = NULL;
+	int		num_segs = conn_path(&t, p0, seg0, seg1, max_depth, wid_flag, dist, last);
 
-		for (i=1; i<num_points-2; i++) {
-			fix	ndist;
-			ndist = vm_vec_dist_quick(&point_segs[i].point, &point_segs[i+1].point);
-			dist += ndist;
-		}
+	Connected_segment_distance = num_segs < 0 ? 1000 : num_segs;
+	return num_segs;
+}
 
-	}
+//	----------------------------------------------------------------------------------------------------------
+//	Determine whether seg0 and seg1 are reachable in a way that allows sound to pass.
+//	Search up to a maximum depth of max_depth.
+//	Return the distance.
+fix find_connected_distance(vms_vector *p0, int seg0, vms_vector *p1, int seg1, int max_depth, int wid_flag)
+{
+	fix		dist;
+	vms_vector	last;
 
-	Connected_segment_distance = num_points;
-	add_to_fcd_cache(seg0, seg1, num_points, dist);
+	if (find_connected_path(p0, seg0, seg1, max_depth, wid_flag, &dist, &last) < 0)
+		return -1;
 
-	return dist;
+	return dist + vm_vec_dist_quick(p1, &last);
+}
 
+//	----------------------------------------------------------------------------------------------------------
+//	find_connected_distance() from one point to n others, with a single table lookup.
+void find_connected_distances(vms_vector *p0, int seg0, int n, vms_vector **p1, int *seg1, int max_depth, int wid_flag, fix *dists)
+{
+	conn_table	*t = NULL;
+	fix		dist;
+	vms_vector	last;
+	int		i;
+
+	for (i=0; i<n; i++)
+		if (conn_path(&t, p0, seg0, seg1[i], max_depth, wid_flag, &dist, &last) < 0)
+			dists[i] = -1;
+		else
+			dists[i] = dist + vm_vec_dist_quick(p1[i], &last);
 }
 
 sbyte convert_to_byte(fix f)
@@ -1850,6 +2492,9 @@ void validate_segment(segment *sp)
 	for (side = 0; side < MAX_SIDES_PER_SEGMENT; side++)
 		validate_segment_side(sp, side);
 
+	if (sp-Segments < Num_seg_planes)
+		compile_seg_planes(sp-Segments);
+
 //	assign_default_uvs_to_segment(sp);
 }
 
@@ -1861,6 +2506,7 @@ void validate_segment_all(void)
 {
 	int	s;
 
+	Num_seg_planes = 0;	//	built again below
 	for (s=0; s<=Highest_segment_index; s++)
 		#ifdef EDITOR
 		if (Segments[s].segnum != -1)
@@ -1875,6 +2521,8 @@ void validate_segment_all(void)
 			}
 	}
 	#endif
+
+	build_seg_planes();
 }
 
 
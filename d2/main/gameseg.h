@@ -85,6 +85,9 @@ segmasks get_seg_masks(const vms_vector *checkp, int segnum, fix rad, char *call
 //Returns segnum if found, or -1
 int find_point_seg(const vms_vector *p,int segnum);
 
+// find_point_seg() looks up segments it can't trace to in a grid built from the mine. Call when the mine changed.
+void invalidate_segment_grid(void);
+
 //--repair-- // Create data specific to segments which does not need to get written to disk.
 //--repair-- extern void create_local_segment_data(void);
 
@@ -100,6 +103,21 @@ int check_lsegments_validity(void);
 //      Return the distance.
 extern fix find_connected_distance(vms_vector *p0, int seg0, vms_vector *p1, int seg1, int max_depth, int wid_flag);
 
+//      Like find_connected_distance(), but from p0 to every point in p1 (n of them, in the segments in seg1).
+//      dists gets the distances, -1 for points that can't be reached.
+extern void find_connected_distances(vms_vector *p0, int seg0, int n, vms_vector **p1, int *seg1, int max_depth, int wid_flag, fix *dists);
+
+//      The path find_connected_distance() takes to segment seg1, all but its last leg: the distance to any
+//      point p in seg1 is *dist + vm_vec_dist_quick(p, last).
+//      Returns the number of segments on the path, -1 if seg1 can't be reached.
+extern int find_connected_path(vms_vector *p0, int seg0, int seg1, int max_depth, int wid_flag, fix *dist, vms_vector *last);
+
+//      The connected distances come from tables built per start segment. Flush them whenever the mine changes.
+extern void flush_conn_tables(void);
+
+//      Walls changed, make the connectivity tables look at them again before the next lookup.
+extern void conn_walls_changed(void);
+
 //create a matrix that describes the orientation of the given segment
 extern void extract_orient_from_segment(vms_matrix *m,segment *seg);
 
@@ -210,7 +210,7 @@ gameseq_init_network_players()
 			if ( (!(Game_mode & GM_MULTI_COOP) && ((Objects[i].type == OBJ_PLAYER)||(Objects[i].type==OBJ_GHOST))) ||
 	           ((Game_mode & GM_MULTI_COOP) && ((j == 0) || ( Objects[i].type==OBJ_COOP ))) )
 			{
-				Objects[i].type=OBJ_PLAYER;
+				obj_set_type(i, OBJ_PLAYER);
 				Player_init[k].pos = Objects[i].pos;
 				Player_init[k].orient = Objects[i].orient;
 				Player_init[k].segnum = Objects[i].segnum;
@@ -755,7 +755,8 @@ void LoadLevel(int level_num,int page_in_textures)
 
 	load_palette(Current_level_palette,1,1);		//don't change screen
 
-	show_boxed_message(TXT_LOADING, 0);
+	if (!GameArg.SysHeadless)
+		show_boxed_message(TXT_LOADING, 0);
 #ifdef RELEASE
 	timer_delay(F1_0);
 #endif
@@ -769,7 +770,7 @@ void LoadLevel(int level_num,int page_in_textures)
 
 	load_level_robots(level_num);
 
-	if ( page_in_textures ) {
+	if ( page_in_textures && !GameArg.SysHeadless ) {
 		piggy_load_level_data();
 #ifdef OGL
 		ogl_cache_level_textures();
@@ -4454,16 +4454,20 @@ void observer_show_bomb_highlights()
 	for (int i = 0; i < MAX_PLAYERS; i++)
 		oldest_bomb[i] = -1;
 
-	for (int i = 0; i <= Highest_object_index; i++)
+	for (int n = 0; n < Obj_type_count[OBJ_WEAPON]; n++)
 	{
-		if (Objects[i].type == OBJ_WEAPON && (Objects[i].id == PROXIMITY_ID || Objects[i].id == SUPERPROX_ID))
+		int i = Obj_type_list[OBJ_WEAPON][n];
+
+		if (Objects[i].id == PROXIMITY_ID || Objects[i].id == SUPERPROX_ID)
 		{
 			if (Objects[i].ctype.laser_info.parent_type == OBJ_PLAYER)
 			{
 				int pnum = Objects[i].ctype.laser_info.parent_num;
 				if (pnum >= 0 && pnum < MAX_PLAYERS)
 				{
-					if (oldest_bomb[pnum] == -1 || Objects[i].lifeleft < Objects[oldest_bomb[pnum]].lifeleft)
+					int old = oldest_bomb[pnum];
+
+					if (old == -1 || Objects[i].lifeleft < Objects[old].lifeleft || (Objects[i].lifeleft == Objects[old].lifeleft && i < old))
 						oldest_bomb[pnum] = i;
 				}
 			}
@@ -56,6 +56,7 @@ char copyright[] = "DESCENT II  COPYRIGHT (C) 1994-1996 PARALLAX SOFTWARE CORPOR
 #include "digi.h"
 #include "palette.h"
 #include "args.h"
+#include "profile.h"
 #include "titles.h"
 #include "text.h"
 #include "gauges.h"
@@ -70,6 +71,7 @@ char copyright[] = "DESCENT II  COPYRIGHT (C) 1994-1996 PARALLAX SOFTWARE CORPOR
 #include "movie.h"
 #include "playsave.h"
 #include "collide.h"
+#include "lighting.h"
 #include "newdemo.h"
 #include "joy.h"
 #include "../texmap/scanline.h" //for select_tmap -MM
@@ -83,8 +85,10 @@ char copyright[] = "DESCENT II  COPYRIGHT (C) 1994-1996 PARALLAX SOFTWARE CORPOR
 #include "ui.h"
 #endif
 #include "vers_id.h"
+#include "timedemo.h"
 #ifdef USE_UDP
 #include "net_udp.h"
+#include "dedicated.h"
 #endif
 
 //Current version number
@@ -113,6 +117,10 @@ void print_commandline_help()
 	printf( "  -lowmem                       Lowers animation detail for better performance with\n\t\t\t\tlow memory\n");
 	printf( "  -pilot <s>                    Select pilot <s> automatically\n");
 	printf( "  -autodemo                     Start in demo mode\n");
+	printf( "  -timedemo <s>                 Play demo <s> as fast as possible and report frame times\n");
+	printf( "  -timedemo_json <s>            Also write the -timedemo report to file <s> as JSON\n");
+	printf( "  -timedemo_norender            Run -timedemo without a window and without rendering\n");
+	printf( "  -headless                     Run without a window, sound or input, printing the console\n\t\t\t\tto stdout line by line, e.g. with -udp_join\n");
 	printf( "  -window                       Run the game in a window\n");
 	printf( "  -noborders                    Do not show borders in window mode\n");
 	printf( "  -nomovies                     Don't play movies\n");
@@ -136,8 +144,11 @@ void print_commandline_help()
 	printf( "  -lowresgraphics               Force to use LowRes graphics\n");
 	printf( "  -lowresmovies                 Play low resolution movies if available (for slow machines)\n");
 	printf( "  -vr                           Enable Virtual Reality mode\n");
+	printf( "  -connectedlight               Bright lights only reach places they are connected to\n");
 #ifdef    OGL
 	printf( "  -gl_fixedfont                 Do not scale fonts to current resolution\n");
+	printf( "  -gl_levelmesh                 Keep level geometry on the graphics card\n");
+	printf( "  -gl_texarray                  Pack level textures into texture arrays\n");
 #endif // OGL
 
 #if defined(USE_UDP)
@@ -145,6 +156,16 @@ void print_commandline_help()
 	printf( "  -udp_hostaddr <s>             Use IP address/Hostname <s> for manual game joining\n\t\t\t\t(default: %s)\n", UDP_MANUAL_ADDR_DEFAULT);
 	printf( "  -udp_hostport <n>             Use UDP port <n> for manual game joining (default: %i)\n", UDP_PORT_DEFAULT);
 	printf( "  -udp_myport <n>               Set my own UDP port to <n> (default: %i)\n", UDP_PORT_DEFAULT);
+	printf( "  -udp_join                     Join the game at -udp_hostaddr/-udp_hostport on start as -pilot,\n\t\t\t\twithout the menus or the game info box\n");
+	printf( "  -udp_thread                   Send and receive network packets on a separate thread\n");
+	printf( "  -udp_mtu <n>                  Bundle game traffic into packets of up to <n> bytes, 0 disables\n\t\t\t\t(default: %i)\n", UDP_MTU_DEFAULT);
+	printf( "  -udp_snapshot                 Send joining players all objects at once, compressed\n");
+	printf( "  -obs_relay                    When observing, pass the game on to other observers\n");
+	printf( "  -dedicated                    Host games without a window, sound or a player of our own\n");
+	printf( "  -dedicated_cmd <s>            Read dedicated host commands from file <s> before starting\n");
+	printf( "  -dedicated_tick <n>           Run the dedicated host at <n> frames per second (default: 60)\n");
+	printf( "  -netlog                       Capture network traffic to netlog.pcap, read it with netlogdump\n");
+	printf( "  -netlog_crash <n>             Keep the last <n> seconds of network traffic,\n\t\t\t\tsaved to netcrash.pcap on a crash\n");
 #ifdef USE_TRACKER
 	printf( "  -tracker_hostaddr <n>         Address of Tracker server to register/query games to/from\n\t\t\t\t(default: %s)\n", TRACKER_ADDR_DEFAULT);
 	printf( "  -tracker_hostport <n>         Port of Tracker server to register/query games to/from\n\t\t\t\t(default: %i)\n", TRACKER_PORT_DEFAULT);
@@ -164,6 +185,15 @@ void print_commandline_help()
 	printf( "  -safelog                      Write gamelog.txt unbuffered.\n\t\t\t\tUse to keep helpful output to trace program crashes.\n");
 	printf( "  -norun                        Bail out after initialization\n");
 	printf( "  -renderstats                  Enable renderstats info by default\n");
+#ifdef BENCHMARKS
+	printf( "  -pointsegbench <n>            Time locating <n> random points in each level\n");
+	printf( "  -objliststress <n>            Check the object lists over <n> random creates and deletes in each level\n");
+#ifdef USE_UDP
+	printf( "  -plpbench <n>                 Time the packet loss prevention queue over <n> simulated frames\n");
+#endif
+	printf( "  -sigbench                     Time finding demo objects by signature against looking at all of them\n");
+#endif
+	printf( "  -profile                      Time the stages of each frame, ALT-SHIFT-F7 shows them,\n\t\t\t\tALT-SHIFT-F8 saves a trace for chrome://tracing\n");
 	printf( "  -text <s>                     Specify alternate .tex file\n");
 	printf( "  -tmap <s>                     Select texmapper <s> to use\n\t\t\t\t(default: c, available: c, fp, quad, i386)\n");
 	printf( "  -showmeminfo                  Show memory statistics\n");
@@ -291,6 +321,27 @@ int standard_handler(d_event *event)
 	return 0;
 }
 
+// a screen in memory, so windows can be made and set_screen_mode() has nothing to do
+static void init_headless_screen(void)
+{
+	static grs_screen headless_screen;
+	ubyte *pixels;
+
+	MALLOC(pixels, ubyte, 320 * 200);
+	if (!pixels)
+		Error("Not enough memory for the headless screen");
+	memset(pixels, 0, 320 * 200);
+
+	memset(&headless_screen, 0, sizeof(grs_screen));
+	headless_screen.sc_mode = Game_screen_mode;
+	headless_screen.sc_w = 320;
+	headless_screen.sc_h = 200;
+	headless_screen.sc_aspect = fixdiv(320 * 3, 200 * 4);
+	gr_init_canvas(&headless_screen.sc_canvas, pixels, BM_LINEAR, 320, 200);
+	grd_curscreen = &headless_screen;
+	gr_set_current_canvas(NULL);
+}
+
 // Use SEH for catching exceptions on Windows, this is needed because of the SDL parachute
 // But only on MSVC/64-bit clang (SEH is broken on 32-bit clang https://github.com/llvm/llvm-project/issues/25753)
 #if defined(WIN32) && (!defined(__clang__) || !defined(__i386__))
@@ -400,28 +451,40 @@ int main(int argc, char *argv[])
 	PHYSFSX_addArchiveContent();
 
 	arch_init();
+	prof_init();
 
 	select_tmap(GameArg.DbgTexMap);
 
 	Lighting_on = 1;
+	use_fcd_lighting = GameArg.GfxConnectedLight;
 
-	con_printf(CON_VERBOSE, "Going into graphics mode...\n");
-	gr_set_mode(Game_screen_mode);
-	vr_openvr_init_gl();
+	if (GameArg.SysHeadless)
+	{
+		init_headless_screen();	// no window, the game draws into memory nobody looks at
+		setvbuf(stdout, NULL, _IOLBF, BUFSIZ); // the console is all there is, and usually goes to a pipe or file
+	}
+	else
+	{
+		con_printf(CON_VERBOSE, "Going into graphics mode...\n");
+		gr_set_mode(Game_screen_mode);
+		vr_openvr_init_gl();
+	}
 
 	// Load the palette stuff. Returns non-zero if error.
 	con_printf(CON_DEBUG, "Initializing palette system...\n" );
 	gr_use_palette_table(D2_DEFAULT_PALETTE );
 
 	con_printf(CON_DEBUG, "Initializing font system...\n" );
-	gamefont_init();	// must load after palette data loaded.
+	if (!GameArg.SysHeadless)
+		gamefont_init();	// must load after palette data loaded.
 
 	set_default_handler(standard_handler);
 
 	con_printf( CON_DEBUG, "Initializing movie libraries...\n" );
 	init_movies();		//init movie libraries
 
-	show_titles();
+	if (!GameArg.SysHeadless && !GameArg.SysTimeDemo) // straight to the benchmark
+		show_titles();
 
 	set_screen_mode(SCREEN_MENU);
 
@@ -435,6 +498,11 @@ int main(int argc, char *argv[])
 	}
 	#endif
 
+#if defined(USE_UDP) && defined(BENCHMARKS)
+	if (GameArg.DbgPlpBench)
+		net_udp_noloss_bench(GameArg.DbgPlpBench);
+#endif
+
 	if (GameArg.DbgNoRun)
 		return(0);
 
@@ -493,7 +561,17 @@ int main(int argc, char *argv[])
 #endif
 	{
 		Game_mode = GM_GAME_OVER;
-		DoMenu();
+#ifdef USE_UDP
+		if (GameArg.MplDedicated)
+			dedicated_main();
+		else if (GameArg.MplUdpJoin)
+			net_udp_auto_join_game();
+		else
+#endif
+		if (GameArg.SysTimeDemo)
+			timedemo_start();
+		else
+			DoMenu();
 	}
 
 	setjmp(LeaveEvents);
@@ -510,8 +588,12 @@ int main(int argc, char *argv[])
 			window_close(wind);
 	}
 
+	if (GameArg.SysTimeDemo)
+		timedemo_report();
+
 	WriteConfigFile();
-	show_order_form();
+	if (!GameArg.SysHeadless)
+		show_order_form();
 
 	con_printf( CON_DEBUG, "\nCleanup...\n" );
 	close_game();
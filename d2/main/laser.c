@@ -1129,7 +1129,8 @@ int find_homing_object(vms_vector *curpos, object *tracker)
 //	Make homing objects not track parent's prox bombs.
 int find_homing_object_complete(vms_vector *curpos, object *tracker, int track_obj_type1, int track_obj_type2)
 {
-	int	objnum;
+	int	objnum, i, n, type_mask;
+	short	objnums[MAX_OBJECTS];
 	fix	max_dot = -F1_0*2;
 	int	best_objnum = -1;
 	fix	max_trackable_dist;
@@ -1146,11 +1147,20 @@ int find_homing_object_complete(vms_vector *curpos, object *tracker, int track_o
 		min_trackable_dot = OMEGA_MIN_TRACKABLE_DOT;
 	}
 
-	for (objnum=0; objnum<=Highest_object_index; objnum++) {
+	//	only what is in tracking range can be tracked, so just look at that
+	type_mask = (1 << track_obj_type1) | (1 << OBJ_WEAPON);
+	if (track_obj_type2 != -1)
+		type_mask |= 1 << track_obj_type2;
+	n = obj_grid_find(curpos, max_trackable_dist, type_mask, objnums);
+
+	for (i=0; i<n; i++) {
 		int			is_proximity = 0;
 		fix			dot, dist;
 		vms_vector	vec_to_curobj;
-		object		*curobjp = &Objects[objnum];
+		object		*curobjp;
+
+		objnum = objnums[i];
+		curobjp = &Objects[objnum];
 
 		if ((curobjp->type != track_obj_type1) && (curobjp->type != track_obj_type2))
 		{
@@ -2096,11 +2106,18 @@ void create_smart_children(object *objp, int num_smart_children)
 	if (((objp->type == OBJ_WEAPON) && (Weapon_info[objp->id].children != -1)) || (objp->type == OBJ_ROBOT)) {
 		int i;
 
+		short objnums[MAX_OBJECTS];
+		int n;
+
 		if (Game_mode & GM_MULTI)
 			d_srand(8321L);
 
-		for (objnum=0; objnum<=Highest_object_index; objnum++) {
-			object *curobjp = &Objects[objnum];
+		n = obj_grid_find(&objp->pos, MAX_SMART_DISTANCE, (1 << OBJ_ROBOT) | (1 << OBJ_PLAYER), objnums);
+		for (i=0; i<n; i++) {
+			object *curobjp;
+
+			objnum = objnums[i];
+			curobjp = &Objects[objnum];
 
 			if ((((curobjp->type == OBJ_ROBOT) && (!curobjp->ctype.ai_info.CLOAKED)) || (curobjp->type == OBJ_PLAYER)) && (objnum != parent_num)) {
 				fix dist;
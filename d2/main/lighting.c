@@ -120,6 +120,10 @@ void apply_light(g3s_lrgb obj_light_emission, int obj_seg, vms_vector *obj_pos,
 						}
 					}
 
+			int			use_path = use_fcd_lighting && abs(obji_64) > F1_0*32, path_seg = -1, path_segs = -1;
+			fix			path_dist = 0;
+			vms_vector	path_last;
+
 			for (vv=0; vv<n_render_vertices; vv++) {
 				int			vertnum, vsegnum;
 				vms_vector	*vertpos;
@@ -130,11 +134,19 @@ void apply_light(g3s_lrgb obj_light_emission, int obj_seg, vms_vector *obj_pos,
 				vsegnum = vert_segnum_list[vv];
 				vertpos = &Vertices[vertnum];
 
-				if (use_fcd_lighting && abs(obji_64) > F1_0*32)
+				if (use_path)
 				{
-					dist = find_connected_distance(obj_pos, obj_seg, vertpos, vsegnum, n_render_vertices, WID_RENDPAST_FLAG+WID_FLY_FLAG);
-					if (dist >= 0)
+					//	vertices come grouped by segment, so the path is the same for a whole run of them
+					if (vsegnum != path_seg)
+					{
+						path_segs = find_connected_path(obj_pos, obj_seg, vsegnum, n_render_vertices, WID_RENDPAST_FLAG+WID_FLY_FLAG, &path_dist, &path_last);
+						path_seg = vsegnum;
+					}
+					if (path_segs >= 0)
+					{
+						dist = path_dist + vm_vec_dist_quick(vertpos, &path_last);
 						apply_light = 1;
+					}
 				}
 				else
 				{
@@ -28,6 +28,8 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 extern fix Beam_brightness;
 extern g3s_lrgb Dynamic_light[MAX_VERTICES];
 
+extern int use_fcd_lighting;
+
 extern void set_dynamic_light(void);
 
 // Compute the lighting from the headlight for a given vertex on a face.
@@ -206,14 +206,14 @@ void MovieShowFrame(ubyte *buf, int dstx, int dsty, int bufw, int bufh, int sw,
 		dsty = (SHEIGHT/2)-((bufh*scale)/2);
 
 #ifdef OGL
-	glDisable (GL_BLEND);
+	ogl_state_disable(GL_BLEND);
 
 	ogl_ubitblt_i(
 		bufw*scale, bufh*scale,
 		dstx, dsty,
 		bufw, bufh, 0, 0, &source_bm,&grd_curcanv->cv_bitmap,GameCfg.MovieTexFilt);
 
-	glEnable (GL_BLEND);
+	ogl_state_enable(GL_BLEND);
 #ifdef USE_OPENVR
 	if (vr_openvr_active() && Screen_mode == SCREEN_MOVIE)
 	{
@@ -61,6 +61,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "byteswap.h"
 #include "sounds.h"
 #include "args.h"
+#include "profile.h"
 #include "effects.h"
 #include "iff.h"
 #include "state.h"
@@ -995,7 +996,7 @@ multi_make_player_ghost(int playernum)
 
 	obj = &Objects[Players[playernum].objnum];
 
-	obj->type = OBJ_GHOST;
+	obj_set_type(obj-Objects, OBJ_GHOST);
 	obj->render_type = RT_NONE;
 	obj->movement_type = MT_NONE;
 	multi_reset_player_object(obj);
@@ -1017,7 +1018,7 @@ multi_make_ghost_player(int playernum)
 
 	obj = &Objects[Players[playernum].objnum];
 
-	obj->type = OBJ_PLAYER;
+	obj_set_type(obj-Objects, OBJ_PLAYER);
 	obj->movement_type = MT_PHYSICS;
 	multi_reset_player_object(obj);
 	if (playernum != Player_num)
@@ -1382,7 +1383,9 @@ void multi_do_protocol_frame(int force, int listen)
 	{
 #ifdef USE_UDP
 		case MULTI_PROTO_UDP:
+			PROF_BEGIN(PROF_NET);
 			net_udp_do_frame(force, listen);
+			PROF_END(PROF_NET);
 			break;
 #endif
 		default:
@@ -60,7 +60,7 @@ extern int multi_protocol; // set and determinate used protocol
 #define MULTI_PROTO_UDP 1 // UDP protocol
 
 // What version of the multiplayer protocol is this? Increment each time something drastic changes in Multiplayer without the version number changes. Can be reset to 0 each time the version of the game changes
-#define MULTI_PROTO_VERSION 30006 // Redux 1.2
+#define MULTI_PROTO_VERSION 30007 // Redux 1.2, game info carries Netgame.DeltaPackets
 
 // PROTOCOL VARIABLES AND DEFINES - END
 
@@ -422,6 +422,7 @@ extern fix64 RefuseTimeLimit;
 #define NETGAME_FLAG_TEAM_HOARD         16
 #define NETGAME_FLAG_REALLY_ENDLEVEL    32
 #define NETGAME_FLAG_REALLY_FORMING     64
+#define NETGAME_FLAG_COALESCE           128 // peers may bundle their in-game messages (UPID_BUNDLE)
 
 #define NETGAME_NAME_LEN                15
 #define NETGAME_AUX_SIZE                20  // Amount of extra data for the network protocol to store in the netgame packet
@@ -582,6 +583,7 @@ typedef struct netgame_info
 	ubyte						team_color[2];
 	ubyte						RebalancedWeapons;
 	ubyte						NewSpawnAlgorithm;
+	ubyte						DeltaPackets;
 } __pack__ netgame_info;
 
 extern int Host_is_obs; // Reminder for host only that they are an observer.  Do not set for other players or observers.
@@ -188,15 +188,18 @@ multi_strip_robots(int playernum)
 			for (i = 0; i < MAX_ROBOTS_CONTROLLED; i++)
 				multi_delete_controlled_robot(robot_controlled[i]);
 
-		for (i = 1; i <= Highest_object_index; i++)
-			if ((Objects[i].type == OBJ_ROBOT) && (Objects[i].ctype.ai_info.REMOTE_OWNER == playernum)) {
-				Assert((Objects[i].control_type == CT_AI) || (Objects[i].control_type == CT_NONE) || (Objects[i].control_type == CT_MORPH));
-				Objects[i].ctype.ai_info.REMOTE_OWNER = -1;
+		for (i = 0; i < Obj_type_count[OBJ_ROBOT]; i++) {
+			object *objp = &Objects[Obj_type_list[OBJ_ROBOT][i]];
+
+			if (objp->ctype.ai_info.REMOTE_OWNER == playernum) {
+				Assert((objp->control_type == CT_AI) || (objp->control_type == CT_NONE) || (objp->control_type == CT_MORPH));
+				objp->ctype.ai_info.REMOTE_OWNER = -1;
 				if (playernum == Player_num)
-					Objects[i].ctype.ai_info.REMOTE_SLOT_NUM = 4;
+					objp->ctype.ai_info.REMOTE_SLOT_NUM = 4;
 				else
-					Objects[i].ctype.ai_info.REMOTE_SLOT_NUM = 0;
+					objp->ctype.ai_info.REMOTE_SLOT_NUM = 0;
 	  		}
+		}
 	}
 	// Note -- only call this with playernum == Player_num if all other players
 	// already know that we are clearing house.  This does not send a release
@@ -8,7 +8,9 @@
 
 // Exported functions
 int net_udp_setup_game(void);
+int net_udp_host_dedicated(void);
 void net_udp_manual_join_game();
+void net_udp_auto_join_game();
 void net_udp_list_join_game();
 int net_udp_objnum_is_past(int objnum);
 void net_udp_do_frame(int force, int listen);
@@ -24,6 +26,15 @@ int net_udp_level_sync();
 void net_udp_send_mdata_direct(ubyte *data, int data_len, int pnum, int priority);
 void net_udp_send_netgame_update();
 void net_udp_send_obs_quit();
+#ifdef BENCHMARKS
+void net_udp_noloss_bench(int frames);
+#endif
+char* msg_name(int type);
+void net_log_init(void);
+void net_log_close(void);
+void net_log_log(char tx, const void *msg, int len, const struct sockaddr *address, u_int64_t when); // when: SDL_GetPerformanceCounter() it went out or came in, 0 for now
+void net_log_comment(char *comment);
+void net_log_crash_dump(void);
 
 // Some defines
 #ifdef IPv6
@@ -32,6 +43,12 @@ void net_udp_send_obs_quit();
 #define UDP_BCAST_ADDR "255.255.255.255"
 #define UDP_PORT_DEFAULT 42424 // Our default port - easy to remember: D = 4, X = 24, X = 24
 #define UDP_MANUAL_ADDR_DEFAULT "localhost"
+#define UDP_MTU_DEFAULT UPID_MAX_SIZE // Largest datagram coalesced game traffic goes out in
+#define NETLOG_LINKTYPE 147 // pcap LINKTYPE_USER0, see net_udp_log.c
+#define NETLOG_HDR_SIZE 20 // direction, address family, port, address
+#define NETLOG_RX 0
+#define NETLOG_TX 1
+#define NETLOG_NOTE 2
 #ifdef USE_TRACKER
 #define TRACKER_ADDR_DEFAULT "retro-tracker.game-server.cc"
 #define TRACKER_PORT_DEFAULT 42420
@@ -50,7 +67,7 @@ void net_udp_send_obs_quit();
 #define UPID_GAME_INFO_REQ_SIZE			 13
 #define UPID_GAME_INFO_LITE_REQ_SIZE		 11
 #define UPID_GAME_INFO				  3 // Packet containing all info about a netgame.
-#define UPID_GAME_INFO_SIZE			(6 + 4*2 + 369 + (NETGAME_NAME_LEN+1) + (MISSION_NAME_LEN+1) + ((MAX_PLAYERS+4)*(CALLSIGN_LEN+1)) + 20*12)
+#define UPID_GAME_INFO_SIZE			(6 + 4*2 + 370 + (NETGAME_NAME_LEN+1) + (MISSION_NAME_LEN+1) + ((MAX_PLAYERS+4)*(CALLSIGN_LEN+1)) + 20*12)
 #define UPID_GAME_INFO_LITE_REQ			  4 // Requesting lite info about a netgame. Used for discovering games.
 #define UPID_GAME_INFO_LITE			  5 // Packet containing lite netgame info.
 #define UPID_GAME_INFO_LITE_SIZE		 (31 + (NETGAME_NAME_LEN+1) + (MISSION_NAME_LEN+1))
@@ -72,6 +89,7 @@ void net_udp_send_obs_quit();
 #define UPID_PDATA_S_SIZE			 (26 + 4 + 1)
 #define UPID_PDATA_Q_SIZE                        (47 + 4 + 1)
 #define UPID_PDATA_U_SIZE			 (72 + 3 + 4 + 1)
+#define UPID_PDATA_D_MAX_SIZE		 (7 + 4 + 5 + 9*5 + 4) // keyframe with every varint at its longest
 #define UPID_MDATA_PNORM			 17 // Packet containing multi buffer from a player. Priority 0,1 - no ACK needed.
 #define UPID_MDATA_PNEEDACK			 18 // Packet containing multi buffer from a player. Priority 2 - ACK needed. Also contains pkt_num
 #define UPID_MDATA_ACK				 19 // ACK packet for UPID_MDATA_P1.
@@ -93,6 +111,22 @@ void net_udp_send_obs_quit();
 #define UPID_OBSDATA 29
 #define UPID_OBSQUIT 30
 #define UPID_OBSQUIT_SIZE (1 + 4 + 4)
+#define UPID_BUNDLE 31 // Several messages to the same peer, each prefixed with its length. Only sent if the host set NETGAME_FLAG_COALESCE and the peer sent UPID_BUNDLE_OFFER.
+#define UPID_BUNDLE_HEADER_SIZE (1 + 4)
+#define UPID_OBS_RELAY 32 // Observer stream from the host to a relaying observer, with the observers to pass it on to, and from there to them.
+#define UPID_OBS_RELAY_HEADER_SIZE (1 + 4 + 2)
+#define UPID_OBS_RELAY_LIST 33 // Host tells a relaying observer the addresses of its observers.
+#define UPID_OBS_RELAY_LIST_MAX_SIZE (1 + 4 + 2 + MAX_OBSERVERS*sizeof(struct _sockaddr))
+#define UPID_OBS_RELAY_OFFER 34 // Observer started with -obs_relay offers to relay.
+#define UPID_OBS_RELAY_OFFER_SIZE (1 + 4)
+#define UPID_OBJECT_SNAPSHOT 35 // Host sends a joining player started with -udp_snapshot a fragment of his snapshot.
+#define UPID_OBJECT_SNAPSHOT_HEADER_SIZE (1 + 4 + 1 + 4 + 4 + 4) // pid, token, serial, compressed size, size, offset
+#define UPID_OBJECT_SNAPSHOT_ACK 36 // Joining player tells the host how much of the snapshot he has.
+#define UPID_OBJECT_SNAPSHOT_ACK_SIZE (1 + 4 + 1 + 4)
+#define UPID_OBS_RELAY_VIA 37 // Host tells an observer the address of the relay that passes the observer stream on to it.
+#define UPID_OBS_RELAY_VIA_SIZE (1 + 4 + sizeof(struct _sockaddr))
+#define UPID_BUNDLE_OFFER 38 // Peer can split UPID_BUNDLE, sent in reply to in-game traffic now and then.
+#define UPID_BUNDLE_OFFER_SIZE (1 + 4)
 
 // Structure keeping lite game infos (for netlist, etc.)
 typedef struct UDP_netgame_info_lite
@@ -120,6 +154,16 @@ typedef struct UDP_sequence_packet
 	netplayer_info  		player;
 } __pack__ UDP_sequence_packet;
 
+// quantized player state of delta pdata packets
+typedef struct UDP_pdata_state
+{
+	short				segnum;
+	int				pos[3];		// relative to vertex 0 of segnum, >> RELPOS_PRECISION
+	int				vel[3];
+	int				rotvel[3];
+	uint32_t			orient;		// smallest three quaternion
+} UDP_pdata_state;
+
 // player position packet structure
 typedef struct UDP_frame_info
 {
@@ -130,6 +174,7 @@ typedef struct UDP_frame_info
 		uncompressed_pos    upp;
 		quaternionpos		qpp;
 		shortpos		spp;
+		UDP_pdata_state		dpp;
 	} __pack__ ptype;
 	ubyte serial; 
 } __pack__ UDP_frame_info;
@@ -149,7 +194,6 @@ typedef struct UDP_mdata_store
 {
 	int 				used;
 	fix64				pkt_initial_timestamp;		// initial timestamp to see if packet is outdated
-	fix64				pkt_timestamp[MAX_PLAYERS];	// Packet timestamp
 	int				pkt_num;			// Packet number
 	ubyte				Player_num;			// sender of this packet
 	ubyte				player_ack[MAX_PLAYERS]; 	// 0 if player has not ACK'd this packet, 1 if ACK'd or not connected
@@ -162,7 +206,6 @@ typedef struct UDP_mdata_obs_store
 {
 	int 				used;
 	fix64				pkt_initial_timestamp;		// initial timestamp to see if packet is outdated
-	fix64				pkt_timestamp[MAX_OBSERVERS];	// Packet timestamp
 	int				pkt_num;			// Packet number
 	ubyte				Player_num;			// sender of this packet
 	ubyte				observer_ack[MAX_OBSERVERS]; 	// 0 if observer has not ACK'd this packet, 1 if ACK'd or not connected
@@ -0,0 +1,363 @@
+/*
+ *
+ * Network traffic capture.
+ *
+ * With -netlog every datagram sent or received, and every net_log_comment(), is copied into an in-memory ring
+ * together with a microsecond timestamp and the address of the other end. A writer thread drains the ring into
+ * netlog.pcap, so the game thread only ever does a memcpy. With -netlog_crash <n> the ring also keeps the last
+ * <n> seconds around (with or without -netlog) and writes them to netcrash.pcap if the game dies in Error() or
+ * on a fatal signal. The signal handler only uses open(), write() and close() on a path put together beforehand.
+ *
+ * The files are pcap files with link type USER0. Each packet starts with a NETLOG_HDR_SIZE byte header of our
+ * own: direction (NETLOG_RX, NETLOG_TX or NETLOG_NOTE), address family (4 or 6, 0 for notes), port in network
+ * byte order and the address, padded to 16 bytes. utilities/netlogdump prints them.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <SDL.h>
+
+#include "pstypes.h"
+#include "args.h"
+#include "console.h"
+#include "dxxerror.h"
+#include "physfsx.h"
+#include "u_mem.h"
+#include "net_udp.h"
+
+#define NETLOG_RING_SIZE (4*1024*1024) // must be a power of 2, a few minutes of a busy game
+#define NETLOG_REC_SIZE 16 // pcap record header: seconds, microseconds, saved length, original length
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+typedef struct netlog_file_header
+{
+	u_int32_t magic;
+	u_int16_t version_major, version_minor;
+	int thiszone;
+	u_int32_t sigfigs, snaplen, linktype;
+} netlog_file_header;
+
+static ubyte *netlog_ring = NULL;
+static SDL_atomic_t netlog_head; // bytes ever put into the ring, only moved by the game thread
+static SDL_atomic_t netlog_flushed; // bytes ever written to netlog.pcap, only moved by the writer thread
+static unsigned netlog_tail = 0; // oldest record still in the ring, game thread only
+static int netlog_dropped = 0;
+static PHYSFS_file *netlog_fp = NULL;
+static SDL_Thread *netlog_thread = NULL;
+static SDL_atomic_t netlog_quit;
+static u_int64_t netlog_start_usec, netlog_start_counter;
+static char netlog_crash_path[PATH_MAX]; // netcrash.pcap in the write dir, ready before anything can crash
+static char netlog_crash_msg[80];
+
+static void netlog_ring_put(unsigned pos, const void *data, int len)
+{
+	unsigned off = pos & (NETLOG_RING_SIZE - 1);
+	int n = min(len, NETLOG_RING_SIZE - off);
+
+	memcpy(netlog_ring + off, data, n);
+	memcpy(netlog_ring, (const ubyte *)data + n, len - n);
+}
+
+static void netlog_ring_get(unsigned pos, void *data, int len)
+{
+	unsigned off = pos & (NETLOG_RING_SIZE - 1);
+	int n = min(len, NETLOG_RING_SIZE - off);
+
+	memcpy(data, netlog_ring + off, n);
+	memcpy((ubyte *)data + n, netlog_ring, len - n);
+}
+
+static void netlog_ring_write(PHYSFS_file *fp, unsigned pos, unsigned len)
+{
+	unsigned off = pos & (NETLOG_RING_SIZE - 1);
+	unsigned n = min(len, NETLOG_RING_SIZE - off);
+
+	PHYSFS_write(fp, netlog_ring + off, 1, n);
+	if (len > n)
+		PHYSFS_write(fp, netlog_ring, 1, len - n);
+}
+
+static int netlog_ring_write_fd(int fd, unsigned pos, unsigned len)
+{
+	unsigned off = pos & (NETLOG_RING_SIZE - 1);
+	unsigned n = min(len, NETLOG_RING_SIZE - off);
+
+	if (write(fd, netlog_ring + off, n) != n)
+		return -1;
+	if (len > n && write(fd, netlog_ring, len - n) != len - n)
+		return -1;
+	return 0;
+}
+
+// size of the record starting at pos
+static unsigned netlog_rec_len(unsigned pos)
+{
+	u_int32_t rec[4];
+
+	netlog_ring_get(pos, rec, sizeof(rec));
+	return NETLOG_REC_SIZE + rec[2];
+}
+
+// microseconds since the epoch at performance counter value when
+static u_int64_t netlog_time(u_int64_t when)
+{
+	u_int64_t t = (when > netlog_start_counter ? when : netlog_start_counter) - netlog_start_counter, freq = SDL_GetPerformanceFrequency();
+
+	return netlog_start_usec + t / freq * 1000000 + t % freq * 1000000 / freq;
+}
+
+static void netlog_header(netlog_file_header *h)
+{
+	h->magic = 0xa1b2c3d4;
+	h->version_major = 2;
+	h->version_minor = 4;
+	h->thiszone = 0;
+	h->sigfigs = 0;
+	h->snaplen = 65535;
+	h->linktype = NETLOG_LINKTYPE;
+}
+
+static void netlog_write_header(PHYSFS_file *fp)
+{
+	netlog_file_header h;
+
+	netlog_header(&h);
+	PHYSFS_write(fp, &h, sizeof(h), 1);
+}
+
+// write everything the game thread has put into the ring so far
+static void netlog_flush(void)
+{
+	unsigned flushed = SDL_AtomicGet(&netlog_flushed), head = SDL_AtomicGet(&netlog_head);
+
+	if (flushed == head)
+		return;
+	SDL_MemoryBarrierAcquire();
+	netlog_ring_write(netlog_fp, flushed, head - flushed);
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&netlog_flushed, head);
+}
+
+static int netlog_thread_main(void *unused)
+{
+	int quit;
+
+	(void)unused;
+	do
+	{
+		quit = SDL_AtomicGet(&netlog_quit);
+		netlog_flush();
+		if (!quit)
+			SDL_Delay(100);
+	} while (!quit);
+
+	return 0;
+}
+
+void net_log_close(void)
+{
+	if (netlog_thread)
+	{
+		SDL_AtomicSet(&netlog_quit, 1);
+		SDL_WaitThread(netlog_thread, NULL);
+		netlog_thread = NULL;
+	}
+	if (netlog_fp)
+	{
+		PHYSFS_close(netlog_fp);
+		netlog_fp = NULL;
+	}
+	if (netlog_dropped)
+		con_printf(CON_NORMAL, "netlog: %i packets not captured, the writer fell behind\n", netlog_dropped);
+	netlog_dropped = 0;
+	if (netlog_ring)
+		d_free(netlog_ring);
+}
+
+/*
+ * Write the last -netlog_crash seconds to netcrash.pcap. Runs in the signal handler too, so no PhysFS, no
+ * allocation, no console and no clock - the seconds count back from the newest record instead.
+ */
+static int netlog_crash_write(void)
+{
+	static volatile sig_atomic_t dumping = 0;
+	netlog_file_header h;
+	u_int64_t newest = 0, cutoff, span = (u_int64_t)GameArg.LogNetCrash * 1000000;
+	u_int32_t rec[4];
+	unsigned pos, head, n;
+	int fd;
+
+	if (!netlog_ring || !netlog_crash_path[0] || dumping)
+		return 0;
+	dumping = 1;
+
+	if ((fd = open(netlog_crash_path, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644)) < 0)
+		return 0;
+	netlog_header(&h);
+	if (write(fd, &h, sizeof(h)) != sizeof(h))
+	{
+		close(fd);
+		return 0;
+	}
+	head = SDL_AtomicGet(&netlog_head);
+	for (pos = netlog_tail; pos != head; pos += n)
+	{
+		netlog_ring_get(pos, rec, sizeof(rec));
+		n = NETLOG_REC_SIZE + rec[2];
+		newest = (u_int64_t)rec[0] * 1000000 + rec[1];
+	}
+	cutoff = newest > span ? newest - span : 0;
+	for (pos = netlog_tail; pos != head; pos += n)
+	{
+		netlog_ring_get(pos, rec, sizeof(rec));
+		n = NETLOG_REC_SIZE + rec[2];
+		if ((u_int64_t)rec[0] * 1000000 + rec[1] >= cutoff && netlog_ring_write_fd(fd, pos, n))
+			break;
+	}
+	close(fd);
+	return 1;
+}
+
+static void netlog_signal(int sig)
+{
+	if (netlog_crash_write())
+	{
+		ssize_t r = write(STDERR_FILENO, netlog_crash_msg, strlen(netlog_crash_msg));
+
+		(void)r; // nobody left to tell if that failed
+	}
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
+void net_log_init(void)
+{
+	if (netlog_ring || !(GameArg.LogNetTraffic || GameArg.LogNetCrash))
+		return;
+
+	MALLOC(netlog_ring, ubyte, NETLOG_RING_SIZE);
+	if (!netlog_ring)
+		return;
+	SDL_AtomicSet(&netlog_head, 0);
+	SDL_AtomicSet(&netlog_flushed, 0);
+	netlog_tail = 0;
+	netlog_start_usec = (u_int64_t)time(NULL) * 1000000;
+	netlog_start_counter = SDL_GetPerformanceCounter();
+	atexit(net_log_close);
+
+	if (GameArg.LogNetTraffic && (netlog_fp = PHYSFS_openWrite("netlog.pcap")))
+	{
+		netlog_write_header(netlog_fp);
+		SDL_AtomicSet(&netlog_quit, 0);
+		netlog_thread = SDL_CreateThread(netlog_thread_main, "netlog", NULL);
+		if (!netlog_thread)
+		{
+			con_printf(CON_NORMAL, "Cannot start netlog writer: %s\n", SDL_GetError());
+			PHYSFS_close(netlog_fp);
+			netlog_fp = NULL;
+		}
+	}
+
+	if (GameArg.LogNetCrash && PHYSFS_getWriteDir())
+	{
+		snprintf(netlog_crash_path, sizeof(netlog_crash_path), "%s%snetcrash.pcap", PHYSFS_getWriteDir(), PHYSFS_getDirSeparator());
+		snprintf(netlog_crash_msg, sizeof(netlog_crash_msg), "Wrote the last %i seconds of network traffic to netcrash.pcap\n", GameArg.LogNetCrash);
+		set_crash_func(net_log_crash_dump);
+		signal(SIGSEGV, netlog_signal);
+		signal(SIGABRT, netlog_signal);
+		signal(SIGFPE, netlog_signal);
+		signal(SIGILL, netlog_signal);
+	}
+}
+
+static void netlog_add(int dir, const struct sockaddr *address, const void *data, int len, u_int64_t when)
+{
+	ubyte hdr[NETLOG_REC_SIZE + NETLOG_HDR_SIZE];
+	u_int32_t rec[4];
+	u_int64_t t;
+	unsigned head, size = sizeof(hdr) + len, n;
+
+	net_log_init();
+	if (!netlog_ring || len < 0 || size > NETLOG_RING_SIZE / 2)
+		return;
+
+	// make room by forgetting the oldest records, but not ones the writer has not saved yet
+	head = SDL_AtomicGet(&netlog_head);
+	while (head + size - netlog_tail > NETLOG_RING_SIZE)
+	{
+		n = netlog_rec_len(netlog_tail);
+		if (netlog_thread)
+		{
+			SDL_MemoryBarrierAcquire();
+			if ((unsigned)SDL_AtomicGet(&netlog_flushed) - netlog_tail < n)
+			{
+				netlog_dropped++;
+				return;
+			}
+		}
+		netlog_tail += n;
+	}
+
+	t = netlog_time(when ? when : SDL_GetPerformanceCounter());
+	rec[0] = t / 1000000;
+	rec[1] = t % 1000000;
+	rec[2] = rec[3] = NETLOG_HDR_SIZE + len;
+	memcpy(hdr, rec, NETLOG_REC_SIZE);
+	memset(hdr + NETLOG_REC_SIZE, 0, NETLOG_HDR_SIZE);
+	hdr[NETLOG_REC_SIZE] = dir;
+	if (address && address->sa_family == AF_INET)
+	{
+		const struct sockaddr_in *in = (const struct sockaddr_in *)address;
+
+		hdr[NETLOG_REC_SIZE + 1] = 4;
+		memcpy(&hdr[NETLOG_REC_SIZE + 2], &in->sin_port, 2);
+		memcpy(&hdr[NETLOG_REC_SIZE + 4], &in->sin_addr, 4);
+	}
+#ifdef IPv6
+	else if (address && address->sa_family == AF_INET6)
+	{
+		const struct sockaddr_in6 *in6 = (const struct sockaddr_in6 *)address;
+
+		hdr[NETLOG_REC_SIZE + 1] = 6;
+		memcpy(&hdr[NETLOG_REC_SIZE + 2], &in6->sin6_port, 2);
+		memcpy(&hdr[NETLOG_REC_SIZE + 4], &in6->sin6_addr, 16);
+	}
+#endif
+
+	netlog_ring_put(head, hdr, sizeof(hdr));
+	netlog_ring_put(head + sizeof(hdr), data, len);
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&netlog_head, head + size);
+}
+
+void net_log_log(char tx, const void *msg, int len, const struct sockaddr *address, u_int64_t when)
+{
+	if (!GameArg.LogNetTraffic && !GameArg.LogNetCrash)
+		return;
+
+	netlog_add(tx ? NETLOG_TX : NETLOG_RX, address, msg, len, when);
+}
+
+void net_log_comment(char *comment)
+{
+	if (!GameArg.LogNetTraffic && !GameArg.LogNetCrash)
+		return;
+
+	netlog_add(NETLOG_NOTE, NULL, comment, strlen(comment), 0);
+}
+
+// Called when the game dies in Error()
+void net_log_crash_dump(void)
+{
+	if (netlog_crash_write())
+		con_printf(CON_URGENT, "%s", netlog_crash_msg);
+}
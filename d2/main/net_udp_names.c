@@ -0,0 +1,92 @@
+/*
+ *
+ * Names of the UDP packet types, for logs and tools.
+ *
+ */
+
+#include "net_udp.h"
+
+char* msg_name(int type)
+{
+	switch(type)
+	{
+		case UPID_VERSION_DENY:
+			return "UPID_VERSION_DENY";
+		case UPID_GAME_INFO_REQ:
+			return "UPID_GAME_INFO_REQ";
+		case UPID_GAME_INFO:
+			return "UPID_GAME_INFO";
+		case UPID_GAME_INFO_LITE_REQ:
+			return "UPID_GAME_INFO_LITE_REQ";
+		case UPID_GAME_INFO_LITE:
+			return "UPID_GAME_INFO_LITE";
+		case UPID_DUMP:
+			return "UPID_DUMP";
+		case UPID_ADDPLAYER:
+			return "UPID_ADDPLAYER";
+		case UPID_REQUEST:
+			return "UPID_REQUEST";
+		case UPID_QUIT_JOINING:
+		    return "UPID_QUIT_JOINING";
+		case UPID_SYNC:
+			return "UPID_SYNC";
+		case UPID_OBJECT_DATA:
+			return "UPID_OBJECT_DATA";
+		case UPID_PING:
+			return "UPID_PING";
+		case UPID_PONG:
+			return "UPID_PONG";
+		case UPID_ENDLEVEL_H:
+			return "UPID_ENDLEVEL_H";
+		case UPID_ENDLEVEL_C:
+			return "UPID_ENDLEVEL_C";
+		case UPID_PDATA:
+			return "UPID_PDATA";
+		case UPID_MDATA_PNORM:
+			return "UPID_MDATA_PNORM";
+		case UPID_MDATA_PNEEDACK:
+			return "UPID_MDATA_PNEEDACK";
+		case UPID_MDATA_ACK:
+			return "UPID_MDATA_ACK";
+#ifdef USE_TRACKER
+		case UPID_TRACKER_VERIFY:
+			return "UPID_TRACKER_VERIFY";
+		case UPID_TRACKER_INCGAME:
+			return "UPID_TRACKER_INCGAME";
+#endif
+
+		case UPID_P2P_PING:
+			return "UPID_P2P_PING";
+		case UPID_P2P_PONG:
+			return "UPID_P2P_PONG";
+
+		case UPID_PROXY:
+			return "UPID_PROXY";
+
+		case UPID_REATTEMPT_DIRECT:
+			return "UPID_REATTEMPT_DIRECT";
+		case UPID_OBSDATA:
+			return "UPID_OBSDATA";
+		case UPID_OBSQUIT:
+			return "UPID_OBSQUIT";
+		case UPID_BUNDLE:
+			return "UPID_BUNDLE";
+		case UPID_OBS_RELAY:
+			return "UPID_OBS_RELAY";
+		case UPID_OBS_RELAY_LIST:
+			return "UPID_OBS_RELAY_LIST";
+		case UPID_OBS_RELAY_OFFER:
+			return "UPID_OBS_RELAY_OFFER";
+		case UPID_OBJECT_SNAPSHOT:
+			return "UPID_OBJECT_SNAPSHOT";
+		case UPID_OBJECT_SNAPSHOT_ACK:
+			return "UPID_OBJECT_SNAPSHOT_ACK";
+		case UPID_OBS_RELAY_VIA:
+			return "UPID_OBS_RELAY_VIA";
+		case UPID_BUNDLE_OFFER:
+			return "UPID_BUNDLE_OFFER";
+
+		default:
+			return "UNKNOWN";
+	}
+}
@@ -193,29 +193,24 @@ void object_goto_prev_viewer()
 
 object *obj_find_first_of_type (int type)
 {
-	int i;
+	int i, objnum = -1;
 
-	for (i=0;i<=Highest_object_index;i++)
-		if (Objects[i].type==type)
-			return (&Objects[i]);
-	return ((object *)NULL);
+	for (i=0;i<Obj_type_count[type];i++)
+		if (objnum == -1 || Obj_type_list[type][i] < objnum)
+			objnum = Obj_type_list[type][i];
+	return objnum == -1 ? NULL : &Objects[objnum];
 }
 
 int obj_return_num_of_type (int type)
 {
-	int i,count=0;
-
-	for (i=0;i<=Highest_object_index;i++)
-		if (Objects[i].type==type)
-			count++;
-	return (count);
+	return Obj_type_count[type];
 }
 int obj_return_num_of_typeid (int type,int id)
 {
 	int i,count=0;
 
-	for (i=0;i<=Highest_object_index;i++)
-		if (Objects[i].type==type && Objects[i].id==id)
+	for (i=0;i<Obj_type_count[type];i++)
+		if (Objects[Obj_type_list[type][i]].id==id)
 			count++;
 	return (count);
 }
@@ -886,10 +881,343 @@ void reset_player_object()
 }
 
 
+//	------------------------------------------------------------------------------------------------------------------
+//	Loose grid of linked objects, for finding the objects near a point without looking at all of them.
+//	Cells are 256 units wide and hashed into a fixed number of buckets. Objects get put into the cell of
+//	their position when they are linked and after every move, so positions can only lag behind a little
+//	for things moved some other way. Queries look OBJ_GRID_SLACK further to make up for that.
+#define	OBJ_GRID_SHIFT		24		//	cell size 256 units
+#define	OBJ_GRID_BUCKETS	512
+#define	OBJ_GRID_SLACK		(F1_0*32)
+
+#define	OBJ_GRID_KEY(x,y,z)	((((x) & 0x3ff) << 20) | (((y) & 0x3ff) << 10) | ((z) & 0x3ff))
+#define	OBJ_GRID_HASH(x,y,z)	(((unsigned) (x)*73856093u ^ (unsigned) (y)*19349663u ^ (unsigned) (z)*83492791u) & (OBJ_GRID_BUCKETS-1))
+
+static short Obj_grid_head[OBJ_GRID_BUCKETS];
+static short Obj_grid_next[MAX_OBJECTS], Obj_grid_prev[MAX_OBJECTS];
+static short Obj_grid_bucket[MAX_OBJECTS];	//	-1 if not in the grid
+static int Obj_grid_key[MAX_OBJECTS];
+static fix Obj_grid_max_size;	//	biggest size seen since the grid was cleared
+
+static void obj_grid_clear(void)
+{
+	memset(Obj_grid_head, -1, sizeof(Obj_grid_head));
+	memset(Obj_grid_bucket, -1, sizeof(Obj_grid_bucket));
+	Obj_grid_max_size = 0;
+}
+
+void obj_grid_remove(int objnum)
+{
+	int	b = Obj_grid_bucket[objnum];
+
+	if (b == -1)
+		return;
+	if (Obj_grid_prev[objnum] == -1)
+		Obj_grid_head[b] = Obj_grid_next[objnum];
+	else
+		Obj_grid_next[Obj_grid_prev[objnum]] = Obj_grid_next[objnum];
+	if (Obj_grid_next[objnum] != -1)
+		Obj_grid_prev[Obj_grid_next[objnum]] = Obj_grid_prev[objnum];
+	Obj_grid_bucket[objnum] = -1;
+}
+
+void obj_grid_update(int objnum)
+{
+	vms_vector	*pos = &Objects[objnum].pos;
+	int	x = pos->x >> OBJ_GRID_SHIFT, y = pos->y >> OBJ_GRID_SHIFT, z = pos->z >> OBJ_GRID_SHIFT;
+	int	key = OBJ_GRID_KEY(x, y, z), b;
+
+	if (Objects[objnum].size > Obj_grid_max_size)
+		Obj_grid_max_size = Objects[objnum].size;
+
+	if (Obj_grid_bucket[objnum] != -1) {
+		if (Obj_grid_key[objnum] == key)
+			return;
+		obj_grid_remove(objnum);
+	}
+
+	b = OBJ_GRID_HASH(x, y, z);
+	Obj_grid_key[objnum] = key;
+	Obj_grid_bucket[objnum] = b;
+	Obj_grid_prev[objnum] = -1;
+	Obj_grid_next[objnum] = Obj_grid_head[b];
+	if (Obj_grid_head[b] != -1)
+		Obj_grid_prev[Obj_grid_head[b]] = objnum;
+	Obj_grid_head[b] = objnum;
+}
+
+static int obj_grid_near(fix a, fix b, fix radius)
+{
+	fix64	d = (fix64) a - b;
+
+	return d <= radius && d >= -radius;
+}
+
+//	Get the objects with a type in type_mask (bits 1<<type) that are at most radius away from pos on every axis,
+//	which includes all within radius. objnums needs room for MAX_OBJECTS. They come in object number order,
+//	just like from a loop over all objects. Returns the number of objects found.
+int obj_grid_find(const vms_vector *pos, fix radius, int type_mask, short *objnums)
+{
+	fix64	r = (fix64) radius + OBJ_GRID_SLACK;
+	int	x0 = (pos->x - r) >> OBJ_GRID_SHIFT, x1 = (pos->x + r) >> OBJ_GRID_SHIFT;
+	int	y0 = (pos->y - r) >> OBJ_GRID_SHIFT, y1 = (pos->y + r) >> OBJ_GRID_SHIFT;
+	int	z0 = (pos->z - r) >> OBJ_GRID_SHIFT, z1 = (pos->z + r) >> OBJ_GRID_SHIFT;
+	int	all, x, y, z, b, i, n = 0;
+
+	//	with a radius covering more cells than there are buckets just go through all buckets once
+	all = (fix64) (x1-x0+1) * (y1-y0+1) * (z1-z0+1) > OBJ_GRID_BUCKETS;
+	if (all) {
+		x0 = x1 = y0 = y1 = 0;
+		z0 = 0;
+		z1 = OBJ_GRID_BUCKETS-1;
+	}
+
+	for (x=x0; x<=x1; x++)
+		for (y=y0; y<=y1; y++)
+			for (z=z0; z<=z1; z++) {
+				int	key = OBJ_GRID_KEY(x, y, z), objnum;
+
+				b = all ? z : OBJ_GRID_HASH(x, y, z);
+				for (objnum=Obj_grid_head[b]; objnum!=-1; objnum=Obj_grid_next[objnum]) {
+					object	*obj = &Objects[objnum];
+
+					if ((!all && Obj_grid_key[objnum] != key) || obj->type >= MAX_OBJECT_TYPES || !(type_mask & (1 << obj->type)))
+						continue;
+					if (!obj_grid_near(obj->pos.x, pos->x, radius) || !obj_grid_near(obj->pos.y, pos->y, radius) || !obj_grid_near(obj->pos.z, pos->z, radius))
+						continue;
+					//	insert sorted, there are only a few
+					for (i=n++; i>0 && objnums[i-1] > objnum; i--)
+						objnums[i] = objnums[i-1];
+					objnums[i] = objnum;
+				}
+			}
+
+	return n;
+}
+
+//	No object in the grid is bigger than this. Add it to the radius of a query for objects touching a sphere
+//	rather than having their center in it.
+fix obj_grid_max_size(void)
+{
+	return Obj_grid_max_size;
+}
+
+//	------------------------------------------------------------------------------------------------------------------
+//	Dense lists of the objects of each type, so loops interested in one type don't have to go up to
+//	Highest_object_index. Objects get filed under their type by obj_link() and taken out by obj_free(),
+//	obj_set_type() moves them. Removal swaps the last entry in, so the lists are in no particular order.
+short Obj_type_list[MAX_OBJECT_TYPES][MAX_OBJECTS];
+short Obj_type_count[MAX_OBJECT_TYPES];
+static sbyte Obj_list_type[MAX_OBJECTS];	//	type an object is filed under, -1 if none
+static short Obj_list_slot[MAX_OBJECTS];
+
+static void obj_list_clear(void)
+{
+	memset(Obj_type_count, 0, sizeof(Obj_type_count));
+	memset(Obj_list_type, -1, sizeof(Obj_list_type));
+}
+
+static void obj_list_remove(int objnum)
+{
+	int	type = Obj_list_type[objnum], last;
+
+	if (type == -1)
+		return;
+	last = Obj_type_list[type][--Obj_type_count[type]];
+	Obj_type_list[type][Obj_list_slot[objnum]] = last;
+	Obj_list_slot[last] = Obj_list_slot[objnum];
+	Obj_list_type[objnum] = -1;
+}
+
+//	file an object under its current type
+static void obj_list_update(int objnum)
+{
+	int	type = Objects[objnum].type;
+
+	if (type == Obj_list_type[objnum])
+		return;
+	obj_list_remove(objnum);
+	if (type < 0 || type >= MAX_OBJECT_TYPES || type == OBJ_NONE)
+		return;
+	Obj_list_slot[objnum] = Obj_type_count[type];
+	Obj_type_list[type][Obj_type_count[type]++] = objnum;
+	Obj_list_type[objnum] = type;
+}
+
+//	change the type of an object that may already be in use
+void obj_set_type(int objnum, int type)
+{
+	Objects[objnum].type = type;
+	if (Obj_list_type[objnum] != -1 || Objects[objnum].segnum != -1)
+		obj_list_update(objnum);
+}
+
+#ifdef BENCHMARKS
+//	compare the type lists with a scan of all objects, returns the number of problems found
+int obj_check_type_lists(void)
+{
+	int	i, type, errors = 0, count[MAX_OBJECT_TYPES];
+
+	memset(count, 0, sizeof(count));
+	for (i=0; i<=Highest_object_index; i++)
+		if (Objects[i].type != OBJ_NONE && Objects[i].segnum != -1) {
+			if (Obj_list_type[i] != Objects[i].type) {
+				con_printf(CON_NORMAL, "Object %i of type %i filed under %i\n", i, Objects[i].type, Obj_list_type[i]);
+				errors++;
+			}
+			count[Objects[i].type]++;
+		}
+
+	for (type=0; type<MAX_OBJECT_TYPES; type++) {
+		if (type != OBJ_NONE && Obj_type_count[type] != count[type]) {
+			con_printf(CON_NORMAL, "%i objects of type %i, list has %i\n", count[type], type, Obj_type_count[type]);
+			errors++;
+		}
+		for (i=0; i<Obj_type_count[type]; i++) {
+			int	objnum = Obj_type_list[type][i];
+
+			if (objnum < 0 || objnum > Highest_object_index || Objects[objnum].type != type || Obj_list_slot[objnum] != i) {
+				con_printf(CON_NORMAL, "Bad entry %i in list of type %i: object %i\n", i, type, objnum);
+				errors++;
+			}
+		}
+	}
+
+	return errors;
+}
+
+//	Create and delete lots of objects at random, changing types in between, and check the type lists and
+//	the free list against a scan of all objects after every step. Everything created gets deleted again.
+void stress_object_lists(int steps)
+{
+	static const ubyte types[] = { OBJ_FIREBALL, OBJ_POWERUP, OBJ_LIGHT, OBJ_CLUTTER };
+	short	created[MAX_OBJECTS];
+	ubyte	on_free_list[MAX_OBJECTS];
+	int	n = 0, step, i, errors = 0, highest = Highest_object_index, used = num_objects;
+
+	for (step=0; step<steps; step++) {
+		int	r = d_rand() % 8;
+
+		if (r < 4 && n < MAX_OBJECTS/2) {
+			int	segnum = d_rand() % (Highest_segment_index+1), objnum;
+			vms_vector	pos;
+
+			compute_segment_center(&pos, &Segments[segnum]);
+			objnum = obj_create((enum object_type_t) types[d_rand() % (sizeof(types)/sizeof(types[0]))], 0, segnum, &pos, &vmd_identity_matrix, F1_0, CT_NONE, MT_NONE, RT_NONE);
+			if (objnum != -1)
+				created[n++] = objnum;
+		} else if (r < 7 && n) {
+			i = d_rand() % n;
+			obj_delete(created[i]);
+			created[i] = created[--n];
+		} else if (n) {
+			obj_set_type(created[d_rand() % n], types[d_rand() % (sizeof(types)/sizeof(types[0]))]);
+		}
+
+		errors += obj_check_type_lists();
+		//	the free list has to hold each unused object exactly once
+		memset(on_free_list, 0, sizeof(on_free_list));
+		for (i=num_objects; i<MAX_OBJECTS; i++) {
+			int	objnum = free_obj_list[i];
+
+			if (Objects[objnum].type != OBJ_NONE || on_free_list[objnum]) {
+				con_printf(CON_NORMAL, "Object %i on the free list is in use or there twice\n", objnum);
+				errors++;
+			}
+			on_free_list[objnum] = 1;
+		}
+		for (i=0; i<MAX_OBJECTS; i++)
+			if (Objects[i].type == OBJ_NONE && !on_free_list[i]) {
+				con_printf(CON_NORMAL, "Unused object %i missing from the free list\n", i);
+				errors++;
+			}
+		if (errors)
+			break;
+	}
+
+	while (n)
+		obj_delete(created[--n]);
+	errors += obj_check_type_lists();
+	if (Highest_object_index != highest || num_objects != used) {
+		con_printf(CON_NORMAL, "Object count not restored: highest %i (was %i), used %i (was %i)\n", Highest_object_index, highest, num_objects, used);
+		errors++;
+	}
+
+	con_printf(CON_NORMAL, "Object list stress: %i steps, %i errors\n", step, errors);
+}
+#endif
+
+//	------------------------------------------------------------------------------------------------------------------
+//	Objects hashed by signature, for finding the object with a signature without looking at all of them.
+//	obj_link() files an object under its signature and obj_free() takes it out, anything that gives a
+//	linked object a new signature calls obj_sig_update(). Lookups check the signature and type of what
+//	they find, so an entry left behind by an object overwritten some other way is harmless.
+#define	OBJ_SIG_BUCKETS		1024		//	signatures are handed out in order, so the low bits spread them
+
+static short Obj_sig_head[OBJ_SIG_BUCKETS];
+static short Obj_sig_next[MAX_OBJECTS], Obj_sig_prev[MAX_OBJECTS];
+static short Obj_sig_bucket[MAX_OBJECTS];	//	-1 if not filed
+static int Obj_sig_key[MAX_OBJECTS];
+
+static void obj_sig_clear(void)
+{
+	memset(Obj_sig_head, -1, sizeof(Obj_sig_head));
+	memset(Obj_sig_bucket, -1, sizeof(Obj_sig_bucket));
+}
+
+void obj_sig_remove(int objnum)
+{
+	int	b = Obj_sig_bucket[objnum];
+
+	if (b == -1)
+		return;
+	if (Obj_sig_prev[objnum] == -1)
+		Obj_sig_head[b] = Obj_sig_next[objnum];
+	else
+		Obj_sig_next[Obj_sig_prev[objnum]] = Obj_sig_next[objnum];
+	if (Obj_sig_next[objnum] != -1)
+		Obj_sig_prev[Obj_sig_next[objnum]] = Obj_sig_prev[objnum];
+	Obj_sig_bucket[objnum] = -1;
+}
+
+//	file an object under its current signature
+void obj_sig_update(int objnum)
+{
+	int	sig = Objects[objnum].signature, b;
+
+	if (Obj_sig_bucket[objnum] != -1) {
+		if (Obj_sig_key[objnum] == sig)
+			return;
+		obj_sig_remove(objnum);
+	}
+
+	b = sig & (OBJ_SIG_BUCKETS-1);
+	Obj_sig_key[objnum] = sig;
+	Obj_sig_bucket[objnum] = b;
+	Obj_sig_prev[objnum] = -1;
+	Obj_sig_next[objnum] = Obj_sig_head[b];
+	if (Obj_sig_head[b] != -1)
+		Obj_sig_prev[Obj_sig_head[b]] = objnum;
+	Obj_sig_head[b] = objnum;
+}
+
+//	Get the object with the given signature, the lowest numbered one if there are several, just like a
+//	loop over all objects would. Returns -1 if there is none.
+int obj_find_signature(int signature)
+{
+	int	objnum, found = -1;
+
+	for (objnum=Obj_sig_head[signature & (OBJ_SIG_BUCKETS-1)]; objnum!=-1; objnum=Obj_sig_next[objnum])
+		if (Objects[objnum].signature == signature && Objects[objnum].type != OBJ_NONE && (found == -1 || objnum < found))
+			found = objnum;
+
+	return found;
+}
+
 //make object0 the player, setting all relevant fields
 void init_player_object()
 {
-	ConsoleObject->type = OBJ_PLAYER;
+	obj_set_type(ConsoleObject-Objects, OBJ_PLAYER);
 	ConsoleObject->id = 0;					//no sub-types for player
 
 	ConsoleObject->signature = 0;			//player has zero, others start at 1
@@ -913,6 +1241,9 @@ void init_objects()
 	int i;
 
 	collide_init();
+	obj_grid_clear();
+	obj_list_clear();
+	obj_sig_clear();
 
 	for (i=0;i<MAX_OBJECTS;i++) {
 		free_obj_list[i] = i;
@@ -1098,6 +1429,10 @@ void obj_link(int objnum,int segnum)
 	Assert(Objects[0].prev != 0);
 	if (Objects[0].prev == 0)
 		Objects[0].prev = -1;
+
+	obj_grid_update(objnum);
+	obj_list_update(objnum);
+	obj_sig_update(objnum);
 }
 
 void obj_unlink(int objnum)
@@ -1115,6 +1450,7 @@ void obj_unlink(int objnum)
 	if (obj->next != -1) Objects[obj->next].prev = obj->prev;
 
 	obj->segnum = -1;
+	obj_grid_remove(objnum);
 
 	Assert(Objects[0].next != 0);
 	Assert(Objects[0].prev != 0);
@@ -1146,7 +1482,6 @@ int obj_get_signature()
 
 int Debris_object_count=0;
 
-int	Unused_object_slots;
 
 //returns the number of a free object, updating Highest_object_index.
 //Generally, obj_create() should be called to get an object, since it
@@ -1168,13 +1503,6 @@ int obj_allocate(void)
 			Highest_ever_object_index = Highest_object_index;
 	}
 
-{
-int	i;
-Unused_object_slots=0;
-for (i=0; i<=Highest_object_index; i++)
-	if (Objects[i].type == OBJ_NONE)
-		Unused_object_slots++;
-}
 	return objnum;
 }
 
@@ -1185,6 +1513,8 @@ void obj_free(int objnum)
 {
 	free_obj_list[--num_objects] = objnum;
 	Assert(num_objects >= 0);
+	obj_list_remove(objnum);
+	obj_sig_remove(objnum);
 
 	if (objnum == Highest_object_index)
 		while (Objects[--Highest_object_index].type == OBJ_NONE);
@@ -1418,6 +1748,7 @@ int obj_create_copy(int objnum, vms_vector *new_pos, int newsegnum)
 	obj_link(newobjnum,newsegnum);
 
 	obj->signature				= obj_get_signature();
+	obj_sig_update(newobjnum);
 
 	//we probably should initialize sub-structures here
 
@@ -1502,7 +1833,7 @@ void dead_player_end(void)
 	//Dead_player_camera = NULL;
 	select_cockpit(PlayerCfg.PreferredCockpitMode);
 	Viewer = Viewer_save;
-	ConsoleObject->type = OBJ_PLAYER;
+	obj_set_type(ConsoleObject-Objects, OBJ_PLAYER);
 	ConsoleObject->flags = Player_flags_save;
 
 	Assert((Control_type_save == CT_FLYING) || (Control_type_save == CT_SLEW));
@@ -1679,7 +2010,7 @@ void dead_player_frame(void)
 				explode_object(ConsoleObject,0);
 				ConsoleObject->flags &= ~OF_SHOULD_BE_DEAD;		//don't really kill player
 				ConsoleObject->render_type = RT_NONE;				//..just make him disappear
-				ConsoleObject->type = OBJ_GHOST;						//..and kill intersections
+				obj_set_type(ConsoleObject-Objects, OBJ_GHOST);	//..and kill intersections
 				Players[Player_num].flags &= ~PLAYER_FLAGS_HEADLIGHT_ON;
 
 #ifdef NETWORK
@@ -2025,6 +2356,9 @@ void object_move_one( object * obj )
 
 	}
 
+	if (obj->segnum != -1)
+		obj_grid_update(obj-Objects);
+
 	//	If player and moved to another segment, see if hit any triggers.
 	// also check in player under a lavafall
 	if (obj->type == OBJ_PLAYER && obj->movement_type==MT_PHYSICS)	{
@@ -2225,7 +2559,7 @@ void compress_objects(void)
 				Cur_object_index = start_i;
 			#endif
 
-			Objects[Highest_object_index].type = OBJ_NONE;
+			obj_set_type(Highest_object_index, OBJ_NONE);
 
 			obj_link(start_i,segnum_copy);
 
@@ -2249,8 +2583,14 @@ void reset_objects(int n_objs)
 
 	Assert(num_objects>0);
 
+	for (i=0;i<num_objects;i++)
+		obj_list_update(i);
+
 	for (i=num_objects;i<MAX_OBJECTS;i++) {
 		free_obj_list[i] = i;
+		obj_grid_remove(i);
+		obj_list_remove(i);
+		obj_sig_remove(i);
 		memset( &Objects[i], 0, sizeof(object) );
 		Objects[i].type = OBJ_NONE;
 		Objects[i].segnum = -1;
@@ -2282,6 +2622,8 @@ int update_object_seg(object * obj )
 
 	if ( newseg != obj->segnum )
 		obj_relink(obj-Objects, newseg );
+	else
+		obj_grid_update(obj-Objects);
 
 	return 1;
 }
@@ -397,6 +397,10 @@ extern object Objects[];
 extern int Highest_object_index;    // highest objnum
 extern int num_objects;
 
+// the objects of each type, in no particular order. Don't delete objects of a type while going through its list
+extern short Obj_type_list[MAX_OBJECT_TYPES][MAX_OBJECTS];
+extern short Obj_type_count[MAX_OBJECT_TYPES];
+
 extern char *robot_names[];         // name of each robot
 
 extern int Num_robot_types;
@@ -441,6 +445,35 @@ void obj_link(int objnum,int segnum);
 // unlinks an object from a segment's list of objects
 void obj_unlink(int objnum);
 
+// keep the signature index up to date, obj_link() and obj_free() do it
+void obj_sig_update(int objnum);
+void obj_sig_remove(int objnum);
+
+// get the lowest numbered object with the given signature, or -1. does not look at all objects
+int obj_find_signature(int signature);
+
+// keep an object's place in the object grid up to date, obj_link() and object_move_one() do it
+void obj_grid_update(int objnum);
+void obj_grid_remove(int objnum);
+
+// get the objects with a type in type_mask (bits 1<<type) that are at most radius away from pos
+// on every axis, in object number order. objnums needs room for MAX_OBJECTS. returns the count
+int obj_grid_find(const vms_vector *pos, fix radius, int type_mask, short *objnums);
+
+// no object in the grid is bigger than this, for queries about objects touching a sphere
+fix obj_grid_max_size(void);
+
+// change the type of an object, keeping Obj_type_list up to date
+void obj_set_type(int objnum, int type);
+
+#ifdef BENCHMARKS
+// check Obj_type_list against all objects, returns the number of errors
+int obj_check_type_lists(void);
+
+// create and delete lots of objects, checking the object lists after each step (-objliststress)
+void stress_object_lists(int steps);
+#endif
+
 // initialize a new object.  adds to the list for the given segment
 // returns the object number
 int obj_create(enum object_type_t type, ubyte id, int segnum, const vms_vector *pos,
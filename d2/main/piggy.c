@@ -35,6 +35,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "bmread.h"
 #include "hash.h"
 #include "args.h"
+#include "profile.h"
 #include "palette.h"
 #include "gamefont.h"
 #include "gamepal.h"
@@ -1108,6 +1109,7 @@ void piggy_bitmap_page_in( bitmap_index bitmap )
 
 	if ( bmp->bm_flags & BM_FLAG_PAGED_OUT ) {
 		stop_time();
+		PROF_BEGIN(PROF_PAGE_IN);
 
 	ReDoIt:
 		descent_critical_error = 0;
@@ -1224,6 +1226,7 @@ void piggy_bitmap_page_in( bitmap_index bitmap )
 
 		compute_average_rgb(bmp, bmp->avg_color_rgb);
 
+		PROF_END(PROF_PAGE_IN);
 		start_time();
 	}
 
@@ -0,0 +1,284 @@
+/*
+ *
+ * Frame profiler.
+ *
+ * With -profile the PROF_BEGIN()/PROF_END() zones around the stages of a frame put a timestamped event into a ring
+ * of the thread they run on, PROF_RING_SIZE events per thread, so the last several seconds are always around. On the
+ * main thread the time spent in each zone is also added up per frame: prof_get_stats() gives the average and the
+ * worst frame over the last second for the overlay (ALT-SHIFT-F7), and prof_write_trace() (ALT-SHIFT-F8) writes the
+ * rings as traceNNNN.json in the Chrome trace event format, to be opened in chrome://tracing or Perfetto.
+ *
+ * A thread gets its ring the first time it enters a zone. The times are inclusive: a zone contains the zones
+ * started inside it, and a zone inside itself is counted once.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+
+#include "pstypes.h"
+#include "args.h"
+#include "console.h"
+#include "dxxerror.h"
+#include "u_mem.h"
+#include "physfsx.h"
+#include "profile.h"
+
+#define PROF_RING_SIZE		65536	// events per thread, must be a power of 2
+#define PROF_RING_SLACK		1024	// events the owner may write while a trace is being saved
+#define PROF_MAX_THREADS	4
+#define PROF_MAX_DEPTH		32
+
+#define PROF_EV_BEGIN		0
+#define PROF_EV_END		1
+#define PROF_EV_FRAME		2	// start of a frame on the main thread
+
+typedef struct prof_event
+{
+	u_int64_t time;
+	short zone, type;
+} prof_event;
+
+typedef struct prof_thread
+{
+	SDL_atomic_t ready;
+	SDL_threadID id;
+	char name[16];
+	prof_event *ring;
+	SDL_atomic_t head; // events ever written, only moved by the owner
+	int depth;
+	short stack[PROF_MAX_DEPTH];
+	u_int64_t start[PROF_MAX_DEPTH];
+} prof_thread;
+
+static const char *const prof_zone_names[PROF_ZONES] =
+{
+	"game", "objects", "ai", "sounds", "multi", "net", "render", "seglist", "lighting", "page_in", "texture",
+	"udp_send", "udp_recv"
+};
+
+int Profile_enabled = 0, Profile_overlay = 0;
+
+static prof_thread prof_threads[PROF_MAX_THREADS]; // the main thread is the first
+static SDL_atomic_t prof_num_threads;
+static u_int64_t prof_start, prof_freq;
+
+// main thread totals for the overlay
+static u_int64_t prof_zone_frame[PROF_ZONES], prof_zone_sum[PROF_ZONES], prof_zone_peak[PROF_ZONES];
+static u_int64_t prof_frame_start = 0, prof_frame_sum = 0, prof_frame_peak = 0, prof_window_start = 0;
+static int prof_frames = 0;
+static prof_stat prof_shown[PROF_ZONES + 1]; // the frame comes last
+
+static prof_thread *prof_thread_self(void)
+{
+	SDL_threadID id = SDL_ThreadID();
+	int i, n = min(SDL_AtomicGet(&prof_num_threads), PROF_MAX_THREADS);
+	prof_thread *t;
+
+	for (i = 0; i < n; i++)
+		if (SDL_AtomicGet(&prof_threads[i].ready) && prof_threads[i].id == id)
+			return &prof_threads[i];
+
+	// a new thread, the rings were made by prof_init()
+	if ((i = SDL_AtomicAdd(&prof_num_threads, 1)) >= PROF_MAX_THREADS)
+		return NULL;
+	t = &prof_threads[i];
+	t->id = id;
+	snprintf(t->name, sizeof(t->name), "thread %i", i);
+	SDL_AtomicSet(&t->head, 0);
+	t->depth = 0;
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&t->ready, 1);
+	return t;
+}
+
+void prof_init(void)
+{
+	int i;
+
+	if (!GameArg.DbgProfile || Profile_enabled)
+		return;
+
+	for (i = 0; i < PROF_MAX_THREADS; i++)
+	{
+		MALLOC(prof_threads[i].ring, prof_event, PROF_RING_SIZE);
+		if (!prof_threads[i].ring)
+			Error("Not enough memory for -profile");
+		SDL_AtomicSet(&prof_threads[i].ready, 0);
+	}
+	SDL_AtomicSet(&prof_num_threads, 0);
+	prof_freq = SDL_GetPerformanceFrequency();
+	prof_start = SDL_GetPerformanceCounter();
+	Profile_enabled = 1;
+	prof_thread_name("main");
+}
+
+void prof_thread_name(const char *name)
+{
+	prof_thread *t;
+
+	if (Profile_enabled && (t = prof_thread_self()))
+		snprintf(t->name, sizeof(t->name), "%s", name);
+}
+
+static void prof_record(prof_thread *t, int zone, int type, u_int64_t time)
+{
+	unsigned head = SDL_AtomicGet(&t->head);
+	prof_event *e = &t->ring[head & (PROF_RING_SIZE - 1)];
+
+	e->time = time;
+	e->zone = zone;
+	e->type = type;
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&t->head, head + 1);
+}
+
+void prof_begin(int zone)
+{
+	u_int64_t now = SDL_GetPerformanceCounter();
+	prof_thread *t = prof_thread_self();
+
+	if (!t)
+		return;
+	prof_record(t, zone, PROF_EV_BEGIN, now);
+	if (t->depth < PROF_MAX_DEPTH)
+	{
+		t->stack[t->depth] = zone;
+		t->start[t->depth] = now;
+	}
+	t->depth++;
+}
+
+void prof_end(int zone)
+{
+	u_int64_t now = SDL_GetPerformanceCounter();
+	prof_thread *t = prof_thread_self();
+	int i;
+
+	if (!t || t->depth <= 0)
+		return;
+	prof_record(t, zone, PROF_EV_END, now);
+	if (--t->depth >= PROF_MAX_DEPTH || t != prof_threads)
+		return;
+	for (i = 0; i < t->depth; i++)
+		if (t->stack[i] == zone)
+			return;
+	prof_zone_frame[zone] += now - t->start[t->depth];
+}
+
+// start of a frame on the main thread, which ends the last one
+void prof_frame(void)
+{
+	u_int64_t now;
+	int i;
+
+	if (!Profile_enabled)
+		return;
+
+	now = SDL_GetPerformanceCounter();
+	prof_record(&prof_threads[0], 0, PROF_EV_FRAME, now);
+	if (prof_frame_start)
+	{
+		prof_frame_sum += now - prof_frame_start;
+		prof_frame_peak = max(prof_frame_peak, now - prof_frame_start);
+		for (i = 0; i < PROF_ZONES; i++)
+		{
+			prof_zone_sum[i] += prof_zone_frame[i];
+			prof_zone_peak[i] = max(prof_zone_peak[i], prof_zone_frame[i]);
+		}
+		prof_frames++;
+	}
+	memset(prof_zone_frame, 0, sizeof(prof_zone_frame));
+	prof_frame_start = now;
+
+	if (now - prof_window_start < prof_freq || !prof_frames)
+		return;
+	for (i = 0; i <= PROF_ZONES; i++)
+	{
+		prof_shown[i].name = i < PROF_ZONES ? prof_zone_names[i] : "frame";
+		prof_shown[i].avg_ms = (i < PROF_ZONES ? prof_zone_sum[i] : prof_frame_sum) * 1000.0 / prof_freq / prof_frames;
+		prof_shown[i].max_ms = (i < PROF_ZONES ? prof_zone_peak[i] : prof_frame_peak) * 1000.0 / prof_freq;
+	}
+	memset(prof_zone_sum, 0, sizeof(prof_zone_sum));
+	memset(prof_zone_peak, 0, sizeof(prof_zone_peak));
+	prof_frame_sum = prof_frame_peak = 0;
+	prof_frames = 0;
+	prof_window_start = now;
+}
+
+// the frame and the n slowest zones over the last second. Returns how many zones were filled in.
+int prof_get_stats(prof_stat *frame, prof_stat *top, int n)
+{
+	int i, j, k, num = 0;
+
+	*frame = prof_shown[PROF_ZONES];
+	for (i = 0; i < PROF_ZONES; i++)
+	{
+		if (prof_shown[i].avg_ms <= 0)
+			continue;
+		for (j = 0; j < num && top[j].avg_ms >= prof_shown[i].avg_ms; j++)
+			;
+		if (j >= n)
+			continue;
+		for (k = min(num, n - 1); k > j; k--)
+			top[k] = top[k - 1];
+		top[j] = prof_shown[i];
+		num = min(num + 1, n);
+	}
+	return num;
+}
+
+// write the rings of all threads as traceNNNN.json. Returns the file name or NULL.
+const char *prof_write_trace(void)
+{
+	static char filename[16];
+	PHYSFS_file *fp;
+	prof_event *e;
+	prof_thread *t;
+	unsigned head, pos;
+	int i, n, depth, first = 1;
+
+	if (!Profile_enabled)
+		return NULL;
+
+	for (i = 0; i < 10000; i++)
+	{
+		snprintf(filename, sizeof(filename), "trace%04i.json", i);
+		if (!PHYSFSX_exists(filename, 0))
+			break;
+	}
+	if (i == 10000 || !(fp = PHYSFS_openWrite(filename)))
+		return NULL;
+
+	PHYSFSX_printf(fp, "{\"traceEvents\":[\n");
+	n = min(SDL_AtomicGet(&prof_num_threads), PROF_MAX_THREADS);
+	for (i = 0; i < n; i++)
+	{
+		t = &prof_threads[i];
+		if (!SDL_AtomicGet(&t->ready))
+			continue;
+		PHYSFSX_printf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", i + 1, t->name);
+		first = 0;
+
+		head = SDL_AtomicGet(&t->head);
+		SDL_MemoryBarrierAcquire();
+		depth = 0;
+		for (pos = head > PROF_RING_SIZE - PROF_RING_SLACK ? head - (PROF_RING_SIZE - PROF_RING_SLACK) : 0; pos != head; pos++)
+		{
+			e = &t->ring[pos & (PROF_RING_SIZE - 1)];
+			if (e->type == PROF_EV_END && !depth)
+				continue; // began before the oldest event still in the ring
+			depth += e->type == PROF_EV_BEGIN ? 1 : e->type == PROF_EV_END ? -1 : 0;
+			if (e->type == PROF_EV_FRAME)
+				PHYSFSX_printf(fp, ",\n{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%i,\"ts\":%.3f}", i + 1, (double)(e->time - prof_start) * 1000000 / prof_freq);
+			else
+				PHYSFSX_printf(fp, ",\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":1,\"tid\":%i,\"ts\":%.3f}", prof_zone_names[e->zone], e->type == PROF_EV_BEGIN ? "B" : "E", i + 1, (double)(e->time - prof_start) * 1000000 / prof_freq);
+		}
+	}
+	PHYSFSX_printf(fp, "\n]}\n");
+	PHYSFS_close(fp);
+	con_printf(CON_NORMAL, "Profile written to %s\n", filename);
+	return filename;
+}
@@ -56,6 +56,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "ogl_init.h"
 #endif
 #include "args.h"
+#include "profile.h"
 
 #define INITIAL_LOCAL_LIGHT (F1_0/4)    // local light value in segment of occurence (of light emission)
 
@@ -196,85 +197,17 @@ void flash_frame()
 }
 
 // ----------------------------------------------------------------------------
-//	Render a face.
-//	It would be nice to not have to pass in segnum and sidenum, but
-//	they are used for our hideously hacked in headlight system.
-//	vp is a pointer to vertex ids.
-//	tmap1, tmap2 are texture map ids.  tmap2 is the pasty one.
-void render_face(int segnum, int sidenum, int nv, int *vp, int tmap1, int tmap2, uvl *uvlp, int wid_flags)
+//	Set light values for each vertex of a face.
+//	uvl_copy[i].l holds the static light of the vertex on entry and dyn_light
+//	gets the rgb light the face is drawn with.
+static void render_face_light(int nv, int *vp, g3s_uvl *uvl_copy, g3s_lrgb *dyn_light)
 {
-	grs_bitmap  *bm;
-#ifdef OGL
-	grs_bitmap  *bm2 = NULL;
-#endif
-
-	g3s_uvl			uvl_copy[8];
-	g3s_lrgb		dyn_light[8];
 	int			i;
-	const g3s_point		*pointlist[8];
 
-	Assert(nv <= 8);
-
-	for (i=0; i<nv; i++) {
-		uvl_copy[i].u = uvlp[i].u;
-		uvl_copy[i].v = uvlp[i].v;
-		dyn_light[i].r = dyn_light[i].g = dyn_light[i].b = uvl_copy[i].l = uvlp[i].l;
-		pointlist[i] = &Segment_points[vp[i]];
-	}
-
-	//handle cloaked walls
-	if (wid_flags & WID_CLOAKED_FLAG) {
-		int wall_num = Segments[segnum].sides[sidenum].wall_num;
-		Assert(wall_num != -1);
-		gr_settransblend(Walls[wall_num].cloak_value, GR_BLEND_NORMAL);
-		gr_setcolor(BM_XRGB(0, 0, 0));  // set to black (matters for s3)
-
-		g3_draw_poly(nv, pointlist);    // draw as flat poly
-
-		gr_settransblend(GR_FADE_OFF, GR_BLEND_NORMAL);
-
-		return;
-	}
-
-	if (tmap1 >= NumTextures) {
-#ifndef RELEASE
-		Int3();
-#endif
-		Segments[segnum].sides[sidenum].tmap_num = 0;
-	}
-
-#ifdef OGL
-	if (GameArg.DbgAltTexMerge){
-		PIGGY_PAGE_IN(Textures[tmap1]);
-		bm = &GameBitmaps[Textures[tmap1].index];
-		if (tmap2){
-			PIGGY_PAGE_IN(Textures[tmap2&0x3FFF]);
-			bm2 = &GameBitmaps[Textures[tmap2&0x3FFF].index];
-			PIGGY_PAGE_IN(Textures[tmap1]); // in case textures just got flushed
-		}
-#ifndef OGL_MERGE
-		if (bm2 && (bm2->bm_flags&BM_FLAG_SUPER_TRANSPARENT)){
-			bm = texmerge_get_cached_bitmap( tmap1, tmap2 );
-			bm2 = NULL;
-		}
-#endif
-	}else
-#endif
-
-		// New code for overlapping textures...
-		if (tmap2 != 0) {
-			bm = texmerge_get_cached_bitmap( tmap1, tmap2 );
-		} else {
-			bm = &GameBitmaps[Textures[tmap1].index];
-			PIGGY_PAGE_IN(Textures[tmap1]);
-		}
-
-	Assert( !(bm->bm_flags & BM_FLAG_PAGED_OUT) );
-
-	//set light values for each vertex & build pointlist
 	for (i=0;i<nv;i++)
 	{
 		//the uvl struct has static light already in it
+		dyn_light[i].r = dyn_light[i].g = dyn_light[i].b = uvl_copy[i].l;
 
 		//scale static light for destruction effect
 		if (Control_center_destroyed || Seismic_tremor_magnitude)	//make lights flash
@@ -319,6 +252,97 @@ void render_face(int segnum, int sidenum, int nv, int *vp, int tmap1, int tmap2,
 			dyn_light[i].b *= .93;
 		}
 	}
+}
+
+// ----------------------------------------------------------------------------
+//	Get the bitmap(s) a face is drawn with.
+//	*bm2 is set to the overlay if it is drawn separately rather than merged into the base bitmap.
+static grs_bitmap *render_face_bitmap(int tmap1, int tmap2, grs_bitmap **bm2)
+{
+	grs_bitmap  *bm;
+
+	*bm2 = NULL;
+
+#ifdef OGL
+	if (GameArg.DbgAltTexMerge){
+		PIGGY_PAGE_IN(Textures[tmap1]);
+		bm = &GameBitmaps[Textures[tmap1].index];
+		if (tmap2){
+			PIGGY_PAGE_IN(Textures[tmap2&0x3FFF]);
+			*bm2 = &GameBitmaps[Textures[tmap2&0x3FFF].index];
+			PIGGY_PAGE_IN(Textures[tmap1]); // in case textures just got flushed
+		}
+#ifndef OGL_MERGE
+		if (*bm2 && ((*bm2)->bm_flags&BM_FLAG_SUPER_TRANSPARENT)){
+			bm = texmerge_get_cached_bitmap( tmap1, tmap2 );
+			*bm2 = NULL;
+		}
+#endif
+	}else
+#endif
+
+		// New code for overlapping textures...
+		if (tmap2 != 0) {
+			bm = texmerge_get_cached_bitmap( tmap1, tmap2 );
+		} else {
+			bm = &GameBitmaps[Textures[tmap1].index];
+			PIGGY_PAGE_IN(Textures[tmap1]);
+		}
+
+	Assert( !(bm->bm_flags & BM_FLAG_PAGED_OUT) );
+
+	return bm;
+}
+
+// ----------------------------------------------------------------------------
+//	Render a face.
+//	It would be nice to not have to pass in segnum and sidenum, but
+//	they are used for our hideously hacked in headlight system.
+//	vp is a pointer to vertex ids.
+//	tmap1, tmap2 are texture map ids.  tmap2 is the pasty one.
+void render_face(int segnum, int sidenum, int nv, int *vp, int tmap1, int tmap2, uvl *uvlp, int wid_flags)
+{
+	grs_bitmap  *bm;
+	grs_bitmap  *bm2;
+
+	g3s_uvl			uvl_copy[8];
+	g3s_lrgb		dyn_light[8];
+	int			i;
+	const g3s_point		*pointlist[8];
+
+	Assert(nv <= 8);
+
+	for (i=0; i<nv; i++) {
+		uvl_copy[i].u = uvlp[i].u;
+		uvl_copy[i].v = uvlp[i].v;
+		uvl_copy[i].l = uvlp[i].l;
+		pointlist[i] = &Segment_points[vp[i]];
+	}
+
+	//handle cloaked walls
+	if (wid_flags & WID_CLOAKED_FLAG) {
+		int wall_num = Segments[segnum].sides[sidenum].wall_num;
+		Assert(wall_num != -1);
+		gr_settransblend(Walls[wall_num].cloak_value, GR_BLEND_NORMAL);
+		gr_setcolor(BM_XRGB(0, 0, 0));  // set to black (matters for s3)
+
+		g3_draw_poly(nv, pointlist);    // draw as flat poly
+
+		gr_settransblend(GR_FADE_OFF, GR_BLEND_NORMAL);
+
+		return;
+	}
+
+	if (tmap1 >= NumTextures) {
+#ifndef RELEASE
+		Int3();
+#endif
+		Segments[segnum].sides[sidenum].tmap_num = 0;
+	}
+
+	bm = render_face_bitmap(tmap1, tmap2, &bm2);
+
+	render_face_light(nv, vp, uvl_copy, dyn_light);
 
 	if ( PlayerCfg.AlphaEffects && ( TmapInfo[tmap1].eclip_num == ECLIP_NUM_FUELCEN || TmapInfo[tmap1].eclip_num == ECLIP_NUM_FORCE_FIELD ) ) // set nice transparency/blending for some special effects (if we do more, we should maybe use switch here)
 		gr_settransblend(GR_FADE_OFF, GR_BLEND_ADDITIVE_C);
@@ -584,6 +608,80 @@ im_so_ashamed: ;
 
 }
 
+#ifdef OGL
+// -----------------------------------------------------------------------------------
+//	Queue a side for the static level mesh instead of drawing it through render_face.
+//	Returns 0 if the side needs something the mesh can't do, render_side has to take care of it then.
+static int render_side_levelmesh(segment *segp, int sidenum)
+{
+	int		vertnum_list[4], faces = 0, i;
+	side		*sidep = &segp->sides[sidenum];
+	vms_vector	tvec;
+	vms_vector	normals[2];
+	g3s_uvl		uvl_copy[4];
+	g3s_lrgb	dyn_light[4];
+	grs_bitmap	*bm, *bm2;
+	int		wid_flags;
+
+	wid_flags = WALL_IS_DOORWAY(segp,sidenum);
+
+	if (!(wid_flags & WID_RENDER_FLAG))
+		return 1;
+
+	if ((wid_flags & WID_CLOAKED_FLAG) || sidep->tmap_num >= NumTextures || Outline_mode || _search_mode)
+		return 0;
+	if (PlayerCfg.AlphaEffects && ( TmapInfo[sidep->tmap_num].eclip_num == ECLIP_NUM_FUELCEN || TmapInfo[sidep->tmap_num].eclip_num == ECLIP_NUM_FORCE_FIELD ))
+		return 0;
+#ifdef EDITOR
+	if ((Render_only_bottom) && (sidenum == WBOTTOM))
+		return 0;
+	if (EditorWindow)	// geometry may change any time in here, start over once we are back in the game
+	{
+		ogl_levelmesh_invalidate();
+		return 0;
+	}
+#endif
+
+#ifdef COMPACT_SEGS
+	get_side_normals(segp, sidenum, &normals[0], &normals[1] );
+#else
+	normals[0] = segp->sides[sidenum].normals[0];
+	normals[1] = segp->sides[sidenum].normals[1];
+#endif
+
+	//	same facing checks as render_side, per triangle. Bit 0 is the triangle on normals[0].
+	if (sidep->type == SIDE_IS_QUAD) {
+		vm_vec_sub(&tvec, &Viewer_eye, &Vertices[segp->verts[Side_to_verts[sidenum][0]]]);
+		if (vm_vec_dot(&tvec, &normals[0]) >= 0)
+			faces = 3;
+	} else {
+		if (sidep->type == SIDE_IS_TRI_13)
+			vm_vec_normalized_dir_quick(&tvec, &Viewer_eye, &Vertices[segp->verts[Side_to_verts[sidenum][1]]]);
+		else
+			vm_vec_normalized_dir_quick(&tvec, &Viewer_eye, &Vertices[segp->verts[Side_to_verts[sidenum][0]]]);
+		if (vm_vec_dot(&tvec, &normals[0]) >= 0)
+			faces |= 1;
+		if (vm_vec_dot(&tvec, &normals[1]) >= 0)
+			faces |= 2;
+	}
+
+	if (!faces)
+		return 1;
+
+	get_side_verts(vertnum_list,segp-Segments,sidenum);
+	for (i=0; i<4; i++) {
+		uvl_copy[i].u = sidep->uvls[i].u;
+		uvl_copy[i].v = sidep->uvls[i].v;
+		uvl_copy[i].l = sidep->uvls[i].l;
+	}
+
+	bm = render_face_bitmap(sidep->tmap_num, sidep->tmap_num2, &bm2);
+	render_face_light(4, vertnum_list, uvl_copy, dyn_light);
+
+	return ogl_levelmesh_add_side(segp-Segments, sidenum, faces, dyn_light, bm, bm2);
+}
+#endif
+
 #ifdef EDITOR
 void render_object_search(object *obj)
 {
@@ -1616,6 +1714,8 @@ void render_frame(fix eye_offset, int window_num)
 		return;
 	}
 
+	PROF_BEGIN(PROF_RENDER);
+
 	if ( Newdemo_state == ND_STATE_RECORDING && eye_offset >= 0 )	{
      
       if (RenderingType==0)
@@ -1744,6 +1844,7 @@ void render_frame(fix eye_offset, int window_num)
 	render_mine(start_seg_num, eye_offset, window_num);
 
 	g3_end_frame();
+	PROF_END(PROF_RENDER);
 
    //RenderingType=0;
 
@@ -2000,7 +2101,9 @@ void render_mine(int start_seg_num,fix eye_offset, int window_num)
 	else
 	#endif
 		//NOTE LINK TO ABOVE!!
+		PROF_BEGIN(PROF_SEGLIST);
 		build_segment_list(start_seg_num, window_num);		//fills in Render_list & N_render_segs
+		PROF_END(PROF_SEGLIST);
 
 	//render away
 
@@ -2028,7 +2131,9 @@ void render_mine(int start_seg_num,fix eye_offset, int window_num)
 		build_object_lists(N_render_segs);
 
 	if (eye_offset<=0) // Do for left eye or zero.
+		PROF_BEGIN(PROF_LIGHTING);
 		set_dynamic_light();
+		PROF_END(PROF_LIGHTING);
 
 	if (!_search_mode && Clear_window == 2) {
 		if (first_terminal_seg < N_render_segs) {
@@ -2119,6 +2224,8 @@ void render_mine(int start_seg_num,fix eye_offset, int window_num)
 	} else {
 	// Sorting elements for Alpha - 3 passes
 	// First Pass: render opaque level geometry + transculent level geometry with high Alpha-Test func
+	// Faces are collected and drawn grouped by texture, the depth buffer sorts them out
+	ogl_world_batch_begin(0);
 	for (nn=N_render_segs;nn--;)
 	{
 		int segnum;
@@ -2153,17 +2260,19 @@ void render_mine(int start_seg_num,fix eye_offset, int window_num)
 						if (WALL_IS_DOORWAY(seg,sn) == WID_TRANSPARENT_WALL || WALL_IS_DOORWAY(seg,sn) == WID_TRANSILLUSORY_WALL ||
 						WALL_IS_DOORWAY(seg,sn) & WID_CLOAKED_FLAG)
 						{
-							glAlphaFunc(GL_GEQUAL,0.8);
-							render_side(seg, sn);
-							glAlphaFunc(GL_GEQUAL,0.02);
+							ogl_alpha_func(0.8);
+							if (!GameArg.OglLevelMesh || !render_side_levelmesh(seg, sn))
+								render_side(seg, sn);
+							ogl_alpha_func(0.02);
 						}
-						else
+						else if (!GameArg.OglLevelMesh || !render_side_levelmesh(seg, sn))
 							render_side(seg, sn);
 				}
 			}
 			visited[segnum]=255;
 		}
 	}
+	ogl_world_batch_end();
 
 	memset(visited, 0, sizeof(visited[0])*(Highest_segment_index+1));
 	
@@ -2224,6 +2333,8 @@ void render_mine(int start_seg_num,fix eye_offset, int window_num)
 	memset(visited, 0, sizeof(visited[0])*(Highest_segment_index+1));
 	
 	// Third Pass - Render Transculent level geometry with normal Alpha-Func
+	// Still batched, but in submission order to keep back-to-front blending intact
+	ogl_world_batch_begin(1);
 	for (nn=N_render_segs;nn--;)
 	{
 		int segnum;
@@ -2263,6 +2374,7 @@ void render_mine(int start_seg_num,fix eye_offset, int window_num)
 			visited[segnum]=255;
 		}
 	}
+	ogl_world_batch_end();
 	}
 #endif
 
@@ -42,6 +42,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "joy.h"
 #include "timer.h"
 #include "text.h"
+#include "args.h"
 #include "strutil.h"
 #include "rbaudio.h"
 
@@ -221,6 +222,8 @@ void scores_maybe_add_player(int abort_flag)
 
 	if ((Game_mode & GM_MULTI) && !(Game_mode & GM_MULTI_COOP))
 		return;
+	if (GameArg.MplDedicated) // the host did not play
+		return;
   
 	scores_read(&scores);
 	
@@ -852,9 +852,6 @@ int state_save_all_sub(char *filename, char *desc)
 	grs_canvas * cnv;
 	ubyte *pal;
 	char mission_filename[9];
-#ifdef OGL
-	GLint gl_draw_buffer;
-#endif
 	fix tmptime32 = 0;
 
 	#ifndef NDEBUG
@@ -905,8 +902,7 @@ int state_save_all_sub(char *filename, char *desc)
 #if defined(OGL)
 		buf = d_malloc(THUMBNAIL_W * THUMBNAIL_H * 4);
 #ifndef OGLES
- 		glGetIntegerv(GL_DRAW_BUFFER, &gl_draw_buffer);
- 		glReadBuffer(gl_draw_buffer);
+ 		ogl_state_read_buffer(ogl_state_get_draw_buffer());
 #endif
 		glReadPixels(0, SHEIGHT - THUMBNAIL_H, THUMBNAIL_W, THUMBNAIL_H, GL_RGBA, GL_UNSIGNED_BYTE, buf);
 		k = THUMBNAIL_H;
@@ -1669,7 +1665,7 @@ int state_restore_all_sub(char *filename, int secret_restore)
 			if (restore_players[i].connected == CONNECT_PLAYING && obj->type == OBJ_PLAYER)
 			{
 				memcpy(&restore_objects[i], obj, sizeof(object));
-				obj->type = OBJ_GHOST;
+				obj_set_type(obj-Objects, OBJ_GHOST);
 				multi_reset_player_object(obj);
 			}
 		}
@@ -1704,7 +1700,7 @@ int state_restore_all_sub(char *filename, int secret_restore)
 					obj->mtype.phys_info = restore_objects[j].mtype.phys_info;
 					obj->rtype.pobj_info = restore_objects[j].rtype.pobj_info;
 					// make this restored player object an actual player again
-					obj->type = OBJ_PLAYER;
+					obj_set_type(obj-Objects, OBJ_PLAYER);
 					multi_reset_player_object(obj);
 					update_object_seg(obj);
 				}
@@ -0,0 +1,168 @@
+/*
+ *
+ * Timedemo benchmark.
+ *
+ * With -timedemo <file> the game plays demos/<file> instead of showing the menus and exits when it ends. Every
+ * recorded frame is shown once, without interpolation, without the frame rate limit and with VSync off for the run
+ * (the configured setting is kept), and game time moves on by the recorded frame times, so each run simulates the
+ * same frames. The time of every frame is kept and split into the TIMEDEMO_* stages; at the end the frame count,
+ * average and percentile frame times and the average time per stage are printed, and written as JSON to
+ * -timedemo_json <file>. With -timedemo_norender there is no window and nothing is drawn, which times the demo and
+ * the simulation alone.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+
+#include "pstypes.h"
+#include "args.h"
+#include "console.h"
+#include "u_mem.h"
+#include "physfsx.h"
+#include "game.h"
+#include "player.h"
+#include "playsave.h"
+#include "newdemo.h"
+#include "timedemo.h"
+
+static const char *const timedemo_stage_names[TIMEDEMO_STAGES] = { "demo", "game", "render", "present" };
+
+static int timedemo_running = 0;
+static u_int32_t *timedemo_times = NULL; // microseconds each frame took
+static int timedemo_num = 0, timedemo_max = 0;
+static u_int64_t timedemo_frame_start = 0, timedemo_last = 0, timedemo_stage_total[TIMEDEMO_STAGES];
+
+void timedemo_start(void)
+{
+	if (!Players[Player_num].callsign[0])
+		new_player_config(); // no pilot, the demo brings its own callsign
+	Newdemo_do_interpolate = 0; // one recorded frame per frame shown
+#if defined(OGL) && SDL_VERSION_ATLEAST(2, 0, 0)
+	if (!GameArg.SysHeadless)
+		SDL_GL_SetSwapInterval(0); // not waiting for the monitor, GameCfg.VSync stays as saved
+#endif
+
+	newdemo_start_playback(GameArg.SysTimeDemo);
+	if (!Game_wind)
+	{
+		con_printf(CON_URGENT, "Cannot play demo %s\n", GameArg.SysTimeDemo);
+		return;
+	}
+
+	timedemo_num = 0;
+	timedemo_frame_start = timedemo_last = 0;
+	memset(timedemo_stage_total, 0, sizeof(timedemo_stage_total));
+	timedemo_running = 1;
+}
+
+// start of a game frame, which is also the end of the last one
+void timedemo_frame(void)
+{
+	u_int64_t now;
+
+	if (!timedemo_running)
+		return;
+
+	now = SDL_GetPerformanceCounter();
+	if (timedemo_frame_start)
+	{
+		timedemo_stage_total[TIMEDEMO_PRESENT] += now - timedemo_last;
+		if (timedemo_num == timedemo_max)
+		{
+			u_int32_t *times = d_realloc(timedemo_times, sizeof(u_int32_t) * (timedemo_max ? timedemo_max * 2 : 4096));
+
+			if (!times)
+				return;
+			timedemo_times = times;
+			timedemo_max = timedemo_max ? timedemo_max * 2 : 4096;
+		}
+		timedemo_times[timedemo_num++] = (now - timedemo_frame_start) * 1000000 / SDL_GetPerformanceFrequency();
+	}
+	timedemo_frame_start = timedemo_last = now;
+}
+
+// the time since the last mark was spent in stage
+void timedemo_stage(int stage)
+{
+	u_int64_t now;
+
+	if (!timedemo_running || !timedemo_frame_start)
+		return;
+
+	now = SDL_GetPerformanceCounter();
+	timedemo_stage_total[stage] += now - timedemo_last;
+	timedemo_last = now;
+}
+
+static int timedemo_cmp(const void *a, const void *b)
+{
+	u_int32_t x = *(const u_int32_t *)a, y = *(const u_int32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+// frame time in milliseconds that p percent of the frames are not slower than
+static double timedemo_percentile(int p)
+{
+	int i = (timedemo_num * p + 99) / 100 - 1;
+
+	return timedemo_times[max(i, 0)] / 1000.0;
+}
+
+void timedemo_report(void)
+{
+	double seconds = 0, stage_ms[TIMEDEMO_STAGES], freq = SDL_GetPerformanceFrequency();
+	PHYSFS_file *fp;
+	int i;
+
+	if (!timedemo_running)
+		return;
+	timedemo_running = 0;
+	if (!timedemo_num)
+	{
+		con_printf(CON_URGENT, "timedemo: no frames\n");
+		return;
+	}
+
+	for (i = 0; i < timedemo_num; i++)
+		seconds += timedemo_times[i] / 1000000.0;
+	for (i = 0; i < TIMEDEMO_STAGES; i++)
+		stage_ms[i] = timedemo_stage_total[i] * 1000 / freq / timedemo_num;
+	qsort(timedemo_times, timedemo_num, sizeof(u_int32_t), timedemo_cmp);
+
+	con_printf(CON_NORMAL, "timedemo: %i frames in %.2f seconds, %.1f fps\n", timedemo_num, seconds, timedemo_num / seconds);
+	con_printf(CON_NORMAL, "timedemo: frame time avg %.2f ms, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+		seconds * 1000 / timedemo_num, timedemo_percentile(50), timedemo_percentile(95), timedemo_percentile(99), timedemo_percentile(100));
+	con_printf(CON_NORMAL, "timedemo: per frame %s %.3f ms, %s %.3f ms, %s %.3f ms, %s %.3f ms\n",
+		timedemo_stage_names[0], stage_ms[0], timedemo_stage_names[1], stage_ms[1], timedemo_stage_names[2], stage_ms[2], timedemo_stage_names[3], stage_ms[3]);
+
+	if (GameArg.SysTimeDemoJSON)
+	{
+		if (!(fp = PHYSFS_openWrite(GameArg.SysTimeDemoJSON)))
+			con_printf(CON_URGENT, "Cannot write %s\n", GameArg.SysTimeDemoJSON);
+		else
+		{
+			PHYSFSX_printf(fp, "{\n");
+			PHYSFSX_printf(fp, "\t\"demo\": \"%s\",\n", GameArg.SysTimeDemo);
+			PHYSFSX_printf(fp, "\t\"render\": %s,\n", GameArg.SysTimeDemoNoRender ? "false" : "true");
+			PHYSFSX_printf(fp, "\t\"vsync\": false,\n"); // always off for the run
+			PHYSFSX_printf(fp, "\t\"frames\": %i,\n", timedemo_num);
+			PHYSFSX_printf(fp, "\t\"seconds\": %.3f,\n", seconds);
+			PHYSFSX_printf(fp, "\t\"fps\": %.2f,\n", timedemo_num / seconds);
+			PHYSFSX_printf(fp, "\t\"frame_ms\": { \"avg\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n",
+				seconds * 1000 / timedemo_num, timedemo_percentile(50), timedemo_percentile(95), timedemo_percentile(99), timedemo_percentile(100));
+			PHYSFSX_printf(fp, "\t\"stage_ms\": {");
+			for (i = 0; i < TIMEDEMO_STAGES; i++)
+				PHYSFSX_printf(fp, "%s \"%s\": %.3f", i ? "," : "", timedemo_stage_names[i], stage_ms[i]);
+			PHYSFSX_printf(fp, " }\n");
+			PHYSFSX_printf(fp, "}\n");
+			PHYSFS_close(fp);
+		}
+	}
+
+	d_free(timedemo_times);
+	timedemo_num = timedemo_max = 0;
+}
@@ -96,9 +96,15 @@ static int rescale_y(int y)
 static void briefing_release_gl(void)
 {
 	if (briefing_fbo)
+	{
 		glDeleteFramebuffers(1, &briefing_fbo);
+		ogl_state_forget_framebuffer(briefing_fbo);
+	}
 	if (briefing_tex)
+	{
 		glDeleteTextures(1, &briefing_tex);
+		ogl_state_forget_texture(briefing_tex);
+	}
 	briefing_fbo = 0;
 	briefing_tex = 0;
 	briefing_tex_w = 0;
@@ -112,10 +118,10 @@ static void briefing_ensure_gl_target(int w, int h)
 		briefing_release_gl();
 
 		glGenFramebuffers(1, &briefing_fbo);
-		glBindFramebuffer(GL_FRAMEBUFFER, briefing_fbo);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, briefing_fbo);
 
 		glGenTextures(1, &briefing_tex);
-		glBindTexture(GL_TEXTURE_2D, briefing_tex);
+		ogl_state_bind_texture(GL_TEXTURE_2D, briefing_tex);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -123,7 +129,7 @@ static void briefing_ensure_gl_target(int w, int h)
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, briefing_tex, 0);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, 0);
 
 		briefing_tex_w = w;
 		briefing_tex_h = h;
@@ -1387,13 +1393,13 @@ int briefing_handler(window *wind, d_event *event, briefing *br)
 			timer_delay2(50);
 #ifdef USE_OPENVR
 #ifdef OGL
-			GLint prev_fbo = 0;
+			GLuint prev_fbo = 0;
 			if (vr_openvr_active())
 			{
-				glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+				prev_fbo = ogl_state_framebuffer(GL_DRAW_FRAMEBUFFER);
 				briefing_ensure_gl_target(grd_curscreen->sc_w, grd_curscreen->sc_h);
-				glBindFramebuffer(GL_FRAMEBUFFER, briefing_fbo);
-				glViewport(0, 0, briefing_tex_w, briefing_tex_h);
+				ogl_state_bind_framebuffer(GL_FRAMEBUFFER, briefing_fbo);
+				ogl_state_viewport(0, 0, briefing_tex_w, briefing_tex_h);
 				glClear(GL_COLOR_BUFFER_BIT);
 			}
 #endif
@@ -1432,7 +1438,7 @@ int briefing_handler(window *wind, d_event *event, briefing *br)
 #ifdef OGL
 			if (vr_openvr_active())
 			{
-				glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev_fbo);
+				ogl_state_bind_framebuffer(GL_FRAMEBUFFER, prev_fbo);
 				vr_openvr_submit_mono_from_texture(briefing_tex, 1.0f, 1.0f, 1);
 			}
 #endif
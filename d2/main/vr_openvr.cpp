@@ -21,6 +21,9 @@ const vms_matrix vmd_identity_matrix = IDENTITY_MATRIX;
 
 #ifdef OGL
 #include <GL/glew.h>
+extern "C" {
+#include "ogl_init.h"
+}
 #endif
 
 #ifdef USE_OPENVR
@@ -63,6 +66,13 @@ static void vr_openvr_release_gl(void)
 	glDeleteRenderbuffers(2, vr_eye_depth);
 	glDeleteFramebuffers(1, &vr_menu_fbo);
 	glDeleteTextures(1, &vr_menu_tex);
+	for (int eye = 0; eye < 2; eye++)
+	{
+		ogl_state_forget_framebuffer(vr_eye_fbo[eye]);
+		ogl_state_forget_texture(vr_eye_color[eye]);
+	}
+	ogl_state_forget_framebuffer(vr_menu_fbo);
+	ogl_state_forget_texture(vr_menu_tex);
 
 	vr_eye_fbo[0] = vr_eye_fbo[1] = 0;
 	vr_eye_color[0] = vr_eye_color[1] = 0;
@@ -92,7 +102,7 @@ static void vr_openvr_init_render_targets(void)
 	for (int eye = 0; eye < 2; eye++)
 	{
 		glGenTextures(1, &vr_eye_color[eye]);
-		glBindTexture(GL_TEXTURE_2D, vr_eye_color[eye]);
+		ogl_state_bind_texture(GL_TEXTURE_2D, vr_eye_color[eye]);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -104,24 +114,24 @@ static void vr_openvr_init_render_targets(void)
 		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, vr_render_width, vr_render_height);
 
 		glGenFramebuffers(1, &vr_eye_fbo[eye]);
-		glBindFramebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, vr_eye_color[eye], 0);
 		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, vr_eye_depth[eye]);
 
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 		{
 			con_printf(CON_NORMAL, "OpenVR framebuffer incomplete for eye %d.\n", eye);
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			ogl_state_bind_framebuffer(GL_FRAMEBUFFER, 0);
 			vr_openvr_release_gl();
 			GameCfg.VREnabled = 0;
 			return;
 		}
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, 0);
 
 	glGenTextures(1, &vr_menu_tex);
-	glBindTexture(GL_TEXTURE_2D, vr_menu_tex);
+	ogl_state_bind_texture(GL_TEXTURE_2D, vr_menu_tex);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -129,12 +139,12 @@ static void vr_openvr_init_render_targets(void)
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, vr_render_width, vr_render_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 
 	glGenFramebuffers(1, &vr_menu_fbo);
-	glBindFramebuffer(GL_FRAMEBUFFER, vr_menu_fbo);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, vr_menu_fbo);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, vr_menu_tex, 0);
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 	{
 		con_printf(CON_NORMAL, "OpenVR framebuffer incomplete for menu.\n");
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, 0);
 		vr_openvr_release_gl();
 		GameCfg.VREnabled = 0;
 		return;
@@ -159,13 +169,13 @@ static void vr_openvr_draw_curved_quad(GLuint texture, float tex_u_max, float te
 	const float radius = 8.0f;
 	const float curve = 1.0f;
 	const float height = 5.0f;
-	const GLboolean prev_blend = glIsEnabled(GL_BLEND);
-	const GLboolean prev_alpha = glIsEnabled(GL_ALPHA_TEST);
+	const int prev_blend = ogl_state_enabled(GL_BLEND);
+	const int prev_alpha = ogl_state_enabled(GL_ALPHA_TEST);
 
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_BLEND);
-	glDisable(GL_ALPHA_TEST);
+	ogl_state_disable(GL_DEPTH_TEST);
+	ogl_state_disable(GL_CULL_FACE);
+	ogl_state_disable(GL_BLEND);
+	ogl_state_disable(GL_ALPHA_TEST);
 	glUseProgram(0);
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
@@ -187,12 +197,12 @@ static void vr_openvr_draw_curved_quad(GLuint texture, float tex_u_max, float te
 
 	if (texture)
 	{
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glEnable(GL_TEXTURE_2D);
+		ogl_state_bind_texture(GL_TEXTURE_2D, texture);
+		ogl_state_enable(GL_TEXTURE_2D);
 	}
 	else
 	{
-		glDisable(GL_TEXTURE_2D);
+		ogl_state_disable(GL_TEXTURE_2D);
 	}
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
@@ -212,11 +222,11 @@ static void vr_openvr_draw_curved_quad(GLuint texture, float tex_u_max, float te
 	}
 	glEnd();
 
-	glDisable(GL_TEXTURE_2D);
+	ogl_state_disable(GL_TEXTURE_2D);
 	if (prev_blend)
-		glEnable(GL_BLEND);
+		ogl_state_enable(GL_BLEND);
 	if (prev_alpha)
-		glEnable(GL_ALPHA_TEST);
+		ogl_state_enable(GL_ALPHA_TEST);
 }
 
 static void vr_openvr_draw_flat_quad(GLuint texture, float tex_u_max, float tex_v_max, int eye)
@@ -224,13 +234,13 @@ static void vr_openvr_draw_flat_quad(GLuint texture, float tex_u_max, float tex_
 	const float width = 2.0f;
 	const float height = 1.2f;
 	const float depth = -2.0f;
-	const GLboolean prev_blend = glIsEnabled(GL_BLEND);
-	const GLboolean prev_alpha = glIsEnabled(GL_ALPHA_TEST);
+	const int prev_blend = ogl_state_enabled(GL_BLEND);
+	const int prev_alpha = ogl_state_enabled(GL_ALPHA_TEST);
 
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_BLEND);
-	glDisable(GL_ALPHA_TEST);
+	ogl_state_disable(GL_DEPTH_TEST);
+	ogl_state_disable(GL_CULL_FACE);
+	ogl_state_disable(GL_BLEND);
+	ogl_state_disable(GL_ALPHA_TEST);
 	glUseProgram(0);
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
@@ -252,12 +262,12 @@ static void vr_openvr_draw_flat_quad(GLuint texture, float tex_u_max, float tex_
 
 	if (texture)
 	{
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glEnable(GL_TEXTURE_2D);
+		ogl_state_bind_texture(GL_TEXTURE_2D, texture);
+		ogl_state_enable(GL_TEXTURE_2D);
 	}
 	else
 	{
-		glDisable(GL_TEXTURE_2D);
+		ogl_state_disable(GL_TEXTURE_2D);
 	}
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
@@ -272,11 +282,11 @@ static void vr_openvr_draw_flat_quad(GLuint texture, float tex_u_max, float tex_
 	glVertex3f(width * 0.5f, height * 0.5f, depth);
 	glEnd();
 
-	glDisable(GL_TEXTURE_2D);
+	ogl_state_disable(GL_TEXTURE_2D);
 	if (prev_blend)
-		glEnable(GL_BLEND);
+		ogl_state_enable(GL_BLEND);
 	if (prev_alpha)
-		glEnable(GL_ALPHA_TEST);
+		ogl_state_enable(GL_ALPHA_TEST);
 }
 
 #endif
@@ -503,10 +513,10 @@ void vr_openvr_bind_eye(int eye)
 	if (!vr_openvr_active() || !vr_gl_ready)
 		return;
 
-	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &vr_prev_fbo);
-	glGetIntegerv(GL_VIEWPORT, vr_prev_viewport);
-	glBindFramebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
-	glViewport(0, 0, vr_render_width, vr_render_height);
+	vr_prev_fbo = (GLint)ogl_state_framebuffer(GL_DRAW_FRAMEBUFFER);
+	ogl_state_get_viewport(vr_prev_viewport);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
+	ogl_state_viewport(0, 0, vr_render_width, vr_render_height);
 	vr_current_eye = eye;
 #else
 	(void)eye;
@@ -523,8 +533,8 @@ void vr_openvr_unbind_eye(void)
 	if (!vr_openvr_active() || !vr_gl_ready)
 		return;
 
-	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)vr_prev_fbo);
-	glViewport(vr_prev_viewport[0], vr_prev_viewport[1], vr_prev_viewport[2], vr_prev_viewport[3]);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, (GLuint)vr_prev_fbo);
+	ogl_state_viewport(vr_prev_viewport[0], vr_prev_viewport[1], vr_prev_viewport[2], vr_prev_viewport[3]);
 	vr_current_eye = -1;
 #endif
 #endif
@@ -541,9 +551,11 @@ void vr_openvr_submit_eyes(void)
 	vr::Texture_t right = {(void *)(uintptr_t)vr_eye_color[1], vr::TextureType_OpenGL, vr::ColorSpace_Auto};
 	vr_compositor->Submit(vr::Eye_Left, &left);
 	vr_compositor->Submit(vr::Eye_Right, &right);
+	// the compositor binds its own textures and framebuffers behind the state cache's back
+	ogl_state_invalidate();
 
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, vr_eye_fbo[0]);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	ogl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, vr_eye_fbo[0]);
+	ogl_state_bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
 	GLint blit_width = (GLint)vr_render_width;
 	GLint blit_height = (GLint)vr_render_height;
 	if (blit_width > grd_curscreen->sc_w)
@@ -551,7 +563,7 @@ void vr_openvr_submit_eyes(void)
 	if (blit_height > grd_curscreen->sc_h)
 		blit_height = grd_curscreen->sc_h;
 	glBlitFramebuffer(0, 0, blit_width, blit_height, 0, 0, grd_curscreen->sc_w, grd_curscreen->sc_h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	ogl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, 0);
 #endif
 #endif
 }
@@ -564,56 +576,43 @@ static void vr_openvr_submit_mono_from_buffer(int curved, int read_front)
 		return;
 
 	vr_openvr_begin_frame();
-	GLint prev_draw_fbo = 0;
-	GLint prev_read_fbo = 0;
-	GLint prev_read_buffer = GL_BACK;
-	GLint prev_draw_buffer = GL_BACK;
-	GLint prev_pack_alignment = 4;
-	GLint prev_unpack_alignment = 4;
-	GLboolean prev_scissor = GL_FALSE;
-	GLint prev_scissor_box[4] = {0, 0, 0, 0};
-	GLint double_buffer = 0;
-#ifdef GL_DRAW_FRAMEBUFFER_BINDING
-	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw_fbo);
-	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);
-#else
-	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_draw_fbo);
-	prev_read_fbo = prev_draw_fbo;
-#endif
-	glGetIntegerv(GL_READ_BUFFER, &prev_read_buffer);
-	glGetIntegerv(GL_DRAW_BUFFER, &prev_draw_buffer);   
-	glGetIntegerv(GL_PACK_ALIGNMENT, &prev_pack_alignment);
-	glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_unpack_alignment);
-	glGetIntegerv(GL_DOUBLEBUFFER, &double_buffer);
-	prev_scissor = glIsEnabled(GL_SCISSOR_TEST);
-	glGetIntegerv(GL_SCISSOR_BOX, prev_scissor_box);
+	const GLuint prev_draw_fbo = ogl_state_framebuffer(GL_DRAW_FRAMEBUFFER);
+	const GLuint prev_read_fbo = ogl_state_framebuffer(GL_READ_FRAMEBUFFER);
+	const GLenum prev_read_buffer = ogl_state_get_read_buffer();
+	const GLenum prev_draw_buffer = ogl_state_get_draw_buffer();
+	const GLint prev_pack_alignment = ogl_state_get_pixel_store(GL_PACK_ALIGNMENT);
+	const GLint prev_unpack_alignment = ogl_state_get_pixel_store(GL_UNPACK_ALIGNMENT);
+	const int double_buffer = ogl_state_doublebuffer();
+	const int prev_scissor = ogl_state_enabled(GL_SCISSOR_TEST);
+	GLint prev_scissor_box[4];
+	ogl_state_get_scissor(prev_scissor_box);
 #ifdef GL_READ_FRAMEBUFFER
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)prev_read_fbo);
+	ogl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read_fbo);
 #else
-	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev_read_fbo);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, prev_read_fbo);
 #endif
 	if (prev_read_fbo)
 	{
 		if (prev_read_buffer == GL_NONE)
-			glReadBuffer(GL_COLOR_ATTACHMENT0);
+			ogl_state_read_buffer(GL_COLOR_ATTACHMENT0);
 		else if (prev_read_buffer == GL_BACK || prev_read_buffer == GL_FRONT)
-			glReadBuffer(GL_COLOR_ATTACHMENT0);
+			ogl_state_read_buffer(GL_COLOR_ATTACHMENT0);
 		else
-			glReadBuffer(prev_read_buffer);
+			ogl_state_read_buffer(prev_read_buffer);
 	}
 	else
 	{
-		GLint fallback = prev_draw_buffer;
+		GLenum fallback = prev_draw_buffer;
 		if (prev_read_buffer != GL_NONE)
-			glReadBuffer(prev_read_buffer);
+			ogl_state_read_buffer(prev_read_buffer);
 		else if (fallback != GL_NONE)
-			glReadBuffer(fallback);
+			ogl_state_read_buffer(fallback);
 		else
-			glReadBuffer(double_buffer ? GL_BACK : GL_FRONT);
+			ogl_state_read_buffer(double_buffer ? GL_BACK : GL_FRONT);
 	}
-	glDisable(GL_SCISSOR_TEST);
+	ogl_state_disable(GL_SCISSOR_TEST);
 	glFlush();
-	glBindTexture(GL_TEXTURE_2D, vr_menu_tex);
+	ogl_state_bind_texture(GL_TEXTURE_2D, vr_menu_tex);
 	GLint copy_width = (GLint)vr_render_width;
 	GLint copy_height = (GLint)vr_render_height;
 	if (copy_width > grd_curscreen->sc_w)
@@ -632,24 +631,24 @@ static void vr_openvr_submit_mono_from_buffer(int curved, int read_front)
 	}
 	if (vr_menu_pixels && copy_size > 0)
 	{
-		glPixelStorei(GL_PACK_ALIGNMENT, 1);
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		ogl_state_pixel_store(GL_PACK_ALIGNMENT, 1);
+		ogl_state_pixel_store(GL_UNPACK_ALIGNMENT, 1);
 		glReadPixels(0, 0, copy_width, copy_height, GL_RGBA, GL_UNSIGNED_BYTE, vr_menu_pixels);
 		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, copy_width, copy_height, GL_RGBA, GL_UNSIGNED_BYTE, vr_menu_pixels);
 	}
-	glPixelStorei(GL_PACK_ALIGNMENT, prev_pack_alignment);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack_alignment);
-	glReadBuffer(prev_read_buffer);
+	ogl_state_pixel_store(GL_PACK_ALIGNMENT, prev_pack_alignment);
+	ogl_state_pixel_store(GL_UNPACK_ALIGNMENT, prev_unpack_alignment);
+	ogl_state_read_buffer(prev_read_buffer);
 	if (prev_scissor)
-		glEnable(GL_SCISSOR_TEST);
+		ogl_state_enable(GL_SCISSOR_TEST);
 	else
-		glDisable(GL_SCISSOR_TEST);
-	glScissor(prev_scissor_box[0], prev_scissor_box[1], prev_scissor_box[2], prev_scissor_box[3]);
+		ogl_state_disable(GL_SCISSOR_TEST);
+	ogl_state_scissor(prev_scissor_box[0], prev_scissor_box[1], prev_scissor_box[2], prev_scissor_box[3]);
 
 	for (int eye = 0; eye < 2; eye++)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
-		glViewport(0, 0, vr_render_width, vr_render_height);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
+		ogl_state_viewport(0, 0, vr_render_width, vr_render_height);
 		glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		if (curved)
@@ -660,15 +659,15 @@ static void vr_openvr_submit_mono_from_buffer(int curved, int read_front)
     if (prev_read_fbo)
 	{
 #ifdef GL_READ_FRAMEBUFFER
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)prev_read_fbo);
+		ogl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read_fbo);
 #else
-		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev_read_fbo);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, prev_read_fbo);
 #endif
 	}
 #ifdef GL_DRAW_FRAMEBUFFER
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)prev_draw_fbo);
+	ogl_state_bind_framebuffer(GL_DRAW_FRAMEBUFFER, prev_draw_fbo);
 #else
-	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev_draw_fbo);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, prev_draw_fbo);
 #endif
 	vr_openvr_submit_eyes();
 #endif
@@ -683,52 +682,41 @@ void vr_openvr_submit_mono_from_screen(int curved)
 		return;
 
 	vr_openvr_begin_frame();
-	GLint prev_draw_fbo = 0;
-	GLint prev_read_fbo = 0;
-	GLint prev_read_buffer = GL_BACK;
-	GLint prev_draw_buffer = GL_BACK;
-	GLboolean prev_scissor = GL_FALSE;
-	GLint prev_scissor_box[4] = {0, 0, 0, 0};
-	GLint double_buffer = 0;
-#ifdef GL_DRAW_FRAMEBUFFER_BINDING
-	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw_fbo);
-	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);
-#else
-	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_draw_fbo);
-	prev_read_fbo = prev_draw_fbo;
-#endif
-	glGetIntegerv(GL_READ_BUFFER, &prev_read_buffer);
-	glGetIntegerv(GL_DRAW_BUFFER, &prev_draw_buffer);
-	glGetIntegerv(GL_DOUBLEBUFFER, &double_buffer);
-	prev_scissor = glIsEnabled(GL_SCISSOR_TEST);
-	glGetIntegerv(GL_SCISSOR_BOX, prev_scissor_box);
+	const GLuint prev_draw_fbo = ogl_state_framebuffer(GL_DRAW_FRAMEBUFFER);
+	const GLuint prev_read_fbo = ogl_state_framebuffer(GL_READ_FRAMEBUFFER);
+	const GLenum prev_read_buffer = ogl_state_get_read_buffer();
+	const GLenum prev_draw_buffer = ogl_state_get_draw_buffer();
+	const int double_buffer = ogl_state_doublebuffer();
+	const int prev_scissor = ogl_state_enabled(GL_SCISSOR_TEST);
+	GLint prev_scissor_box[4];
+	ogl_state_get_scissor(prev_scissor_box);
 #ifdef GL_READ_FRAMEBUFFER
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)prev_read_fbo);
+	ogl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read_fbo);
 #else
-	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev_read_fbo);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, prev_read_fbo);
 #endif
 	if (prev_read_fbo)
 	{
 			if (prev_read_buffer == GL_NONE)
-			glReadBuffer(GL_COLOR_ATTACHMENT0);
+			ogl_state_read_buffer(GL_COLOR_ATTACHMENT0);
 			else if (prev_read_buffer == GL_BACK || prev_read_buffer == GL_FRONT)
-			glReadBuffer(GL_COLOR_ATTACHMENT0);
+			ogl_state_read_buffer(GL_COLOR_ATTACHMENT0);
 		    else
-			glReadBuffer(prev_read_buffer);
+			ogl_state_read_buffer(prev_read_buffer);
 	}
 	else
 	{
-		GLint fallback = prev_draw_buffer;
+		GLenum fallback = prev_draw_buffer;
 		if (prev_read_buffer != GL_NONE)
-			glReadBuffer(prev_read_buffer);
+			ogl_state_read_buffer(prev_read_buffer);
 		else if (fallback != GL_NONE)
-			glReadBuffer(fallback);
+			ogl_state_read_buffer(fallback);
 		else
-			glReadBuffer(double_buffer ? GL_BACK : GL_FRONT);
+			ogl_state_read_buffer(double_buffer ? GL_BACK : GL_FRONT);
 	}
-	glDisable(GL_SCISSOR_TEST);
+	ogl_state_disable(GL_SCISSOR_TEST);
 	glFlush();
-	glBindTexture(GL_TEXTURE_2D, vr_menu_tex);
+	ogl_state_bind_texture(GL_TEXTURE_2D, vr_menu_tex);
 	GLint copy_width = (GLint)vr_render_width;
 	GLint copy_height = (GLint)vr_render_height;
 	if (copy_width > grd_curscreen->sc_w)
@@ -736,17 +724,17 @@ void vr_openvr_submit_mono_from_screen(int curved)
 	if (copy_height > grd_curscreen->sc_h)
 		copy_height = grd_curscreen->sc_h;
 	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, copy_width, copy_height);
-	glReadBuffer(prev_read_buffer);
+	ogl_state_read_buffer(prev_read_buffer);
 	if (prev_scissor)
-		glEnable(GL_SCISSOR_TEST);
+		ogl_state_enable(GL_SCISSOR_TEST);
 	else
-		glDisable(GL_SCISSOR_TEST);
-	glScissor(prev_scissor_box[0], prev_scissor_box[1], prev_scissor_box[2], prev_scissor_box[3]);
+		ogl_state_disable(GL_SCISSOR_TEST);
+	ogl_state_scissor(prev_scissor_box[0], prev_scissor_box[1], prev_scissor_box[2], prev_scissor_box[3]);
 
 	for (int eye = 0; eye < 2; eye++)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
-		glViewport(0, 0, vr_render_width, vr_render_height);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
+		ogl_state_viewport(0, 0, vr_render_width, vr_render_height);
 		glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		if (curved)
@@ -757,15 +745,15 @@ void vr_openvr_submit_mono_from_screen(int curved)
 	if (prev_read_fbo)
 	{
 #ifdef GL_READ_FRAMEBUFFER
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)prev_read_fbo);
+		ogl_state_bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read_fbo);
 #else
-		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev_read_fbo);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, prev_read_fbo);
 #endif
 	}
 #ifdef GL_DRAW_FRAMEBUFFER
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)prev_draw_fbo);
+	ogl_state_bind_framebuffer(GL_DRAW_FRAMEBUFFER, prev_draw_fbo);
 #else
-	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev_draw_fbo);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, prev_draw_fbo);
 #endif
 	vr_openvr_submit_eyes();
 #endif
@@ -784,14 +772,14 @@ void vr_openvr_bind_menu_target(void)
 	if (!vr_openvr_active() || !vr_gl_ready || !vr_menu_fbo)
 		return;
 		
-	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &vr_prev_fbo);
-	glGetIntegerv(GL_VIEWPORT, vr_prev_viewport);
+	vr_prev_fbo = (GLint)ogl_state_framebuffer(GL_DRAW_FRAMEBUFFER);
+	ogl_state_get_viewport(vr_prev_viewport);
 	vr_prev_canvas_width = Canvas_width;
 	vr_prev_canvas_height = Canvas_height;
 	vr_prev_last_width = last_width;
 	vr_prev_last_height = last_height;
-	glBindFramebuffer(GL_FRAMEBUFFER, vr_menu_fbo);
-	glViewport(0, 0, vr_render_width, vr_render_height);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, vr_menu_fbo);
+	ogl_state_viewport(0, 0, vr_render_width, vr_render_height);
 	Canvas_width = (int)vr_render_width;
 	Canvas_height = (int)vr_render_height;
 	last_width = (int)vr_render_width;
@@ -810,8 +798,8 @@ void vr_openvr_unbind_menu_target(void)
 		return;
 
 	extern int last_width, last_height;
-	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)vr_prev_fbo);
-	glViewport(vr_prev_viewport[0], vr_prev_viewport[1], vr_prev_viewport[2], vr_prev_viewport[3]);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, (GLuint)vr_prev_fbo);
+	ogl_state_viewport(vr_prev_viewport[0], vr_prev_viewport[1], vr_prev_viewport[2], vr_prev_viewport[3]);
 	Canvas_width = vr_prev_canvas_width;
 	Canvas_height = vr_prev_canvas_height;
 	last_width = vr_prev_last_width;
@@ -842,8 +830,8 @@ void vr_openvr_submit_mono_from_texture(unsigned int texture, float u, float v,
 	vr_openvr_begin_frame();
 	for (int eye = 0; eye < 2; eye++)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
-		glViewport(0, 0, vr_render_width, vr_render_height);
+		ogl_state_bind_framebuffer(GL_FRAMEBUFFER, vr_eye_fbo[eye]);
+		ogl_state_viewport(0, 0, vr_render_width, vr_render_height);
 		glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		if (curved)
@@ -852,7 +840,7 @@ void vr_openvr_submit_mono_from_texture(unsigned int texture, float u, float v,
 			vr_openvr_draw_flat_quad(texture, u, v, eye);
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	ogl_state_bind_framebuffer(GL_FRAMEBUFFER, 0);
 	vr_openvr_submit_eyes();
 #endif
 #endif
@@ -1433,8 +1433,6 @@ void remove_obsolete_stuck_objects(void)
 
 }
 
-extern void flush_fcd_cache(void);
-
 //	----------------------------------------------------------------------------------------------------
 //	Door with wall index wallnum is opening, kill all objects stuck in it.
 void kill_stuck_objects(int wallnum)
@@ -1457,7 +1455,7 @@ void kill_stuck_objects(int wallnum)
 			Num_stuck_objects++;
 		}
 	//	Ok, this is awful, but we need to do things whenever a door opens/closes/disappears, etc.
-	flush_fcd_cache();
+	conn_walls_changed();
 
 }
 
@@ -1137,72 +1137,59 @@ void smega_rock_stuff(void)
 	}
 }
 
-int	Super_mines_yes = 1;
-
 //	Call this once/frame to process all super mines in the level.
 void process_super_mines_frame(void)
 {
-	int	i, j;
-	int	start, add;
-
-	//	If we don't know of there being any super mines in the level, just
-	//	check every 8th object each frame.
-	if (Super_mines_yes == 0) {
-		start = d_tick_count & 7;
-		add = 8;
-	} else {
-		start = 0;
-		add = 1;
-	}
+	int	n, m, cnt, i, j;
+	short	objnums[MAX_OBJECTS];
 
-	Super_mines_yes = 0;
-
-	for (i=start; i<=Highest_object_index; i+=add) {
-		if ((Objects[i].type == OBJ_WEAPON) && (Objects[i].id == SUPERPROX_ID)) {
+	for (n=0; n<Obj_type_count[OBJ_WEAPON]; n++) {
+		i = Obj_type_list[OBJ_WEAPON][n];
+		if (Objects[i].id == SUPERPROX_ID) {
 			int	parent_num;
 
 			parent_num = Objects[i].ctype.laser_info.parent_num;
 
-			Super_mines_yes = 1;
 			if (Objects[i].lifeleft + F1_0*2 < Weapon_info[SUPERPROX_ID].lifetime) {
 				vms_vector	*bombpos;
 
 				bombpos = &Objects[i].pos;
 
-				for (j=0; j<=Highest_object_index; j++) {
-					if ((Objects[j].type == OBJ_PLAYER) || (Objects[j].type == OBJ_ROBOT)) {
-						fix	dist;
-
-						dist = vm_vec_dist_quick(bombpos, &Objects[j].pos);
-
-						if (j != parent_num)
-							if (dist - Objects[j].size < F1_0*20)
-							{
-								if (Objects[i].segnum == Objects[j].segnum)
-									Objects[i].lifeleft = 1;
-								else {
-									//	Object which is close enough to detonate smart mine is not in same segment as smart mine.
-									//	Need to do a more expensive check to make sure there isn't an obstruction.
-									if (((d_tick_count ^ (i+j)) % 4) == 0) {
-										fvi_query	fq;
-										fvi_info		hit_data;
-										int			fate;
-
-										fq.startseg = Objects[i].segnum;
-										fq.p0						= &Objects[i].pos;
-										fq.p1						= &Objects[j].pos;
-										fq.rad					= 0;
-										fq.thisobjnum			= i;
-										fq.ignore_obj_list	= NULL;
-										fq.flags					= 0;
-
-										fate = find_vector_intersection(&fq, &hit_data);
-										if (fate != HIT_WALL)
-											Objects[i].lifeleft = 1;
-									}
+				//	only players and robots that reach within 20 units of the mine can set it off
+				cnt = obj_grid_find(bombpos, F1_0*20 + obj_grid_max_size(), (1 << OBJ_PLAYER) | (1 << OBJ_ROBOT), objnums);
+				for (m=0; m<cnt; m++) {
+					fix	dist;
+
+					j = objnums[m];
+					dist = vm_vec_dist_quick(bombpos, &Objects[j].pos);
+
+					if (j != parent_num)
+						if (dist - Objects[j].size < F1_0*20)
+						{
+							if (Objects[i].segnum == Objects[j].segnum)
+								Objects[i].lifeleft = 1;
+							else {
+								//	Object which is close enough to detonate smart mine is not in same segment as smart mine.
+								//	Need to do a more expensive check to make sure there isn't an obstruction.
+								if (((d_tick_count ^ (i+j)) % 4) == 0) {
+									fvi_query	fq;
+									fvi_info		hit_data;
+									int			fate;
+
+									fq.startseg = Objects[i].segnum;
+									fq.p0						= &Objects[i].pos;
+									fq.p1						= &Objects[j].pos;
+									fq.rad					= 0;
+									fq.thisobjnum			= i;
+									fq.ignore_obj_list	= NULL;
+									fq.flags					= 0;
+
+									fate = find_vector_intersection(&fq, &hit_data);
+									if (fate != HIT_WALL)
+										Objects[i].lifeleft = 1;
 								}
 							}
-					}
+						}
 				}
 			}
 		}
@@ -144,6 +144,9 @@ void ReadCmdArgs(void)
 	GameArg.SysNoBorders 		= FindArg("-noborders");
 	GameArg.SysNoMovies 		= FindArg("-nomovies");
 	GameArg.SysAutoDemo 		= FindArg("-autodemo");
+	GameArg.SysTimeDemo 		= get_str_arg("-timedemo", NULL);
+	GameArg.SysTimeDemoJSON 	= get_str_arg("-timedemo_json", NULL);
+	GameArg.SysTimeDemoNoRender 	= FindArg("-timedemo_norender");
 
 	// Control Options
 
@@ -175,11 +178,14 @@ void ReadCmdArgs(void)
 	GameArg.GfxHiresFNTAvailable	= !FindArg("-lowresfont");
 	GameArg.GfxMovieHires 		= !FindArg( "-lowresmovies" );
 	GameArg.GfxVREnabled		= FindArg("-vr");
+	GameArg.GfxConnectedLight	= FindArg("-connectedlight");
 
 #ifdef OGL
 	// OpenGL Options
 
 	GameArg.OglFixedFont 		= FindArg("-gl_fixedfont");
+	GameArg.OglLevelMesh 		= FindArg("-gl_levelmesh");
+	GameArg.OglTexArray 		= FindArg("-gl_texarray");
 #endif
 
 	// Multiplayer Options
@@ -188,6 +194,14 @@ void ReadCmdArgs(void)
 	GameArg.MplUdpHostAddr		= get_str_arg("-udp_hostaddr", UDP_MANUAL_ADDR_DEFAULT);
 	GameArg.MplUdpHostPort		= get_int_arg("-udp_hostport", 0);
 	GameArg.MplUdpMyPort		= get_int_arg("-udp_myport", 0);
+	GameArg.MplUdpJoin		= FindArg("-udp_join");
+	GameArg.MplUdpThread		= FindArg("-udp_thread");
+	GameArg.MplUdpMtu		= get_int_arg("-udp_mtu", UDP_MTU_DEFAULT);
+	GameArg.MplUdpSnapshot		= FindArg("-udp_snapshot");
+	GameArg.MplObsRelay		= FindArg("-obs_relay");
+	GameArg.MplDedicated		= FindArg("-dedicated");
+	GameArg.MplDedicatedCmd		= get_str_arg("-dedicated_cmd", NULL);
+	GameArg.MplDedicatedTick	= get_int_arg("-dedicated_tick", 60);
 #ifdef USE_TRACKER
 	GameArg.MplTrackerAddr		= get_str_arg("-tracker_hostaddr", TRACKER_ADDR_DEFAULT);
 	GameArg.MplTrackerPort		= get_int_arg("-tracker_hostport", TRACKER_PORT_DEFAULT);
@@ -211,6 +225,13 @@ void ReadCmdArgs(void)
 	GameArg.DbgSafelog 		= FindArg("-safelog");
 	GameArg.DbgNoRun 		= FindArg("-norun");
 	GameArg.DbgRenderStats 		= FindArg("-renderstats");
+#ifdef BENCHMARKS
+	GameArg.DbgPointSegBench 	= get_int_arg("-pointsegbench", 0);
+	GameArg.DbgObjListStress 	= get_int_arg("-objliststress", 0);
+	GameArg.DbgPlpBench 		= get_int_arg("-plpbench", 0);
+	GameArg.DbgSigBench 		= FindArg("-sigbench");
+#endif
+	GameArg.DbgProfile 		= FindArg("-profile");
 	GameArg.DbgAltTex 		= get_str_arg("-text", NULL);
 	GameArg.DbgTexMap 		= get_str_arg("-tmap", NULL);
 	GameArg.DbgShowMemInfo 		= FindArg("-showmeminfo");
@@ -231,9 +252,17 @@ void ReadCmdArgs(void)
 #endif
 
 	GameArg.LogNetTraffic 		= FindArg("-netlog");
+	GameArg.LogNetCrash 		= get_int_arg("-netlog_crash", 0);
 
 	GameArg.GameLogTimeStamp	= FindArg("-gamelog_timestamp");
 	GameArg.GameLogSplit		= FindArg("-gamelog_split");
+
+	GameArg.SysHeadless = GameArg.MplDedicated || FindArg("-headless") || (GameArg.SysTimeDemo && GameArg.SysTimeDemoNoRender);
+	if (GameArg.SysHeadless) // nothing to show, play or read input from
+	{
+		GameArg.SndNoSound = GameArg.SndNoMusic = 1;
+		GameArg.CtlNoMouse = GameArg.CtlNoJoystick = 1;
+	}
 }
 
 void args_exit(void)
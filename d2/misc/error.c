@@ -29,6 +29,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #define MAX_MSG_LEN 256
 
 static void (*ErrorPrintFunc)(const char *);
+static void (*ErrorCrashFunc)(void);
 
 char warn_message[MAX_MSG_LEN];
 
@@ -46,6 +47,12 @@ void set_warn_func(void (*f)(char *s))
 	warn_func = f;
 }
 
+//provides a function to call when Error() is about to exit, e.g. to save debug data
+void set_crash_func(void (*f)(void))
+{
+	ErrorCrashFunc = f;
+}
+
 //uninstall warning function - install default printf
 void clear_warn_func(void (*f)(char *s))
 {
@@ -73,6 +80,9 @@ void Error(const char *fmt,...)
 
 	Int3();
 
+	if (ErrorCrashFunc)
+		(*ErrorCrashFunc)();
+
 	print_exit_message(exit_message);
 
 	exit(1);
@@ -0,0 +1,481 @@
+/*
+ * udpproxy - sits between the players of a UDP game on one machine and
+ * delays, drops, duplicates and reorders their packets.
+ *
+ * Players connect to the proxy instead of the host. Every player (and the
+ * host) is represented to the others by a socket of its own on the proxy,
+ * so the addresses the host hands out for peer to peer traffic lead
+ * through the proxy as well.
+ *
+ * This program is licensed under the terms of the GPL, version 2 or later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "net_udp.h"
+
+#define MAX_ENDPOINTS 64
+#define MAX_PENDING 8192
+#define REPEAT_HISTORY 4096
+#define REPEAT_WINDOW 10000 // ms an identical packet counts as resent
+
+typedef struct endpoint
+{
+	struct sockaddr_in real; // where the game instance really is
+	int fd; // the socket that stands for it
+} endpoint;
+
+typedef struct pending
+{
+	unsigned long long due;
+	int from, to, len;
+	unsigned char data[UPID_MAX_SIZE];
+} pending;
+
+typedef struct type_stats
+{
+	unsigned int packets, dropped, duped, repeats, bundled;
+	unsigned long long bytes;
+} type_stats;
+
+typedef struct impairment
+{
+	int latency, jitter, reorder_delay; // ms
+	double loss, dup, reorder; // percent
+} impairment;
+
+static endpoint endpoints[MAX_ENDPOINTS];
+static int num_endpoints = 0;
+static pending *queue[MAX_PENDING];
+static int queue_len = 0;
+static type_stats stats[256];
+static unsigned int repeat_hash[REPEAT_HISTORY];
+static unsigned long long repeat_time[REPEAT_HISTORY];
+static int repeat_pos = 0;
+static impairment imp;
+static struct in_addr bind_addr;
+static unsigned int rng_state = 1;
+static volatile sig_atomic_t quit = 0;
+
+static unsigned long long now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// xorshift, so a seed gives the same run again
+static unsigned int rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+static int chance(double percent)
+{
+	return percent > 0 && (rng() % 1000000) < percent * 10000;
+}
+
+static int same_addr(struct sockaddr_in *a, struct sockaddr_in *b)
+{
+	return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+static int open_socket(int port)
+{
+	struct sockaddr_in sa;
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (fd < 0)
+		return -1;
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_addr = bind_addr;
+	sa.sin_port = htons(port);
+	if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// The endpoint for a game instance, a new socket for it if we have not heard from it yet
+static int find_endpoint(struct sockaddr_in *addr)
+{
+	int i;
+
+	for (i = 0; i < num_endpoints; i++)
+		if (same_addr(&endpoints[i].real, addr))
+			return i;
+	if (num_endpoints == MAX_ENDPOINTS)
+		return -1;
+	endpoints[i].fd = open_socket(0);
+	if (endpoints[i].fd < 0)
+		return -1;
+	endpoints[i].real = *addr;
+	num_endpoints++;
+	printf("udpproxy: new peer %s:%i\n", inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
+	return i;
+}
+
+// Is this packet the same as one that went the same way a moment ago?
+static int is_repeat(int from, int to, unsigned char *data, int len, unsigned long long now)
+{
+	unsigned int h = 2166136261u ^ (from * 31 + to); // FNV-1a
+	int i;
+
+	for (i = 0; i < len; i++)
+		h = (h ^ data[i]) * 16777619u;
+	for (i = 0; i < REPEAT_HISTORY; i++)
+		if (repeat_hash[i] == h && repeat_time[i] + REPEAT_WINDOW > now)
+			return 1;
+	repeat_hash[repeat_pos] = h;
+	repeat_time[repeat_pos] = now;
+	repeat_pos = (repeat_pos + 1) % REPEAT_HISTORY;
+	return 0;
+}
+
+static void count_packet(unsigned char *data, int len, int repeat)
+{
+	type_stats *s = &stats[data[0]];
+	int loc = UPID_BUNDLE_HEADER_SIZE, l;
+
+	s->packets++;
+	s->bytes += len;
+	s->repeats += repeat;
+	if (data[0] != UPID_BUNDLE)
+		return;
+	// count what the bundle carries as well
+	while (loc + 2 < len)
+	{
+		l = data[loc] | (data[loc + 1] << 8);
+		loc += 2;
+		if (l < 1 || loc + l > len)
+			break;
+		stats[data[loc]].bundled++;
+		loc += l;
+	}
+}
+
+static void queue_packet(int from, int to, unsigned char *data, int len, unsigned long long now, int extra)
+{
+	pending *p;
+	int i;
+
+	if (queue_len == MAX_PENDING || !(p = malloc(sizeof(pending))))
+	{
+		stats[data[0]].dropped++;
+		return;
+	}
+	p->due = now + imp.latency + (imp.jitter ? rng() % (imp.jitter + 1) : 0) + extra;
+	p->from = from;
+	p->to = to;
+	p->len = len;
+	memcpy(p->data, data, len);
+
+	// keep it sorted by due time, packets with the same time stay in order
+	for (i = queue_len; i > 0 && queue[i - 1]->due > p->due; i--)
+		queue[i] = queue[i - 1];
+	queue[i] = p;
+	queue_len++;
+}
+
+static void got_packet(int to, unsigned char *data, int len, struct sockaddr_in *src, unsigned long long now)
+{
+	int from = find_endpoint(src);
+
+	if (from < 0 || from == to || len < 1)
+		return;
+
+	count_packet(data, len, is_repeat(from, to, data, len, now));
+
+	if (chance(imp.loss))
+	{
+		stats[data[0]].dropped++;
+		return;
+	}
+	queue_packet(from, to, data, len, now, chance(imp.reorder) ? imp.reorder_delay : 0);
+	if (chance(imp.dup))
+	{
+		stats[data[0]].duped++;
+		queue_packet(from, to, data, len, now, 0);
+	}
+}
+
+static void send_due(unsigned long long now)
+{
+	pending *p;
+	int i, n = 0;
+
+	while (n < queue_len && queue[n]->due <= now)
+	{
+		p = queue[n++];
+		sendto(endpoints[p->from].fd, p->data, p->len, 0, (struct sockaddr *)&endpoints[p->to].real, sizeof(struct sockaddr_in));
+		free(p);
+	}
+	for (i = n; i < queue_len; i++)
+		queue[i - n] = queue[i];
+	queue_len -= n;
+}
+
+static void print_stats(unsigned long long elapsed, unsigned long long since, unsigned long long bytes_since)
+{
+	unsigned long long bytes = 0;
+	unsigned int packets = 0;
+	int i;
+
+	printf("\n%-28s %9s %11s %8s %8s %8s %8s\n", "type", "packets", "bytes", "dropped", "duped", "resent", "bundled");
+	for (i = 0; i < 256; i++)
+	{
+		if (!stats[i].packets && !stats[i].bundled)
+			continue;
+		printf("%-28s %9u %11llu %8u %8u %8u %8u\n", msg_name(i), stats[i].packets, stats[i].bytes, stats[i].dropped, stats[i].duped, stats[i].repeats, stats[i].bundled);
+		packets += stats[i].packets;
+		bytes += stats[i].bytes;
+	}
+	printf("%.1f s: %u packets, %llu bytes, %.1f kB/s now, %.1f kB/s average\n",
+		elapsed / 1000.0, packets, bytes, since ? bytes_since / (double)since : 0, elapsed ? bytes / (double)elapsed : 0);
+	fflush(stdout);
+}
+
+static unsigned long long total_bytes(void)
+{
+	unsigned long long bytes = 0;
+	int i;
+
+	for (i = 0; i < 256; i++)
+		bytes += stats[i].bytes;
+	return bytes;
+}
+
+// Change one setting, from the command line or a scenario. Returns 0 if there is no such setting.
+static int set_option(impairment *i, const char *name, const char *value)
+{
+	if (!strcmp(name, "latency"))
+		i->latency = atoi(value);
+	else if (!strcmp(name, "jitter"))
+		i->jitter = atoi(value);
+	else if (!strcmp(name, "loss"))
+		i->loss = atof(value);
+	else if (!strcmp(name, "dup"))
+		i->dup = atof(value);
+	else if (!strcmp(name, "reorder"))
+		i->reorder = atof(value);
+	else if (!strcmp(name, "reorder_delay"))
+		i->reorder_delay = atoi(value);
+	else
+		return 0;
+	return 1;
+}
+
+// Scenario lines are "<seconds> <setting> <value>" or "<seconds> end", # starts a comment
+typedef struct scenario_step
+{
+	unsigned long long at;
+	char name[32], value[32];
+} scenario_step;
+
+static scenario_step *script = NULL;
+static int script_len = 0, script_pos = 0;
+
+static int load_script(const char *filename)
+{
+	char line[256];
+	double at;
+	impairment check;
+	FILE *f = fopen(filename, "r");
+
+	if (!f)
+		return 0;
+	while (fgets(line, sizeof(line), f))
+	{
+		scenario_step *s;
+
+		if (line[0] == '#')
+			continue;
+		script = realloc(script, (script_len + 1) * sizeof(scenario_step));
+		s = &script[script_len];
+		s->value[0] = 0;
+		if (sscanf(line, "%lf %31s %31s", &at, s->name, s->value) < 2)
+			continue;
+		if (strcmp(s->name, "end") && !set_option(&check, s->name, s->value))
+		{
+			fprintf(stderr, "udpproxy: unknown setting '%s' in %s\n", s->name, filename);
+			fclose(f);
+			return 0;
+		}
+		s->at = at * 1000;
+		script_len++;
+	}
+	fclose(f);
+	return 1;
+}
+
+static void run_script(unsigned long long elapsed)
+{
+	while (script_pos < script_len && script[script_pos].at <= elapsed)
+	{
+		scenario_step *s = &script[script_pos++];
+
+		if (!strcmp(s->name, "end"))
+		{
+			quit = 1;
+			return;
+		}
+		set_option(&imp, s->name, s->value);
+		printf("udpproxy: %.1f s: %s %s\n", elapsed / 1000.0, s->name, s->value);
+	}
+}
+
+static void on_signal(int sig)
+{
+	quit = 1;
+}
+
+static void usage(void)
+{
+	printf("Usage: udpproxy [options]\n"
+	       "  -port <n>            port the players connect to instead of the host (default 42425)\n"
+	       "  -host <addr> <port>  where the game host really is (default 127.0.0.1 %i)\n"
+	       "  -bind <addr>         address of the proxy sockets (default 127.0.0.1)\n"
+	       "  -latency <ms>        delay every packet\n"
+	       "  -jitter <ms>         delay every packet by up to that much more\n"
+	       "  -loss <percent>      drop packets\n"
+	       "  -dup <percent>       send packets twice\n"
+	       "  -reorder <percent>   hold packets back so later ones overtake them\n"
+	       "  -reorder_delay <ms>  how long to hold them back (default 20)\n"
+	       "  -seed <n>            random seed, the same seed gives the same drops\n"
+	       "  -interval <s>        print statistics every n seconds (default 10, 0 only at the end)\n"
+	       "  -duration <s>        stop after n seconds\n"
+	       "  -script <file>       change settings over time, lines are \"<seconds> <setting> <value>\"\n",
+	       UDP_PORT_DEFAULT);
+	exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+	struct pollfd pfd[MAX_ENDPOINTS];
+	struct sockaddr_in src;
+	socklen_t srclen;
+	unsigned char buf[UPID_MAX_SIZE];
+	unsigned long long start, now, last_print, last_bytes = 0, next;
+	int port = 42425, interval = 10, duration = 0, i, n, len, timeout;
+
+	memset(&imp, 0, sizeof(imp));
+	imp.reorder_delay = 20;
+	inet_aton("127.0.0.1", &bind_addr);
+	memset(&endpoints[0], 0, sizeof(endpoint));
+	endpoints[0].real.sin_family = AF_INET;
+	inet_aton("127.0.0.1", &endpoints[0].real.sin_addr);
+	endpoints[0].real.sin_port = htons(UDP_PORT_DEFAULT);
+	rng_state = time(NULL) | 1;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-port") && i + 1 < argc)
+			port = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-host") && i + 2 < argc)
+		{
+			if (!inet_aton(argv[++i], &endpoints[0].real.sin_addr))
+				usage();
+			endpoints[0].real.sin_port = htons(atoi(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "-bind") && i + 1 < argc)
+		{
+			if (!inet_aton(argv[++i], &bind_addr))
+				usage();
+		}
+		else if (!strcmp(argv[i], "-seed") && i + 1 < argc)
+			rng_state = atoi(argv[++i]) | 1;
+		else if (!strcmp(argv[i], "-interval") && i + 1 < argc)
+			interval = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-duration") && i + 1 < argc)
+			duration = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-script") && i + 1 < argc)
+		{
+			if (!load_script(argv[++i]))
+			{
+				fprintf(stderr, "udpproxy: cannot use script %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (argv[i][0] == '-' && i + 1 < argc && set_option(&imp, argv[i] + 1, argv[i + 1]))
+			i++;
+		else
+			usage();
+	}
+
+	endpoints[0].fd = open_socket(port);
+	if (endpoints[0].fd < 0)
+	{
+		fprintf(stderr, "udpproxy: cannot bind port %i: %s\n", port, strerror(errno));
+		return 1;
+	}
+	num_endpoints = 1;
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	printf("udpproxy: players connect to %s:%i, host is %s:%i\n", inet_ntoa(bind_addr), port, inet_ntoa(endpoints[0].real.sin_addr), ntohs(endpoints[0].real.sin_port));
+
+	start = last_print = now_ms();
+	while (!quit)
+	{
+		now = now_ms();
+		run_script(now - start);
+		if (duration && now - start >= (unsigned long long)duration * 1000)
+			break;
+		if (interval && now - last_print >= (unsigned long long)interval * 1000)
+		{
+			print_stats(now - start, now - last_print, total_bytes() - last_bytes);
+			last_bytes = total_bytes();
+			last_print = now;
+		}
+
+		next = now + 100;
+		if (queue_len && queue[0]->due < next)
+			next = queue[0]->due;
+		timeout = next > now ? next - now : 0;
+
+		n = num_endpoints; // got_packet() may add some
+		for (i = 0; i < n; i++)
+		{
+			pfd[i].fd = endpoints[i].fd;
+			pfd[i].events = POLLIN;
+			pfd[i].revents = 0;
+		}
+		if (poll(pfd, n, timeout) < 0 && errno != EINTR)
+			break;
+
+		now = now_ms();
+		for (i = 0; i < n; i++)
+		{
+			if (!(pfd[i].revents & POLLIN))
+				continue;
+			srclen = sizeof(src);
+			while ((len = recvfrom(endpoints[i].fd, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr *)&src, &srclen)) > 0)
+			{
+				got_packet(i, buf, len, &src, now);
+				srclen = sizeof(src);
+			}
+		}
+		send_due(now);
+	}
+
+	now = now_ms();
+	print_stats(now - start, now - last_print, total_bytes() - last_bytes);
+	return 0;
+}